@@ -0,0 +1,152 @@
+'use strict';
+// Statistics for comparing two sets of benchmark samples: the mean and
+// variance of each set and Welch's t-test for the difference of the means,
+// which does not assume that both sets have the same variance.
+
+exports.mean = mean;
+exports.variance = variance;
+exports.studentTCdf = studentTCdf;
+exports.studentTQuantile = studentTQuantile;
+exports.welch = welch;
+
+function mean(samples) {
+  var sum = 0;
+  for (var i = 0; i < samples.length; i++)
+    sum += samples[i];
+  return sum / samples.length;
+}
+
+// Sample variance, with Bessel's correction.
+function variance(samples) {
+  var m = mean(samples);
+  var sum = 0;
+  for (var i = 0; i < samples.length; i++)
+    sum += (samples[i] - m) * (samples[i] - m);
+  return sum / (samples.length - 1);
+}
+
+// Lanczos approximation of ln(Gamma(x)), good to about 15 digits.
+var lanczos = [
+  0.99999999999980993, 676.5203681218851, -1259.1392167224028,
+  771.32342877765313, -176.61502916214059, 12.507343278686905,
+  -0.13857109526572012, 9.9843695780195716e-6, 1.5056327351493116e-7
+];
+
+function logGamma(x) {
+  if (x < 0.5)
+    return Math.log(Math.PI / Math.sin(Math.PI * x)) - logGamma(1 - x);
+  x -= 1;
+  var a = lanczos[0];
+  var t = x + 7.5;
+  for (var i = 1; i < 9; i++)
+    a += lanczos[i] / (x + i);
+  return 0.5 * Math.log(2 * Math.PI) + (x + 0.5) * Math.log(t) - t +
+         Math.log(a);
+}
+
+// Continued fraction for the regularized incomplete beta function, evaluated
+// with the modified Lentz method.
+function betaContinuedFraction(x, a, b) {
+  var tiny = 1e-300;
+  var c = 1;
+  var d = 1 - (a + b) * x / (a + 1);
+  if (Math.abs(d) < tiny)
+    d = tiny;
+  d = 1 / d;
+  var h = d;
+  for (var m = 1; m <= 300; m++) {
+    var m2 = 2 * m;
+    var aa = m * (b - m) * x / ((a + m2 - 1) * (a + m2));
+    d = 1 + aa * d;
+    if (Math.abs(d) < tiny)
+      d = tiny;
+    c = 1 + aa / c;
+    if (Math.abs(c) < tiny)
+      c = tiny;
+    d = 1 / d;
+    h *= d * c;
+    aa = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1));
+    d = 1 + aa * d;
+    if (Math.abs(d) < tiny)
+      d = tiny;
+    c = 1 + aa / c;
+    if (Math.abs(c) < tiny)
+      c = tiny;
+    d = 1 / d;
+    var delta = d * c;
+    h *= delta;
+    if (Math.abs(delta - 1) < 1e-15)
+      break;
+  }
+  return h;
+}
+
+function incompleteBeta(x, a, b) {
+  if (x <= 0)
+    return 0;
+  if (x >= 1)
+    return 1;
+  var front = Math.exp(logGamma(a + b) - logGamma(a) - logGamma(b) +
+                       a * Math.log(x) + b * Math.log(1 - x));
+  if (x < (a + 1) / (a + b + 2))
+    return front * betaContinuedFraction(x, a, b) / a;
+  return 1 - front * betaContinuedFraction(1 - x, b, a) / b;
+}
+
+// P(T <= t) for Student's t distribution with df degrees of freedom.
+function studentTCdf(t, df) {
+  var tail = 0.5 * incompleteBeta(df / (df + t * t), df / 2, 0.5);
+  return t > 0 ? 1 - tail : tail;
+}
+
+// The t for which P(T <= t) is p, found by bisection.
+function studentTQuantile(p, df) {
+  var lo = -1e3;
+  var hi = 1e3;
+  for (var i = 0; i < 200 && hi - lo > 1e-12; i++) {
+    var mid = (lo + hi) / 2;
+    if (studentTCdf(mid, df) < p)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return (lo + hi) / 2;
+}
+
+// Welch's t-test for the means of `a` and `b`.  Returns the difference of the
+// means (b - a), its confidence interval at the given level and the two-sided
+// p-value of the hypothesis that the means are equal.
+function welch(a, b, confidence) {
+  if (confidence === undefined)
+    confidence = 0.95;
+  var result = {
+    diff: mean(b) - mean(a),
+    low: NaN,
+    high: NaN,
+    t: NaN,
+    df: NaN,
+    p: NaN
+  };
+  if (a.length < 2 || b.length < 2)
+    return result;
+
+  var va = variance(a) / a.length;
+  var vb = variance(b) / b.length;
+  var se = Math.sqrt(va + vb);
+  if (se === 0) {
+    result.low = result.high = result.diff;
+    result.p = result.diff === 0 ? 1 : 0;
+    return result;
+  }
+
+  result.t = result.diff / se;
+  // Welch-Satterthwaite approximation of the degrees of freedom.
+  var dfa = va * va / (a.length - 1);
+  var dfb = vb * vb / (b.length - 1);
+  result.df = (va + vb) * (va + vb) / (dfa + dfb);
+  result.p = 2 * studentTCdf(-Math.abs(result.t), result.df);
+  var margin = studentTQuantile(1 - (1 - confidence) / 2, result.df) * se;
+  result.low = result.diff - margin;
+  result.high = result.diff + margin;
+  return result;
+}
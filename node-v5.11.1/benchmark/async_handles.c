@@ -0,0 +1,95 @@
+/**
+ * Wakeup cost of uv_async_send() as a function of the number of async
+ * handles on the loop.  Another thread and the loop ping-pong on two
+ * handles while the others sit idle.
+ *
+ * cc -O2 -Ideps/uv/include -o async_handles benchmark/async_handles.c \
+ *   out/Release/libuv.a -lpthread -ldl -lrt
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "uv.h"
+
+#define ROUNDS 20000
+
+static uv_loop_t* loop;
+static uv_async_t* idle_handles;
+static uv_async_t ping;
+static uv_async_t pong_handle;
+static uv_sem_t pong;
+static int rounds;
+
+static void idle_cb(uv_async_t* handle) {
+  abort();
+}
+
+static void close_cb(uv_handle_t* handle) {
+}
+
+static void ping_cb(uv_async_t* handle) {
+  uv_sem_post(&pong);
+}
+
+static void stop_cb(uv_async_t* handle) {
+  uv_close((uv_handle_t*) &ping, close_cb);
+  uv_close((uv_handle_t*) &pong_handle, close_cb);
+}
+
+static void pinger(void* arg) {
+  for (rounds = 0; rounds < ROUNDS; rounds++) {
+    uv_async_send(&ping);
+    uv_sem_wait(&pong);
+  }
+  uv_async_send(&pong_handle);
+}
+
+static void run(int nhandles) {
+  uv_thread_t thread;
+  uint64_t start;
+  uint64_t elapsed;
+  int i;
+
+  loop = uv_default_loop();
+  idle_handles = malloc(nhandles * sizeof(*idle_handles));
+  assert(idle_handles != NULL);
+
+  for (i = 0; i < nhandles; i++)
+    assert(0 == uv_async_init(loop, &idle_handles[i], idle_cb));
+  assert(0 == uv_async_init(loop, &ping, ping_cb));
+  assert(0 == uv_async_init(loop, &pong_handle, stop_cb));
+  assert(0 == uv_sem_init(&pong, 0));
+
+  /* The idle handles shouldn't keep the loop alive. */
+  for (i = 0; i < nhandles; i++)
+    uv_unref((uv_handle_t*) &idle_handles[i]);
+
+  start = uv_hrtime();
+  assert(0 == uv_thread_create(&thread, pinger, NULL));
+  assert(0 == uv_run(loop, UV_RUN_DEFAULT));
+  assert(0 == uv_thread_join(&thread));
+  elapsed = uv_hrtime() - start;
+
+  printf("%6d handles: %8.0f wakeups/s, %6.2f us/wakeup\n",
+         nhandles,
+         ROUNDS / (elapsed / 1e9),
+         elapsed / 1e3 / ROUNDS);
+
+  for (i = 0; i < nhandles; i++)
+    uv_close((uv_handle_t*) &idle_handles[i], close_cb);
+  assert(0 == uv_run(loop, UV_RUN_DEFAULT));
+  uv_sem_destroy(&pong);
+  free(idle_handles);
+}
+
+int main(int argc, char** argv) {
+  static const int counts[] = { 1, 100, 1000, 10000 };
+  unsigned i;
+
+  for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    run(counts[i]);
+
+  return 0;
+}
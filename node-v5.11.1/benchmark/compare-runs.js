@@ -0,0 +1,294 @@
+'use strict';
+var fs = require('fs');
+var path = require('path');
+var spawn = require('child_process').spawn;
+var stats = require('./_stats.js');
+
+var usage = 'node benchmark/compare-runs.js ' +
+            '--old <node-binary> --new <node-binary> ' +
+            '[--runs n] [--cpus list] [--csv file] [--set key=value] ' +
+            '[--alpha a] [--threshold pct] ' +
+            '<type|file> [testFilter]\n' +
+            '  node benchmark/compare-runs.js --analyze <csv-file> ' +
+            '[--alpha a] [--threshold pct]';
+
+var binaries = {};
+var runs = 30;
+var cpus = null;
+var csvFile = null;
+var analyzeFile = null;
+var alpha = 0.05;
+var threshold = null;
+var settings = [];
+var targets = [];
+
+for (var i = 2; i < process.argv.length; i++) {
+  var arg = process.argv[i];
+  switch (arg) {
+    case '--old': case '--new':
+      binaries[arg.slice(2)] = process.argv[++i];
+      break;
+    case '--runs':
+      runs = +process.argv[++i];
+      break;
+    case '--cpus':
+      cpus = process.argv[++i];
+      break;
+    case '--csv':
+      csvFile = process.argv[++i];
+      break;
+    case '--analyze':
+      analyzeFile = process.argv[++i];
+      break;
+    case '--set':
+      settings.push(process.argv[++i]);
+      break;
+    case '--alpha':
+      alpha = +process.argv[++i];
+      break;
+    case '--threshold':
+      threshold = +process.argv[++i];
+      break;
+    case '-h': case '-?': case '--help':
+      console.log('usage:\n  %s', usage);
+      process.exit(0);
+      break;
+    default:
+      targets.push(arg);
+      break;
+  }
+}
+
+if (analyzeFile) {
+  if (targets.length)
+    fail();
+} else if (!binaries.old || !binaries.new || !targets.length ||
+           !(runs >= 2) || targets.length > 2) {
+  fail();
+}
+if (!(alpha > 0 && alpha < 1) || threshold !== null && !(threshold >= 0))
+  fail();
+
+function fail() {
+  console.error('usage:\n  %s', usage);
+  process.exit(1);
+}
+
+// Samples by configuration, in the order they were first seen.  Each entry
+// holds the benchmark's file name, its configuration and the rates measured
+// with the old and the new binary.
+var results = new Map();
+
+function addSample(binary, filename, configuration, rate) {
+  var key = filename + ' ' + configuration;
+  var entry = results.get(key);
+  if (!entry) {
+    entry = { filename: filename, configuration: configuration,
+              old: [], new: [] };
+    results.set(key, entry);
+  }
+  entry[binary].push(rate);
+}
+
+if (analyzeFile)
+  analyze();
+else
+  runAll();
+
+function analyze() {
+  var lines = fs.readFileSync(analyzeFile, 'utf8').split(/\r?\n/);
+  var row = /^(old|new),(\d+),([^,]+),"((?:[^"]|"")*)",([-\d.eE+]+)$/;
+  lines.slice(1).forEach(function(line) {
+    if (!line)
+      return;
+    var match = line.match(row);
+    if (!match) {
+      console.error('%s: cannot parse %j', analyzeFile, line);
+      process.exit(1);
+    }
+    addSample(match[1], match[3], match[4].replace(/""/g, '"'), +match[5]);
+  });
+  report();
+}
+
+function findBenchmarks() {
+  var target = targets[0];
+  var filter = targets[1];
+  if (/\.js$/.test(target))
+    return [path.resolve(target)];
+
+  var dir = path.join(__dirname, target);
+  var files = fs.readdirSync(dir).filter(function(file) {
+    return /\.js$/.test(file) && !/^[\._]/.test(file) &&
+           (!filter || file.indexOf(filter) !== -1);
+  });
+  if (!files.length) {
+    console.error('no benchmarks in %s match %j', dir, filter || '');
+    process.exit(1);
+  }
+  return files.map(function(file) {
+    return path.join(dir, file);
+  });
+}
+
+function runAll() {
+  var benchmarks = findBenchmarks();
+  var csv = csvFile ? fs.createWriteStream(csvFile) : null;
+  if (csv)
+    csv.write('binary,run,filename,configuration,result\n');
+
+  // One job per run, benchmark and binary.  The binaries take turns going
+  // first so that neither one is favored by the order, e.g. because the
+  // machine heats up over a run.
+  var jobs = [];
+  for (var run = 1; run <= runs; run++) {
+    benchmarks.forEach(function(benchmark, index) {
+      var order = (run + index) % 2 ? ['old', 'new'] : ['new', 'old'];
+      order.forEach(function(binary) {
+        jobs.push({ run: run, benchmark: benchmark, binary: binary });
+      });
+    });
+  }
+
+  var done = 0;
+  next();
+
+  function next() {
+    var job = jobs[done++];
+    if (!job) {
+      if (csv)
+        csv.end();
+      return report();
+    }
+    process.stderr.write('[' + done + '/' + jobs.length + '] ' +
+                         job.binary + ' ' +
+                         path.relative(__dirname, job.benchmark) + '\n');
+    runBenchmark(job.binary, job.benchmark, function(lines) {
+      lines.forEach(function(line) {
+        addSample(job.binary, line.filename, line.configuration, line.rate);
+        if (csv) {
+          csv.write([
+            job.binary,
+            job.run,
+            line.filename,
+            '"' + line.configuration.replace(/"/g, '""') + '"',
+            line.rate
+          ].join(',') + '\n');
+        }
+      });
+      next();
+    });
+  }
+}
+
+function runBenchmark(binary, benchmark, cb) {
+  var env = {};
+  for (var key in process.env)
+    env[key] = process.env[key];
+  delete env.OUTPUT_FORMAT;
+  delete env.NODE_BENCH_SILENT;
+
+  var args = [binaries[binary], benchmark].concat(settings);
+  var child = cpus ? spawn('taskset', ['-c', cpus].concat(args), { env: env }) :
+                     spawn(args[0], args.slice(1), { env: env });
+  var out = '';
+  child.stdout.setEncoding('utf8');
+  child.stdout.on('data', function(chunk) {
+    out += chunk;
+  });
+  child.stderr.pipe(process.stderr);
+  child.on('error', function(err) {
+    console.error('cannot run %s: %s', args[0], err.message);
+    process.exit(1);
+  });
+  child.on('close', function(code, signal) {
+    if (code || signal) {
+      console.error('%s %s exited with %s', binaries[binary], benchmark,
+                    signal || 'code ' + code);
+      process.exit(1);
+    }
+    // Lines look like "type/file.js key=value key=value: rate".
+    var lines = [];
+    out.split(/\r?\n/).forEach(function(line) {
+      var match = line.match(/^(\S+\.js) ?(.*): ([-\d.eE+]+)$/);
+      if (match) {
+        lines.push({ filename: match[1], configuration: match[2],
+                     rate: +match[3] });
+      }
+    });
+    cb(lines);
+  });
+}
+
+function stars(p) {
+  if (p < 0.001) return '***';
+  if (p < 0.01) return '**';
+  if (p < alpha) return '*';
+  return '';
+}
+
+function formatRate(rate) {
+  return Math.abs(rate) >= 1e5 ? rate.toFixed(0) : rate.toPrecision(6);
+}
+
+function percent(value) {
+  return (value >= 0 ? '+' : '') + value.toFixed(2) + ' %';
+}
+
+function report() {
+  var header = ['', 'old', 'new', 'improvement', (1 - alpha) * 100 + '% CI',
+                '', 'p.value'];
+  var rows = [header];
+  var regressions = [];
+
+  results.forEach(function(entry) {
+    var oldMean = stats.mean(entry.old);
+    var newMean = stats.mean(entry.new);
+    var test = stats.welch(entry.old, entry.new, 1 - alpha);
+    var improvement = test.diff / oldMean * 100;
+    var name = entry.configuration ?
+        entry.filename + ' ' + entry.configuration : entry.filename;
+    rows.push([
+      name,
+      formatRate(oldMean),
+      formatRate(newMean),
+      percent(improvement),
+      isNaN(test.low) ? '' :
+          '[' + percent(test.low / oldMean * 100) + ', ' +
+          percent(test.high / oldMean * 100) + ']',
+      stars(test.p),
+      isNaN(test.p) ? 'n/a' : test.p.toFixed(4)
+    ]);
+    if (threshold !== null && test.p < alpha && improvement < -threshold)
+      regressions.push(name + ': ' + percent(improvement));
+  });
+
+  var widths = header.map(function(_, column) {
+    return rows.reduce(function(width, row) {
+      return Math.max(width, row[column].length);
+    }, 0);
+  });
+  rows.forEach(function(row) {
+    console.log(row.map(function(cell, column) {
+      return column === 0 || column === 5 ?
+          cell + ' '.repeat(widths[column] - cell.length) :
+          ' '.repeat(widths[column] - cell.length) + cell;
+    }).join('  ').replace(/\s+$/, ''));
+  });
+
+  console.log('\nSignificance: * p < %s, ** p < 0.01, *** p < 0.001 ' +
+              '(Welch\'s t-test, %d configurations)', alpha, results.size);
+  if (results.size * alpha >= 1) {
+    console.log('With %d configurations about %d are expected to come out ' +
+                'significant by chance alone.', results.size,
+                Math.round(results.size * alpha));
+  }
+
+  if (regressions.length) {
+    console.error('\nSignificant regressions of more than %d %%:', threshold);
+    regressions.forEach(function(line) {
+      console.error('  %s', line);
+    });
+    process.exit(1);
+  }
+}
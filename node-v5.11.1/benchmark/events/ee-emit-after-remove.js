@@ -0,0 +1,35 @@
+'use strict';
+var common = require('../common.js');
+var EventEmitter = require('events').EventEmitter;
+
+// Emitting on an emitter that had listeners removed before, like a socket
+// after its 'connect' and 'lookup' listeners fired.
+var bench = common.createBenchmark(main, {
+  removed: ['true', 'false'],
+  n: [2e6]
+});
+
+function main(conf) {
+  var n = conf.n | 0;
+
+  var ee = new EventEmitter();
+  var count = 0;
+  ee.on('data', function(chunk) {
+    count += chunk;
+  });
+  ee.on('end', function() {});
+  if (conf.removed === 'true') {
+    ee.once('connect', function() {});
+    ee.emit('connect');
+    ee.once('drain', function() {});
+    ee.emit('drain');
+  }
+
+  bench.start();
+  for (var i = 0; i < n; i += 1)
+    ee.emit('data', 1);
+  bench.end(n);
+
+  if (count !== n)
+    throw new Error('wrong count');
+}
@@ -0,0 +1,38 @@
+'use strict';
+var common = require('../common.js');
+var EventEmitter = require('events').EventEmitter;
+
+// What a short-lived socket or stream does to its emitters: a few listeners
+// come and go and a few events are emitted.
+var bench = common.createBenchmark(main, {
+  events: ['stream', 'custom'],
+  n: [1e6]
+});
+
+function noop() {}
+
+function main(conf) {
+  var n = conf.n | 0;
+  var names = conf.events === 'stream' ?
+      ['data', 'end', 'error', 'close'] :
+      ['chunk', 'done', 'failure', 'closed'];
+  var data = names[0];
+  var end = names[1];
+  var error = names[2];
+  var close = names[3];
+
+  bench.start();
+  for (var i = 0; i < n; i += 1) {
+    var ee = new EventEmitter();
+    ee.on(data, noop);
+    ee.on(error, noop);
+    ee.once(end, noop);
+    ee.once(close, noop);
+    ee.emit(data, i);
+    ee.emit(data, i);
+    ee.emit(end);
+    ee.removeListener(error, noop);
+    ee.emit(close);
+  }
+  bench.end(n);
+}
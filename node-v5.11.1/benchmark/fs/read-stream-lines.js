@@ -0,0 +1,116 @@
+// test how fast a file can be split into lines: readline.LineSplitter,
+// with per-line 'data' events and in batch mode, readline.Interface and
+// a StringDecoder plus split() on a regexp, the way readline used to do it
+'use strict';
+
+var path = require('path');
+var common = require('../common.js');
+var filename = path.resolve(__dirname, '.removeme-benchmark-garbage');
+var fs = require('fs');
+var readline = require('readline');
+var StringDecoder = require('string_decoder').StringDecoder;
+
+var bench = common.createBenchmark(main, {
+  type: ['splitter', 'splitter-batch', 'splitter-buf', 'readline', 'regexp'],
+  mb: [2048]
+});
+
+var type, filesize;
+
+function main(conf) {
+  type = conf.type;
+  filesize = +conf.mb * 1024 * 1024;
+  makeFile(runTest);
+}
+
+function runTest() {
+  var rs = fs.createReadStream(filename, { highWaterMark: 64 * 1024 });
+  var lines = 0;
+
+  rs.on('open', function() {
+    bench.start();
+  });
+
+  function done() {
+    try { fs.unlinkSync(filename); } catch (e) {}
+    if (lines === 0)
+      throw new Error('no lines read');
+    // MB/sec
+    bench.end(filesize / (1024 * 1024));
+  }
+
+  switch (type) {
+    case 'splitter':
+    case 'splitter-buf':
+      var encoding = type === 'splitter' ? 'utf8' : null;
+      rs.pipe(new readline.LineSplitter({ encoding: encoding }))
+        .on('data', function(line) {
+          lines++;
+        })
+        .on('end', done);
+      break;
+    case 'splitter-batch':
+      rs.pipe(new readline.LineSplitter({ batch: true }))
+        .on('datav', function(batch) {
+          lines += batch.length;
+        })
+        .on('end', done);
+      break;
+    case 'readline':
+      readline.createInterface({ input: rs })
+        .on('line', function(line) {
+          lines++;
+        })
+        .on('close', done);
+      break;
+    case 'regexp':
+      var decoder = new StringDecoder('utf8');
+      var rest = '';
+      rs.on('data', function(chunk) {
+        var parts = (rest + decoder.write(chunk)).split(/\r\n|\n|\r/);
+        rest = parts.pop();
+        lines += parts.length;
+      });
+      rs.on('end', function() {
+        if (rest + decoder.end())
+          lines++;
+        done();
+      });
+      break;
+    default:
+      throw new Error('invalid type');
+  }
+}
+
+// Log lines of different lengths, some with multibyte characters.
+function makeBlock() {
+  var words = ['GET', '/api/v1/users', 'ümlaut', '200', 'ok', 'upstream',
+               'timeout', '0.042s', 'x-request-id', 'a7f3c2'];
+  var text = '';
+  for (var i = 0; text.length < 1024 * 1024; i++) {
+    text += '2016-04-26T12:00:00.000Z info';
+    for (var j = 0; j < i % 17; j++)
+      text += ' ' + words[(i + j) % words.length];
+    text += '\n';
+  }
+  return new Buffer(text);
+}
+
+function makeFile(cb) {
+  var buf = makeBlock();
+  var left = Math.ceil(filesize / buf.length);
+  filesize = left * buf.length;
+
+  try { fs.unlinkSync(filename); } catch (e) {}
+  var ws = fs.createWriteStream(filename);
+  ws.on('close', cb);
+  ws.on('drain', write);
+  write();
+  function write() {
+    do {
+      left--;
+    } while (false !== ws.write(buf) && left > 0);
+    if (left === 0)
+      ws.end();
+  }
+}
@@ -9,19 +9,36 @@ const kOnBody = HTTPParser.kOnBody | 0;
 const kOnMessageComplete = HTTPParser.kOnMessageComplete | 0;
 const CRLF = '\r\n';
 
+// Reports megabytes of request headers parsed per second.  The parser scans
+// URLs and header values in bulk where the CPU supports it; run with
+// HTTP_PARSER_SIMD=scalar in the environment to compare against the
+// byte-at-a-time scanners.
 const bench = common.createBenchmark(main, {
   fields: [4, 8, 16, 32],
+  valueLength: [10, 100],
+  urlLength: [6, 200],
   n: [1e5],
 });
 
 
+function filler(length) {
+  var s = '';
+  while (s.length < length)
+    s += Math.random().toString(36).substr(2);
+  return s.slice(0, length);
+}
+
+
 function main(conf) {
   const fields = conf.fields >>> 0;
+  const valueLength = conf.valueLength >>> 0;
+  const urlLength = conf.urlLength >>> 0;
   const n = conf.n >>> 0;
-  var header = `GET /hello HTTP/1.1${CRLF}Content-Type: text/plain${CRLF}`;
+  const url = `/${filler(urlLength - 1)}`;
+  var header = `GET ${url} HTTP/1.1${CRLF}Content-Type: text/plain${CRLF}`;
 
   for (var i = 0; i < fields; i++) {
-    header += `X-Filler${i}: ${Math.random().toString(36).substr(2)}${CRLF}`;
+    header += `X-Filler${i}: ${filler(valueLength)}${CRLF}`;
   }
   header += CRLF;
 
@@ -37,7 +54,7 @@ function processHeader(header, n) {
     parser.execute(header, 0, header.length);
     parser.reinitialize(REQUEST);
   }
-  bench.end(n);
+  bench.end(n * header.length / (1024 * 1024));
 }
 
 
@@ -0,0 +1,61 @@
+'use strict';
+var common = require('../common.js');
+// Run with --experimental-json-stream, the benchmark processes inherit it.
+var json_stream = require('json_stream');
+
+var bench = common.createBenchmark(main, {
+  method: ['JSON.parse', 'stream', 'stream-tokens'],
+  items: [1e3, 1e5],
+  chunk: [16 * 1024],
+  n: [20]
+});
+
+function main(conf) {
+  var method = conf.method;
+  var items = conf.items | 0;
+  var chunkLen = conf.chunk | 0;
+  var n = conf.n | 0;
+
+  var array = [];
+  for (var i = 0; i < items; i++) {
+    array.push({
+      id: i,
+      name: 'item ' + i,
+      tags: ['a', 'b', 'c'],
+      score: i / 3,
+      active: i % 2 === 0
+    });
+  }
+  var buffer = new Buffer(JSON.stringify(array));
+  var chunks = [];
+  for (i = 0; i < buffer.length; i += chunkLen)
+    chunks.push(buffer.slice(i, i + chunkLen));
+
+  if (method === 'JSON.parse') {
+    // What it takes to parse the same chunks without a streaming parser.
+    bench.start();
+    for (i = 0; i < n; i++)
+      JSON.parse(Buffer.concat(chunks).toString());
+    bench.end(n);
+    return;
+  }
+
+  var options = method === 'stream' ? { depth: 1 } : { tokens: true };
+  var runs = 0;
+  bench.start();
+  run();
+
+  function run() {
+    var parser = new json_stream.Parser(options);
+    parser.on('data', function() {});
+    parser.on('end', function() {
+      if (++runs === n)
+        bench.end(n);
+      else
+        run();
+    });
+    for (var j = 0; j < chunks.length; j++)
+      parser.write(chunks[j]);
+    parser.end();
+  }
+}
@@ -0,0 +1,69 @@
+'use strict';
+var common = require('../common.js');
+// Run with --experimental-json-stream, the benchmark processes inherit it.
+var json_stream = require('json_stream');
+
+// With measure=throughput the result is megabytes of JSON produced per
+// second.  With measure=rss it is the peak growth of the resident set in
+// megabytes, which includes the intermediate strings and copies.
+var bench = common.createBenchmark(main, {
+  method: ['JSON.stringify', 'stringify', 'stringifyChunks'],
+  measure: ['throughput', 'rss'],
+  items: [1e3, 1e5],
+  n: [20]
+});
+
+function main(conf) {
+  var method = conf.method;
+  var items = conf.items | 0;
+  var n = conf.n | 0;
+
+  var array = [];
+  for (var i = 0; i < items; i++) {
+    array.push({
+      id: i,
+      name: 'item ' + i + ' é€',
+      tags: ['a', 'b', 'c'],
+      score: i / 3,
+      active: i % 2 === 0
+    });
+  }
+
+  var fn;
+  switch (method) {
+    case 'JSON.stringify':
+      // What it takes to get the same bytes without the native serializer.
+      fn = function() { return new Buffer(JSON.stringify(array)); };
+      break;
+    case 'stringify':
+      fn = function() { return json_stream.stringify(array); };
+      break;
+    case 'stringifyChunks':
+      fn = function() { return json_stream.stringifyChunks(array); };
+      break;
+    default:
+      throw new Error('Unexpected method');
+  }
+
+  var result = fn();
+  var bytes = Array.isArray(result) ?
+      result.reduce(function(sum, chunk) { return sum + chunk.length; }, 0) :
+      result.length;
+  result = null;
+
+  if (conf.measure === 'rss') {
+    var base = process.memoryUsage().rss;
+    var peak = base;
+    for (i = 0; i < n; i++) {
+      result = fn();
+      peak = Math.max(peak, process.memoryUsage().rss);
+    }
+    bench.report((peak - base) / (1024 * 1024));
+    return;
+  }
+
+  bench.start();
+  for (i = 0; i < n; i++)
+    fn();
+  bench.end(n * bytes / (1024 * 1024));
+}
@@ -4,11 +4,21 @@ var spawn = require('child_process').spawn;
 var path = require('path');
 var emptyJsFile = path.resolve(__dirname, '../../test/fixtures/semicolon.js');
 
+// 'empty' measures the bootstrap alone, 'core' also loads the core modules
+// that most servers need, which is where built-in code caches pay off.
+var scripts = {
+  empty: [emptyJsFile],
+  core: ['-e', 'require("net"); require("fs"); require("stream"); ' +
+               'require("util"); require("events"); require("assert")']
+};
+
 var bench = common.createBenchmark(startNode, {
+  script: Object.keys(scripts),
   dur: [1]
 });
 
 function startNode(conf) {
+  var args = scripts[conf.script];
   var dur = +conf.dur;
   var go = true;
   var starts = 0;
@@ -21,7 +31,7 @@ function startNode(conf) {
   start();
 
   function start() {
-    var node = spawn(process.execPath || process.argv[0], [emptyJsFile]);
+    var node = spawn(process.execPath || process.argv[0], args);
     node.on('exit', function(exitCode) {
       if (exitCode !== 0) {
         throw new Error('Error during node startup');
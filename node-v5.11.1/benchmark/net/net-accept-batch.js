@@ -0,0 +1,49 @@
+// test how many connections per second a server accepts when they come in
+// bursts, with and without accepting them in batches
+'use strict';
+
+var common = require('../common.js');
+var net = require('net');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  batch: [0, 64],
+  burst: [16, 128],
+  dur: [5]
+});
+
+function main(conf) {
+  var burst = +conf.burst;
+  var dur = +conf.dur;
+  var accepted = 0;
+  var running = true;
+
+  var server = net.createServer({
+    acceptBatch: +conf.batch,
+    noDelay: true
+  }, function(conn) {
+    accepted++;
+    conn.destroy();
+  });
+
+  server.listen(PORT, function() {
+    bench.start();
+    connectBurst();
+    setTimeout(function() {
+      running = false;
+      bench.end(accepted);
+      server.close();
+    }, dur * 1000);
+  });
+
+  function connectBurst() {
+    var left = burst;
+    for (var i = 0; i < burst; i++) {
+      net.connect(PORT).on('error', onClose).on('close', onClose);
+    }
+    function onClose() {
+      if (--left === 0 && running)
+        connectBurst();
+    }
+  }
+}
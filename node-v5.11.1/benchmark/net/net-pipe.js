@@ -7,12 +7,14 @@ var PORT = common.PORT;
 var bench = common.createBenchmark(main, {
   len: [102400, 1024 * 1024 * 16],
   type: ['utf', 'asc', 'buf'],
+  native: [0, 1],
   dur: [5],
 });
 
 var dur;
 var len;
 var type;
+var native;
 var chunk;
 var encoding;
 
@@ -20,6 +22,7 @@ function main(conf) {
   dur = +conf.dur;
   len = +conf.len;
   type = conf.type;
+  native = !!+conf.native;
 
   switch (type) {
     case 'buf':
@@ -92,7 +95,7 @@ function server() {
 
   // the actual benchmark.
   var server = net.createServer(function(socket) {
-    socket.pipe(socket);
+    socket.pipe(socket, { native: native });
   });
 
   server.listen(PORT, function() {
@@ -0,0 +1,67 @@
+// test request/response round trips where the server writes every response
+// in several small pieces, with Nagle off, with and without auto cork
+'use strict';
+
+var common = require('../common.js');
+var net = require('net');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  pieces: [1, 4, 16],
+  autocork: [0, 1],
+  pipelined: [1, 32],
+  dur: [5]
+});
+
+function main(conf) {
+  var pieces = +conf.pieces;
+  var autocork = +conf.autocork === 1;
+  var pipelined = +conf.pipelined;
+  var dur = +conf.dur;
+  var piece = new Buffer(64).fill('x');
+  var responseLength = pieces * piece.length;
+
+  var server = net.createServer(function(socket) {
+    socket.setNoDelay(true);
+    if (autocork)
+      socket.setAutoCork(true);
+    socket.on('data', function(data) {
+      // One byte per request.
+      for (var i = 0; i < data.length; i++) {
+        for (var j = 0; j < pieces; j++)
+          socket.write(piece);
+      }
+    });
+  });
+
+  server.listen(PORT, function() {
+    var client = net.connect(PORT);
+    var responses = 0;
+    var received = 0;
+    var running = true;
+
+    client.setNoDelay(true);
+    client.on('connect', function() {
+      bench.start();
+      for (var i = 0; i < pipelined; i++)
+        client.write('r');
+      setTimeout(function() {
+        running = false;
+        bench.end(responses);
+        client.destroy();
+        server.close();
+      }, dur * 1000);
+    });
+
+    client.on('data', function(data) {
+      received += data.length;
+      var done = Math.floor(received / responseLength);
+      if (done === 0)
+        return;
+      received -= done * responseLength;
+      responses += done;
+      if (running)
+        client.write(new Buffer(done).fill('r'));
+    });
+  });
+}
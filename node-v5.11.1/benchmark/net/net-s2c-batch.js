@@ -0,0 +1,95 @@
+// test the receiving side of a socket in batch mode ('datav') against
+// per-chunk 'data' events, with a listener and with .pipe()
+'use strict';
+
+var common = require('../common.js');
+var PORT = common.PORT;
+
+var bench = common.createBenchmark(main, {
+  len: [64, 1024, 65536],
+  batch: [0, 1],
+  recv: ['listener', 'pipe'],
+  dur: [5]
+});
+
+var dur;
+var len;
+var batch;
+var recv;
+var chunk;
+
+function main(conf) {
+  dur = +conf.dur;
+  len = +conf.len;
+  batch = !!+conf.batch;
+  recv = conf.recv;
+
+  chunk = new Buffer(len);
+  chunk.fill('x');
+
+  server();
+}
+
+var net = require('net');
+var stream = require('stream');
+
+function Sink() {
+  stream.Writable.call(this);
+  this.received = 0;
+}
+require('util').inherits(Sink, stream.Writable);
+
+Sink.prototype._write = function(chunk, encoding, cb) {
+  this.received += chunk.length;
+  cb();
+};
+
+Sink.prototype._writev = function(chunks, cb) {
+  for (var i = 0; i < chunks.length; i++)
+    this.received += chunks[i].chunk.length;
+  cb();
+};
+
+
+function server() {
+  // the sender writes its chunks corked, so that it isn't the bottleneck
+  var server = net.createServer(function(socket) {
+    socket.on('error', function() {});
+    function flow() {
+      socket.cork();
+      while (socket.write(chunk));
+      socket.uncork();
+      socket.once('drain', flow);
+    }
+    flow();
+  });
+
+  server.listen(PORT, function() {
+    var socket = net.connect({ port: PORT, batch: batch });
+    socket.on('connect', function() {
+      var sink = new Sink();
+      var received = 0;
+
+      bench.start();
+
+      if (recv === 'pipe') {
+        socket.pipe(sink);
+      } else if (batch) {
+        socket.on('datav', function(chunks) {
+          for (var i = 0; i < chunks.length; i++)
+            received += chunks[i].length;
+        });
+      } else {
+        socket.on('data', function(chunk) {
+          received += chunk.length;
+        });
+      }
+
+      setTimeout(function() {
+        var bytes = recv === 'pipe' ? sink.received : received;
+        var gbits = (bytes * 8) / (1024 * 1024 * 1024);
+        bench.end(gbits);
+      }, dur * 1000);
+    });
+  });
+}
@@ -0,0 +1,59 @@
+'use strict';
+var common = require('../common.js');
+var zlib = require('zlib');
+
+// Pipes a buffer through a zlib stream in `writes` pieces, the result is
+// megabytes of uncompressed data per second.  `fill` is the fraction of
+// the input that is zeros, the rest is random; inflating mostly zeros
+// produces many output chunks per input chunk.
+var bench = common.createBenchmark(main, {
+  method: ['deflate', 'inflate'],
+  chained: [0, 1],
+  fill: [0.5, 0.99],
+  writes: [1, 64],
+  n: [20]
+});
+
+function main(conf) {
+  var chained = conf.chained === 1;
+  var writes = conf.writes | 0;
+  var n = conf.n | 0;
+  var size = 8 * 1024 * 1024;
+
+  var data = new Buffer(size).fill(0);
+  var seed = 42;
+  for (var i = Math.floor(size * conf.fill); i < size; i++) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    data[i] = seed >>> 16;
+  }
+
+  var input;
+  var create;
+  if (conf.method === 'deflate') {
+    input = data;
+    create = function() { return zlib.createDeflate({ chained: chained }); };
+  } else {
+    input = zlib.deflateSync(data);
+    create = function() { return zlib.createInflate({ chained: chained }); };
+  }
+
+  var piece = Math.ceil(input.length / writes);
+  var left = n;
+
+  bench.start();
+  run();
+
+  function run() {
+    var stream = create();
+    stream.on('data', function() {});
+    stream.on('end', function() {
+      if (--left === 0)
+        bench.end(n * size / (1024 * 1024));
+      else
+        run();
+    });
+    for (var offset = 0; offset < input.length; offset += piece)
+      stream.write(input.slice(offset, offset + piece));
+    stream.end();
+  }
+}
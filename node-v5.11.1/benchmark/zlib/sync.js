@@ -0,0 +1,59 @@
+'use strict';
+var common = require('../common.js');
+var zlib = require('zlib');
+
+// Compresses or decompresses a buffer of source text, the result is
+// megabytes of uncompressed data per second.  gzip and gunzip include the
+// CRC-32 of the data, deflate and inflate its Adler-32, inflateRaw neither.
+var bench = common.createBenchmark(main, {
+  method: ['deflate', 'inflate', 'gzip', 'gunzip', 'inflateRaw'],
+  level: [1, 6],
+  size: [64 * 1024, 1024 * 1024],
+  n: [50]
+});
+
+function main(conf) {
+  var level = conf.level | 0;
+  var size = conf.size | 0;
+  var n = conf.n | 0;
+
+  // Repetitive enough to give longest_match() something to do.
+  var words = ['function', 'return', 'var', 'this', '(', ')', '{', '}',
+               ';', '\n', 'buffer', 'length', 'offset', '=', '+', '0'];
+  var input = new Buffer(size);
+  var seed = 42;
+  for (var i = 0; i < size;) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    i += input.write(words[seed % words.length] + ' ', i);
+  }
+
+  var options = { level: level };
+  var fn;
+  switch (conf.method) {
+    case 'deflate':
+      fn = function() { return zlib.deflateSync(input, options); };
+      break;
+    case 'gzip':
+      fn = function() { return zlib.gzipSync(input, options); };
+      break;
+    case 'inflate':
+      var deflated = zlib.deflateSync(input, options);
+      fn = function() { return zlib.inflateSync(deflated); };
+      break;
+    case 'gunzip':
+      var gzipped = zlib.gzipSync(input, options);
+      fn = function() { return zlib.gunzipSync(gzipped); };
+      break;
+    case 'inflateRaw':
+      var raw = zlib.deflateRawSync(input, options);
+      fn = function() { return zlib.inflateRawSync(raw); };
+      break;
+    default:
+      throw new Error('Unexpected method');
+  }
+
+  bench.start();
+  for (var j = 0; j < n; j++)
+    fn();
+  bench.end(n * size / (1024 * 1024));
+}
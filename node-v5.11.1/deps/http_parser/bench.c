@@ -21,6 +21,7 @@
 #include "http_parser.h"
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
 
@@ -41,6 +42,27 @@ static const char data[] =
     "Cache-Control: max-age=0\r\n\r\nb\r\nhello world\r\n0\r\n\r\n";
 static const size_t data_len = sizeof(data) - 1;
 
+/* Long URL and header values, where the bulk scanners matter most. */
+static const char big_data[] =
+    "GET /api/v2/repos/nodejs/node/commits?sha=master&path=deps%2Fhttp_parser"
+        "&since=2016-01-01T00%3A00%3A00Z&until=2016-04-01T00%3A00%3A00Z"
+        "&per_page=100&page=3 HTTP/1.1\r\n"
+    "Host: api.github.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 "
+        "(KHTML, like Gecko) Chrome/49.0.2623.110 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,"
+        "image/webp,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.8,de;q=0.6,fr;q=0.4,ru;q=0.2\r\n"
+    "Cookie: _octo=GH1.1.1234567890.1458000000; logged_in=yes; "
+        "dotcom_user=someone; _ga=GA1.2.1234567890.1458000000; "
+        "user_session=9c2fb0a5d8e44c1b8f3a6e7d2c1b0a9f8e7d6c5b4a3928171605f4e3; "
+        "__Host-user_session_same_site=9c2fb0a5d8e44c1b8f3a6e7d2c1b0a9f8e7d6c5b"
+        "4a3928171605f4e3; tz=Europe%2FBerlin\r\n"
+    "Referer: https://github.com/nodejs/node/commits/master/deps/http_parser"
+        "?after=0123456789abcdef0123456789abcdef01234567+34\r\n"
+    "Connection: keep-alive\r\n\r\n";
+static const size_t big_data_len = sizeof(big_data) - 1;
+
 static int on_info(http_parser* p) {
   return 0;
 }
@@ -61,12 +83,14 @@ static http_parser_settings settings = {
   .on_body = on_data
 };
 
-int bench(int iter_count, int silent) {
+int bench(const char* name, const char* buf, size_t len,
+          int iter_count, int silent) {
   struct http_parser parser;
   int i;
   int err;
   struct timeval start;
   struct timeval end;
+  float secs;
   float rps;
 
   if (!silent) {
@@ -78,34 +102,42 @@ int bench(int iter_count, int silent) {
     size_t parsed;
     http_parser_init(&parser, HTTP_REQUEST);
 
-    parsed = http_parser_execute(&parser, &settings, data, data_len);
-    assert(parsed == data_len);
+    parsed = http_parser_execute(&parser, &settings, buf, len);
+    assert(parsed == len);
   }
 
   if (!silent) {
     err = gettimeofday(&end, NULL);
     assert(err == 0);
 
-    fprintf(stdout, "Benchmark result:\n");
+    fprintf(stdout, "Benchmark result (%s, %u bytes):\n", name, (unsigned) len);
 
-    rps = (float) (end.tv_sec - start.tv_sec) +
-          (end.tv_usec - start.tv_usec) * 1e-6f;
-    fprintf(stdout, "Took %f seconds to run\n", rps);
+    secs = (float) (end.tv_sec - start.tv_sec) +
+           (end.tv_usec - start.tv_usec) * 1e-6f;
+    fprintf(stdout, "Took %f seconds to run\n", secs);
 
-    rps = (float) iter_count / rps;
+    rps = (float) iter_count / secs;
     fprintf(stdout, "%f req/sec\n", rps);
+    fprintf(stdout, "%f MB/sec\n", rps * len / (1024 * 1024));
     fflush(stdout);
   }
 
   return 0;
 }
 
+/* HTTP_PARSER_SIMD=scalar ./bench compares against the byte-at-a-time
+ * scanners, see scan_init() in http_parser.c.
+ */
 int main(int argc, char** argv) {
+  const char* simd = getenv("HTTP_PARSER_SIMD");
+
   if (argc == 2 && strcmp(argv[1], "infinite") == 0) {
     for (;;)
-      bench(5000000, 1);
+      bench("small", data, data_len, 5000000, 1);
     return 0;
   } else {
-    return bench(5000000, 0);
+    fprintf(stdout, "HTTP_PARSER_SIMD=%s\n", simd ? simd : "(auto)");
+    bench("small", data, data_len, 5000000, 0);
+    return bench("big", big_data, big_data_len, 2000000, 0);
   }
 }
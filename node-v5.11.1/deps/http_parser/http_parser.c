@@ -29,6 +29,26 @@
 #include <string.h>
 #include <limits.h>
 
+/* SSE4.2 and AVX2 scanners are compiled with per-function target attributes
+ * and picked at runtime, so the rest of the file doesn't need -msse4.2 or
+ * -mavx2.  That needs GCC 4.9+ or a clang with __builtin_cpu_supports().
+ */
+#if !defined(HTTP_PARSER_NO_SIMD) && (defined(__x86_64__) || defined(__i386__))
+# if defined(__clang__)
+#  if defined(__has_builtin)
+#   if __has_builtin(__builtin_cpu_supports)
+#    define HTTP_PARSER_X86_SIMD 1
+#   endif
+#  endif
+# elif defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#  define HTTP_PARSER_X86_SIMD 1
+# endif
+#endif
+
+#ifdef HTTP_PARSER_X86_SIMD
+# include <immintrin.h>
+#endif
+
 #ifndef ULLONG_MAX
 # define ULLONG_MAX ((uint64_t) -1) /* 2^64-1 */
 #endif
@@ -631,6 +651,188 @@ parse_url_char(enum state s, const char ch)
   return s_dead;
 }
 
+/* Bulk scanners for the two places where most of the bytes of a request
+ * are: URLs and header values.  Both skip a run of bytes that can't change
+ * the parser's state and return its length, so http_parser_execute() only
+ * has to look at the byte that ends the run.
+ *
+ * The byte classes are given as inclusive [lo, hi] ranges of bytes that end
+ * a run, in the format of PCMPESTRI's range mode, so the SSE4.2 scanner can
+ * use them as is.  The AVX2 scanner tests 32 bytes against each range.  The
+ * scalar loops are the reference; the vector scanners only look at full
+ * 16 or 32 byte blocks and leave the tail to them.
+ *
+ * The implementation is picked on first use from what the CPU supports.  Set
+ * HTTP_PARSER_SIMD=scalar, sse4.2 or avx2 in the environment to force one,
+ * for benchmarking.
+ */
+enum scan_impl {
+  SCAN_UNINITIALIZED = 0,
+  SCAN_SCALAR,
+  SCAN_SSE42,
+  SCAN_AVX2
+};
+
+static enum scan_impl scan_impl = SCAN_UNINITIALIZED;
+
+/* Bytes that end a run of URL characters, see normal_url_char. */
+#if HTTP_PARSER_STRICT
+static const char url_stop_ranges[16] =
+  { 0x00, 0x20, '#', '#', '?', '?', 0x7f, (char) 0xff };
+static const int url_stop_ranges_len = 8;
+#else
+static const char url_stop_ranges[16] =
+  { 0x00, 0x08, 0x0a, 0x0b, 0x0d, 0x20, '#', '#', '?', '?', 0x7f, 0x7f };
+static const int url_stop_ranges_len = 12;
+#endif
+
+/* Bytes that end a header value or are invalid in one, see IS_HEADER_CHAR.
+ * In lenient mode only CR and LF end a run.
+ */
+static const char header_value_stop_ranges[16] =
+  { 0x00, 0x08, 0x0a, 0x1f, 0x7f, 0x7f };
+static const int header_value_stop_ranges_len = 6;
+static const char lenient_header_value_stop_ranges[16] =
+  { CR, CR, LF, LF };
+static const int lenient_header_value_stop_ranges_len = 4;
+
+#ifdef HTTP_PARSER_X86_SIMD
+__attribute__((target("sse4.2")))
+static size_t
+scan_sse42(const char *p, size_t len, const char *ranges, int ranges_len)
+{
+  const __m128i r = _mm_loadu_si128((const __m128i *) ranges);
+  size_t i;
+  int index;
+
+  for (i = 0; i + 16 <= len; i += 16) {
+    const __m128i v = _mm_loadu_si128((const __m128i *) (p + i));
+    index = _mm_cmpestri(r, ranges_len, v, 16,
+                         _SIDD_UBYTE_OPS |
+                         _SIDD_CMP_RANGES |
+                         _SIDD_LEAST_SIGNIFICANT);
+    if (index != 16)
+      return i + index;
+  }
+
+  return i;
+}
+
+__attribute__((target("avx2")))
+static size_t
+scan_avx2(const char *p, size_t len, const char *ranges, int ranges_len)
+{
+  size_t i;
+  int k;
+
+  for (i = 0; i + 32 <= len; i += 32) {
+    const __m256i v = _mm256_loadu_si256((const __m256i *) (p + i));
+    __m256i stop = _mm256_setzero_si256();
+    unsigned int mask;
+
+    for (k = 0; k < ranges_len; k += 2) {
+      /* lo <= v <= hi  <=>  (v - lo) <= (hi - lo), unsigned. */
+      const __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8(ranges[k]));
+      const __m256i span = _mm256_set1_epi8((char) (ranges[k + 1] - ranges[k]));
+      stop = _mm256_or_si256(stop,
+                             _mm256_cmpeq_epi8(_mm256_min_epu8(d, span), d));
+    }
+
+    mask = (unsigned int) _mm256_movemask_epi8(stop);
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+
+  return i;
+}
+#endif  /* HTTP_PARSER_X86_SIMD */
+
+static void
+scan_init(void)
+{
+  enum scan_impl impl = SCAN_SCALAR;
+  const char *force = getenv("HTTP_PARSER_SIMD");
+
+#ifdef HTTP_PARSER_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    impl = SCAN_AVX2;
+  else if (__builtin_cpu_supports("sse4.2"))
+    impl = SCAN_SSE42;
+
+  /* Can only force an implementation the CPU supports. */
+  if (force != NULL) {
+    if (strcmp(force, "scalar") == 0)
+      impl = SCAN_SCALAR;
+    else if (strcmp(force, "sse4.2") == 0 && impl == SCAN_AVX2)
+      impl = SCAN_SSE42;
+  }
+#else
+  (void) force;
+#endif
+
+  /* Racing threads all store the same value. */
+  scan_impl = impl;
+}
+
+static size_t
+scan_vector(const char *p, size_t len, const char *ranges, int ranges_len)
+{
+  if (UNLIKELY(scan_impl == SCAN_UNINITIALIZED))
+    scan_init();
+
+#ifdef HTTP_PARSER_X86_SIMD
+  if (scan_impl == SCAN_AVX2)
+    return scan_avx2(p, len, ranges, ranges_len);
+  if (scan_impl == SCAN_SSE42)
+    return scan_sse42(p, len, ranges, ranges_len);
+#else
+  (void) p;
+  (void) len;
+  (void) ranges;
+  (void) ranges_len;
+#endif
+
+  return 0;
+}
+
+/* Returns the number of leading bytes of p that are URL characters. */
+static size_t
+scan_url(const char *p, size_t len)
+{
+  size_t i = scan_vector(p, len, url_stop_ranges, url_stop_ranges_len);
+
+  while (i < len && IS_URL_CHAR(p[i]))
+    i++;
+
+  return i;
+}
+
+/* Returns the number of leading bytes of p that are neither CR nor LF nor,
+ * unless lenient, invalid in a header value.
+ */
+static size_t
+scan_header_value(const char *p, size_t len, unsigned int lenient)
+{
+  size_t i;
+
+  if (lenient) {
+    i = scan_vector(p, len,
+                    lenient_header_value_stop_ranges,
+                    lenient_header_value_stop_ranges_len);
+    while (i < len && p[i] != CR && p[i] != LF)
+      i++;
+  } else {
+    i = scan_vector(p, len,
+                    header_value_stop_ranges,
+                    header_value_stop_ranges_len);
+    while (i < len && p[i] != CR && p[i] != LF && IS_HEADER_CHAR(p[i]))
+      i++;
+  }
+
+  return i;
+}
+
 size_t http_parser_execute (http_parser *parser,
                             const http_parser_settings *settings,
                             const char *data,
@@ -1119,6 +1321,15 @@ reexecute:
               SET_ERRNO(HPE_INVALID_URL);
               goto error;
             }
+
+            /* Runs of URL characters don't leave these states. */
+            if (CURRENT_STATE() == s_req_path ||
+                CURRENT_STATE() == s_req_query_string ||
+                CURRENT_STATE() == s_req_fragment) {
+              size_t skip = scan_url(p + 1, data + len - (p + 1));
+              COUNT_HEADER_SIZE(skip);
+              p += skip;
+            }
         }
         break;
       }
@@ -1533,24 +1744,14 @@ reexecute:
           switch (h_state) {
             case h_general:
             {
-              const char* p_cr;
-              const char* p_lf;
               size_t limit = data + len - p;
 
               limit = MIN(limit, HTTP_MAX_HEADER_SIZE);
 
-              p_cr = (const char*) memchr(p, CR, limit);
-              p_lf = (const char*) memchr(p, LF, limit);
-              if (p_cr != NULL) {
-                if (p_lf != NULL && p_cr >= p_lf)
-                  p = p_lf;
-                else
-                  p = p_cr;
-              } else if (UNLIKELY(p_lf != NULL)) {
-                p = p_lf;
-              } else {
-                p = data + len;
-              }
+              /* Stop at the end of the line or at a byte that's invalid in
+               * a header value, the top of the loop deals with either.
+               */
+              p += 1 + scan_header_value(p + 1, limit - 1, lenient);
               --p;
 
               break;
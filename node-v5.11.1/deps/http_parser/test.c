@@ -3345,6 +3345,12 @@ test_invalid_header_field_content_error (int req)
 {
   test_invalid_header_content(req, "Foo: F\01ailure");
   test_invalid_header_content(req, "Foo: B\02ar");
+  /* Past the first byte of the value, and past the bulk scanners' blocks. */
+  test_invalid_header_content(req, "Foo: Fa\01ilure");
+  test_invalid_header_content(req,
+      "Foo: 0123456789abcdef0123456789abcdef0123456789\177");
+  test_invalid_header_content(req,
+      "Foo: 0123456789abcdef0123456789abcdef01234567\03189abcdef\r\n");
 }
 
 void
@@ -4077,6 +4083,17 @@ main (void)
     test_simple(buf, HPE_INVALID_METHOD);
   }
 
+  // invalid URL characters inside and after the bulk scanners' blocks
+  test_simple("GET /0123456789abcdef0123456789abcdef0123\001 HTTP/1.1\r\n\r\n",
+              HPE_INVALID_URL);
+  test_simple("GET /0123456789abcdef?0123456789abcdef0123456789\177 HTTP/1.1\r\n"
+              "\r\n",
+              HPE_INVALID_URL);
+  test_simple("GET /0123456789abcdef0123456789abcdef0123456789abcdef?x=1&y=\"2\"#"
+              "0123456789abcdef0123456789abcdef0123456789abcdef HTTP/1.1\r\n"
+              "\r\n",
+              HPE_OK);
+
   // illegal header field name line folding
   test_simple("GET / HTTP/1.1\r\n"
               "name\r\n"
@@ -223,7 +223,8 @@ typedef struct {
   void* prepare_handles[2];                                                   \
   void* check_handles[2];                                                     \
   void* idle_handles[2];                                                      \
-  void* async_handles[2];                                                     \
+  uv_async_t* async_pending;                                                  \
+  void* async_reserved;                                                       \
   struct uv__async async_watcher;                                             \
   struct {                                                                    \
     void* min;                                                                \
@@ -310,7 +311,8 @@ typedef struct {
 
 #define UV_ASYNC_PRIVATE_FIELDS                                               \
   uv_async_cb async_cb;                                                       \
-  void* queue[2];                                                             \
+  struct uv_async_s* pending_next;                                            \
+  void* reserved;                                                             \
   int pending;                                                                \
 
 #define UV_TIMER_PRIVATE_FIELDS                                               \
@@ -37,6 +37,22 @@ static void uv__async_event(uv_loop_t* loop,
                             struct uv__async* w,
                             unsigned int nevents);
 static int uv__async_eventfd(void);
+static int uv__async_push(uv_loop_t* loop,
+                          uv_async_t* first,
+                          uv_async_t* last);
+static uv_async_t* uv__async_take(uv_loop_t* loop);
+
+
+/* Handles that have been sent to but not dispatched yet are kept on
+ * loop->async_pending, a lock-free stack linked through pending_next.  Any
+ * thread pushes onto it, only the loop thread takes from it, and it takes
+ * the whole stack at once, so a dispatch only touches the handles that were
+ * actually sent to, however many handles the loop has.
+ *
+ * A handle is on the stack exactly when its pending flag is set; the thread
+ * that flips the flag from 0 to 1 pushes it, the loop clears the flag when it
+ * runs the callback.
+ */
 
 
 int uv_async_init(uv_loop_t* loop, uv_async_t* handle, uv_async_cb async_cb) {
@@ -48,9 +64,9 @@ int uv_async_init(uv_loop_t* loop, uv_async_t* handle, uv_async_cb async_cb) {
 
   uv__handle_init(loop, (uv_handle_t*)handle, UV_ASYNC);
   handle->async_cb = async_cb;
+  handle->pending_next = NULL;
   handle->pending = 0;
 
-  QUEUE_INSERT_TAIL(&loop->async_handles, &handle->queue);
   uv__handle_start(handle);
 
   return 0;
@@ -62,7 +78,13 @@ int uv_async_send(uv_async_t* handle) {
   if (ACCESS_ONCE(int, handle->pending) != 0)
     return 0;
 
-  if (cmpxchgi(&handle->pending, 0, 1) == 0)
+  if (cmpxchgi(&handle->pending, 0, 1) != 0)
+    return 0;
+
+  /* Only the send that finds the stack empty has to wake up the loop, the
+   * loop takes the handles pushed after it with the same wakeup.
+   */
+  if (uv__async_push(handle->loop, handle, handle))
     uv__async_send(&handle->loop->async_watcher);
 
   return 0;
@@ -70,25 +92,96 @@ int uv_async_send(uv_async_t* handle) {
 
 
 void uv__async_close(uv_async_t* handle) {
-  QUEUE_REMOVE(&handle->queue);
+  uv_loop_t* loop;
+  uv_async_t* first;
+  uv_async_t* last;
+  uv_async_t* h;
+  uv_async_t* next;
+
+  /* Take the handle off the pending stack so the loop doesn't look at it
+   * after the close callback.  uv_async_send() must not race with
+   * uv_close(), so if the flag is set the handle is on the stack, or in the
+   * list that uv__async_event() is working on and that skips closing handles.
+   */
+  if (ACCESS_ONCE(int, handle->pending) != 0) {
+    loop = handle->loop;
+    first = NULL;
+    last = NULL;
+
+    for (h = uv__async_take(loop); h != NULL; h = next) {
+      next = h->pending_next;
+      if (h == handle)
+        continue;
+      h->pending_next = first;
+      first = h;
+      if (last == NULL)
+        last = h;
+    }
+
+    /* The wakeup for the others is still pending. */
+    if (first != NULL)
+      uv__async_push(loop, first, last);
+  }
+
   uv__handle_stop(handle);
 }
 
 
+/* Pushes the handles first..last, linked through pending_next, onto the
+ * pending stack.  Returns non-zero if the stack was empty.
+ */
+static int uv__async_push(uv_loop_t* loop,
+                          uv_async_t* first,
+                          uv_async_t* last) {
+  void* head;
+
+  do {
+    head = loop->async_pending;
+    last->pending_next = head;
+  } while (cmpxchgp((void**) &loop->async_pending, head, first) != head);
+
+  return head == NULL;
+}
+
+
+/* Empties the pending stack and returns what was on it, most recently sent
+ * handle first.
+ */
+static uv_async_t* uv__async_take(uv_loop_t* loop) {
+  void* head;
+
+  do {
+    head = loop->async_pending;
+    if (head == NULL)
+      return NULL;
+  } while (cmpxchgp((void**) &loop->async_pending, head, NULL) != head);
+
+  return head;
+}
+
+
 static void uv__async_event(uv_loop_t* loop,
                             struct uv__async* w,
                             unsigned int nevents) {
-  QUEUE queue;
-  QUEUE* q;
+  uv_async_t* list;
   uv_async_t* h;
+  uv_async_t* next;
+
+  /* Run the callbacks in the order of the sends. */
+  list = NULL;
+  for (h = uv__async_take(loop); h != NULL; h = next) {
+    next = h->pending_next;
+    h->pending_next = list;
+    list = h;
+  }
 
-  QUEUE_MOVE(&loop->async_handles, &queue);
-  while (!QUEUE_EMPTY(&queue)) {
-    q = QUEUE_HEAD(&queue);
-    h = QUEUE_DATA(q, uv_async_t, queue);
+  for (h = list; h != NULL; h = next) {
+    /* Another thread can push the handle again once the flag is cleared. */
+    next = h->pending_next;
 
-    QUEUE_REMOVE(q);
-    QUEUE_INSERT_TAIL(&loop->async_handles, q);
+    /* Closed by one of the callbacks before it. */
+    if (uv__is_closing(h))
+      continue;
 
     if (cmpxchgi(&h->pending, 1, 0) == 0)
       continue;
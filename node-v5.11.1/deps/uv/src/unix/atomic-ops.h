@@ -25,6 +25,7 @@
 
 UV_UNUSED(static int cmpxchgi(int* ptr, int oldval, int newval));
 UV_UNUSED(static long cmpxchgl(long* ptr, long oldval, long newval));
+UV_UNUSED(static void* cmpxchgp(void** ptr, void* oldval, void* newval));
 UV_UNUSED(static void cpu_relax(void));
 
 /* Prefer hand-rolled assembly over the gcc builtins because the latter also
@@ -68,6 +69,11 @@ UV_UNUSED(static long cmpxchgl(long* ptr, long oldval, long newval)) {
 #endif
 }
 
+/* long is pointer-sized on the platforms that use this file. */
+UV_UNUSED(static void* cmpxchgp(void** ptr, void* oldval, void* newval)) {
+  return (void*) cmpxchgl((long*) ptr, (long) oldval, (long) newval);
+}
+
 UV_UNUSED(static void cpu_relax(void)) {
 #if defined(__i386__) || defined(__x86_64__)
   __asm__ __volatile__ ("rep; nop");  /* a.k.a. PAUSE */
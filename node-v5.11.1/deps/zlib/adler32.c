@@ -6,6 +6,7 @@
 /* @(#) $Id$ */
 
 #include "zutil.h"
+#include "adler32_simd.h"
 
 #define local static
 
@@ -89,6 +90,16 @@ uLong ZEXPORT adler32(adler, buf, len)
     if (buf == Z_NULL)
         return 1L;
 
+#ifdef ADLER32_SIMD_SSSE3
+    if (len >= Z_ADLER32_SIMD_MINIMUM_LENGTH) {
+        cpu_check_features();
+        if (x86_cpu_enable_avx2)
+            return adler32_avx2_simd_(adler | (sum2 << 16), buf, len);
+        if (x86_cpu_enable_ssse3)
+            return adler32_ssse3_simd_(adler | (sum2 << 16), buf, len);
+    }
+#endif /* ADLER32_SIMD_SSSE3 */
+
     /* in case short lengths are provided, keep it somewhat fast */
     if (len < 16) {
         while (len--) {
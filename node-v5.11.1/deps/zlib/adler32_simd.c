@@ -0,0 +1,191 @@
+/* adler32_simd.c -- Adler-32 with SSSE3 and AVX2
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ *
+ * Per block of 32 bytes b[0..31], Adler-32 adds
+ *
+ *   s1 += b[0] + b[1] + ... + b[31]
+ *   s2 += 32 * s1 + 32 * b[0] + 31 * b[1] + ... + 1 * b[31]
+ *
+ * where s1 is its value before the block.  The byte sums are computed with
+ * PSADBW, the weighted sums with PMADDUBSW against the taps 32..1, and the
+ * 32 * s1 terms are accumulated in v_ps and added once per run of blocks.
+ * The sums are reduced modulo BASE every NMAX bytes, like adler32() does.
+ */
+
+#include "adler32_simd.h"
+
+#ifdef ADLER32_SIMD_SSSE3
+
+#include <tmmintrin.h>
+#include <immintrin.h>
+
+#define BASE 65521      /* largest prime smaller than 65536 */
+#define NMAX 5552       /* see adler32.c */
+
+#define BLOCK_SIZE 32
+
+local uLong adler32_tail OF((unsigned long s1, unsigned long s2,
+                             const Bytef *buf, uInt len));
+
+/* Adds the last len < BLOCK_SIZE bytes and recombines the sums. */
+local uLong adler32_tail(s1, s2, buf, len)
+    unsigned long s1;
+    unsigned long s2;
+    const Bytef *buf;
+    uInt len;
+{
+    if (len) {
+        while (len--) {
+            s1 += *buf++;
+            s2 += s1;
+        }
+        if (s1 >= BASE)
+            s1 -= BASE;
+        s2 %= BASE;
+    }
+    return s1 | (s2 << 16);
+}
+
+Z_TARGET("ssse3")
+uLong ZLIB_INTERNAL adler32_ssse3_simd_(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned long s1 = adler & 0xffff;
+    unsigned long s2 = (adler >> 16) & 0xffff;
+    uInt blocks = len / BLOCK_SIZE;
+
+    const __m128i tap1 =
+        _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                      24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 =
+        _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+
+    len -= blocks * BLOCK_SIZE;
+
+    while (blocks) {
+        unsigned n = NMAX / BLOCK_SIZE;
+        __m128i v_ps, v_s1, v_s2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        v_ps = _mm_set_epi32(0, 0, 0, (int)(s1 * n));
+        v_s2 = _mm_set_epi32(0, 0, 0, (int)s2);
+        v_s1 = _mm_setzero_si128();
+
+        do {
+            const __m128i bytes1 = _mm_loadu_si128((const __m128i *)buf);
+            const __m128i bytes2 =
+                _mm_loadu_si128((const __m128i *)(buf + 16));
+
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                       _mm_maddubs_epi16(bytes1, tap1), ones));
+
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(
+                       _mm_maddubs_epi16(bytes2, tap2), ones));
+
+            buf += BLOCK_SIZE;
+        } while (--n);
+
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        /* Sum the lanes. */
+        v_s1 = _mm_add_epi32(v_s1,
+                             _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1,
+                             _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += (unsigned)_mm_cvtsi128_si32(v_s1);
+
+        v_s2 = _mm_add_epi32(v_s2,
+                             _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2,
+                             _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = (unsigned)_mm_cvtsi128_si32(v_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+
+    return adler32_tail(s1, s2, buf, len);
+}
+
+Z_TARGET("avx2")
+uLong ZLIB_INTERNAL adler32_avx2_simd_(adler, buf, len)
+    uLong adler;
+    const Bytef *buf;
+    uInt len;
+{
+    unsigned long s1 = adler & 0xffff;
+    unsigned long s2 = (adler >> 16) & 0xffff;
+    uInt blocks = len / BLOCK_SIZE;
+
+    const __m256i tap =
+        _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25,
+                         24, 23, 22, 21, 20, 19, 18, 17,
+                         16, 15, 14, 13, 12, 11, 10, 9,
+                         8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    len -= blocks * BLOCK_SIZE;
+
+    while (blocks) {
+        unsigned n = NMAX / BLOCK_SIZE;
+        __m256i v_ps, v_s1, v_s2;
+        __m128i x_s1, x_s2;
+
+        if (n > blocks)
+            n = blocks;
+        blocks -= n;
+
+        v_ps = _mm256_set_epi32(0, 0, 0, 0, 0, 0, 0, (int)(s1 * n));
+        v_s2 = _mm256_set_epi32(0, 0, 0, 0, 0, 0, 0, (int)s2);
+        v_s1 = _mm256_setzero_si256();
+
+        do {
+            const __m256i bytes = _mm256_loadu_si256((const __m256i *)buf);
+
+            v_ps = _mm256_add_epi32(v_ps, v_s1);
+            v_s1 = _mm256_add_epi32(v_s1, _mm256_sad_epu8(bytes, zero));
+            v_s2 = _mm256_add_epi32(v_s2, _mm256_madd_epi16(
+                       _mm256_maddubs_epi16(bytes, tap), ones));
+
+            buf += BLOCK_SIZE;
+        } while (--n);
+
+        v_s2 = _mm256_add_epi32(v_s2, _mm256_slli_epi32(v_ps, 5));
+
+        /* Sum the lanes. */
+        x_s1 = _mm_add_epi32(_mm256_castsi256_si128(v_s1),
+                             _mm256_extracti128_si256(v_s1, 1));
+        x_s1 = _mm_add_epi32(x_s1,
+                             _mm_shuffle_epi32(x_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        x_s1 = _mm_add_epi32(x_s1,
+                             _mm_shuffle_epi32(x_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += (unsigned)_mm_cvtsi128_si32(x_s1);
+
+        x_s2 = _mm_add_epi32(_mm256_castsi256_si128(v_s2),
+                             _mm256_extracti128_si256(v_s2, 1));
+        x_s2 = _mm_add_epi32(x_s2,
+                             _mm_shuffle_epi32(x_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        x_s2 = _mm_add_epi32(x_s2,
+                             _mm_shuffle_epi32(x_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = (unsigned)_mm_cvtsi128_si32(x_s2);
+
+        s1 %= BASE;
+        s2 %= BASE;
+    }
+
+    return adler32_tail(s1, s2, buf, len);
+}
+
+#endif /* ADLER32_SIMD_SSSE3 */
@@ -0,0 +1,25 @@
+/* adler32_simd.h -- Adler-32 with SSSE3 and AVX2
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef ADLER32_SIMD_H
+#define ADLER32_SIMD_H
+
+#include "cpu_features.h"
+
+#ifdef ADLER32_SIMD_SSSE3
+
+/* Same contract as adler32(), minus the Z_NULL and short length handling.
+ * The SSSE3 version needs x86_cpu_enable_ssse3, the AVX2 version
+ * x86_cpu_enable_avx2.
+ */
+uLong ZLIB_INTERNAL adler32_ssse3_simd_ OF((uLong adler,
+                                            const Bytef *buf, uInt len));
+uLong ZLIB_INTERNAL adler32_avx2_simd_ OF((uLong adler,
+                                           const Bytef *buf, uInt len));
+
+#define Z_ADLER32_SIMD_MINIMUM_LENGTH 64
+
+#endif /* ADLER32_SIMD_SSSE3 */
+
+#endif /* ADLER32_SIMD_H */
@@ -0,0 +1,84 @@
+/* cpu_features.c -- runtime detection of x86 SIMD extensions
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#include "cpu_features.h"
+
+#ifdef Z_X86_SIMD
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+int x86_cpu_enable_ssse3 = 0;
+int x86_cpu_enable_simd = 0;
+int x86_cpu_enable_avx2 = 0;
+
+local volatile int cpu_checked = 0;
+
+local void cpuid OF((unsigned leaf, unsigned subleaf, unsigned regs[4]));
+local unsigned long long xgetbv0 OF((void));
+
+local void cpuid(leaf, subleaf, regs)
+    unsigned leaf;
+    unsigned subleaf;
+    unsigned regs[4];
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, (int)leaf, (int)subleaf);
+    regs[0] = (unsigned)r[0];
+    regs[1] = (unsigned)r[1];
+    regs[2] = (unsigned)r[2];
+    regs[3] = (unsigned)r[3];
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* Which register states the OS saves on context switches. */
+local unsigned long long xgetbv0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ __volatile__ ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+void ZLIB_INTERNAL cpu_check_features()
+{
+    unsigned regs[4];
+    unsigned max_leaf;
+    int has_ssse3, has_sse42, has_pclmul, has_avx, has_avx2 = 0;
+
+    if (cpu_checked)
+        return;
+
+    cpuid(0, 0, regs);
+    max_leaf = regs[0];
+
+    cpuid(1, 0, regs);
+    has_ssse3 = (regs[2] >> 9) & 1;
+    has_sse42 = (regs[2] >> 20) & 1;
+    has_pclmul = (regs[2] >> 1) & 1;
+    /* AVX needs OSXSAVE and the OS saving the XMM and YMM registers. */
+    has_avx = ((regs[2] >> 27) & 1) && ((regs[2] >> 28) & 1) &&
+              (xgetbv0() & 6) == 6;
+
+    if (has_avx && max_leaf >= 7) {
+        cpuid(7, 0, regs);
+        has_avx2 = (regs[1] >> 5) & 1;
+    }
+
+    x86_cpu_enable_ssse3 = has_ssse3;
+    x86_cpu_enable_simd = has_sse42 && has_pclmul;
+    x86_cpu_enable_avx2 = has_avx2;
+    cpu_checked = 1;
+}
+
+#endif /* Z_X86_SIMD */
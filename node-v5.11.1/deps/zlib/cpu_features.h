@@ -0,0 +1,55 @@
+/* cpu_features.h -- runtime detection of x86 SIMD extensions
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+#include "zutil.h"
+
+/* The SIMD code is enabled by the build (see zlib.gyp) with
+ * ADLER32_SIMD_SSSE3 and CRC32_SIMD_SSE42_PCLMUL on x86 targets.  It is
+ * compiled with per-function target attributes rather than -m flags, so the
+ * rest of zlib keeps running on any x86 CPU; that needs MSVC, GCC 4.9+ or a
+ * clang that has __builtin_cpu_supports().  Other compilers get the plain C
+ * code.
+ */
+#if defined(ADLER32_SIMD_SSSE3) || defined(CRC32_SIMD_SSE42_PCLMUL)
+#  if defined(_MSC_VER)
+#    define Z_X86_SIMD
+#    define Z_TARGET(features)
+#  elif defined(__clang__)
+#    if defined(__has_builtin)
+#      if __has_builtin(__builtin_cpu_supports)
+#        define Z_X86_SIMD
+#      endif
+#    endif
+#  elif defined(__GNUC__)
+#    if __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#      define Z_X86_SIMD
+#    endif
+#  endif
+#  ifndef Z_TARGET
+#    define Z_TARGET(features) __attribute__((target(features)))
+#  endif
+#  ifndef Z_X86_SIMD
+#    undef ADLER32_SIMD_SSSE3
+#    undef CRC32_SIMD_SSE42_PCLMUL
+#  endif
+#endif
+
+#ifdef Z_X86_SIMD
+
+/* Set by cpu_check_features(). */
+extern int x86_cpu_enable_ssse3;  /* SSSE3 */
+extern int x86_cpu_enable_simd;   /* SSE4.2 and PCLMULQDQ */
+extern int x86_cpu_enable_avx2;   /* AVX2, with OS support for YMM state */
+
+/* Fills in the flags above on the first call; cheap afterwards.  Racing
+ * threads store the same values, so no locking is needed.
+ */
+void ZLIB_INTERNAL cpu_check_features OF((void));
+
+#endif /* Z_X86_SIMD */
+
+#endif /* CPU_FEATURES_H */
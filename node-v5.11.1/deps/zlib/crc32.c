@@ -29,6 +29,7 @@
 #endif /* MAKECRCH */
 
 #include "zutil.h"      /* for STDC and FAR definitions */
+#include "crc32_simd.h"
 
 #define local static
 
@@ -213,6 +214,23 @@ unsigned long ZEXPORT crc32(crc, buf, len)
         make_crc_table();
 #endif /* DYNAMIC_CRC_TABLE */
 
+#ifdef CRC32_SIMD_SSE42_PCLMUL
+    /* Fold whole 16-byte blocks with PCLMULQDQ and finish the tail with the
+     * table code below.
+     */
+    if (len >= Z_CRC32_SSE42_MINIMUM_LENGTH) {
+        cpu_check_features();
+        if (x86_cpu_enable_simd) {
+            uInt chunk = len & ~Z_CRC32_SSE42_CHUNKSIZE_MASK;
+            crc = ~crc32_sse42_simd_(buf, chunk, ~(uInt)crc) & 0xffffffffUL;
+            buf += chunk;
+            len -= chunk;
+            if (len == 0)
+                return crc;
+        }
+    }
+#endif /* CRC32_SIMD_SSE42_PCLMUL */
+
 #ifdef BYFOUR
     if (sizeof(void *) == sizeof(ptrdiff_t)) {
         z_crc_t endian;
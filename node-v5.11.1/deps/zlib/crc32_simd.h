@@ -0,0 +1,24 @@
+/* crc32_simd.h -- CRC-32 with PCLMULQDQ
+ * For conditions of distribution and use, see copyright notice in zlib.h
+ */
+
+#ifndef CRC32_SIMD_H
+#define CRC32_SIMD_H
+
+#include "cpu_features.h"
+
+#ifdef CRC32_SIMD_SSE42_PCLMUL
+
+/* Runs the CRC-32 register crc, i.e. the complement of a crc32() value,
+ * over len bytes of buf and returns the new register value.  len must be a
+ * multiple of 16 and at least Z_CRC32_SSE42_MINIMUM_LENGTH.
+ */
+uInt ZLIB_INTERNAL crc32_sse42_simd_ OF((const unsigned char *buf,
+                                         uInt len, uInt crc));
+
+#define Z_CRC32_SSE42_MINIMUM_LENGTH 64
+#define Z_CRC32_SSE42_CHUNKSIZE_MASK 15
+
+#endif /* CRC32_SIMD_SSE42_PCLMUL */
+
+#endif /* CRC32_SIMD_H */
@@ -97,6 +97,40 @@ local  void check_match OF((deflate_state *s, IPos start, IPos match,
                             int length));
 #endif
 
+/* Without UNALIGNED_OK, longest_match() compares eight bytes at a time on
+ * little-endian CPUs that have cheap unaligned loads, and finds the first
+ * differing byte by counting the trailing zeros of their exclusive-or.  It
+ * finds the same matches as the byte by byte loop, so the compressed output
+ * doesn't change.  Define NO_MATCH_BY_WORDS to use the byte loop anyway.
+ */
+#if !defined(UNALIGNED_OK) && !defined(NO_MATCH_BY_WORDS)
+#  if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__) || \
+      (defined(__aarch64__) && !defined(__AARCH64EB__)))
+#    define MATCH_BY_WORDS
+#    define match_ctz64(x) __builtin_ctzll(x)
+#  elif defined(_MSC_VER) && defined(_M_X64)
+#    include <intrin.h>
+#    define MATCH_BY_WORDS
+local int match_ctz64 OF((unsigned __int64 x));
+local int match_ctz64(x)
+    unsigned __int64 x;
+{
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (int)index;
+}
+#  endif
+#endif
+
+#ifdef MATCH_BY_WORDS
+#  include <string.h>
+#  ifdef _MSC_VER
+     typedef unsigned __int64 match_word;
+#  else
+     typedef unsigned long long match_word;
+#  endif
+#endif
+
 /* ===========================================================================
  * Local data
  */
@@ -1253,6 +1287,26 @@ local uInt longest_match(s, cur_match)
         scan += 2, match++;
         Assert(*scan == *match, "match[2]?");
 
+#ifdef MATCH_BY_WORDS
+        /* Compare strstart+3 .. strstart+258 as 32 words; the last word
+         * ends at strend like the byte loop below.
+         */
+        scan++, match++;
+        for (;;) {
+            match_word a, b;
+            memcpy(&a, scan, sizeof(a));
+            memcpy(&b, match, sizeof(b));
+            if (a != b) {
+                scan += match_ctz64(a ^ b) >> 3;
+                break;
+            }
+            scan += sizeof(a), match += sizeof(b);
+            if (scan > strend) {
+                scan = strend;
+                break;
+            }
+        }
+#else
         /* We check for insufficient lookahead only every 8th comparison;
          * the 256th check will be made at strstart+258.
          */
@@ -1262,6 +1316,7 @@ local uInt longest_match(s, cur_match)
                  *++scan == *++match && *++scan == *++match &&
                  *++scan == *++match && *++scan == *++match &&
                  scan < strend);
+#endif /* MATCH_BY_WORDS */
 
         Assert(scan <= s->window+(unsigned)(s->window_size-1), "wild scan");
 
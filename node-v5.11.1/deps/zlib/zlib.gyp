@@ -14,9 +14,15 @@
           'type': 'static_library',
           'sources': [
             'adler32.c',
+            'adler32_simd.c',
+            'adler32_simd.h',
             'compress.c',
+            'cpu_features.c',
+            'cpu_features.h',
             'crc32.c',
             'crc32.h',
+            'crc32_simd.c',
+            'crc32_simd.h',
             'deflate.c',
             'deflate.h',
             'gzclose.c',
@@ -61,6 +67,13 @@
                 'USE_FILE32API'
               ],
             }],
+            ['target_arch=="ia32" or target_arch=="x64"', {
+              # Checksums with SSSE3, AVX2 and PCLMULQDQ, picked at runtime.
+              'defines': [
+                'ADLER32_SIMD_SSSE3',
+                'CRC32_SIMD_SSE42_PCLMUL',
+              ],
+            }],
           ],
         },
       ],
@@ -8,6 +8,7 @@ const Stream = require('stream');
 const Buffer = require('buffer').Buffer;
 const util = require('util');
 const debug = util.debuglog('stream');
+const BufferList = require('internal/streams/buffer_list');
 var StringDecoder;
 
 util.inherits(Readable, Stream);
@@ -31,7 +32,7 @@ function ReadableState(options, stream) {
   // cast to ints.
   this.highWaterMark = ~~this.highWaterMark;
 
-  this.buffer = [];
+  this.buffer = new BufferList();
   this.length = 0;
   this.pipes = null;
   this.pipesCount = 0;
@@ -68,6 +69,11 @@ function ReadableState(options, stream) {
   // if true, a maybeReadMore has been scheduled
   this.readingMore = false;
 
+  // In batch mode, the chunks that arrive while flowing are collected and
+  // emitted together as a 'datav' event, once per event loop iteration.
+  this.batch = !!options.batch;
+  this.batchScheduled = false;
+
   this.decoder = null;
   this.encoding = null;
   if (options.encoding) {
@@ -149,7 +155,8 @@ function readableAddChunk(stream, state, chunk, encoding, addToFront) {
       // we're not in object mode
       if (!skipAdd) {
         // if we want the data now, just emit it.
-        if (state.flowing && state.length === 0 && !state.sync) {
+        if (state.flowing && state.length === 0 && !state.sync &&
+            !state.batch) {
           stream.emit('data', chunk);
           stream.read(0);
         } else {
@@ -160,7 +167,9 @@ function readableAddChunk(stream, state, chunk, encoding, addToFront) {
           else
             state.buffer.push(chunk);
 
-          if (state.needReadable)
+          if (state.batch && state.flowing)
+            scheduleBatch(stream, state);
+          else if (state.needReadable)
             emitReadable(stream);
         }
       }
@@ -226,7 +235,7 @@ function howMuchToRead(n, state) {
   if (n === null || isNaN(n)) {
     // only flow one buffer at a time
     if (state.flowing && state.buffer.length)
-      return state.buffer[0].length;
+      return state.buffer.head.data.length;
     else
       return state.length;
   }
@@ -517,6 +526,7 @@ Readable.prototype.pipe = function(dest, pipeOpts) {
     src.removeListener('end', onend);
     src.removeListener('end', cleanup);
     src.removeListener('data', ondata);
+    src.removeListener('datav', ondatav);
 
     cleanedUp = true;
 
@@ -530,10 +540,31 @@ Readable.prototype.pipe = function(dest, pipeOpts) {
       ondrain();
   }
 
-  src.on('data', ondata);
+  // A source in batch mode writes each batch corked, so that a dest with a
+  // _writev() gets it in a single call.
+  if (state.batch)
+    src.on('datav', ondatav);
+  else
+    src.on('data', ondata);
   function ondata(chunk) {
     debug('ondata');
-    var ret = dest.write(chunk);
+    onwritten(dest.write(chunk));
+  }
+
+  function ondatav(chunks) {
+    debug('ondatav', chunks.length);
+    var ret = true;
+    var cork = chunks.length > 1 && typeof dest.cork === 'function';
+    if (cork)
+      dest.cork();
+    for (var i = 0; i < chunks.length; i++)
+      ret = dest.write(chunks[i]);
+    if (cork)
+      dest.uncork();
+    onwritten(ret);
+  }
+
+  function onwritten(ret) {
     if (false === ret) {
       // If the user unpiped during `dest.write()`, it is possible
       // to get stuck in a permanently paused state if that write
@@ -604,7 +635,8 @@ function pipeOnDrain(src) {
     debug('pipeOnDrain', state.awaitDrain);
     if (state.awaitDrain)
       state.awaitDrain--;
-    if (state.awaitDrain === 0 && EE.listenerCount(src, 'data')) {
+    if (state.awaitDrain === 0 &&
+        (EE.listenerCount(src, 'data') || EE.listenerCount(src, 'datav'))) {
       state.flowing = true;
       flow(src);
     }
@@ -678,6 +710,13 @@ Readable.prototype.on = function(ev, fn) {
     this.resume();
   }
 
+  // Same for 'datav', which also switches the stream to batch mode.
+  if (ev === 'datav') {
+    this._readableState.batch = true;
+    if (false !== this._readableState.flowing)
+      this.resume();
+  }
+
   if (ev === 'readable' && !this._readableState.endEmitted) {
     var state = this._readableState;
     if (!state.readableListening) {
@@ -747,12 +786,45 @@ function flow(stream) {
   var state = stream._readableState;
   debug('flow', state.flowing);
   if (state.flowing) {
+    if (state.batch) {
+      scheduleBatch(stream, state);
+      return;
+    }
     do {
       var chunk = stream.read();
     } while (null !== chunk && state.flowing);
   }
 }
 
+// Use setImmediate() rather than process.nextTick(): the tick queue runs
+// after every I/O callback, so the batch of a socket would never hold more
+// than the chunk of a single read.
+function scheduleBatch(stream, state) {
+  if (!state.batchScheduled) {
+    state.batchScheduled = true;
+    setImmediate(emitBatch, stream, state);
+  }
+}
+
+function emitBatch(stream, state) {
+  state.batchScheduled = false;
+  if (!state.flowing)
+    return;
+  debug('emitBatch', state.buffer.length);
+  if (state.length > 0) {
+    var chunks = state.buffer.drain();
+    state.length = 0;
+    state.emittedReadable = false;
+    stream.emit('datav', chunks);
+    if (EE.listenerCount(stream, 'data') > 0) {
+      for (var i = 0; i < chunks.length; i++)
+        stream.emit('data', chunks[i]);
+    }
+  }
+  // Refill the buffer, or emit 'end' if that was the last of it.
+  stream.read(0);
+}
+
 // wrap an old-style stream as the async data source.
 // This is *not* part of the readable stream interface.
 // It is an ugly unfortunate mess of history.
@@ -823,7 +895,7 @@ Readable.prototype.wrap = function(stream) {
 // exposed for testing purposes only.
 Readable._fromList = fromList;
 
-// Pluck off n bytes from an array of buffers.
+// Pluck off n bytes from a list of buffers.
 // Length is the combined lengths of all the buffers in the list.
 function fromList(n, state) {
   var list = state.buffer;
@@ -841,23 +913,21 @@ function fromList(n, state) {
   else if (objectMode)
     ret = list.shift();
   else if (!n || n >= length) {
-    // read it all, truncate the array.
+    // read it all, truncate the list.
     if (stringMode)
       ret = list.join('');
-    else if (list.length === 1)
-      ret = list[0];
     else
-      ret = Buffer.concat(list, length);
-    list.length = 0;
+      ret = list.concat(length);
+    list.clear();
   } else {
     // read just some of it.
-    if (n < list[0].length) {
+    if (n < list.head.data.length) {
       // just take a part of the first list item.
       // slice is the same for buffers and strings.
-      const buf = list[0];
+      const buf = list.head.data;
       ret = buf.slice(0, n);
-      list[0] = buf.slice(n);
-    } else if (n === list[0].length) {
+      list.head.data = buf.slice(n);
+    } else if (n === list.head.data.length) {
       // first list is a perfect match
       ret = list.shift();
     } else {
@@ -869,8 +939,8 @@ function fromList(n, state) {
         ret = new Buffer(n);
 
       var c = 0;
-      for (var i = 0, l = list.length; i < l && c < n; i++) {
-        const buf = list[0];
+      while (list.length > 0 && c < n) {
+        const buf = list.head.data;
         var cpy = Math.min(n - c, buf.length);
 
         if (stringMode)
@@ -879,7 +949,7 @@ function fromList(n, state) {
           buf.copy(ret, c, 0, cpy);
 
         if (cpy < buf.length)
-          list[0] = buf.slice(cpy);
+          list.head.data = buf.slice(cpy);
         else
           list.shift();
 
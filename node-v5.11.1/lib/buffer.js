@@ -77,8 +77,9 @@ function createPool() {
   poolSize = Buffer.poolSize;
   allocPool = createBuffer(poolSize, true);
   poolOffset = 0;
+  // Transferring it would take the memory of unrelated Buffers along.
+  internalUtil.untransferable.add(allocPool.buffer);
 }
-createPool();
 
 
 function alignPool() {
@@ -121,6 +122,9 @@ Buffer.from = function(value, encodingOrOffset, length) {
 Object.setPrototypeOf(Buffer.prototype, Uint8Array.prototype);
 Object.setPrototypeOf(Buffer, Uint8Array);
 
+// createPool() reads allocPool.buffer, which needs the prototypes above.
+createPool();
+
 /**
  * Creates a new filled Buffer instance.
  * alloc(size[, fill[, encoding]])
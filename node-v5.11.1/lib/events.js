@@ -12,6 +12,36 @@ EventEmitter.EventEmitter = EventEmitter;
 
 EventEmitter.usingDomains = false;
 
+// The listeners of an emitter by event name, a function or an array of them.
+// Streams and sockets listen for a handful of events on every instance; they
+// get a property up front so that all emitters share one hidden class.
+// Removing the last listener for one of them stores undefined, deleting the
+// property would turn the object into a slower and larger dictionary.  Other
+// event names are added and deleted as needed.
+function EventHandlers() {
+  this.close = undefined;
+  this.data = undefined;
+  this.drain = undefined;
+  this.end = undefined;
+  this.error = undefined;
+  this.finish = undefined;
+}
+
+function clearListeners(events, type) {
+  switch (type) {
+    case 'close':
+    case 'data':
+    case 'drain':
+    case 'end':
+    case 'error':
+    case 'finish':
+      events[type] = undefined;
+      break;
+    default:
+      delete events[type];
+  }
+}
+
 EventEmitter.prototype.domain = undefined;
 EventEmitter.prototype._events = undefined;
 EventEmitter.prototype._maxListeners = undefined;
@@ -44,7 +74,7 @@ EventEmitter.init = function() {
   }
 
   if (!this._events || this._events === Object.getPrototypeOf(this)._events) {
-    this._events = {};
+    this._events = new EventHandlers();
     this._eventsCount = 0;
   }
 
@@ -211,7 +241,7 @@ EventEmitter.prototype.addListener = function addListener(type, listener) {
 
   events = this._events;
   if (!events) {
-    events = this._events = {};
+    events = this._events = new EventHandlers();
     this._eventsCount = 0;
   } else {
     // To avoid recursion in the case that type === "newListener"! Before
@@ -298,9 +328,9 @@ EventEmitter.prototype.removeListener =
 
       if (list === listener || (list.listener && list.listener === listener)) {
         if (--this._eventsCount === 0)
-          this._events = {};
+          this._events = new EventHandlers();
         else {
-          delete events[type];
+          clearListeners(events, type);
           if (events.removeListener)
             this.emit('removeListener', type, listener);
         }
@@ -321,10 +351,10 @@ EventEmitter.prototype.removeListener =
         if (list.length === 1) {
           list[0] = undefined;
           if (--this._eventsCount === 0) {
-            this._events = {};
+            this._events = new EventHandlers();
             return this;
           } else {
-            delete events[type];
+            clearListeners(events, type);
           }
         } else {
           spliceOne(list, position);
@@ -348,13 +378,13 @@ EventEmitter.prototype.removeAllListeners =
       // not listening for removeListener, no need to emit
       if (!events.removeListener) {
         if (arguments.length === 0) {
-          this._events = {};
+          this._events = new EventHandlers();
           this._eventsCount = 0;
         } else if (events[type]) {
           if (--this._eventsCount === 0)
-            this._events = {};
+            this._events = new EventHandlers();
           else
-            delete events[type];
+            clearListeners(events, type);
         }
         return this;
       }
@@ -368,7 +398,7 @@ EventEmitter.prototype.removeAllListeners =
           this.removeAllListeners(key);
         }
         this.removeAllListeners('removeListener');
-        this._events = {};
+        this._events = new EventHandlers();
         this._eventsCount = 0;
         return this;
       }
@@ -43,9 +43,9 @@
     _process.setupKillAndExit();
     _process.setupSignalHandlers();
 
-    // Do not initialize channel in debugger agent, it deletes env variable
-    // and the main thread won't see it.
-    if (process.argv[1] !== '--debug-agent')
+    // Do not initialize channel in debugger agent or in worker threads, it
+    // deletes env variable and the main thread won't see it.
+    if (process.argv[1] !== '--debug-agent' && isMainThread)
       _process.setupChannel();
 
     _process.setupRawDebug();
@@ -57,7 +57,14 @@
     // others like the debugger or running --eval arguments. Here we decide
     // which mode we run in.
 
-    if (NativeModule.exists('_third_party_main')) {
+    if (!isMainThread) {
+      // A worker thread of the worker_threads module.  It runs the file it
+      // was started with, its argv is [execPath, filename].
+      NativeModule.require('internal/worker').setupChild();
+      NativeModule.require('module')._load(process.argv[1], null, true);
+      process._tickCallback();
+
+    } else if (NativeModule.exists('_third_party_main')) {
       // To allow people to extend Node in different ways, this hook allows
       // one to drop a file lib/_third_party_main.js into the build
       // directory which will be executed instead of Node's normal loading.
@@ -309,6 +316,28 @@
     return script.runInThisContext();
   }
 
+  const workerBinding = process.binding('worker');
+  const isMainThread = workerBinding.isMainThread;
+
+  // Worker threads share the code caches of the core modules, so only the
+  // first worker that loads a module compiles it from scratch.  Producing a
+  // cache creates a Buffer, which has to wait for lib/buffer.js.
+  function compileWithCodeCache(id, filename, source) {
+    const cachedData = workerBinding.getCodeCache(id);
+    const buffer = NativeModule.getCached('buffer');
+    const script = new ContextifyScript(source, {
+      filename: filename,
+      lineOffset: 0,
+      cachedData: cachedData,
+      produceCachedData: cachedData === undefined &&
+                         buffer !== undefined &&
+                         buffer.loaded === true
+    });
+    if (script.cachedDataProduced)
+      workerBinding.setCodeCache(id, script.cachedData);
+    return script.runInThisContext();
+  }
+
   function NativeModule(id) {
     this.filename = `${id}.js`;
     this.id = id;
@@ -317,6 +346,8 @@
   }
 
   NativeModule._source = process.binding('natives');
+  // Code caches built into the binary, if any.  See src/node_mkcodecache.cc.
+  NativeModule._codeCache = process.binding('code_cache');
   NativeModule._cache = {};
 
   NativeModule.require = function(id) {
@@ -355,6 +386,17 @@
     return arg.match(/^--expose[-_]internals$/);
   });
 
+  // Experimental modules can't be required without their flag, so that they
+  // don't shadow packages of the same name in node_modules.
+  const EXPERIMENTAL_MODULES = {
+    json_stream: '--experimental-json-stream',
+    profiler: '--experimental-profiler',
+    worker_threads: '--experimental-worker'
+  };
+  const disabledModules = Object.keys(EXPERIMENTAL_MODULES).filter((id) => {
+    return process.execArgv.indexOf(EXPERIMENTAL_MODULES[id]) === -1;
+  });
+
   if (EXPOSE_INTERNALS) {
     NativeModule.nonInternalExists = NativeModule.exists;
 
@@ -367,7 +409,7 @@
     };
 
     NativeModule.isInternal = function(id) {
-      return id.startsWith('internal/');
+      return id.startsWith('internal/') || disabledModules.indexOf(id) !== -1;
     };
   }
 
@@ -389,10 +431,25 @@
     var source = NativeModule.getSource(this.id);
     source = NativeModule.wrap(source);
 
-    var fn = runInThisContext(source, {
-      filename: this.filename,
-      lineOffset: 0
-    });
+    var fn;
+    var cachedData = NativeModule._codeCache.get(this.id);
+    if (cachedData !== undefined) {
+      const script = new ContextifyScript(source, {
+        filename: this.filename,
+        lineOffset: 0,
+        cachedData: cachedData
+      });
+      if (script.cachedDataRejected)
+        NativeModule._codeCache.rejected.push(this.id);
+      fn = script.runInThisContext();
+    } else if (isMainThread) {
+      fn = runInThisContext(source, {
+        filename: this.filename,
+        lineOffset: 0
+      });
+    } else {
+      fn = compileWithCodeCache(this.id, this.filename, source);
+    }
     fn(this.exports, NativeModule.require, this, this.filename);
 
     this.loaded = true;
@@ -0,0 +1,99 @@
+'use strict';
+
+// Background parsing of user modules during startup, enabled with
+// --prefetch-modules=<manifest>.
+//
+// The manifest lists the absolute paths of the .js files that were loaded
+// while the main module ran, one per line, in load order.  Those files are
+// read and parsed on V8's worker threads a window ahead of the module that
+// is currently loading so that most require() calls find them ready to be
+// compiled.  Once the main module has run, the manifest is rewritten with
+// the files that were actually loaded if those differ from the list.
+
+const fs = require('fs');
+const debug = require('util').debuglog('module');
+
+// Number of modules that are parsed ahead of the one that's loading.
+const kWindowSize = 32;
+
+var prefetcher = null;
+var manifest = null;
+var wrapper = null;
+var head = null;
+var tail = null;
+var planned = [];
+var next = 0;
+var loaded = [];
+
+exports.start = function(filename, moduleWrapper) {
+  manifest = filename;
+  wrapper = moduleWrapper;
+  head = wrapper[0];
+  tail = wrapper[1];
+
+  try {
+    planned = fs.readFileSync(manifest, 'utf8').split(/\r?\n/).filter(Boolean);
+  } catch (e) {
+    // Not an error, the manifest is written when the main module is done.
+    debug('cannot read module manifest %s: %s', manifest, e.message);
+  }
+
+  const binding = process.binding('module_prefetch');
+  prefetcher = new binding.ModulePrefetcher(head, tail);
+  fill();
+};
+
+
+// Returns the compiled module wrapper for |filename| or undefined if the
+// file wasn't prefetched.  Records the file in the load trace either way.
+exports.take = function(filename) {
+  if (prefetcher === null)
+    return;
+
+  loaded.push(filename);
+  const compiledWrapper = prefetcher.take(filename);
+  fill();
+
+  // The source was wrapped with the wrapper in effect at start-up.
+  if (compiledWrapper === undefined ||
+      wrapper[0] !== head ||
+      wrapper[1] !== tail) {
+    return;
+  }
+  debug('prefetched %s', filename);
+  return compiledWrapper;
+};
+
+
+exports.finish = function() {
+  if (prefetcher === null)
+    return;
+
+  prefetcher.clear();
+  prefetcher = null;
+
+  if (loaded.join('\n') === planned.join('\n'))
+    return;
+
+  // Cluster workers may write the manifest at the same time and a process
+  // may die halfway through, so the new one is written next to it and then
+  // renamed over it.  Readers see either the old or the new manifest.
+  const contents = loaded.map((filename) => filename + '\n').join('');
+  const temporary = `${manifest}.${process.pid}.tmp`;
+  try {
+    fs.writeFileSync(temporary, contents);
+    fs.renameSync(temporary, manifest);
+  } catch (e) {
+    debug('cannot write module manifest %s: %s', manifest, e.message);
+    try {
+      fs.unlinkSync(temporary);
+    } catch (e) {}
+  }
+};
+
+
+function fill() {
+  const end = Math.min(planned.length, loaded.length + kWindowSize);
+  while (next < end)
+    prefetcher.prefetch(planned[next++]);
+}
@@ -0,0 +1,86 @@
+'use strict';
+
+const Buffer = require('buffer').Buffer;
+
+module.exports = BufferList;
+
+// The read buffer of a Readable: a singly linked list of chunks.  Unlike an
+// array, pushing and shifting never moves the other chunks around, which
+// matters for streams that buffer thousands of small chunks.
+function BufferList() {
+  this.head = null;
+  this.tail = null;
+  this.length = 0;
+}
+
+BufferList.prototype.push = function(v) {
+  const entry = { data: v, next: null };
+  if (this.length > 0)
+    this.tail.next = entry;
+  else
+    this.head = entry;
+  this.tail = entry;
+  ++this.length;
+};
+
+BufferList.prototype.unshift = function(v) {
+  const entry = { data: v, next: this.head };
+  if (this.length === 0)
+    this.tail = entry;
+  this.head = entry;
+  ++this.length;
+};
+
+BufferList.prototype.shift = function() {
+  if (this.length === 0)
+    return;
+  const ret = this.head.data;
+  if (this.length === 1)
+    this.head = this.tail = null;
+  else
+    this.head = this.head.next;
+  --this.length;
+  return ret;
+};
+
+BufferList.prototype.clear = function() {
+  this.head = this.tail = null;
+  this.length = 0;
+};
+
+// Empties the list and returns its chunks as an array.
+BufferList.prototype.drain = function() {
+  const ret = new Array(this.length);
+  var p = this.head;
+  for (var i = 0; p !== null; i++, p = p.next)
+    ret[i] = p.data;
+  this.clear();
+  return ret;
+};
+
+BufferList.prototype.join = function(s) {
+  if (this.length === 0)
+    return '';
+  var p = this.head;
+  var ret = '' + p.data;
+  while ((p = p.next) !== null)
+    ret += s + p.data;
+  return ret;
+};
+
+// The contents of all the Buffers in the list, |n| bytes in total.
+BufferList.prototype.concat = function(n) {
+  if (this.length === 0)
+    return new Buffer(0);
+  if (this.length === 1)
+    return this.head.data;
+  const ret = new Buffer(n);
+  var p = this.head;
+  var i = 0;
+  while (p !== null) {
+    p.data.copy(ret, i);
+    i += p.data.length;
+    p = p.next;
+  }
+  return ret;
+};
@@ -5,6 +5,10 @@ const prefix = '(node) ';
 
 exports.getHiddenValue = binding.getHiddenValue;
 
+// ArrayBuffers that postMessage() copies even when they are in the transfer
+// list, because other objects keep using them.  See lib/internal/worker.js.
+exports.untransferable = new WeakSet();
+
 // All the internal deprecations have to use this function only, as this will
 // prepend the prefix to the actual message.
 exports.deprecate = function(fn, msg) {
@@ -0,0 +1,436 @@
+'use strict';
+
+const Buffer = require('buffer').Buffer;
+const EventEmitter = require('events');
+const path = require('path');
+const util = require('util');
+const internalUtil = require('internal/util');
+
+const binding = process.binding('worker');
+const errnoException = util._errnoException;
+
+module.exports = {
+  Worker,
+  isMainThread: binding.isMainThread,
+  threadId: binding.threadId,
+  parentPort: null,
+  workerData: undefined,
+  waitAsync,
+  notify,
+  setupChild,
+  serialize,
+  deserialize
+};
+
+// Message types, see node::worker::Message.
+const kMessage = 0;
+const kError = 1;
+
+// Marks the objects that stand in for binary data in the JSON of a message.
+const kTag = '\u0000';
+
+// Atomics.OK, Atomics.NOTEQUAL and Atomics.TIMEDOUT, Atomics only exists with
+// --harmony-atomics.
+const kOk = 0;
+const kNotEqual = -1;
+const kTimedOut = -2;
+
+const views = {
+  Int8Array,
+  Uint8Array,
+  Uint8ClampedArray,
+  Int16Array,
+  Uint16Array,
+  Int32Array,
+  Uint32Array,
+  Float32Array,
+  Float64Array,
+  DataView
+};
+
+function isSharedArrayBuffer(value) {
+  return Object.prototype.toString.call(value) === '[object SharedArrayBuffer]';
+}
+
+
+// Turns |value| into the [json, buffers, shared] triple the binding posts.
+// Binary data is pulled out of the JSON: ArrayBuffers in |transferList| move
+// to the receiving thread and are neutered here, all others are copied.
+// SharedArrayBuffers are shared with the receiving thread.  Values that JSON
+// can't represent are lost the way JSON.stringify() loses them.
+function serialize(value, transferList) {
+  const transfer = new Set();
+  if (transferList !== undefined) {
+    if (!Array.isArray(transferList))
+      throw new TypeError('transferList must be an array');
+    for (var i = 0; i < transferList.length; i++) {
+      if (!(transferList[i] instanceof ArrayBuffer))
+        throw new TypeError('transferList may only contain ArrayBuffers');
+      transfer.add(transferList[i]);
+    }
+  }
+
+  const buffers = [];
+  const indices = new Map();
+
+  function indexOf(ab) {
+    var index = indices.get(ab);
+    if (index === undefined) {
+      index = buffers.length;
+      indices.set(ab, index);
+      if (transfer.has(ab) && !internalUtil.untransferable.has(ab))
+        buffers.push(ab);
+      else
+        buffers.push(ab.slice(0));
+    }
+    return index;
+  }
+
+  const shared = [];
+  const sharedIndices = new Map();
+
+  function sharedIndexOf(sab) {
+    var index = sharedIndices.get(sab);
+    if (index === undefined) {
+      index = shared.length;
+      sharedIndices.set(sab, index);
+      shared.push(sab);
+    }
+    return index;
+  }
+
+  function replacer(key, val) {
+    // |val| went through toJSON() already, look at the original.
+    const raw = this[key];
+    if (raw instanceof ArrayBuffer)
+      return { [kTag]: 'ArrayBuffer', i: indexOf(raw) };
+    if (isSharedArrayBuffer(raw))
+      return { [kTag]: 'SharedArrayBuffer', s: sharedIndexOf(raw) };
+    if (ArrayBuffer.isView(raw)) {
+      const view = {
+        [kTag]: raw instanceof Buffer ? 'Buffer' : raw.constructor.name,
+        o: raw.byteOffset,
+        l: raw instanceof DataView ? raw.byteLength : raw.length
+      };
+      if (isSharedArrayBuffer(raw.buffer))
+        view.s = sharedIndexOf(raw.buffer);
+      else
+        view.i = indexOf(raw.buffer);
+      return view;
+    }
+    return val;
+  }
+
+  // Buffer.prototype.toJSON() would turn every Buffer into an array of
+  // numbers before the replacer gets to see it.
+  const toJSON = Buffer.prototype.toJSON;
+  Buffer.prototype.toJSON = undefined;
+  var json;
+  try {
+    json = JSON.stringify(value, replacer);
+  } finally {
+    Buffer.prototype.toJSON = toJSON;
+  }
+
+  // Transferred ArrayBuffers are neutered even when |value| doesn't
+  // reference them.
+  transfer.forEach(indexOf);
+
+  return [json === undefined ? '' : json, buffers, shared];
+}
+
+
+function deserialize(json, buffers, shared) {
+  if (json === '')
+    return undefined;
+  return JSON.parse(json, function(key, val) {
+    if (val === null || typeof val !== 'object' || !(kTag in val))
+      return val;
+    const ab = val.s === undefined ? buffers[val.i] : shared[val.s];
+    const type = val[kTag];
+    if (type === 'ArrayBuffer' || type === 'SharedArrayBuffer')
+      return ab;
+    if (type === 'Buffer') {
+      // Buffer.from() doesn't take SharedArrayBuffers.
+      const buf = new Uint8Array(ab, val.o, val.l);
+      Object.setPrototypeOf(buf, Buffer.prototype);
+      return buf;
+    }
+    return new views[type](ab, val.o, val.l);
+  });
+}
+
+
+// What the parent's 'error' event gets for an exception that the worker
+// didn't handle.
+function serializeError(er) {
+  if (!(er instanceof Error))
+    return serialize({ error: false, value: er });
+  return serialize({
+    error: true,
+    value: { name: er.name, message: er.message, stack: er.stack }
+  });
+}
+
+
+function deserializeError(json, buffers, shared) {
+  const thrown = deserialize(json, buffers, shared);
+  if (!thrown.error)
+    return thrown.value;
+  const er = new Error(thrown.value.message);
+  er.name = thrown.value.name;
+  er.stack = thrown.value.stack;
+  return er;
+}
+
+
+function Worker(filename, options) {
+  if (!(this instanceof Worker))
+    return new Worker(filename, options);
+
+  EventEmitter.call(this);
+
+  if (typeof filename !== 'string')
+    throw new TypeError('filename must be a string');
+  options = options || {};
+
+  const execArgv = options.execArgv || process.execArgv;
+  if (!Array.isArray(execArgv))
+    throw new TypeError('options.execArgv must be an array');
+
+  var workerData = [];
+  if (options.workerData !== undefined)
+    workerData = serialize(options.workerData, options.transferList);
+
+  this._handle = new binding.Worker(path.resolve(filename),
+                                    execArgv,
+                                    workerData[0],
+                                    workerData[1],
+                                    workerData[2]);
+  this._handle.owner = this;
+  this._handle.onmessage = onmessage;
+  this._handle.onexit = onexit;
+  this.threadId = this._handle.threadId;
+
+  const err = this._handle.start();
+  if (err) {
+    this._handle.close();
+    this._handle = null;
+    throw errnoException(err, 'uv_thread_create');
+  }
+}
+util.inherits(Worker, EventEmitter);
+
+
+Worker.prototype.postMessage = function(value, transferList) {
+  const message = serialize(value, transferList);
+  // Messages to a worker that exited are dropped.
+  if (this._handle)
+    this._handle.postMessage(kMessage, message[0], message[1], message[2]);
+};
+
+
+// Stops the worker as soon as possible, even if it's busy running JS.
+Worker.prototype.terminate = function(callback) {
+  if (typeof callback === 'function') {
+    if (!this._handle)
+      return process.nextTick(callback, null, this.exitCode);
+    this.once('exit', function(code) {
+      callback(null, code);
+    });
+  }
+  if (this._handle)
+    this._handle.terminate();
+};
+
+
+Worker.prototype.ref = function() {
+  if (this._handle)
+    this._handle.ref();
+};
+
+
+Worker.prototype.unref = function() {
+  if (this._handle)
+    this._handle.unref();
+};
+
+
+function onmessage(type, json, buffers, shared) {
+  const owner = this.owner;
+  if (type === kError)
+    owner.emit('error', deserializeError(json, buffers, shared));
+  else
+    owner.emit('message', deserialize(json, buffers, shared));
+}
+
+
+function onexit(code) {
+  const owner = this.owner;
+  this.close();
+  owner._handle = null;
+  owner.exitCode = code;
+  owner.emit('exit', code);
+}
+
+
+// The handle that the wake-ups of this thread's waitAsync() calls arrive on,
+// created on first use.  It keeps the loop alive while waits are pending.
+var waiter = null;
+const waits = new Map();
+var nextWaitId = 0;
+
+// Returns the byte offset of |typedArray[index]| in its SharedArrayBuffer.
+function wordOffset(typedArray, index) {
+  if (!(typedArray instanceof Int32Array) ||
+      !isSharedArrayBuffer(typedArray.buffer)) {
+    throw new TypeError('typedArray must be an Int32Array on a ' +
+                        'SharedArrayBuffer');
+  }
+  if (typeof index !== 'number' || index % 1 !== 0 ||
+      index < 0 || index >= typedArray.length) {
+    throw new RangeError('index out of range');
+  }
+  return typedArray.byteOffset + index * 4;
+}
+
+
+// Like Atomics.futexWait(), but calls |callback| with the result on this
+// thread's event loop instead of blocking it.
+function waitAsync(typedArray, index, value, timeout, callback) {
+  if (typeof timeout === 'function') {
+    callback = timeout;
+    timeout = undefined;
+  }
+  if (typeof callback !== 'function')
+    throw new TypeError('callback must be a function');
+  const offset = wordOffset(typedArray, index);
+  timeout = timeout === undefined ? Infinity : +timeout;
+  if (timeout !== timeout)
+    timeout = Infinity;
+
+  if (waiter === null) {
+    waiter = new binding.AtomicsWaiter();
+    waiter.onwake = onwake;
+    waiter.unref();
+  }
+
+  const id = nextWaitId;
+  nextWaitId = (nextWaitId + 1) >>> 0;
+  if (!waiter.wait(typedArray.buffer, offset, value | 0, id))
+    return process.nextTick(callback, kNotEqual);
+
+  const wait = { callback: callback, typedArray: typedArray, timer: null };
+  if (timeout !== Infinity)
+    wait.timer = setTimeout(ontimeout, Math.max(timeout, 0), id);
+  if (waits.size === 0)
+    waiter.ref();
+  waits.set(id, wait);
+}
+
+
+function finishWait(id, result) {
+  const wait = waits.get(id);
+  waits.delete(id);
+  if (waits.size === 0)
+    waiter.unref();
+  if (wait.timer !== null)
+    clearTimeout(wait.timer);
+  process.nextTick(wait.callback, result);
+}
+
+
+function onwake(ids) {
+  for (var i = 0; i < ids.length; i++)
+    finishWait(ids[i], kOk);
+}
+
+
+function ontimeout(id) {
+  // If the wait was woken up already, onwake() is on its way.
+  if (waiter.cancel(id))
+    finishWait(id, kTimedOut);
+}
+
+
+// Wakes up to |count| waiters on |typedArray[index]|, those that block in
+// Atomics.futexWait() first, then those of waitAsync().  Returns how many
+// it woke up.
+function notify(typedArray, index, count) {
+  const offset = wordOffset(typedArray, index);
+  count = count === undefined ? Infinity : Math.max(0, +count || 0);
+  var woken = 0;
+  // futexWake() throws on counts that don't fit in an int32.
+  if (typeof Atomics === 'object')
+    woken = Atomics.futexWake(typedArray, index, Math.min(count, 0x7fffffff));
+  if (woken < count)
+    woken += binding.notify(typedArray.buffer, offset, count - woken);
+  return woken;
+}
+
+
+function throwInWorker(name) {
+  return function() {
+    throw new Error(`process.${name}() is not supported in workers`);
+  };
+}
+
+
+// Called by lib/internal/bootstrap_node.js on worker threads, before the
+// worker's main module runs.
+function setupChild() {
+  const port = new binding.MessagePort();
+  // Workers that don't listen for messages exit when they run out of work.
+  port.unref();
+
+  const parentPort = new EventEmitter();
+  parentPort.postMessage = function(value, transferList) {
+    const message = serialize(value, transferList);
+    port.postMessage(kMessage, message[0], message[1], message[2]);
+  };
+  parentPort.on('newListener', function(name) {
+    if (name === 'message' && this.listenerCount('message') === 0) {
+      port.ref();
+      port.start();
+    }
+  });
+  parentPort.on('removeListener', function(name) {
+    if (name === 'message' && this.listenerCount('message') === 0) {
+      port.stop();
+      port.unref();
+    }
+  });
+  port.onmessage = function(type, json, buffers, shared) {
+    parentPort.emit('message', deserialize(json, buffers, shared));
+  };
+
+  const workerData = binding.getWorkerData();
+  if (workerData !== undefined)
+    module.exports.workerData =
+        deserialize(workerData[0], workerData[1], workerData[2]);
+  module.exports.parentPort = parentPort;
+
+  // Unhandled errors end up in the parent's 'error' event.
+  const fatalException = process._fatalException;
+  process._fatalException = function(er) {
+    const caught = fatalException(er);
+    if (!caught) {
+      try {
+        const message = serializeError(er);
+        port.postMessage(kError, message[0], message[1], message[2]);
+      } catch (e) {
+        // Not serializable, the parent only sees the exit code.
+      }
+    }
+    return caught;
+  };
+
+  // They change the state of the whole process.
+  process.chdir = throwInWorker('chdir');
+  const umask = process.umask;
+  process.umask = function(mask) {
+    if (mask !== undefined)
+      throwInWorker('umask')();
+    return umask();
+  };
+}
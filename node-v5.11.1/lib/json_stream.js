@@ -0,0 +1,129 @@
+'use strict';
+
+const Transform = require('_stream_transform');
+const util = require('util');
+const JSONParser = process.binding('json_parser').JSONParser;
+const binding = process.binding('json_stringifier');
+
+const tokenTypes = [];
+tokenTypes[JSONParser.kStartObject] = 'startObject';
+tokenTypes[JSONParser.kEndObject] = 'endObject';
+tokenTypes[JSONParser.kStartArray] = 'startArray';
+tokenTypes[JSONParser.kEndArray] = 'endArray';
+tokenTypes[JSONParser.kKey] = 'key';
+tokenTypes[JSONParser.kValue] = 'value';
+
+
+// Parser is a Transform stream that takes UTF-8 encoded JSON text on its
+// writable side and produces objects on its readable side.  The input is
+// parsed incrementally, without turning it into a string first, and may
+// hold any number of whitespace separated JSON values.
+//
+// By default each top-level value is pushed as `{ key, value }`, where key
+// is the index of the value in the input.  With `options.depth` set to n,
+// the values nested n levels deep are pushed instead, with the array index
+// or object key they have in their parent; the enclosing containers are
+// validated but never built.  With `options.tokens` set, the readable side
+// yields `{ type, value }` tokens and no containers are built at all.
+function Parser(options) {
+  if (!(this instanceof Parser))
+    return new Parser(options);
+
+  options = options || {};
+
+  var depth = 0;
+  if (options.depth !== undefined) {
+    depth = options.depth;
+    if (typeof depth !== 'number' || depth < 0 || depth % 1 !== 0 ||
+        !isFinite(depth)) {
+      throw new TypeError('"depth" must be a non-negative integer');
+    }
+  }
+  this._tokens = !!options.tokens;
+
+  Transform.call(this, {
+    highWaterMark: options.highWaterMark,
+    readableObjectMode: true
+  });
+
+  this._handle = new JSONParser(this._tokens ? -1 : depth);
+}
+util.inherits(Parser, Transform);
+
+
+Parser.prototype._transform = function(chunk, encoding, callback) {
+  this._pushResults(this._handle.execute(chunk), callback);
+};
+
+
+Parser.prototype._flush = function(callback) {
+  this._pushResults(this._handle.finish(), callback);
+};
+
+
+Parser.prototype._pushResults = function(results, callback) {
+  if (results instanceof Error)
+    return callback(results);
+
+  var i;
+  if (this._tokens) {
+    for (i = 0; i < results.length; i += 2)
+      this.push({ type: tokenTypes[results[i]], value: results[i + 1] });
+  } else {
+    for (i = 0; i < results.length; i += 2)
+      this.push({ key: results[i], value: results[i + 1] });
+  }
+  callback();
+};
+
+
+exports.Parser = Parser;
+
+exports.createParser = function(options) {
+  return new Parser(options);
+};
+
+
+// Normalizes the replacer and space arguments the way JSON.stringify() does
+// and serializes |value| as UTF-8 straight into Buffer memory.
+function stringify(value, replacer, space, chunked) {
+  var replacerFunction;
+  var propertyList;
+  if (typeof replacer === 'function') {
+    replacerFunction = replacer;
+  } else if (Array.isArray(replacer)) {
+    propertyList = [];
+    for (var i = 0; i < replacer.length; i++) {
+      var item = replacer[i];
+      if (typeof item === 'number' || item instanceof Number ||
+          item instanceof String) {
+        item = String(item);
+      }
+      if (typeof item === 'string' && propertyList.indexOf(item) === -1)
+        propertyList.push(item);
+    }
+  }
+
+  if (space instanceof Number)
+    space = Number(space);
+  else if (space instanceof String)
+    space = String(space);
+
+  var gap = '';
+  if (typeof space === 'number')
+    gap = '          '.slice(0, Math.max(0, Math.min(10, Math.floor(space))));
+  else if (typeof space === 'string')
+    gap = space.slice(0, 10);
+
+  return binding.stringify(value, replacerFunction, propertyList, gap,
+                           chunked);
+}
+
+
+exports.stringify = function(value, replacer, space) {
+  return stringify(value, replacer, space, false);
+};
+
+exports.stringifyChunks = function(value, replacer, space) {
+  return stringify(value, replacer, space, true);
+};
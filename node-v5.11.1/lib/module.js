@@ -3,6 +3,7 @@
 const NativeModule = require('native_module');
 const util = require('util');
 const internalModule = require('internal/module');
+const prefetch = require('internal/module_prefetch');
 const internalUtil = require('internal/util');
 const runInThisContext = require('vm').runInThisContext;
 const assert = require('assert').ok;
@@ -386,6 +387,12 @@ Module.prototype._compile = function(content, filename) {
 
   var compiledWrapper = runInThisContext(wrapper,
                                       { filename: filename, lineOffset: 0 });
+  return runWrapper(this, compiledWrapper, filename);
+};
+const defaultCompile = Module.prototype._compile;
+
+
+function runWrapper(module, compiledWrapper, filename) {
   if (global.v8debug) {
     if (!resolvedArgv) {
       // we enter the repl if we're not given a filename argument.
@@ -406,18 +413,27 @@ Module.prototype._compile = function(content, filename) {
     }
   }
   const dirname = path.dirname(filename);
-  const require = internalModule.makeRequireFunction.call(this);
-  const args = [this.exports, require, this, filename, dirname];
+  const require = internalModule.makeRequireFunction.call(module);
+  const args = [module.exports, require, module, filename, dirname];
   const depth = internalModule.requireDepth;
   if (depth === 0) stat.cache = new Map();
-  const result = compiledWrapper.apply(this.exports, args);
+  const result = compiledWrapper.apply(module.exports, args);
   if (depth === 0) stat.cache = null;
   return result;
-};
+}
 
 
 // Native extension for .js
 Module._extensions['.js'] = function(module, filename) {
+  // Prefetched modules were wrapped and compiled the way the default
+  // _compile() and wrap() do it, don't use them if either was replaced.
+  const compiledWrapper = prefetch.take(filename);
+  if (compiledWrapper !== undefined &&
+      module._compile === defaultCompile &&
+      Module.wrap === NativeModule.wrap) {
+    runWrapper(module, compiledWrapper, filename);
+    return;
+  }
   var content = fs.readFileSync(filename, 'utf8');
   module._compile(internalModule.stripBOM(content), filename);
 };
@@ -443,8 +459,11 @@ Module._extensions['.node'] = function(module, filename) {
 
 // bootstrap main module.
 Module.runMain = function() {
+  if (process._prefetch_modules_manifest)
+    prefetch.start(process._prefetch_modules_manifest, Module.wrapper);
   // Load the main module--the command line argument.
   Module._load(process.argv[1], null, true);
+  prefetch.finish();
   // Handle any nextTicks added in the first tick of the program
   process._tickCallback();
 };
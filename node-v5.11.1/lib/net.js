@@ -18,6 +18,7 @@ const TCPConnectWrap = process.binding('tcp_wrap').TCPConnectWrap;
 const PipeConnectWrap = process.binding('pipe_wrap').PipeConnectWrap;
 const ShutdownWrap = process.binding('stream_wrap').ShutdownWrap;
 const WriteWrap = process.binding('stream_wrap').WriteWrap;
+const StreamPipe = process.binding('stream_pipe').StreamPipe;
 
 
 var cluster;
@@ -159,6 +160,7 @@ function Socket(options) {
 
   this._pendingData = null;
   this._pendingEncoding = '';
+  this._autoCork = false;
 
   // handle strings directly
   this._writableState.decodeStrings = false;
@@ -361,6 +363,41 @@ Socket.prototype.setKeepAlive = function(setting, msecs) {
 };
 
 
+Socket.prototype.setAutoCork = function(enable, budget) {
+  enable = enable === undefined ? true : !!enable;
+  budget = budget === undefined ? 100 : +budget;
+  if (enable && !(budget >= 0))
+    throw new TypeError('budget must be a non-negative number');
+
+  if (!this._handle) {
+    this.once('connect', () => this.setAutoCork(enable, budget));
+    return this;
+  }
+
+  if (this._handle.setAutoCork &&
+      this._handle.setAutoCork(enable, budget) === 0) {
+    this._autoCork = enable;
+  }
+
+  return this;
+};
+
+
+Socket.prototype.uncork = function() {
+  stream.Duplex.prototype.uncork.call(this);
+  // The end of a message, let the kernel send what it has been holding back.
+  if (this._autoCork && this._handle && this._writableState.corked === 0)
+    this._handle.flushCork();
+};
+
+
+Socket.prototype.getWriteStats = function() {
+  if (!this._handle || !this._handle.getWriteStats)
+    return null;
+  return this._handle.getWriteStats();
+};
+
+
 Socket.prototype.address = function() {
   return this._getsockname();
 };
@@ -479,6 +516,9 @@ Socket.prototype._destroy = function(exception, cb) {
     // `bytesRead` should be accessible after `.destroy()`
     this[BYTES_READ] = this._handle.bytesRead;
 
+    if (this._nativePipe)
+      unpipeNatively(this._nativePipe);
+
     this._handle.close(() => {
       debug('emit close');
       this.emit('close', isException);
@@ -511,6 +551,113 @@ Socket.prototype.destroy = function(exception) {
 };
 
 
+// With `options.native`, the data is moved from one socket to the other in
+// C++ land, without waking up JS for every chunk.  Anything the JS pipe would
+// have to take care of (buffered data, other consumers, an encoding) makes us
+// fall back to it.
+Socket.prototype.pipe = function(dest, options) {
+  if (options && options.native && canPipeNatively(this, dest) &&
+      pipeNatively(this, dest, options)) {
+    return dest;
+  }
+  return stream.Duplex.prototype.pipe.call(this, dest, options);
+};
+
+
+function isNativeHandle(handle) {
+  return (handle instanceof TCP || handle instanceof Pipe) &&
+         handle._externalStream !== undefined;
+}
+
+
+function canPipeNatively(src, dest) {
+  if (!(dest instanceof Socket))
+    return false;
+  if (!src._handle || !dest._handle || src._connecting || dest._connecting)
+    return false;
+  if (!isNativeHandle(src._handle) || !isNativeHandle(dest._handle))
+    return false;
+  if (src._nativePipe || dest._nativePipe)
+    return false;
+
+  const rs = src._readableState;
+  if (rs.length !== 0 || rs.pipesCount !== 0 || rs.ended || rs.decoder ||
+      rs.objectMode || !src.readable) {
+    return false;
+  }
+  if (src.listenerCount('data') > 0 || src.listenerCount('datav') > 0)
+    return false;
+
+  const ws = dest._writableState;
+  return ws.length === 0 && !ws.corked && !ws.ending && dest.writable;
+}
+
+
+function pipeNatively(src, dest, options) {
+  const pipe = new StreamPipe(src._handle._externalStream,
+                              dest._handle._externalStream,
+                              dest._writableState.highWaterMark);
+  const err = pipe.start(src._handle instanceof TCP &&
+                         dest._handle instanceof TCP);
+  if (err) {
+    debug('native pipe failed to start', err);
+    return false;
+  }
+  debug('native pipe');
+
+  pipe.src = src;
+  pipe.dest = dest;
+  pipe.end = !options || options.end !== false;
+  pipe.oncomplete = onNativePipeComplete;
+  src._nativePipe = dest._nativePipe = pipe;
+
+  // The handle reads for the pipe now, keep _read() from starting it again.
+  src._handle.reading = true;
+  src.resume();
+  dest.emit('pipe', src);
+  return true;
+}
+
+
+function detachNativePipe(pipe) {
+  const src = pipe.src;
+  const dest = pipe.dest;
+  src._nativePipe = dest._nativePipe = null;
+  // The last _read() is still waiting for data that went into the pipe.
+  src._readableState.reading = false;
+  if (src._handle)
+    src._handle.reading = false;
+  dest.emit('unpipe', src);
+}
+
+
+function unpipeNatively(pipe) {
+  pipe.unpipe();
+  detachNativePipe(pipe);
+  pipe.src.pause();
+}
+
+
+function onNativePipeComplete(status, inSink) {
+  const src = this.src;
+  const dest = this.dest;
+  debug('native pipe complete', status, inSink);
+  detachNativePipe(this);
+
+  if (inSink) {
+    // Like the JS pipe, leave the source alone when the destination fails.
+    src.pause();
+    dest._destroy(errnoException(status, 'write'));
+    return;
+  }
+
+  if (this.end && status === 0)
+    src.once('end', () => dest.end());
+  if (src._handle)
+    src._handle.onread(status === 0 ? uv.UV_EOF : status);
+}
+
+
 // This function is called whenever the handle gets a
 // buffer, or when there's an error reading.
 function onread(nread, buffer) {
@@ -1128,6 +1275,10 @@ function Server(options, connectionListener) {
 
   this.allowHalfOpen = options.allowHalfOpen || false;
   this.pauseOnConnect = !!options.pauseOnConnect;
+  this.acceptBatch = options.acceptBatch >>> 0;
+  this.noDelay = !!options.noDelay;
+  this.keepAlive = !!options.keepAlive;
+  this.keepAliveInitialDelay = ~~options.keepAliveInitialDelay;
 }
 util.inherits(Server, EventEmitter);
 exports.Server = Server;
@@ -1238,8 +1389,18 @@ Server.prototype._listen2 = function(address, port, addressType, backlog, fd) {
   }
 
   this._handle.onconnection = onconnection;
+  this._handle.onconnections = onconnections;
   this._handle.owner = this;
 
+  // Accepted sockets are set up natively, without a trip to JS land each.
+  if (this._handle.setAcceptOptions &&
+      (this.acceptBatch > 1 || this.noDelay || this.keepAlive)) {
+    this._handle.setAcceptOptions(this.acceptBatch,
+                                  this.noDelay,
+                                  this.keepAlive,
+                                  ~~(this.keepAliveInitialDelay / 1000));
+  }
+
   var err = _listen(this._handle, backlog);
 
   if (err) {
@@ -1428,6 +1589,30 @@ function onconnection(err, clientHandle) {
     return;
   }
 
+  // Handles that were not accepted by this process, like the ones that the
+  // cluster master hands out, did not get the socket options yet.
+  if (!handle.setAcceptOptions && clientHandle.setNoDelay) {
+    if (self.noDelay)
+      clientHandle.setNoDelay(true);
+    if (self.keepAlive)
+      clientHandle.setKeepAlive(true, ~~(self.keepAliveInitialDelay / 1000));
+  }
+
+  acceptConnection(self, clientHandle);
+}
+
+
+function onconnections(clientHandles) {
+  var self = this.owner;
+
+  debug('onconnections', clientHandles.length);
+
+  for (var i = 0; i < clientHandles.length; i++)
+    acceptConnection(self, clientHandles[i]);
+}
+
+
+function acceptConnection(self, clientHandle) {
   if (self.maxConnections && self._connections >= self.maxConnections) {
     clientHandle.close();
     return;
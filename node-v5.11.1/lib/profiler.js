@@ -0,0 +1,370 @@
+'use strict';
+
+const Buffer = require('buffer').Buffer;
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const binding = process.binding('profiler');
+
+// Sampling interval when none is given, in microseconds.  At 100 samples per
+// second the profiler costs well under one percent of a busy process.
+const kDefaultInterval = 10000;
+
+var profiling = false;
+var startDate = 0;
+var startInterval = 0;
+
+
+function start(options) {
+  options = options || {};
+
+  var interval = kDefaultInterval;
+  if (options.interval !== undefined) {
+    interval = options.interval;
+    if (typeof interval !== 'number' || interval % 1 !== 0 ||
+        interval < 1 || interval > 0xffffffff) {
+      throw new TypeError('"interval" must be a positive integer');
+    }
+  }
+
+  if (profiling)
+    throw new Error('The profiler is already running');
+
+  profiling = true;
+  startDate = Date.now();
+  startInterval = interval;
+  // Lets V8 tell time spent waiting for I/O apart from time spent in C++.
+  process._startProfilerIdleNotifier();
+  binding.start(interval);
+}
+exports.start = start;
+
+
+function stop() {
+  if (!profiling)
+    throw new Error('The profiler is not running');
+
+  profiling = false;
+  process._stopProfilerIdleNotifier();
+  const raw = binding.stop();
+  return new Profile(raw, startDate, startInterval);
+}
+exports.stop = stop;
+
+
+exports.isProfiling = function isProfiling() {
+  return profiling;
+};
+
+
+// A frame is native when V8 has no script for it but it is not one of the
+// pseudo frames like "(program)" or "(garbage collector)" either.  These are
+// the C++ functions that JS calls into, e.g. the methods of the bindings.
+function isNative(name, url) {
+  return url === '' && name !== '' && name.charCodeAt(0) !== 40;  // '('
+}
+
+
+// The profile of one start()/stop() pair, as the call tree V8 built while
+// sampling: nodes[0] is the root and every other node has the index of its
+// caller in `parent`.  A node's hitCount is the number of samples in which
+// it was on top of the stack.
+function Profile(raw, date, interval) {
+  this.startTime = date;
+  this.duration = (raw.endTime - raw.startTime) / 1000;
+  this.interval = interval;
+  this.samples = 0;
+  this.nodes = new Array(raw.names.length);
+  for (var i = 0; i < raw.names.length; i++) {
+    const name = raw.names[i];
+    const url = raw.urls[i];
+    this.nodes[i] = {
+      name: name || '(anonymous)',
+      url: url,
+      line: raw.lines[i],
+      column: raw.columns[i],
+      parent: raw.parents[i],
+      hitCount: raw.hitCounts[i],
+      native: isNative(name, url)
+    };
+    this.samples += raw.hitCounts[i];
+  }
+}
+exports.Profile = Profile;
+
+
+// Calls fn(stack, hitCount) for every node that has samples, with the stack
+// as an array of node indices from the caller-most frame down to the node.
+// The root is left out.
+Profile.prototype._forEachStack = function(fn) {
+  const nodes = this.nodes;
+  const stacks = new Array(nodes.length);
+  stacks[0] = [];
+  // Parents always come before their children.
+  for (var i = 1; i < nodes.length; i++) {
+    stacks[i] = stacks[nodes[i].parent].concat(i);
+    if (nodes[i].hitCount > 0)
+      fn(stacks[i], nodes[i].hitCount);
+  }
+};
+
+
+function frameLabel(node) {
+  var label;
+  if (node.native)
+    label = node.name + ' [native]';
+  else if (node.url)
+    label = node.name + ' (' + node.url + ':' + node.line + ')';
+  else
+    label = node.name;
+  return label.replace(/[;\n]/g, '_');
+}
+
+
+// One line per distinct stack, "frame;frame;frame count", which is what
+// flamegraph.pl and most other flame graph tools take as input.
+Profile.prototype.toCollapsed = function() {
+  const nodes = this.nodes;
+  var out = '';
+  this._forEachStack(function(stack, hitCount) {
+    const labels = stack.map(function(index) {
+      return frameLabel(nodes[index]);
+    });
+    out += labels.join(';') + ' ' + hitCount + '\n';
+  });
+  return out;
+};
+
+
+// Encodes the profile in the protocol buffer format that pprof reads, see
+// https://github.com/google/pprof/blob/master/proto/profile.proto.  Every
+// sample has two values: the number of samples and the CPU time they stand
+// for, in nanoseconds.  The result is not compressed.
+Profile.prototype.toPprof = function() {
+  const nodes = this.nodes;
+  const periodNanos = this.interval * 1000;
+  const strings = new Map([['', 0]]);
+  const functionIds = new Map();
+  const functions = [];
+  const locationIds = new Array(nodes.length);
+
+  function intern(s) {
+    var id = strings.get(s);
+    if (id === undefined) {
+      id = strings.size;
+      strings.set(s, id);
+    }
+    return id;
+  }
+
+  // Location i + 1 belongs to function i + 1; a location only carries the
+  // line a function starts at because V8 does not record more than that.
+  function locationId(index) {
+    if (locationIds[index] !== undefined)
+      return locationIds[index];
+    const node = nodes[index];
+    const key = node.name + '\0' + node.url + '\0' + node.line + '\0' +
+                node.column;
+    var id = functionIds.get(key);
+    if (id === undefined) {
+      id = functions.length + 1;
+      functionIds.set(key, id);
+      functions.push(node);
+    }
+    locationIds[index] = id;
+    return id;
+  }
+
+  const profile = new ProtoWriter();
+  const periodType = new ProtoWriter();
+  periodType.int64(1, intern('cpu'));
+  periodType.int64(2, intern('nanoseconds'));
+
+  const samplesType = new ProtoWriter();
+  samplesType.int64(1, intern('samples'));
+  samplesType.int64(2, intern('count'));
+  profile.message(1, samplesType);
+  profile.message(1, periodType);
+
+  this._forEachStack(function(stack, hitCount) {
+    const ids = new Array(stack.length);
+    // pprof lists the locations leaf first.
+    for (var i = 0; i < stack.length; i++)
+      ids[i] = locationId(stack[stack.length - 1 - i]);
+    const sample = new ProtoWriter();
+    sample.packed(1, ids);
+    sample.packed(2, [hitCount, hitCount * periodNanos]);
+    profile.message(2, sample);
+  });
+
+  functions.forEach(function(node, index) {
+    const id = index + 1;
+    const line = new ProtoWriter();
+    line.int64(1, id);
+    line.int64(2, Math.max(node.line, 0));
+    const location = new ProtoWriter();
+    location.int64(1, id);
+    location.message(4, line);
+    profile.message(4, location);
+  });
+
+  functions.forEach(function(node, index) {
+    const fn = new ProtoWriter();
+    fn.int64(1, index + 1);
+    fn.int64(2, intern(node.name));
+    fn.int64(3, intern(node.name));
+    fn.int64(4, intern(node.native ? '[native]' : node.url));
+    fn.int64(5, Math.max(node.line, 0));
+    profile.message(5, fn);
+  });
+
+  strings.forEach(function(id, s) {
+    profile.string(6, s);
+  });
+
+  profile.int64(9, this.startTime * 1e6);
+  profile.int64(10, Math.round(this.duration * 1e6));
+  profile.message(11, periodType);
+  profile.int64(12, periodNanos);
+
+  return profile.finish();
+};
+
+
+// Just enough of a protocol buffer encoder for the pprof format: varints,
+// strings and nested messages.  Numbers may be up to 2^53.
+function ProtoWriter() {
+  this.chunks = [];
+  this.bytes = [];
+  this.length = 0;
+}
+
+ProtoWriter.prototype.varint = function(value) {
+  while (value >= 128) {
+    this.bytes.push(value % 128 + 128);
+    value = Math.floor(value / 128);
+  }
+  this.bytes.push(value);
+};
+
+ProtoWriter.prototype.flushBytes = function() {
+  if (this.bytes.length > 0) {
+    this.chunks.push(Buffer.from(this.bytes));
+    this.length += this.bytes.length;
+    this.bytes = [];
+  }
+};
+
+ProtoWriter.prototype.buffer = function(buf) {
+  this.varint(buf.length);
+  this.flushBytes();
+  this.chunks.push(buf);
+  this.length += buf.length;
+};
+
+// Zero is the default value and is left out, like protoc does.
+ProtoWriter.prototype.int64 = function(field, value) {
+  if (value === 0)
+    return;
+  this.varint(field * 8);
+  this.varint(value);
+};
+
+ProtoWriter.prototype.string = function(field, value) {
+  this.varint(field * 8 + 2);
+  this.buffer(Buffer.from(value, 'utf8'));
+};
+
+ProtoWriter.prototype.packed = function(field, values) {
+  const writer = new ProtoWriter();
+  for (var i = 0; i < values.length; i++)
+    writer.varint(values[i]);
+  this.message(field, writer);
+};
+
+ProtoWriter.prototype.message = function(field, writer) {
+  this.varint(field * 8 + 2);
+  this.buffer(writer.finish());
+};
+
+ProtoWriter.prototype.finish = function() {
+  this.flushBytes();
+  return Buffer.concat(this.chunks, this.length);
+};
+
+
+// Profiles the process for `duration` milliseconds whenever it receives
+// `signal`, and writes the profile to a file in `directory`.  Calls
+// cb(err, filename) when a profile is written.  Returns a function that stops
+// watching for the signal.
+function watchSignal(options, cb) {
+  if (typeof options === 'function') {
+    cb = options;
+    options = {};
+  }
+  options = options || {};
+
+  const signal = options.signal || 'SIGUSR2';
+  const duration = options.duration === undefined ? 10000 : options.duration;
+  const interval = options.interval;
+  const format = options.format || 'pprof';
+  const directory = options.directory || process.cwd();
+
+  if (typeof duration !== 'number' || !(duration > 0))
+    throw new TypeError('"duration" must be a positive number');
+  if (format !== 'pprof' && format !== 'collapsed')
+    throw new TypeError('"format" must be "pprof" or "collapsed"');
+  if (cb !== undefined && typeof cb !== 'function')
+    throw new TypeError('"callback" must be a function');
+
+  var timer = null;
+
+  function done(err, filename) {
+    if (cb)
+      cb(err, filename);
+    else if (err)
+      console.error('profiler: %s', err.message);
+  }
+
+  function finish() {
+    clearTimeout(timer);
+    timer = null;
+    const profile = stop();
+    const filename = path.join(directory, 'profile-' + process.pid + '-' +
+                               profile.startTime +
+                               (format === 'pprof' ? '.pb.gz' : '.txt'));
+    if (format === 'collapsed') {
+      fs.writeFile(filename, profile.toCollapsed(), function(err) {
+        done(err, filename);
+      });
+      return;
+    }
+    zlib.gzip(profile.toPprof(), function(err, data) {
+      if (err)
+        return done(err);
+      fs.writeFile(filename, data, function(err) {
+        done(err, filename);
+      });
+    });
+  }
+
+  // A second signal while the profiler runs ends the profile early.
+  function onSignal() {
+    if (timer !== null)
+      return finish();
+    if (profiling)
+      return done(new Error('The profiler is already running'));
+    start({ interval: interval });
+    timer = setTimeout(finish, duration);
+    timer.unref();
+  }
+
+  process.on(signal, onSignal);
+
+  return function unwatch() {
+    process.removeListener(signal, onSignal);
+    if (timer !== null)
+      finish();
+  };
+}
+exports.watchSignal = watchSignal;
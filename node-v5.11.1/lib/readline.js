@@ -14,6 +14,8 @@ const internalUtil = require('internal/util');
 const inherits = util.inherits;
 const Buffer = require('buffer').Buffer;
 const EventEmitter = require('events');
+const Transform = require('_stream_transform');
+const splitLines = process.binding('buffer').splitLines;
 
 
 exports.createInterface = function(input, output, completer, terminal) {
@@ -88,10 +90,9 @@ function Interface(input, output, completer, terminal) {
   }
 
   function onend() {
-    if (typeof self._line_buffer === 'string' &&
-        self._line_buffer.length > 0) {
-      self.emit('line', self._line_buffer);
-    }
+    var line = self._lineScanner.end();
+    if (line !== null)
+      self.emit('line', line);
     self.close();
   }
 
@@ -117,8 +118,7 @@ function Interface(input, output, completer, terminal) {
       input.removeListener('data', ondata);
       input.removeListener('end', onend);
     });
-    var StringDecoder = require('string_decoder').StringDecoder; // lazy load
-    this._decoder = new StringDecoder('utf8');
+    this._lineScanner = new LineScanner('utf8');
 
   } else {
 
@@ -310,40 +310,16 @@ Interface.prototype.write = function(d, key) {
   this.terminal ? this._ttyWrite(d, key) : this._normalWrite(d);
 };
 
-// \r\n, \n, or \r followed by something other than \n
-const lineEnding = /\r?\n|\r(?!\n)/;
 Interface.prototype._normalWrite = function(b) {
   if (b === undefined) {
     return;
   }
-  var string = this._decoder.write(b);
-  if (this._sawReturn) {
-    string = string.replace(/^\n/, '');
-    this._sawReturn = false;
-  }
-
-  // Run test() on the new string chunk, not on the entire line buffer.
-  var newPartContainsEnding = lineEnding.test(string);
+  if (typeof b === 'string')
+    b = new Buffer(b, 'utf8');
 
-  if (this._line_buffer) {
-    string = this._line_buffer + string;
-    this._line_buffer = null;
-  }
-  if (newPartContainsEnding) {
-    this._sawReturn = string.endsWith('\r');
-
-    // got one or more newlines; process into "line" events
-    var lines = string.split(lineEnding);
-    // either '' or (concievably) the unfinished portion of the next line
-    string = lines.pop();
-    this._line_buffer = string;
-    lines.forEach(function(line) {
-      this._onLine(line);
-    }, this);
-  } else if (string) {
-    // no newlines this time, save what we have for next time
-    this._line_buffer = string;
-  }
+  var lines = this._lineScanner.write(b);
+  for (var i = 0; i < lines.length; i++)
+    this._onLine(lines[i]);
 };
 
 Interface.prototype._insertString = function(c) {
@@ -895,6 +871,122 @@ Interface.prototype._ttyWrite = function(s, key) {
 exports.Interface = Interface;
 
 
+// Offsets of the lines found by splitLines(), two for each line.
+const lineOffsets = new Uint32Array(2 * 1024);
+
+// Splits Buffers into lines that end in \n, \r\n or \r.  The terminators
+// are looked for in C++ before anything is decoded, which works for the
+// encodings in which those bytes can't be part of another character.  The
+// start of a line that isn't finished at the end of a chunk is kept as a
+// list of slices until its end shows up.
+function LineScanner(encoding) {
+  this.encoding = encoding;
+  this.partial = [];
+  this.partialLength = 0;
+  this.sawReturn = false;
+}
+
+// Returns the lines that end in |chunk|.
+LineScanner.prototype.write = function(chunk) {
+  var lines = [];
+  if (chunk.length === 0)
+    return lines;
+
+  var start = 0;
+  // A \r at the end of the last chunk has already ended a line.
+  if (this.sawReturn && chunk[0] === 10)
+    start = 1;
+
+  var count;
+  do {
+    count = splitLines(chunk, start, lineOffsets);
+    for (var i = 0; i < count; i++) {
+      lines.push(this._line(chunk, start, lineOffsets[i * 2]));
+      start = lineOffsets[i * 2 + 1];
+    }
+  } while (count === lineOffsets.length / 2);
+
+  if (start < chunk.length) {
+    this.partial.push(chunk.slice(start));
+    this.partialLength += chunk.length - start;
+    this.sawReturn = false;
+  } else {
+    this.sawReturn = chunk[chunk.length - 1] === 13;
+  }
+  return lines;
+};
+
+LineScanner.prototype._line = function(chunk, start, end) {
+  if (this.partialLength === 0) {
+    return this.encoding === null ? chunk.slice(start, end) :
+                                    chunk.toString(this.encoding, start, end);
+  }
+
+  this.partial.push(chunk.slice(start, end));
+  var line = Buffer.concat(this.partial, this.partialLength + end - start);
+  this.partial = [];
+  this.partialLength = 0;
+  return this.encoding === null ? line : line.toString(this.encoding);
+};
+
+// Returns what is left of the last line, or null if it ended with a
+// terminator.
+LineScanner.prototype.end = function() {
+  this.sawReturn = false;
+  if (this.partialLength === 0)
+    return null;
+  var line = Buffer.concat(this.partial, this.partialLength);
+  this.partial = [];
+  this.partialLength = 0;
+  return this.encoding === null ? line : line.toString(this.encoding);
+};
+
+
+const lineEncodings = ['utf8', 'utf-8', 'ascii', 'binary'];
+
+/**
+ * A Transform stream that takes Buffers and emits one line at a time,
+ * as a string or, if `options.encoding` is null, as a Buffer slice.
+ */
+function LineSplitter(options) {
+  if (!(this instanceof LineSplitter))
+    return new LineSplitter(options);
+
+  options = options || {};
+  var encoding = options.encoding === undefined ? 'utf8' : options.encoding;
+  if (encoding !== null) {
+    if (typeof encoding !== 'string' ||
+        lineEncodings.indexOf(encoding.toLowerCase()) === -1) {
+      throw new TypeError('Unsupported encoding: ' + encoding);
+    }
+    encoding = encoding.toLowerCase();
+  }
+
+  Transform.call(this, {
+    readableObjectMode: true,
+    batch: options.batch
+  });
+  this._lineScanner = new LineScanner(encoding);
+}
+inherits(LineSplitter, Transform);
+
+LineSplitter.prototype._transform = function(chunk, encoding, cb) {
+  var lines = this._lineScanner.write(chunk);
+  for (var i = 0; i < lines.length; i++)
+    this.push(lines[i]);
+  cb();
+};
+
+LineSplitter.prototype._flush = function(cb) {
+  var line = this._lineScanner.end();
+  if (line !== null)
+    this.push(line);
+  cb();
+};
+
+exports.LineSplitter = LineSplitter;
+
+
 /**
  * accepts a readable Stream instance and makes it emit "keypress" events
  */
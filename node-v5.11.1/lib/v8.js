@@ -38,6 +38,35 @@ const kSpaceUsedSizeIndex = v8binding.kSpaceUsedSizeIndex;
 const kSpaceAvailableSizeIndex = v8binding.kSpaceAvailableSizeIndex;
 const kPhysicalSpaceSizeIndex = v8binding.kPhysicalSpaceSizeIndex;
 
+// Properties for idle time garbage collection statistics extraction.
+const gcIdleStatisticsBuffer =
+    new Float64Array(v8binding.gcIdleStatisticsArrayBuffer);
+const kGCIdleNotificationsIndex = v8binding.kGCIdleNotificationsIndex;
+const kGCIdleSkippedIndex = v8binding.kGCIdleSkippedIndex;
+const kGCIdleCompletedIndex = v8binding.kGCIdleCompletedIndex;
+const kGCIdleBudgetIndex = v8binding.kGCIdleBudgetIndex;
+const kGCIdleUsedIndex = v8binding.kGCIdleUsedIndex;
+
+// Properties for platform statistics extraction.
+const kPlatformTaskTypes = v8binding.kPlatformTaskTypes;
+const kPlatformStatisticsPropertiesCount =
+    v8binding.kPlatformStatisticsPropertiesCount;
+const kPlatformTaskStatisticsPropertiesCount =
+    v8binding.kPlatformTaskStatisticsPropertiesCount;
+const platformStatisticsBuffer =
+    new Float64Array(kPlatformStatisticsPropertiesCount +
+                     kPlatformTaskTypes.length *
+                         kPlatformTaskStatisticsPropertiesCount);
+const kPlatformThreadPoolSizeIndex = v8binding.kPlatformThreadPoolSizeIndex;
+const kPlatformThreadsIndex = v8binding.kPlatformThreadsIndex;
+const kPlatformBusyThreadsIndex = v8binding.kPlatformBusyThreadsIndex;
+const kTaskPostedIndex = v8binding.kTaskPostedIndex;
+const kTaskQueuedIndex = v8binding.kTaskQueuedIndex;
+const kTaskCompletedIndex = v8binding.kTaskCompletedIndex;
+const kTaskWaitTimeIndex = v8binding.kTaskWaitTimeIndex;
+const kTaskMaxWaitTimeIndex = v8binding.kTaskMaxWaitTimeIndex;
+const kTaskCPUTimeIndex = v8binding.kTaskCPUTimeIndex;
+
 exports.getHeapStatistics = function() {
   const buffer = heapStatisticsBuffer;
 
@@ -73,3 +102,41 @@ exports.getHeapSpaceStatistics = function() {
 
   return heapSpaceStatistics;
 };
+
+exports.getGCIdleStatistics = function() {
+  const buffer = gcIdleStatisticsBuffer;
+
+  return {
+    'notifications': buffer[kGCIdleNotificationsIndex],
+    'skipped': buffer[kGCIdleSkippedIndex],
+    'completed': buffer[kGCIdleCompletedIndex],
+    'idle_budget_ms': buffer[kGCIdleBudgetIndex],
+    'idle_time_used_ms': buffer[kGCIdleUsedIndex]
+  };
+};
+
+exports.getPlatformStatistics = function() {
+  const buffer = platformStatisticsBuffer;
+  v8binding.updatePlatformStatistics(buffer);
+
+  const tasks = {};
+  for (let i = 0; i < kPlatformTaskTypes.length; i++) {
+    const offset = kPlatformStatisticsPropertiesCount +
+                   i * kPlatformTaskStatisticsPropertiesCount;
+    tasks[kPlatformTaskTypes[i]] = {
+      posted: buffer[offset + kTaskPostedIndex],
+      queued: buffer[offset + kTaskQueuedIndex],
+      completed: buffer[offset + kTaskCompletedIndex],
+      wait_time_ms: buffer[offset + kTaskWaitTimeIndex] / 1e6,
+      max_wait_time_ms: buffer[offset + kTaskMaxWaitTimeIndex] / 1e6,
+      cpu_time_ms: buffer[offset + kTaskCPUTimeIndex] / 1e6
+    };
+  }
+
+  return {
+    'thread_pool_size': buffer[kPlatformThreadPoolSizeIndex],
+    'threads': buffer[kPlatformThreadsIndex],
+    'busy_threads': buffer[kPlatformBusyThreadsIndex],
+    'tasks': tasks
+  };
+};
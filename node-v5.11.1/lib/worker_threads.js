@@ -0,0 +1,13 @@
+'use strict';
+
+const worker = require('internal/worker');
+
+module.exports = {
+  Worker: worker.Worker,
+  isMainThread: worker.isMainThread,
+  parentPort: worker.parentPort,
+  threadId: worker.threadId,
+  workerData: worker.workerData,
+  waitAsync: worker.waitAsync,
+  notify: worker.notify
+};
@@ -26,6 +26,13 @@ binding.Z_MIN_MEMLEVEL = 1;
 binding.Z_MAX_MEMLEVEL = 9;
 binding.Z_DEFAULT_MEMLEVEL = 8;
 
+// Chained streams size their output from the compression ratio seen so far,
+// these are the guesses before the first write.  They never allocate output
+// buffers larger than kMaxChainBuffer, the binding allocates more past that.
+const kChainDeflateRatio = 1;
+const kChainInflateRatio = 4;
+const kMaxChainBuffer = 64 * 1024 * 1024;
+
 binding.Z_MIN_LEVEL = -1;
 binding.Z_MAX_LEVEL = 9;
 binding.Z_DEFAULT_LEVEL = binding.Z_DEFAULT_COMPRESSION;
@@ -191,6 +198,7 @@ function zlibBuffer(engine, buffer, callback) {
   var buffers = [];
   var nread = 0;
 
+  engine._chained = true;
   engine.on('error', onError);
   engine.on('end', onEnd);
 
@@ -236,7 +244,7 @@ function zlibBufferSync(engine, buffer) {
 
   var flushFlag = engine._finishFlushFlag;
 
-  return engine._processChunk(buffer, flushFlag);
+  return engine._processChain([buffer], flushFlag, flushFlag);
 }
 
 // generic zlib
@@ -391,6 +399,14 @@ function Zlib(opts, mode) {
   this._level = level;
   this._strategy = strategy;
 
+  this._chained = !!opts.chained;
+  this._chainRatio = mode === binding.DEFLATE ||
+                     mode === binding.GZIP ||
+                     mode === binding.DEFLATERAW ?
+      kChainDeflateRatio : kChainInflateRatio;
+  if (this._chained)
+    this._writev = writevChained;
+
   this.once('end', this.close);
 }
 
@@ -480,14 +496,36 @@ function emitCloseNT(self) {
   self.emit('close');
 }
 
+// The _writev() of chained streams, everything that was written while zlib
+// was busy goes through in a single writeChain() call.
+function writevChained(chunks, cb) {
+  var buffers = new Array(chunks.length);
+  for (var i = 0; i < chunks.length; i++)
+    buffers[i] = chunks[i].chunk;
+  this._write(buffers, '', cb);
+}
+
 Zlib.prototype._transform = function(chunk, encoding, cb) {
   var flushFlag;
   var ws = this._writableState;
   var ending = ws.ending || ws.ended;
-  var last = ending && (!chunk || ws.length === chunk.length);
+  // An array of Buffers when it comes from writevChained().
+  var chunks = Array.isArray(chunk) ? chunk : null;
+  var length = 0;
+
+  if (chunks) {
+    for (var i = 0; i < chunks.length; i++) {
+      if (!(chunks[i] instanceof Buffer))
+        return cb(new Error('invalid input'));
+      length += chunks[i].length;
+    }
+  } else if (chunk !== null) {
+    if (!(chunk instanceof Buffer))
+      return cb(new Error('invalid input'));
+    length = chunk.length;
+  }
 
-  if (chunk !== null && !(chunk instanceof Buffer))
-    return cb(new Error('invalid input'));
+  var last = ending && (!chunk || ws.length === length);
 
   if (this._closed)
     return cb(new Error('zlib binding closed'));
@@ -497,18 +535,130 @@ Zlib.prototype._transform = function(chunk, encoding, cb) {
   // If it's explicitly flushing at some other time, then we use
   // Z_FULL_FLUSH. Otherwise, use Z_NO_FLUSH for maximum compression
   // goodness.
+  var chunkFlushFlag = this._flushFlag;
   if (last)
     flushFlag = this._finishFlushFlag;
   else {
     flushFlag = this._flushFlag;
     // once we've flushed the last of the queue, stop flushing and
     // go back to the normal behavior.
-    if (chunk.length >= ws.length) {
+    if (length >= ws.length) {
       this._flushFlag = this._opts.flush || binding.Z_NO_FLUSH;
     }
   }
 
-  this._processChunk(chunk, flushFlag, cb);
+  if (this._chained) {
+    if (!chunks)
+      chunks = [chunk || new Buffer(0)];
+    this._processChain(chunks, chunkFlushFlag, flushFlag, cb);
+  } else {
+    this._processChunk(chunk, flushFlag, cb);
+  }
+};
+
+// Like _processChunk(), but all of |chunks| go through zlib in a single
+// call, using |flushFlag| between chunks and |lastFlushFlag| after the last
+// one.  The output goes to one buffer sized from the compression ratio seen
+// so far, or to what's left of the current one if that's enough; if the
+// guess falls short, the binding allocates the rest of the output.
+Zlib.prototype._processChain = function(chunks, flushFlag, lastFlushFlag, cb) {
+  var inLength = 0;
+  for (var i = 0; i < chunks.length; i++)
+    inLength += chunks[i].length;
+
+  var estimate = Math.ceil(inLength * this._chainRatio);
+  var room = this._buffer.length - this._offset;
+  if (room === 0 || room < estimate) {
+    var size = Math.min(Math.max(estimate, this._chunkSize), kMaxChainBuffer);
+    this._buffer = new Buffer(size);
+    this._offset = 0;
+  }
+  var output = this._buffer.slice(this._offset);
+
+  var self = this;
+
+  var async = typeof cb === 'function';
+
+  if (!async) {
+    var buffers = [];
+    var nread = 0;
+
+    var error;
+    this.on('error', function(er) {
+      error = er;
+    });
+
+    assert(!this._closed, 'zlib binding closed');
+    var res = this._handle.writeChainSync(flushFlag,
+                                          lastFlushFlag,
+                                          chunks,
+                                          [output]);
+    if (this._hadError) {
+      throw error;
+    }
+
+    callback(res[0], res[1], res[2]);
+
+    if (nread >= kMaxLength) {
+      this.close();
+      throw new RangeError(kRangeErrorMessage);
+    }
+
+    // Hand out the output buffer itself when it isn't mostly empty.  The
+    // binding's buffers are trimmed to size.
+    var written = res[1];
+    var buf;
+    if (buffers.length === 1 && (written === 0 || written * 2 >= output.length))
+      buf = buffers[0];
+    else
+      buf = Buffer.concat(buffers, nread);
+    this.close();
+
+    return buf;
+  }
+
+  assert(!this._closed, 'zlib binding closed');
+  var req = this._handle.writeChain(flushFlag,
+                                    lastFlushFlag,
+                                    chunks,
+                                    [output]);
+
+  req.buffer = chunks;
+  req.output = output;
+  req.callback = callback;
+
+  function callback(availInAfter, written, overflow) {
+    if (self._hadError)
+      return;
+
+    var produced = written;
+    if (written > 0) {
+      self._offset += written;
+      serve(output.slice(0, written));
+    }
+    if (overflow !== undefined) {
+      for (var i = 0; i < overflow.length; i++) {
+        produced += overflow[i].length;
+        serve(overflow[i]);
+      }
+    }
+
+    var consumed = inLength - availInAfter;
+    if (consumed > 0)
+      self._chainRatio = produced / consumed;
+
+    if (async)
+      cb();
+  }
+
+  function serve(out) {
+    if (async) {
+      self.push(out);
+    } else {
+      buffers.push(out);
+      nread += out.length;
+    }
+  }
 };
 
 Zlib.prototype._processChunk = function(chunk, flushFlag, cb) {
@@ -15,6 +15,40 @@
     'node_enable_v8_vtunejit%': 'false',
     'node_target_type%': 'executable',
     'node_core_target_name%': 'node',
+    'node_use_code_cache%': 'false',
+    # Core modules whose code caches are built into the binary when
+    # configured with --with-code-cache.  These are the modules that are
+    # loaded by nearly every program during bootstrap.
+    'node_code_cache_modules': [
+      'internal/bootstrap_node',
+      'events',
+      'internal/process',
+      'internal/process/next_tick',
+      'internal/process/promises',
+      'internal/process/stdio',
+      'internal/util',
+      'internal/linkedlist',
+      'internal/module',
+      'internal/net',
+      'buffer',
+      'util',
+      'timers',
+      'path',
+      'module',
+      'vm',
+      'fs',
+      'assert',
+      'stream',
+      '_stream_readable',
+      '_stream_writable',
+      '_stream_duplex',
+      '_stream_transform',
+      '_stream_passthrough',
+      'string_decoder',
+      'console',
+      'tty',
+      'net',
+    ],
     'library_files': [
       'lib/internal/bootstrap_node.js',
       'lib/_debug_agent.js',
@@ -40,12 +74,14 @@
       'lib/_http_outgoing.js',
       'lib/_http_server.js',
       'lib/https.js',
+      'lib/json_stream.js',
       'lib/_linklist.js',
       'lib/module.js',
       'lib/net.js',
       'lib/os.js',
       'lib/path.js',
       'lib/process.js',
+      'lib/profiler.js',
       'lib/punycode.js',
       'lib/querystring.js',
       'lib/readline.js',
@@ -69,6 +105,7 @@
       'lib/util.js',
       'lib/v8.js',
       'lib/vm.js',
+      'lib/worker_threads.js',
       'lib/zlib.js',
       'lib/internal/child_process.js',
       'lib/internal/cluster.js',
@@ -76,6 +113,7 @@
       'lib/internal/linkedlist.js',
       'lib/internal/net.js',
       'lib/internal/module.js',
+      'lib/internal/module_prefetch.js',
       'lib/internal/process/next_tick.js',
       'lib/internal/process/promises.js',
       'lib/internal/process/stdio.js',
@@ -85,7 +123,9 @@
       'lib/internal/util.js',
       'lib/internal/v8_prof_polyfill.js',
       'lib/internal/v8_prof_processor.js',
+      'lib/internal/worker.js',
       'lib/internal/streams/lazy_transform.js',
+      'lib/internal/streams/buffer_list.js',
       'deps/v8/tools/splaytree.js',
       'deps/v8/tools/codemap.js',
       'deps/v8/tools/consarray.js',
@@ -128,19 +168,28 @@
         'src/handle_wrap.cc',
         'src/js_stream.cc',
         'src/node.cc',
+        'src/node_allocator.cc',
         'src/node_buffer.cc',
         'src/node_constants.cc',
         'src/node_contextify.cc',
         'src/node_file.cc',
         'src/node_http_parser.cc',
         'src/node_javascript.cc',
+        'src/node_json_parser.cc',
+        'src/node_json_stringifier.cc',
         'src/node_main.cc',
+        'src/node_module_prefetch.cc',
         'src/node_os.cc',
+        'src/node_platform.cc',
+        'src/node_profiler.cc',
         'src/node_revert.cc',
+        'src/node_code_cache.cc',
         'src/node_util.cc',
         'src/node_v8.cc',
         'src/node_stat_watcher.cc',
+        'src/node_string_decoder.cc',
         'src/node_watchdog.cc',
+        'src/node_worker.cc',
         'src/node_zlib.cc',
         'src/node_i18n.cc',
         'src/pipe_wrap.cc',
@@ -148,6 +197,7 @@
         'src/spawn_sync.cc',
         'src/string_bytes.cc',
         'src/stream_base.cc',
+        'src/stream_pipe.cc',
         'src/stream_wrap.cc',
         'src/tcp_wrap.cc',
         'src/timer_wrap.cc',
@@ -166,17 +216,21 @@
         'src/handle_wrap.h',
         'src/js_stream.h',
         'src/node.h',
+        'src/node_allocator.h',
         'src/node_buffer.h',
         'src/node_constants.h',
         'src/node_file.h',
         'src/node_http_parser.h',
         'src/node_internals.h',
         'src/node_javascript.h',
+        'src/node_platform.h',
         'src/node_root_certs.h',
         'src/node_version.h',
         'src/node_watchdog.h',
+        'src/node_worker.h',
         'src/node_wrap.h',
         'src/node_revert.h',
+        'src/node_code_cache.h',
         'src/node_i18n.h',
         'src/pipe_wrap.h',
         'src/tty_wrap.h',
@@ -187,6 +241,7 @@
         'src/string_bytes.h',
         'src/stream_base.h',
         'src/stream_base-inl.h',
+        'src/stream_pipe.h',
         'src/stream_wrap.h',
         'src/tree.h',
         'src/util.h',
@@ -219,6 +274,12 @@
         [ 'node_v8_options!=""', {
           'defines': [ 'NODE_V8_OPTIONS="<(node_v8_options)"'],
         }],
+        [ 'node_use_code_cache=="true"', {
+          'dependencies': [ 'node_code_cache' ],
+          'sources': [ '<(SHARED_INTERMEDIATE_DIR)/node_code_cache_data.cc' ],
+        }, {
+          'sources': [ 'src/node_code_cache_stub.cc' ],
+        }],
         # No node_main.cc for anything except executable
         [ 'node_target_type!="executable"', {
           'sources!': [
@@ -366,6 +427,22 @@
             'tools/msvs/genfiles/node_perfctr_provider.rc',
           ]
         } ],
+        [ 'node_use_perfctr=="false" and OS=="linux"', {
+          'defines': [ 'HAVE_SHM_COUNTERS=1' ],
+          'sources': [
+            'src/node_counters.cc',
+            'src/node_counters.h',
+            'src/node_shm_counters.cc',
+            'src/node_shm_counters.h',
+          ]
+        } ],
+        [ 'OS=="linux"', {
+          'defines': [ 'HAVE_PERF_JIT=1' ],
+          'sources': [
+            'src/node_perf_jit.cc',
+            'src/node_perf_jit.h',
+          ]
+        } ],
         [ 'node_no_browser_globals=="true"', {
           'defines': [ 'NODE_NO_BROWSER_GLOBALS' ],
         } ],
@@ -530,7 +607,7 @@
             ['node_use_lttng=="false"', {
               'inputs': [ 'src/nolttng_macros.py' ]
             }],
-            [ 'node_use_perfctr=="false"', {
+            [ 'node_use_perfctr=="false" and OS!="linux"', {
               'inputs': [ 'src/perfctr_macros.py' ]
             }]
           ],
@@ -543,6 +620,58 @@
         },
       ],
     }, # end node_js2c
+    {
+      'target_name': 'node_mkcodecache',
+      'type': 'executable',
+      'dependencies': [
+        'node_js2c#host',
+        'deps/v8/tools/gyp/v8.gyp:v8',
+        'deps/v8/tools/gyp/v8.gyp:v8_libplatform'
+      ],
+      'include_dirs': [
+        'src',
+        '<(SHARED_INTERMEDIATE_DIR)', # for node_natives.h
+        'deps/v8/include',
+        'deps/v8' # include/v8_platform.h
+      ],
+      'sources': [
+        'src/node_mkcodecache.cc',
+      ],
+      'conditions': [
+        # The caches are only used when V8 runs with the same flags.
+        [ 'node_v8_options!=""', {
+          'defines': [ 'NODE_V8_OPTIONS="<(node_v8_options)"'],
+        }],
+        [ 'v8_enable_i18n_support==1', {
+          'defines': [ 'NODE_HAVE_I18N_SUPPORT=1' ],
+          'dependencies': [
+            '<(icu_gyp_path):icui18n',
+            '<(icu_gyp_path):icuuc',
+          ],
+        }],
+      ],
+    }, # end node_mkcodecache
+    {
+      'target_name': 'node_code_cache',
+      'type': 'none',
+      'dependencies': [ 'node_mkcodecache' ],
+      'actions': [
+        {
+          'action_name': 'node_mkcodecache',
+          'inputs': [
+            '<(PRODUCT_DIR)/<(EXECUTABLE_PREFIX)node_mkcodecache<(EXECUTABLE_SUFFIX)',
+          ],
+          'outputs': [
+            '<(SHARED_INTERMEDIATE_DIR)/node_code_cache_data.cc',
+          ],
+          'action': [
+            '<@(_inputs)',
+            '<@(_outputs)',
+            '<@(node_code_cache_modules)',
+          ],
+        },
+      ],
+    }, # end node_code_cache
     {
       'target_name': 'node_dtrace_header',
       'type': 'none',
@@ -704,6 +833,59 @@
       'sources': [
         'test/cctest/util.cc',
       ],
+    },
+    {
+      'target_name': 'ccbench',
+      'type': 'executable',
+      'dependencies': [
+        'deps/cares/cares.gyp:cares',
+        'deps/v8/tools/gyp/v8.gyp:v8',
+        'deps/v8/tools/gyp/v8.gyp:v8_libplatform'
+      ],
+      'include_dirs': [
+        'src',
+        'deps/v8', # include/v8_platform.h
+        'deps/v8/include'
+      ],
+      'defines': [
+        'NODE_WANT_INTERNALS=1',
+      ],
+      'sources': [
+        'test/ccbench/bench.cc',
+        'test/ccbench/bench.h',
+        'test/ccbench/buffer.cc',
+        'test/ccbench/http_parser_bench.cc',
+        'test/ccbench/string_bytes_bench.cc',
+        'test/ccbench/string_search_bench.cc',
+        # The code under test, built into the benchmarks.
+        'src/string_bytes.cc',
+        'src/string_search.cc',
+      ],
+      'conditions': [
+        [ 'node_use_openssl=="true"', {
+          'defines': [ 'HAVE_OPENSSL=1' ],
+          'sources': [
+            'test/ccbench/node_bio_bench.cc',
+            'src/node_crypto_bio.cc',
+          ],
+          'conditions': [
+            [ 'node_shared_openssl=="false"', {
+              'dependencies': [ './deps/openssl/openssl.gyp:openssl' ],
+            }],
+          ],
+        }],
+        [ 'node_shared_http_parser=="false"', {
+          'dependencies': [ 'deps/http_parser/http_parser.gyp:http_parser' ],
+        }],
+        [ 'node_shared_libuv=="false"', {
+          'dependencies': [ 'deps/uv/uv.gyp:libuv' ],
+        }],
+        [ 'OS=="win"', {
+          'defines': [ 'FD_SETSIZE=1024' ],
+        }, {
+          'defines': [ '__POSIX__' ],
+        }],
+      ],
     }
   ], # end targets
 
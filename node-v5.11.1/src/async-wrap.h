@@ -12,6 +12,7 @@ namespace node {
 
 #define NODE_ASYNC_PROVIDER_TYPES(V)                                          \
   V(NONE)                                                                     \
+  V(ATOMICSWAITER)                                                            \
   V(CRYPTO)                                                                   \
   V(FSEVENTWRAP)                                                              \
   V(FSREQWRAP)                                                                \
@@ -26,6 +27,7 @@ namespace node {
   V(SHUTDOWNWRAP)                                                             \
   V(SIGNALWRAP)                                                               \
   V(STATWATCHER)                                                              \
+  V(STREAMPIPE)                                                               \
   V(TCPWRAP)                                                                  \
   V(TCPCONNECTWRAP)                                                           \
   V(TIMERWRAP)                                                                \
@@ -33,6 +35,7 @@ namespace node {
   V(TTYWRAP)                                                                  \
   V(UDPWRAP)                                                                  \
   V(UDPSENDWRAP)                                                              \
+  V(WORKER)                                                                   \
   V(WRITEWRAP)                                                                \
   V(ZLIB)
 
@@ -91,6 +91,7 @@ inline void Environment::AsyncHooks::set_enable_callbacks(uint32_t flag) {
 inline Environment::AsyncCallbackScope::AsyncCallbackScope(Environment* env)
     : env_(env) {
   env_->makecallback_cntr_++;
+  env_->gc_idle_info()->clear_heap_idle();
 }
 
 inline Environment::AsyncCallbackScope::~AsyncCallbackScope() {
@@ -163,6 +164,42 @@ inline void Environment::ArrayBufferAllocatorInfo::reset_fill_flag() {
   fields_[kNoZeroFill] = 0;
 }
 
+inline Environment::GCIdleInfo::GCIdleInfo() : heap_idle_(false) {
+  for (int i = 0; i < kFieldsCount; ++i)
+    fields_[i] = 0;
+}
+
+inline double* Environment::GCIdleInfo::fields() {
+  return fields_;
+}
+
+inline int Environment::GCIdleInfo::fields_count() const {
+  return kFieldsCount;
+}
+
+inline void Environment::GCIdleInfo::RecordSkipped() {
+  fields_[kSkipped] += 1;
+}
+
+inline void Environment::GCIdleInfo::RecordNotification(double budget_ms,
+                                                        double used_ms,
+                                                        bool completed) {
+  fields_[kNotifications] += 1;
+  fields_[kBudgetMs] += budget_ms;
+  fields_[kUsedMs] += used_ms;
+  if (completed)
+    fields_[kCompleted] += 1;
+  heap_idle_ = completed;
+}
+
+inline bool Environment::GCIdleInfo::heap_idle() const {
+  return heap_idle_;
+}
+
+inline void Environment::GCIdleInfo::clear_heap_idle() {
+  heap_idle_ = false;
+}
+
 inline Environment* Environment::New(v8::Local<v8::Context> context,
                                      uv_loop_t* loop) {
   Environment* env = new Environment(context, loop);
@@ -207,6 +244,7 @@ inline Environment::Environment(v8::Local<v8::Context> context,
       using_domains_(false),
       printed_error_(false),
       trace_sync_io_(false),
+      stack_limit_(0),
       makecallback_cntr_(0),
       async_wrap_uid_(0),
       debugger_agent_(this),
@@ -304,6 +342,15 @@ inline uv_check_t* Environment::idle_check_handle() {
   return &idle_check_handle_;
 }
 
+inline Environment* Environment::from_gc_idle_prepare_handle(
+    uv_prepare_t* handle) {
+  return ContainerOf(&Environment::gc_idle_prepare_handle_, handle);
+}
+
+inline uv_prepare_t* Environment::gc_idle_prepare_handle() {
+  return &gc_idle_prepare_handle_;
+}
+
 inline void Environment::RegisterHandleCleanup(uv_handle_t* handle,
                                                HandleCleanupCb cb,
                                                void *arg) {
@@ -335,6 +382,10 @@ inline Environment::ArrayBufferAllocatorInfo*
   return &array_buffer_allocator_info_;
 }
 
+inline Environment::GCIdleInfo* Environment::gc_idle_info() {
+  return &gc_idle_info_;
+}
+
 inline uint64_t Environment::timer_base() const {
   return timer_base_;
 }
@@ -355,6 +406,14 @@ inline void Environment::set_printed_error(bool value) {
   printed_error_ = value;
 }
 
+inline uintptr_t Environment::stack_limit() const {
+  return stack_limit_;
+}
+
+inline void Environment::set_stack_limit(uintptr_t value) {
+  stack_limit_ = value;
+}
+
 inline void Environment::set_trace_sync_io(bool value) {
   trace_sync_io_ = value;
 }
@@ -384,6 +443,15 @@ inline void Environment::set_heap_space_statistics_buffer(uint32_t* pointer) {
 }
 
 
+inline ArrayBufferAllocator* Environment::array_buffer_allocator() const {
+  return array_buffer_allocator_;
+}
+
+inline void Environment::set_array_buffer_allocator(
+    ArrayBufferAllocator* allocator) {
+  array_buffer_allocator_ = allocator;
+}
+
 inline char* Environment::http_parser_buffer() const {
   return http_parser_buffer_;
 }
@@ -393,6 +461,22 @@ inline void Environment::set_http_parser_buffer(char* buffer) {
   http_parser_buffer_ = buffer;
 }
 
+inline worker::Worker* Environment::worker_context() const {
+  return worker_context_;
+}
+
+inline void Environment::set_worker_context(worker::Worker* context) {
+  worker_context_ = context;
+}
+
+inline bool Environment::can_call_into_js() const {
+  return can_call_into_js_;
+}
+
+inline void Environment::set_can_call_into_js(bool value) {
+  can_call_into_js_ = value;
+}
+
 inline Environment* Environment::from_cares_timer_handle(uv_timer_t* handle) {
   return ContainerOf(&Environment::cares_timer_handle_, handle);
 }
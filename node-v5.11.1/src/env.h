@@ -22,6 +22,12 @@
 // and NODE_ISOLATE_SLOT, they may have been defined externally.
 namespace node {
 
+class ArrayBufferAllocator;
+
+namespace worker {
+class Worker;
+}  // namespace worker
+
 // Pick an index that's hopefully out of the way when we're embedded inside
 // another application. Performance-wise or memory-wise it doesn't matter:
 // Context::SetAlignedPointerInEmbedderData() is backed by a FixedArray,
@@ -149,6 +155,7 @@ namespace node {
   V(onclienthello_string, "onclienthello")                                    \
   V(oncomplete_string, "oncomplete")                                          \
   V(onconnection_string, "onconnection")                                      \
+  V(onconnections_string, "onconnections")                                    \
   V(ondone_string, "ondone")                                                  \
   V(onerror_string, "onerror")                                                \
   V(onexit_string, "onexit")                                                  \
@@ -165,6 +172,7 @@ namespace node {
   V(onshutdown_string, "onshutdown")                                          \
   V(onsignal_string, "onsignal")                                              \
   V(onstop_string, "onstop")                                                  \
+  V(onwake_string, "onwake")                                                  \
   V(onwrite_string, "onwrite")                                                \
   V(output_string, "output")                                                  \
   V(order_string, "order")                                                    \
@@ -224,6 +232,7 @@ namespace node {
   V(tls_sni_string, "tls_sni")                                                \
   V(tls_string, "tls")                                                        \
   V(tls_ticket_string, "tlsTicket")                                           \
+  V(to_json_string, "toJSON")                                                 \
   V(type_string, "type")                                                      \
   V(uid_string, "uid")                                                        \
   V(unknown_string, "<unknown>")                                              \
@@ -386,6 +395,39 @@ class Environment {
     DISALLOW_COPY_AND_ASSIGN(ArrayBufferAllocatorInfo);
   };
 
+  class GCIdleInfo {
+   public:
+    // Shared with lib/v8.js through a Float64Array, see node_v8.cc.
+    enum Fields {
+      kNotifications,
+      kSkipped,
+      kCompleted,
+      kBudgetMs,
+      kUsedMs,
+      kFieldsCount
+    };
+
+    inline double* fields();
+    inline int fields_count() const;
+    inline void RecordSkipped();
+    inline void RecordNotification(double budget_ms,
+                                   double used_ms,
+                                   bool completed);
+    // True from a notification after which V8 had nothing left to do until
+    // JS runs again.
+    inline bool heap_idle() const;
+    inline void clear_heap_idle();
+
+   private:
+    friend class Environment;  // So we can call the constructor.
+    inline GCIdleInfo();
+
+    double fields_[kFieldsCount];
+    bool heap_idle_;
+
+    DISALLOW_COPY_AND_ASSIGN(GCIdleInfo);
+  };
+
   typedef void (*HandleCleanupCb)(Environment* env,
                                   uv_handle_t* handle,
                                   void* arg);
@@ -439,6 +481,9 @@ class Environment {
   static inline Environment* from_idle_check_handle(uv_check_t* handle);
   inline uv_check_t* idle_check_handle();
 
+  static inline Environment* from_gc_idle_prepare_handle(uv_prepare_t* handle);
+  inline uv_prepare_t* gc_idle_prepare_handle();
+
   // Register clean-up cb to be called on env->Dispose()
   inline void RegisterHandleCleanup(uv_handle_t* handle,
                                     HandleCleanupCb cb,
@@ -449,6 +494,7 @@ class Environment {
   inline DomainFlag* domain_flag();
   inline TickInfo* tick_info();
   inline ArrayBufferAllocatorInfo* array_buffer_allocator_info();
+  inline GCIdleInfo* gc_idle_info();
   inline uint64_t timer_base() const;
 
   static inline Environment* from_cares_timer_handle(uv_timer_t* handle);
@@ -463,6 +509,11 @@ class Environment {
   inline bool printed_error() const;
   inline void set_printed_error(bool value);
 
+  // Where V8's stack guard sits for the thread of this environment.  Native
+  // code that recurses on the C++ stack stops there as well.
+  inline uintptr_t stack_limit() const;
+  inline void set_stack_limit(uintptr_t value);
+
   void PrintSyncTrace() const;
   inline void set_trace_sync_io(bool value);
 
@@ -474,9 +525,22 @@ class Environment {
   inline uint32_t* heap_space_statistics_buffer() const;
   inline void set_heap_space_statistics_buffer(uint32_t* pointer);
 
+  inline ArrayBufferAllocator* array_buffer_allocator() const;
+  inline void set_array_buffer_allocator(ArrayBufferAllocator* allocator);
+
   inline char* http_parser_buffer() const;
   inline void set_http_parser_buffer(char* buffer);
 
+  // The worker thread that runs this environment, nullptr for the main
+  // thread.
+  inline worker::Worker* worker_context() const;
+  inline void set_worker_context(worker::Worker* context);
+
+  // Cleared when a worker thread stops, from then on MakeCallback() no longer
+  // runs JS.
+  inline bool can_call_into_js() const;
+  inline void set_can_call_into_js(bool value);
+
   inline void ThrowError(const char* errmsg);
   inline void ThrowTypeError(const char* errmsg);
   inline void ThrowRangeError(const char* errmsg);
@@ -553,10 +617,12 @@ class Environment {
   uv_idle_t immediate_idle_handle_;
   uv_prepare_t idle_prepare_handle_;
   uv_check_t idle_check_handle_;
+  uv_prepare_t gc_idle_prepare_handle_;
   AsyncHooks async_hooks_;
   DomainFlag domain_flag_;
   TickInfo tick_info_;
   ArrayBufferAllocatorInfo array_buffer_allocator_info_;
+  GCIdleInfo gc_idle_info_;
   const uint64_t timer_base_;
   uv_timer_t cares_timer_handle_;
   ares_channel cares_channel_;
@@ -564,6 +630,7 @@ class Environment {
   bool using_domains_;
   bool printed_error_;
   bool trace_sync_io_;
+  uintptr_t stack_limit_;
   size_t makecallback_cntr_;
   int64_t async_wrap_uid_;
   debugger::Agent debugger_agent_;
@@ -577,8 +644,13 @@ class Environment {
   uint32_t* heap_statistics_buffer_ = nullptr;
   uint32_t* heap_space_statistics_buffer_ = nullptr;
 
+  ArrayBufferAllocator* array_buffer_allocator_ = nullptr;
+
   char* http_parser_buffer_;
 
+  worker::Worker* worker_context_ = nullptr;
+  bool can_call_into_js_ = true;
+
 #define V(PropertyName, TypeName)                                             \
   v8::Persistent<TypeName> PropertyName ## _;
   ENVIRONMENT_STRONG_PERSISTENT_PROPERTIES(V)
@@ -3,6 +3,7 @@
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
+#include "node_counters.h"
 #include "util.h"
 #include "util-inl.h"
 #include "node.h"
@@ -38,21 +39,26 @@ void HandleWrap::Unref(const FunctionCallbackInfo<Value>& args) {
 
 
 void HandleWrap::Close(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-
   HandleWrap* wrap = Unwrap<HandleWrap>(args.Holder());
 
-  // guard against uninitialized handle or double close
-  if (!IsAlive(wrap))
+  // guard against uninitialized handle
+  if (wrap != nullptr)
+    wrap->Close(args[0]);
+}
+
+
+void HandleWrap::Close(Local<Value> close_callback) {
+  // guard against double close
+  if (handle__ == nullptr)
     return;
 
-  CHECK_EQ(false, wrap->persistent().IsEmpty());
-  uv_close(wrap->handle__, OnClose);
-  wrap->handle__ = nullptr;
+  CHECK_EQ(false, persistent().IsEmpty());
+  uv_close(handle__, OnClose);
+  handle__ = nullptr;
 
-  if (args[0]->IsFunction()) {
-    wrap->object()->Set(env->onclose_string(), args[0]);
-    wrap->flags_ |= kCloseCallback;
+  if (!close_callback.IsEmpty() && close_callback->IsFunction()) {
+    object()->Set(env()->onclose_string(), close_callback);
+    flags_ |= kCloseCallback;
   }
 }
 
@@ -69,6 +75,7 @@ HandleWrap::HandleWrap(Environment* env,
   HandleScope scope(env->isolate());
   Wrap(object, this);
   env->handle_wrap_queue()->PushBack(this);
+  NODE_COUNT_HANDLE_OPEN(provider);
 }
 
 
@@ -98,6 +105,7 @@ void HandleWrap::OnClose(uv_handle_t* handle) {
 
   object->SetAlignedPointerInInternalField(0, nullptr);
   wrap->persistent().Reset();
+  NODE_COUNT_HANDLE_CLOSE(wrap->provider_type());
   delete wrap;
 }
 
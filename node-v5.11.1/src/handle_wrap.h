@@ -42,6 +42,11 @@ class HandleWrap : public AsyncWrap {
 
   inline uv_handle_t* GetHandle() const { return handle__; }
 
+  // Closes the handle unless it's closed already.  |close_callback| is called
+  // from JS land once it's closed if it's a function.
+  virtual void Close(
+      v8::Local<v8::Value> close_callback = v8::Local<v8::Value>());
+
  protected:
   HandleWrap(Environment* env,
              v8::Local<v8::Object> object,
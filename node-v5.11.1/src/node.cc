@@ -1,14 +1,18 @@
 #include "node.h"
+#include "node_allocator.h"
 #include "node_buffer.h"
 #include "node_constants.h"
 #include "node_file.h"
 #include "node_http_parser.h"
 #include "node_javascript.h"
+#include "node_platform.h"
 #include "node_version.h"
+#include "node_worker.h"
 #include "node_internals.h"
 #include "node_revert.h"
+#include "node_code_cache.h"
 
-#if defined HAVE_PERFCTR
+#if defined HAVE_PERFCTR || defined HAVE_SHM_COUNTERS
 #include "node_counters.h"
 #endif
 
@@ -28,6 +32,10 @@
 #include "node_lttng.h"
 #endif
 
+#if defined HAVE_PERF_JIT
+#include "node_perf_jit.h"
+#endif
+
 #include "ares.h"
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
@@ -39,7 +47,6 @@
 #include "string_bytes.h"
 #include "util.h"
 #include "uv.h"
-#include "libplatform/libplatform.h"
 #include "v8-debug.h"
 #include "v8-profiler.h"
 #include "zlib.h"
@@ -74,6 +81,7 @@
 #define umask _umask
 typedef int mode_t;
 #else
+#include <poll.h>
 #include <sys/resource.h>  // getrlimit, setrlimit
 #include <unistd.h>  // setuid, getuid
 #endif
@@ -124,6 +132,8 @@ using v8::ObjectTemplate;
 using v8::Promise;
 using v8::PromiseRejectMessage;
 using v8::PropertyCallbackInfo;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
 using v8::SealHandleScope;
 using v8::StackFrame;
 using v8::StackTrace;
@@ -150,7 +160,22 @@ static int debug_port = 5858;
 static const int v8_default_thread_pool_size = 4;
 static int v8_thread_pool_size = v8_default_thread_pool_size;
 static bool prof_process = false;
+static int gc_idle_time = 0;
+static bool use_pooled_array_buffer_allocator = false;
+static const char* prefetch_modules_manifest = nullptr;
+#if defined HAVE_PERF_JIT
+static bool perf_map = false;
+static const char* perf_jitdump_dir = nullptr;
+static size_t perf_max_size = 64 << 20;
+#endif
 static bool v8_is_profiling = false;
+// V8's --stack-size in KB, see V8_DEFAULT_STACK_SIZE_KB in
+// deps/v8/src/globals.h.  V8 doesn't export its flags.
+#if defined(__arm__) || defined(_M_ARM)
+static int v8_stack_size = 864;
+#else
+static int v8_stack_size = 984;
+#endif
 static bool node_is_initialized = false;
 static node_module* modpending;
 static node_module* modlist_builtin;
@@ -171,7 +196,7 @@ static bool debugger_running;
 static uv_async_t dispatch_debug_messages_async;
 
 static node::atomic<Isolate*> node_isolate;
-static v8::Platform* default_platform;
+static NodePlatform* default_platform;
 
 static void PrintErrorString(const char* format, ...) {
   va_list ap;
@@ -954,13 +979,24 @@ Local<Value> WinapiErrnoException(Isolate* isolate,
 #endif
 
 
-void* ArrayBufferAllocator::Allocate(size_t size) {
+bool ArrayBufferAllocator::ShouldZeroFill() {
   if (env_ == nullptr ||
       !env_->array_buffer_allocator_info()->no_zero_fill() ||
       zero_fill_all_buffers)
-    return calloc(size, 1);
+    return true;
   env_->array_buffer_allocator_info()->reset_fill_flag();
-  return malloc(size);
+  return false;
+}
+
+
+ArrayBufferAllocator* ArrayBufferAllocator::New() {
+  if (use_pooled_array_buffer_allocator) {
+    PooledArrayBufferAllocator* allocator = new PooledArrayBufferAllocator();
+    if (allocator->Init())
+      return allocator;
+    delete allocator;
+  }
+  return new ArrayBufferAllocator();
 }
 
 static bool DomainHasErrorHandler(const Environment* env,
@@ -1145,6 +1181,9 @@ Local<Value> MakeCallback(Environment* env,
   // If you hit this assertion, you forgot to enter the v8::Context first.
   CHECK_EQ(env->context(), env->isolate()->GetCurrentContext());
 
+  if (!env->can_call_into_js())
+    return Undefined(env->isolate());
+
   Local<Function> pre_fn = env->async_hooks_pre_function();
   Local<Function> post_fn = env->async_hooks_post_function();
   Local<Object> object, domain;
@@ -1619,9 +1658,12 @@ static void ReportException(Environment* env, const TryCatch& try_catch) {
 
 
 // Executes a str within the current v8 context.
-static Local<Value> ExecuteString(Environment* env,
-                                  Local<String> source,
-                                  Local<String> filename) {
+// Takes ownership of |cached_data|, see node_code_cache.h.
+static Local<Value> ExecuteString(
+    Environment* env,
+    Local<String> source,
+    Local<String> filename,
+    ScriptCompiler::CachedData* cached_data = nullptr) {
   EscapableHandleScope scope(env->isolate());
   TryCatch try_catch;
 
@@ -1629,8 +1671,14 @@ static Local<Value> ExecuteString(Environment* env,
   // we will handle exceptions ourself.
   try_catch.SetVerbose(false);
 
-  Local<v8::Script> script = v8::Script::Compile(source, filename);
-  if (script.IsEmpty()) {
+  ScriptOrigin origin(filename);
+  ScriptCompiler::Source script_source(source, origin, cached_data);
+  const ScriptCompiler::CompileOptions compile_options =
+      cached_data == nullptr ? ScriptCompiler::kNoCompileOptions :
+                               ScriptCompiler::kConsumeCodeCache;
+  Local<v8::Script> script;
+  if (!ScriptCompiler::Compile(env->context(), &script_source, compile_options)
+           .ToLocal(&script)) {
     ReportException(env, try_catch);
     exit(3);
   }
@@ -2105,8 +2153,19 @@ static void InitGroups(const FunctionCallbackInfo<Value>& args) {
 #endif  // __POSIX__ && !defined(__ANDROID__)
 
 
+// Exits the process, or only the thread when |env| belongs to a worker.
+// Returns in the latter case, with the JS on the stack being terminated.
+static void ExitEnvironment(Environment* env, int code) {
+  if (env->worker_context() != nullptr)
+    return env->worker_context()->Exit(code);
+  worker::Worker::StopWorkers(env);
+  exit(code);
+}
+
+
 void Exit(const FunctionCallbackInfo<Value>& args) {
-  exit(args[0]->Int32Value());
+  Environment* env = Environment::GetCurrent(args);
+  ExitEnvironment(env, args[0]->Int32Value());
 }
 
 
@@ -2226,26 +2285,26 @@ struct node_module* get_linked_module(const char* name) {
 
 typedef void (UV_DYNAMIC* extInit)(Local<Object> exports);
 
-// DLOpen is process.dlopen(module, filename).
-// Used to load 'module.node' dynamically shared objects.
-//
-// FIXME(bnoordhuis) Not multi-context ready. TBD how to resolve the conflict
-// when two contexts try to load the same shared object. Maybe have a shadow
-// cache that's a plain C list or hash table that's shared across contexts?
-void DLOpen(const FunctionCallbackInfo<Value>& args) {
-  Environment* env = Environment::GetCurrent(args);
-  uv_lib_t lib;
+// Worker threads load addons too.  The shared object registers itself in
+// node_module_register() while it's loaded, through the process-wide
+// modpending, so loading is serialized.
+static uv_once_t dlopen_once = UV_ONCE_INIT;
+static uv_mutex_t dlopen_mutex;
 
-  CHECK_EQ(modpending, nullptr);
 
-  if (args.Length() != 2) {
-    env->ThrowError("process.dlopen takes exactly 2 arguments.");
-    return;
-  }
+static void InitDLOpen() {
+  CHECK_EQ(0, uv_mutex_init(&dlopen_mutex));
+}
 
-  Local<Object> module = args[0]->ToObject(env->isolate());  // Cast
-  node::Utf8Value filename(env->isolate(), args[1]);  // Cast
-  const bool is_dlopen_error = uv_dlopen(*filename, &lib);
+
+// Loads the shared object and returns the module that it registered, or
+// nullptr with an exception pending.  Called with dlopen_mutex held.
+static node_module* LoadAddon(Environment* env,
+                              Local<Value> filename_v,
+                              const char* filename,
+                              uv_lib_t* lib) {
+  CHECK_EQ(modpending, nullptr);
+  const bool is_dlopen_error = uv_dlopen(filename, lib);
 
   // Objects containing v14 or later modules will have registered themselves
   // on the pending list.  Activate all of them now.  At present, only one
@@ -2254,20 +2313,29 @@ void DLOpen(const FunctionCallbackInfo<Value>& args) {
   modpending = nullptr;
 
   if (is_dlopen_error) {
-    Local<String> errmsg = OneByteString(env->isolate(), uv_dlerror(&lib));
-    uv_dlclose(&lib);
+    Local<String> errmsg = OneByteString(env->isolate(), uv_dlerror(lib));
+    uv_dlclose(lib);
 #ifdef _WIN32
     // Windows needs to add the filename into the error message
-    errmsg = String::Concat(errmsg, args[1]->ToString(env->isolate()));
+    errmsg = String::Concat(errmsg, filename_v->ToString(env->isolate()));
 #endif  // _WIN32
     env->isolate()->ThrowException(Exception::Error(errmsg));
-    return;
+    return nullptr;
   }
 
   if (mp == nullptr) {
-    uv_dlclose(&lib);
+    // The object only registers itself the first time it's loaded into the
+    // process.  When it's loaded again, by another thread or after it was
+    // deleted from require.cache, use what it registered then.
+    for (node_module* loaded = modlist_addon;
+         loaded != nullptr;
+         loaded = loaded->nm_link) {
+      if (loaded->nm_dso_handle == lib->handle)
+        return loaded;
+    }
+    uv_dlclose(lib);
     env->ThrowError("Module did not self-register.");
-    return;
+    return nullptr;
   }
   if (mp->nm_version != NODE_MODULE_VERSION) {
     char errmsg[1024];
@@ -2278,32 +2346,69 @@ void DLOpen(const FunctionCallbackInfo<Value>& args) {
 
     // NOTE: `mp` is allocated inside of the shared library's memory, calling
     // `uv_dlclose` will deallocate it
-    uv_dlclose(&lib);
+    uv_dlclose(lib);
     env->ThrowError(errmsg);
-    return;
+    return nullptr;
   }
   if (mp->nm_flags & NM_F_BUILTIN) {
-    uv_dlclose(&lib);
+    uv_dlclose(lib);
     env->ThrowError("Built-in module self-registered.");
-    return;
+    return nullptr;
+  }
+  if (mp->nm_context_register_func == nullptr &&
+      mp->nm_register_func == nullptr) {
+    uv_dlclose(lib);
+    env->ThrowError("Module has no declared entry point.");
+    return nullptr;
   }
 
-  mp->nm_dso_handle = lib.handle;
+  mp->nm_dso_handle = lib->handle;
   mp->nm_link = modlist_addon;
   modlist_addon = mp;
+  return mp;
+}
+
+
+// DLOpen is process.dlopen(module, filename).
+// Used to load 'module.node' dynamically shared objects.
+//
+// The shared object is loaded into the process once.  Contexts that load it
+// after the first one get the module it registered then; only modules that
+// are registered with NODE_MODULE_CONTEXT_AWARE() can be initialized in a
+// worker thread, the others keep their state in globals.
+void DLOpen(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  uv_lib_t lib;
+
+  if (args.Length() != 2) {
+    env->ThrowError("process.dlopen takes exactly 2 arguments.");
+    return;
+  }
+
+  Local<Object> module = args[0]->ToObject(env->isolate());  // Cast
+  node::Utf8Value filename(env->isolate(), args[1]);  // Cast
+
+  uv_once(&dlopen_once, InitDLOpen);
+  uv_mutex_lock(&dlopen_mutex);
+  node_module* const mp = LoadAddon(env, args[1], *filename, &lib);
+  uv_mutex_unlock(&dlopen_mutex);
+  if (mp == nullptr)
+    return;  // Exception pending.
+
+  if (mp->nm_context_register_func == nullptr &&
+      env->worker_context() != nullptr) {
+    env->ThrowError("Module is not context-aware and can't be loaded in a "
+                    "worker thread.");
+    return;
+  }
 
   Local<String> exports_string = env->exports_string();
   Local<Object> exports = module->Get(exports_string)->ToObject(env->isolate());
 
-  if (mp->nm_context_register_func != nullptr) {
+  if (mp->nm_context_register_func != nullptr)
     mp->nm_context_register_func(exports, module, env->context(), mp->nm_priv);
-  } else if (mp->nm_register_func != nullptr) {
+  else
     mp->nm_register_func(exports, module, mp->nm_priv);
-  } else {
-    uv_dlclose(&lib);
-    env->ThrowError("Module has no declared entry point.");
-    return;
-  }
 
   // Tell coverity that 'handle' should not be freed when we return.
   // coverity[leaked_storage]
@@ -2334,6 +2439,10 @@ void FatalException(Isolate* isolate,
   HandleScope scope(isolate);
 
   Environment* env = Environment::GetCurrent(isolate);
+  // A worker thread that is exiting.
+  if (!env->can_call_into_js())
+    return;
+
   Local<Object> process_object = env->process_object();
   Local<String> fatal_exception_string = env->fatal_exception_string();
   Local<Function> fatal_exception_function =
@@ -2343,7 +2452,7 @@ void FatalException(Isolate* isolate,
     // failed before the process._fatalException function was added!
     // this is probably pretty bad.  Nothing to do but report and exit.
     ReportException(env, error, message);
-    exit(6);
+    return ExitEnvironment(env, 6);
   }
 
   TryCatch fatal_try_catch;
@@ -2358,12 +2467,14 @@ void FatalException(Isolate* isolate,
   if (fatal_try_catch.HasCaught()) {
     // the fatal exception function threw, so we must exit
     ReportException(env, fatal_try_catch);
-    exit(7);
+    return ExitEnvironment(env, 7);
   }
 
   if (false == caught->BooleanValue()) {
-    ReportException(env, error, message);
-    exit(1);
+    // Workers hand the error to their parent, see lib/internal/worker.js.
+    if (env->worker_context() == nullptr)
+      ReportException(env, error, message);
+    return ExitEnvironment(env, 1);
   }
 }
 
@@ -2402,6 +2513,11 @@ void ClearFatalExceptionHandlers(Environment* env) {
 }
 
 
+NodePlatform* GetNodePlatform() {
+  return default_platform;
+}
+
+
 static void Binding(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -2811,6 +2927,69 @@ void StopProfilerIdleNotifier(Environment* env) {
 }
 
 
+// uv_backend_timeout() doesn't see sockets that are ready to be read.  The
+// epoll or kqueue fd itself polls readable when events are waiting on it.
+// Windows has no such fd, there ready I/O goes unnoticed.
+static bool HasReadyIO(uv_loop_t* loop) {
+#ifdef _WIN32
+  return false;
+#else
+  const int fd = uv_backend_fd(loop);
+  if (fd < 0)
+    return false;
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+  int r;
+  do {
+    r = poll(&pfd, 1, 0);
+  } while (r == -1 && errno == EINTR);
+  return r > 0;
+#endif
+}
+
+
+// Runs right before libuv blocks in epoll_wait() and friends.  If nothing is
+// pending, the time until the next timer expires is dead time that we hand to
+// V8 so it can do incremental marking, sweeping and scavenges in the gap
+// rather than in the middle of the next request.  The budget is capped at
+// --gc-idle-time so a loop without timers doesn't stall on a long full GC.
+static void GCIdleNotification(uv_prepare_t* handle) {
+  Environment* env = Environment::from_gc_idle_prepare_handle(handle);
+  Environment::GCIdleInfo* info = env->gc_idle_info();
+
+  // V8 said it had nothing left to do.  The heap only changes when JS runs,
+  // which clears the flag, see AsyncCallbackScope.
+  if (info->heap_idle())
+    return info->RecordSkipped();
+
+  // Zero means there are pending callbacks, immediates or closing handles.
+  const int timeout = uv_backend_timeout(env->event_loop());
+  if (timeout == 0 || HasReadyIO(env->event_loop()))
+    return info->RecordSkipped();
+
+  double budget_ms = gc_idle_time;
+  if (timeout > 0 && timeout < gc_idle_time)
+    budget_ms = timeout;
+
+  // The deadline must use the same timebase as the platform, see
+  // Isolate::IdleNotificationDeadline().  V8 returning true means it has
+  // nothing left to do until the heap changes.
+  const double start = default_platform->MonotonicallyIncreasingTime();
+  const bool completed =
+      env->isolate()->IdleNotificationDeadline(start + budget_ms / 1000);
+  const double end = default_platform->MonotonicallyIncreasingTime();
+
+  // libuv computes the poll timeout from the loop time it cached before the
+  // prepare handles ran.  Without this the time V8 just spent is waited for
+  // a second time and the next timer fires late.
+  uv_update_time(env->event_loop());
+
+  info->RecordNotification(budget_ms, (end - start) * 1000, completed);
+}
+
+
 void StartProfilerIdleNotifier(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   StartProfilerIdleNotifier(env);
@@ -3056,6 +3235,14 @@ void SetupProcessObject(Environment* env,
     preload_module_count = 0;
   }
 
+  // --prefetch-modules
+  if (prefetch_modules_manifest) {
+    READONLY_PROPERTY(process,
+                      "_prefetch_modules_manifest",
+                      String::NewFromUtf8(env->isolate(),
+                                          prefetch_modules_manifest));
+  }
+
   // --no-deprecation
   if (no_deprecation) {
     READONLY_PROPERTY(process, "noDeprecation", True(env->isolate()));
@@ -3213,7 +3400,8 @@ void LoadEnvironment(Environment* env) {
   // source code.)
 
   // The node.js file returns a function 'f'
-  atexit(AtExit);
+  if (env->worker_context() == nullptr)
+    atexit(AtExit);
 
   TryCatch try_catch;
 
@@ -3223,7 +3411,9 @@ void LoadEnvironment(Environment* env) {
   try_catch.SetVerbose(false);
 
   Local<String> script_name = FIXED_ONE_BYTE_STRING(env->isolate(), "node.js");
-  Local<Value> f_value = ExecuteString(env, MainSource(env), script_name);
+  Local<Value> f_value =
+      ExecuteString(env, MainSource(env), script_name,
+                    code_cache::Get("internal/bootstrap_node"));
   if (try_catch.HasCaught())  {
     ReportException(env, try_catch);
     exit(10);
@@ -3250,7 +3440,7 @@ void LoadEnvironment(Environment* env) {
   InitLTTNG(env, global);
 #endif
 
-#if defined HAVE_PERFCTR
+#if defined HAVE_PERFCTR || defined HAVE_SHM_COUNTERS
   InitPerfCounters(env, global);
 #endif
 
@@ -3321,6 +3511,10 @@ static void PrintHelp() {
          "  -i, --interactive     always enter the REPL even if stdin\n"
          "                        does not appear to be a terminal\n"
          "  -r, --require         module to preload (option can be repeated)\n"
+         "  --prefetch-modules=file\n"
+         "                        parse the modules listed in file on\n"
+         "                        background threads during startup and\n"
+         "                        update file with the modules that loaded\n"
          "  --no-deprecation      silence deprecation warnings\n"
          "  --trace-deprecation   show stack traces on deprecations\n"
          "  --throw-deprecation   throw an exception anytime a deprecated "
@@ -3333,8 +3527,27 @@ static void PrintHelp() {
          "                        using --prof\n"
          "  --zero-fill-buffers   automatically zero-fill all newly allocated\n"
          "                        Buffer and SlowBuffer instances\n"
+         "  --buffer-allocator=malloc|pool\n"
+         "                        memory allocator for Buffer and typed array\n"
+         "                        contents (default: malloc)\n"
+         "  --buffer-hugepages    back large buffers with transparent huge\n"
+         "                        pages (requires --buffer-allocator=pool)\n"
          "  --v8-options          print v8 command line options\n"
          "  --v8-pool-size=num    set v8's thread pool size\n"
+         "  --gc-idle-time=ms     let v8 collect garbage for up to ms\n"
+         "                        milliseconds when the event loop is idle\n"
+         "  --experimental-worker enable the worker_threads module\n"
+         "  --experimental-profiler\n"
+         "                        enable the profiler module\n"
+         "  --experimental-json-stream\n"
+         "                        enable the json_stream module\n"
+#if defined HAVE_PERF_JIT
+         "  --perf-map            write /tmp/perf-<pid>.map for Linux perf\n"
+         "  --perf-jitdump[=dir]  write a perf jitdump file to dir\n"
+         "                        (default: /tmp)\n"
+         "  --perf-max-size=mb    rotate the perf map and jitdump file when\n"
+         "                        they grow past mb megabytes (default: 64)\n"
+#endif
 #if HAVE_OPENSSL
          "  --tls-cipher-list=val use an alternative default TLS cipher list\n"
 #endif
@@ -3406,6 +3619,7 @@ static void ParseArgs(int* argc,
 
   unsigned int index = 1;
   bool short_circuit = false;
+  bool buffer_hugepages = false;
   while (index < nargs && argv[index][0] == '-' && !short_circuit) {
     const char* const arg = argv[index];
     unsigned int args_consumed = 1;
@@ -3475,11 +3689,43 @@ static void ParseArgs(int* argc,
       short_circuit = true;
     } else if (strcmp(arg, "--zero-fill-buffers") == 0) {
       zero_fill_all_buffers = true;
+    } else if (strcmp(arg, "--buffer-allocator=malloc") == 0) {
+      use_pooled_array_buffer_allocator = false;
+    } else if (strcmp(arg, "--buffer-allocator=pool") == 0) {
+      use_pooled_array_buffer_allocator = true;
+    } else if (strncmp(arg, "--buffer-allocator=", 19) == 0) {
+      fprintf(stderr, "%s: unknown buffer allocator %s\n", argv[0], arg + 19);
+      exit(9);
+    } else if (strcmp(arg, "--buffer-hugepages") == 0) {
+      buffer_hugepages = true;
+    } else if (strncmp(arg, "--prefetch-modules=", 19) == 0) {
+      prefetch_modules_manifest = arg + 19;
+#if defined HAVE_PERF_JIT
+    } else if (strcmp(arg, "--perf-map") == 0) {
+      perf_map = true;
+    } else if (strcmp(arg, "--perf-jitdump") == 0) {
+      perf_jitdump_dir = "/tmp";
+    } else if (strncmp(arg, "--perf-jitdump=", 15) == 0) {
+      perf_jitdump_dir = arg + 15;
+    } else if (strncmp(arg, "--perf-max-size=", 16) == 0) {
+      const int mb = atoi(arg + 16);
+      if (mb <= 0) {
+        fprintf(stderr, "%s: --perf-max-size must be > 0\n", argv[0]);
+        exit(9);
+      }
+      perf_max_size = static_cast<size_t>(mb) << 20;
+#endif
     } else if (strcmp(arg, "--v8-options") == 0) {
       new_v8_argv[new_v8_argc] = "--help";
       new_v8_argc += 1;
     } else if (strncmp(arg, "--v8-pool-size=", 15) == 0) {
       v8_thread_pool_size = atoi(arg + 15);
+    } else if (strncmp(arg, "--gc-idle-time=", 15) == 0) {
+      gc_idle_time = atoi(arg + 15);
+      if (gc_idle_time < 0) {
+        fprintf(stderr, "%s: --gc-idle-time must be >= 0\n", argv[0]);
+        exit(9);
+      }
 #if HAVE_OPENSSL
     } else if (strncmp(arg, "--tls-cipher-list=", 18) == 0) {
       default_cipher_list = arg + 18;
@@ -3491,6 +3737,10 @@ static void ParseArgs(int* argc,
     } else if (strcmp(arg, "--expose-internals") == 0 ||
                strcmp(arg, "--expose_internals") == 0) {
       // consumed in js
+    } else if (strcmp(arg, "--experimental-worker") == 0 ||
+               strcmp(arg, "--experimental-profiler") == 0 ||
+               strcmp(arg, "--experimental-json-stream") == 0) {
+      // consumed in js
     } else {
       // V8 option.  Pass through as-is.
       new_v8_argv[new_v8_argc] = arg;
@@ -3505,6 +3755,16 @@ static void ParseArgs(int* argc,
     index += args_consumed;
   }
 
+  // The huge page arena is part of the pool allocator, it would go unused.
+  if (buffer_hugepages && !use_pooled_array_buffer_allocator) {
+    fprintf(stderr,
+            "%s: --buffer-hugepages requires --buffer-allocator=pool\n",
+            argv[0]);
+    exit(9);
+  }
+  if (buffer_hugepages)
+    PooledArrayBufferAllocator::EnableHugePages();
+
   // Copy remaining arguments.
   const unsigned int args_left = nargs - index;
   memcpy(new_argv + new_argc, argv + index, args_left * sizeof(*argv));
@@ -3928,6 +4188,13 @@ void Init(int* argc,
     }
   }
 
+  for (int i = 1; i < v8_argc; ++i) {
+    if (strncmp(v8_argv[i], "--stack-size=", 13) == 0 ||
+        strncmp(v8_argv[i], "--stack_size=", 13) == 0) {
+      v8_stack_size = atoi(v8_argv[i] + 13);
+    }
+  }
+
 #ifdef __POSIX__
   // Block SIGPROF signals when sleeping in epoll_wait/kevent/etc.  Avoids the
   // performance penalty of frequent EINTR wakeups when the profiler is running.
@@ -4116,6 +4383,12 @@ Environment* CreateEnvironment(Isolate* isolate,
   Context::Scope context_scope(context);
   Environment* env = Environment::New(context, loop);
 
+  // V8 puts its stack guard --stack-size below the stack position at which
+  // the isolate was created, which is normally not far up from here.
+  char stack_position;
+  env->set_stack_limit(reinterpret_cast<uintptr_t>(&stack_position) -
+                       static_cast<uintptr_t>(v8_stack_size) * 1024);
+
   isolate->SetAutorunMicrotasks(false);
 
   uv_check_init(env->event_loop(), env->immediate_check_handle());
@@ -4138,6 +4411,8 @@ Environment* CreateEnvironment(Isolate* isolate,
   uv_unref(reinterpret_cast<uv_handle_t*>(env->idle_prepare_handle()));
   uv_unref(reinterpret_cast<uv_handle_t*>(env->idle_check_handle()));
 
+  uv_prepare_init(env->event_loop(), env->gc_idle_prepare_handle());
+  uv_unref(reinterpret_cast<uv_handle_t*>(env->gc_idle_prepare_handle()));
   // Register handle cleanups
   env->RegisterHandleCleanup(
       reinterpret_cast<uv_handle_t*>(env->immediate_check_handle()),
@@ -4155,11 +4430,19 @@ Environment* CreateEnvironment(Isolate* isolate,
       reinterpret_cast<uv_handle_t*>(env->idle_check_handle()),
       HandleCleanup,
       nullptr);
+  env->RegisterHandleCleanup(
+      reinterpret_cast<uv_handle_t*>(env->gc_idle_prepare_handle()),
+      HandleCleanup,
+      nullptr);
 
   if (v8_is_profiling) {
     StartProfilerIdleNotifier(env);
   }
 
+  if (gc_idle_time > 0) {
+    uv_prepare_start(env->gc_idle_prepare_handle(), GCIdleNotification);
+  }
+
   Local<FunctionTemplate> process_template = FunctionTemplate::New(isolate);
   process_template->SetClassName(FIXED_ONE_BYTE_STRING(isolate, "process"));
 
@@ -4175,10 +4458,10 @@ Environment* CreateEnvironment(Isolate* isolate,
 
 // Entry point for new node instances, also called directly for the main
 // node instance.
-static void StartNodeInstance(void* arg) {
+void StartNodeInstance(void* arg) {
   NodeInstanceData* instance_data = static_cast<NodeInstanceData*>(arg);
   Isolate::CreateParams params;
-  ArrayBufferAllocator* array_buffer_allocator = new ArrayBufferAllocator();
+  ArrayBufferAllocator* array_buffer_allocator = ArrayBufferAllocator::New();
   params.array_buffer_allocator = array_buffer_allocator;
 #ifdef NODE_ENABLE_VTUNE_PROFILING
   params.code_event_handler = vTune::GetVtuneCodeEventHandler();
@@ -4197,19 +4480,32 @@ static void StartNodeInstance(void* arg) {
     Locker locker(isolate);
     Isolate::Scope isolate_scope(isolate);
     HandleScope handle_scope(isolate);
+#if defined HAVE_PERF_JIT
+    // Registered before the context exists so that the code compiled for it
+    // is reported; the code from the snapshot is enumerated right away.
+    if (perf_jit::IsEnabled()) {
+      isolate->SetJitCodeEventHandler(v8::kJitCodeEventEnumExisting,
+                                      perf_jit::HandleCodeEvent);
+    }
+#endif
     Local<Context> context = Context::New(isolate);
     Environment* env = CreateEnvironment(isolate, context, instance_data);
     array_buffer_allocator->set_env(env);
+    env->set_array_buffer_allocator(array_buffer_allocator);
     Context::Scope context_scope(context);
 
     isolate->SetAbortOnUncaughtExceptionCallback(
         ShouldAbortOnUncaughtException);
 
+    worker::Worker* worker = instance_data->worker();
+    if (worker != nullptr)
+      worker->Attach(env);
+
     // Start debug agent when argv has --debug
     if (instance_data->use_debug_agent())
       StartDebug(env, debug_wait_connect);
 
-    {
+    if (env->can_call_into_js()) {
       Environment::AsyncCallbackScope callback_scope(env);
       LoadEnvironment(env);
     }
@@ -4222,13 +4518,17 @@ static void StartNodeInstance(void* arg) {
 
     {
       SealHandleScope seal(isolate);
-      bool more;
-      do {
-        v8::platform::PumpMessageLoop(default_platform, isolate);
+      bool more = env->can_call_into_js();
+      while (more == true) {
+        default_platform->PumpMessageLoop(isolate);
         more = uv_run(env->event_loop(), UV_RUN_ONCE);
 
+        // process.exit() or terminate() in a worker stops the loop.
+        if (worker != nullptr && worker->IsStopping())
+          break;
+
         if (more == false) {
-          v8::platform::PumpMessageLoop(default_platform, isolate);
+          default_platform->PumpMessageLoop(isolate);
           EmitBeforeExit(env);
 
           // Emit `beforeExit` if the loop became alive either after emitting
@@ -4237,21 +4537,33 @@ static void StartNodeInstance(void* arg) {
           if (uv_run(env->event_loop(), UV_RUN_NOWAIT) != 0)
             more = true;
         }
-      } while (more == true);
+      }
     }
 
     env->set_trace_sync_io(false);
 
-    int exit_code = EmitExit(env);
-    if (instance_data->is_main())
+    if (worker == nullptr || !worker->IsStopping()) {
+      int exit_code = EmitExit(env);
+      if (worker != nullptr && worker->IsStopping())
+        exit_code = worker->exit_code();
       instance_data->set_exit_code(exit_code);
-    RunAtExit(env);
+    } else {
+      instance_data->set_exit_code(worker->exit_code());
+    }
+
+    if (worker == nullptr) {
+      RunAtExit(env);
+      worker::Worker::StopWorkers(env);
+    } else {
+      worker->Detach(env);
+    }
 
 #if defined(LEAK_SANITIZER)
     __lsan_do_leak_check();
 #endif
 
     array_buffer_allocator->set_env(nullptr);
+    env->set_array_buffer_allocator(nullptr);
     env->Dispose();
     env = nullptr;
   }
@@ -4262,6 +4574,7 @@ static void StartNodeInstance(void* arg) {
   }
 
   CHECK_NE(isolate, nullptr);
+  default_platform->UnregisterIsolate(isolate);
   isolate->Dispose();
   isolate = nullptr;
   delete array_buffer_allocator;
@@ -4287,10 +4600,17 @@ int Start(int argc, char** argv) {
   V8::SetEntropySource(crypto::EntropySource);
 #endif
 
-  default_platform = v8::platform::CreateDefaultPlatform(v8_thread_pool_size);
+  default_platform = new NodePlatform(v8_thread_pool_size);
   V8::InitializePlatform(default_platform);
   V8::Initialize();
 
+#if defined HAVE_PERF_JIT
+  if (perf_map || perf_jitdump_dir != nullptr) {
+    if (!perf_jit::Start(perf_map, perf_jitdump_dir, perf_max_size))
+      exit(9);
+  }
+#endif
+
   int exit_code = 1;
   {
     NodeInstanceData instance_data(NodeInstanceType::MAIN,
@@ -0,0 +1,308 @@
+#include "node_allocator.h"
+#include "node_internals.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__POSIX__)
+#include <sys/mman.h>
+#endif
+
+namespace node {
+
+namespace {
+
+// Process-wide arena for large blocks, carved in kUnitSize units with a
+// first-fit search.  Large buffers tend to be long-lived (file contents,
+// caches, message batches) so the arena keeps freed units mapped for reuse
+// instead of returning them to the OS.  On Linux the range is marked with
+// MADV_HUGEPAGE so that it's backed by transparent huge pages, which cuts
+// down on TLB misses when those buffers are scanned.
+class HugePageArena {
+ public:
+  static const size_t kUnitSize = 64 * 1024;
+  static const size_t kArenaSize = 1024 * 1024 * 1024;
+  static const size_t kUnitCount = kArenaSize / kUnitSize;
+
+  bool Init();
+  void* Allocate(size_t size, bool zero_fill, size_t* allocated);
+  bool Free(void* data, size_t* released);
+  bool Contains(const void* data) const;
+
+ private:
+  uv_mutex_t mutex_;
+  char* base_;
+  // Number of units of the allocation that starts at that unit, zero for
+  // free units and for the interior units of an allocation.
+  uint32_t run_length_[kUnitCount];
+};
+
+
+bool HugePageArena::Init() {
+#if defined(__POSIX__) && defined(MAP_NORESERVE)
+  void* base = mmap(nullptr,
+                    kArenaSize,
+                    PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                    -1,
+                    0);
+  if (base == MAP_FAILED)
+    return false;
+#if defined(MADV_HUGEPAGE)
+  // Best effort, the arena still works with regular pages.
+  madvise(base, kArenaSize, MADV_HUGEPAGE);
+#endif
+  if (uv_mutex_init(&mutex_) != 0) {
+    munmap(base, kArenaSize);
+    return false;
+  }
+  base_ = static_cast<char*>(base);
+  memset(run_length_, 0, sizeof(run_length_));
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+void* HugePageArena::Allocate(size_t size, bool zero_fill, size_t* allocated) {
+  const size_t units = (size + kUnitSize - 1) / kUnitSize;
+  if (units > kUnitCount)
+    return nullptr;
+
+  char* data = nullptr;
+  uv_mutex_lock(&mutex_);
+  // Live allocations are skipped as a whole, so any unit with a zero run
+  // length that we land on is free.
+  size_t i = 0;
+  while (i + units <= kUnitCount) {
+    if (run_length_[i] != 0) {
+      i += run_length_[i];
+      continue;
+    }
+    size_t start = i;
+    while (i < kUnitCount && i - start < units && run_length_[i] == 0)
+      i += 1;
+    if (i - start == units) {
+      run_length_[start] = units;
+      data = base_ + start * kUnitSize;
+      break;
+    }
+  }
+  uv_mutex_unlock(&mutex_);
+
+  if (data == nullptr)
+    return nullptr;
+  // Units are recycled, unlike the fresh mmap() pages they start out as.
+  if (zero_fill)
+    memset(data, 0, size);
+  *allocated = units * kUnitSize;
+  return data;
+}
+
+
+bool HugePageArena::Free(void* data, size_t* released) {
+  char* const p = static_cast<char*>(data);
+  if (p < base_ || p >= base_ + kArenaSize)
+    return false;
+  const size_t unit = (p - base_) / kUnitSize;
+  uv_mutex_lock(&mutex_);
+  CHECK_NE(run_length_[unit], 0);
+  *released = run_length_[unit] * kUnitSize;
+  run_length_[unit] = 0;
+  uv_mutex_unlock(&mutex_);
+  return true;
+}
+
+
+bool HugePageArena::Contains(const void* data) const {
+  const char* const p = static_cast<const char*>(data);
+  return p >= base_ && p < base_ + kArenaSize;
+}
+
+
+bool hugepages_requested = false;
+HugePageArena* hugepage_arena = nullptr;
+uv_once_t hugepage_arena_once = UV_ONCE_INIT;
+
+
+void InitHugePageArena() {
+  HugePageArena* arena = new HugePageArena();
+  if (arena->Init())
+    hugepage_arena = arena;
+  else
+    delete arena;
+}
+
+}  // anonymous namespace
+
+
+void PooledArrayBufferAllocator::EnableHugePages() {
+  hugepages_requested = true;
+}
+
+
+PooledArrayBufferAllocator::PooledArrayBufferAllocator()
+    : region_(nullptr), slabs_used_(0) {
+  memset(slab_class_, 0, sizeof(slab_class_));
+  for (size_t i = 0; i < kClassCount; i += 1) {
+    classes_[i].free_list = nullptr;
+    classes_[i].bump = nullptr;
+    classes_[i].limit = nullptr;
+  }
+}
+
+
+PooledArrayBufferAllocator::~PooledArrayBufferAllocator() {
+#if defined(__POSIX__)
+  // The isolate is gone by now, nothing can reference the slabs anymore.
+  if (region_ != nullptr)
+    munmap(region_, kRegionSize);
+#endif
+}
+
+
+bool PooledArrayBufferAllocator::Init() {
+  static_assert(kMinClassSize << (kClassCount - 1) == kMaxClassSize,
+                "size classes must span kMinClassSize to kMaxClassSize");
+  static_assert(kSlabSize % kMaxClassSize == 0,
+                "slabs must hold a whole number of blocks");
+  static_assert(sizeof(FreeBlock) <= kMinClassSize,
+                "free list links must fit in the smallest block");
+
+  if (hugepages_requested)
+    uv_once(&hugepage_arena_once, InitHugePageArena);
+
+#if defined(__POSIX__) && defined(MAP_NORESERVE)
+  // Reserve the address range without committing memory; pages are faulted
+  // in as slabs are carved out of it.
+  void* region = mmap(nullptr,
+                      kRegionSize,
+                      PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                      -1,
+                      0);
+  if (region == MAP_FAILED)
+    return false;
+  region_ = static_cast<char*>(region);
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+inline size_t PooledArrayBufferAllocator::ClassIndex(size_t size) {
+  size_t index = 0;
+  while (ClassSize(index) < size)
+    index += 1;
+  return index;
+}
+
+
+inline size_t PooledArrayBufferAllocator::ClassSize(size_t index) {
+  return kMinClassSize << index;
+}
+
+
+inline bool PooledArrayBufferAllocator::IsPooled(const void* data) const {
+  const char* const p = static_cast<const char*>(data);
+  return p >= region_ && p < region_ + kRegionSize;
+}
+
+
+void* PooledArrayBufferAllocator::Allocate(size_t size) {
+  return AllocateBlock(size, ShouldZeroFill());
+}
+
+
+void* PooledArrayBufferAllocator::AllocateUninitialized(size_t size) {
+  return AllocateBlock(size, false);
+}
+
+
+void* PooledArrayBufferAllocator::AllocateBlock(size_t size, bool zero_fill) {
+  statistics_[kAllocations] += 1;
+
+  if (size == 0 || size > kMaxClassSize) {
+    if (size >= kHugePageThreshold && hugepage_arena != nullptr) {
+      size_t allocated;
+      void* data = hugepage_arena->Allocate(size, zero_fill, &allocated);
+      if (data != nullptr) {
+        statistics_[kHugePageAllocations] += 1;
+        statistics_[kHugePageBytes] += allocated;
+        return data;
+      }
+    }
+    return zero_fill ? calloc(size, 1) : malloc(size);
+  }
+
+  const size_t index = ClassIndex(size);
+  SizeClass* const size_class = &classes_[index];
+
+  if (FreeBlock* block = size_class->free_list) {
+    size_class->free_list = block->next;
+    statistics_[kPoolHits] += 1;
+    statistics_[kPoolFreeBytes] -= ClassSize(index);
+    if (zero_fill)
+      memset(block, 0, size);
+    return block;
+  }
+
+  statistics_[kPoolMisses] += 1;
+
+  if (size_class->bump == size_class->limit) {
+    if (slabs_used_ == kSlabCount) {
+      statistics_[kPoolFallbacks] += 1;
+      return zero_fill ? calloc(size, 1) : malloc(size);
+    }
+    char* const slab = region_ + slabs_used_ * kSlabSize;
+    slab_class_[slabs_used_] = static_cast<uint8_t>(index);
+    slabs_used_ += 1;
+    size_class->bump = slab;
+    size_class->limit = slab + kSlabSize;
+    statistics_[kPoolSlabBytes] += kSlabSize;
+  }
+
+  // Never handed out before so still zeroed by mmap(), no need to clear it.
+  void* const data = size_class->bump;
+  size_class->bump += ClassSize(index);
+  return data;
+}
+
+
+void PooledArrayBufferAllocator::Free(void* data, size_t length) {
+  statistics_[kFrees] += 1;
+
+  if (IsPooled(data)) {
+    const size_t slab = (static_cast<char*>(data) - region_) / kSlabSize;
+    const size_t index = slab_class_[slab];
+    FreeBlock* const block = static_cast<FreeBlock*>(data);
+    block->next = classes_[index].free_list;
+    classes_[index].free_list = block;
+    statistics_[kPoolFreeBytes] += ClassSize(index);
+    return;
+  }
+
+  size_t released;
+  if (hugepage_arena != nullptr && hugepage_arena->Free(data, &released)) {
+    statistics_[kHugePageBytes] -= released;
+    return;
+  }
+
+  // Either too large for the pool or malloc()'d memory that was handed to
+  // V8 by Buffer::New() and friends.
+  free(data);
+}
+
+
+bool PooledArrayBufferAllocator::IsMalloced(const void* data) const {
+  if (IsPooled(data))
+    return false;
+  return hugepage_arena == nullptr || !hugepage_arena->Contains(data);
+}
+
+}  // namespace node
@@ -0,0 +1,81 @@
+#ifndef SRC_NODE_ALLOCATOR_H_
+#define SRC_NODE_ALLOCATOR_H_
+
+#include "node_internals.h"
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+
+// Size-classed allocator for ArrayBuffer backing stores, selected with
+// --buffer-allocator=pool.
+//
+// Blocks of up to kMaxClassSize bytes are rounded up to a power of two and
+// carved from slabs that are dedicated to one size class.  Freed blocks go
+// onto a per-class free list and are handed out again without going through
+// malloc.  All slabs live in a single address range that is reserved up
+// front, that's how Free() tells pooled blocks apart from the malloc()'d
+// memory that Buffer::New() hands to V8.  When the range is exhausted,
+// allocations fall back to malloc().
+//
+// The pool is owned by one isolate and V8 only calls into the allocator from
+// that isolate's thread, so it doesn't lock.  Blocks larger than
+// kHugePageThreshold are allocated from a process-wide arena backed by
+// transparent huge pages when --buffer-hugepages is set; that arena is
+// shared between isolates and protected by a mutex.
+class PooledArrayBufferAllocator : public ArrayBufferAllocator {
+ public:
+  PooledArrayBufferAllocator();
+  virtual ~PooledArrayBufferAllocator() override;
+
+  // Returns false if the platform can't reserve the address range.
+  bool Init();
+
+  void* Allocate(size_t size) override;
+  void* AllocateUninitialized(size_t size) override;
+  void Free(void* data, size_t length) override;
+  bool IsMalloced(const void* data) const override;
+
+  static const size_t kMinClassSize = 64;
+  static const size_t kMaxClassSize = 64 * 1024;
+  static const size_t kSlabSize = 256 * 1024;
+  static const size_t kRegionSize = 64 * 1024 * 1024;
+  static const size_t kHugePageThreshold = 1024 * 1024;
+
+  // Enables the huge page arena for all pooled allocators.
+  static void EnableHugePages();
+
+ private:
+  static const size_t kClassCount = 11;  // 64 bytes to 64 kB.
+  static const size_t kSlabCount = kRegionSize / kSlabSize;
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct SizeClass {
+    FreeBlock* free_list;
+    char* bump;   // Next unused block in the current slab.
+    char* limit;  // End of the current slab.
+  };
+
+  inline static size_t ClassIndex(size_t size);
+  inline static size_t ClassSize(size_t index);
+  inline bool IsPooled(const void* data) const;
+  void* AllocateBlock(size_t size, bool zero_fill);
+
+  char* region_;
+  size_t slabs_used_;
+  uint8_t slab_class_[kSlabCount];
+  SizeClass classes_[kClassCount];
+
+  DISALLOW_COPY_AND_ASSIGN(PooledArrayBufferAllocator);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_ALLOCATOR_H_
@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_buffer.h"
+#include "node_internals.h"
 
 #include "env.h"
 #include "env-inl.h"
@@ -1152,6 +1153,62 @@ void IndexOfNumber(const FunctionCallbackInfo<Value>& args) {
                                 : -1);
 }
 
+// splitLines(buffer, start, offsets) looks for line terminators (\n, \r\n and
+// a lone \r) from |start| on.  For each one, the offset where the line ends
+// and the offset where the next one starts are stored in the Uint32Array
+// |offsets|.  Returns the number of lines found; when that fills |offsets|,
+// the rest of the buffer hasn't been looked at.
+void SplitLines(const FunctionCallbackInfo<Value>& args) {
+  THROW_AND_RETURN_UNLESS_BUFFER(Environment::GetCurrent(args), args[0]);
+  SPREAD_ARG(args[0], ts_obj);
+  CHECK(args[2]->IsUint32Array());
+
+  Local<Uint32Array> array = args[2].As<Uint32Array>();
+  uint32_t* const offsets = reinterpret_cast<uint32_t*>(
+      static_cast<char*>(array->Buffer()->GetContents().Data()) +
+      array->ByteOffset());
+  const size_t max_lines = array->Length() / 2;
+
+  const char* const data = ts_obj_data;
+  const char* const end = data + ts_obj_length;
+  const char* p = data + MIN(args[1]->Uint32Value(), ts_obj_length);
+
+  // memchr() is vectorized, so it is faster to look for each terminator on
+  // its own and only search again for the one that was passed.
+  const char* lf = static_cast<const char*>(memchr(p, '\n', end - p));
+  const char* cr = static_cast<const char*>(memchr(p, '\r', end - p));
+  if (lf == nullptr)
+    lf = end;
+  if (cr == nullptr)
+    cr = end;
+
+  size_t lines = 0;
+  while (lines < max_lines) {
+    const char* eol = MIN(lf, cr);
+    if (eol == end)
+      break;
+    p = eol + 1;
+    if (eol == cr && p < end && *p == '\n')
+      p++;
+    offsets[lines * 2] = eol - data;
+    offsets[lines * 2 + 1] = p - data;
+    lines++;
+
+    if (lf < p) {
+      lf = static_cast<const char*>(memchr(p, '\n', end - p));
+      if (lf == nullptr)
+        lf = end;
+    }
+    if (cr < p) {
+      cr = static_cast<const char*>(memchr(p, '\r', end - p));
+      if (cr == nullptr)
+        cr = end;
+    }
+  }
+
+  args.GetReturnValue().Set(static_cast<uint32_t>(lines));
+}
+
 void Swap16(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
   THROW_AND_RETURN_UNLESS_BUFFER(env, args.This());
@@ -1214,6 +1271,27 @@ void SetupBufferJS(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Returns the counters of the ArrayBuffer allocator of this isolate, or
+// undefined if node is embedded and the embedder provided the allocator.
+void GetAllocatorStatistics(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  ArrayBufferAllocator* allocator = env->array_buffer_allocator();
+  if (allocator == nullptr)
+    return;
+
+  const double* const statistics = allocator->statistics();
+  Local<Object> obj = Object::New(env->isolate());
+#define V(index, name)                                                        \
+  obj->Set(env->context(),                                                    \
+           FIXED_ONE_BYTE_STRING(env->isolate(), #name),                      \
+           Number::New(env->isolate(),                                        \
+                       statistics[ArrayBufferAllocator::index])).FromJust();
+  ARRAY_BUFFER_ALLOCATOR_STATISTICS(V)
+#undef V
+  args.GetReturnValue().Set(obj);
+}
+
+
 void Initialize(Local<Object> target,
                 Local<Value> unused,
                 Local<Context> context) {
@@ -1230,6 +1308,7 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "indexOfBuffer", IndexOfBuffer);
   env->SetMethod(target, "indexOfNumber", IndexOfNumber);
   env->SetMethod(target, "indexOfString", IndexOfString);
+  env->SetMethod(target, "splitLines", SplitLines);
 
   env->SetMethod(target, "readDoubleBE", ReadDoubleBE);
   env->SetMethod(target, "readDoubleLE", ReadDoubleLE);
@@ -1244,6 +1323,8 @@ void Initialize(Local<Object> target,
   env->SetMethod(target, "swap16", Swap16);
   env->SetMethod(target, "swap32", Swap32);
 
+  env->SetMethod(target, "getAllocatorStatistics", GetAllocatorStatistics);
+
   target->Set(env->context(),
               FIXED_ONE_BYTE_STRING(env->isolate(), "kMaxLength"),
               Integer::NewFromUnsigned(env->isolate(), kMaxLength)).FromJust();
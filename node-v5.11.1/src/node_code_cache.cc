@@ -0,0 +1,80 @@
+#include "node_code_cache.h"
+#include "node.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <string.h>
+
+namespace node {
+namespace code_cache {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Local;
+using v8::Object;
+using v8::ScriptCompiler;
+using v8::Uint8Array;
+using v8::Value;
+
+
+static const Entry* Find(const char* id) {
+  for (const Entry* entry = entries; entry->id != nullptr; entry += 1)
+    if (strcmp(entry->id, id) == 0)
+      return entry;
+  return nullptr;
+}
+
+
+ScriptCompiler::CachedData* Get(const char* id) {
+  const Entry* entry = Find(id);
+  if (entry == nullptr)
+    return nullptr;
+  return new ScriptCompiler::CachedData(entry->data,
+                                        static_cast<int>(entry->length));
+}
+
+
+// Returns a Uint8Array rather than a Buffer, the core modules that are
+// compiled before lib/buffer.js don't have Buffer.prototype yet.
+static void GetCodeCache(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  node::Utf8Value id(env->isolate(), args[0]);
+  const Entry* entry = Find(*id);
+  if (entry == nullptr)
+    return;
+  // Externalized, V8 never frees the static data.
+  Local<ArrayBuffer> ab =
+      ArrayBuffer::New(env->isolate(),
+                       const_cast<uint8_t*>(entry->data),
+                       entry->length);
+  args.GetReturnValue().Set(Uint8Array::New(ab, 0, entry->length));
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<Array> ids = Array::New(env->isolate());
+  for (const Entry* entry = entries; entry->id != nullptr; entry += 1)
+    ids->Set(ids->Length(), OneByteString(env->isolate(), entry->id));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ids"), ids);
+
+  // Filled in by lib/internal/bootstrap_node.js with the ids of the modules
+  // whose cache V8 refused to use.
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "rejected"),
+              Array::New(env->isolate()));
+
+  env->SetMethod(target, "get", GetCodeCache);
+}
+
+}  // namespace code_cache
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(code_cache, node::code_cache::Initialize)
@@ -0,0 +1,32 @@
+#ifndef SRC_NODE_CODE_CACHE_H_
+#define SRC_NODE_CODE_CACHE_H_
+
+#include "v8.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace node {
+namespace code_cache {
+
+struct Entry {
+  const char* id;
+  const uint8_t* data;
+  size_t length;
+};
+
+// Code caches of the core modules, terminated by an entry with a nullptr id.
+// Defined in the file generated by node_mkcodecache when node was configured
+// with --with-code-cache, in node_code_cache_stub.cc otherwise.
+extern const Entry entries[];
+
+// Returns the code cache for the core module |id|, or nullptr if there is
+// none.  The returned object is meant to be passed to a
+// ScriptCompiler::Source, which takes ownership of it.  It doesn't own the
+// data, which lives as long as the process.
+v8::ScriptCompiler::CachedData* Get(const char* id);
+
+}  // namespace code_cache
+}  // namespace node
+
+#endif  // SRC_NODE_CODE_CACHE_H_
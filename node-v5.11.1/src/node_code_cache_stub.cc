@@ -0,0 +1,14 @@
+#include "node_code_cache.h"
+
+// Used instead of the file generated by node_mkcodecache when node is built
+// without --with-code-cache.
+
+namespace node {
+namespace code_cache {
+
+const Entry entries[] = {
+  { nullptr, nullptr, 0 }
+};
+
+}  // namespace code_cache
+}  // namespace node
@@ -8,6 +8,7 @@
 
 namespace node {
 
+using v8::Context;
 using v8::FunctionCallbackInfo;
 using v8::FunctionTemplate;
 using v8::GCCallbackFlags;
@@ -18,6 +19,7 @@ using v8::HandleScope;
 using v8::Isolate;
 using v8::Local;
 using v8::Object;
+using v8::Script;
 using v8::String;
 using v8::Value;
 
@@ -70,6 +72,8 @@ static void counter_gc_done(Isolate* isolate,
     uint64_t totalperiod = endgc - counter_gc_end_time;
     uint64_t gcperiod = endgc - counter_gc_start_time;
 
+    NODE_COUNT_GC_PAUSE(gcperiod);
+
     if (totalperiod > 0) {
       unsigned int percent = static_cast<unsigned int>(
           (gcperiod * 100) / totalperiod);
@@ -98,15 +102,41 @@ void InitPerfCounters(Environment* env, Local<Object> target) {
 #undef NODE_PROBE
   };
 
+#ifdef HAVE_PERFCTR
+  InitPerfCountersWin32();
+#else
+  InitPerfCountersShm();
+#endif
+
+  // Without a counters file there is nothing to count.  The probes are
+  // called for every HTTP request and response and every connection, an
+  // empty JS function costs them far less than a call into C++.
+  Local<Value> noop;
+#ifdef HAVE_SHM_COUNTERS
+  if (counters::values == nullptr) {
+    Local<Context> context = env->context();
+    Local<String> source =
+        FIXED_ONE_BYTE_STRING(env->isolate(), "(function() {})");
+    noop = Script::Compile(context, source).ToLocalChecked()
+               ->Run(context).ToLocalChecked();
+    CHECK(noop->IsFunction());
+  }
+#endif
+
   for (size_t i = 0; i < arraysize(tab); i++) {
     Local<String> key = OneByteString(env->isolate(), tab[i].name);
-    Local<Value> val = env->NewFunctionTemplate(tab[i].func)->GetFunction();
+    Local<Value> val = noop;
+    if (val.IsEmpty())
+      val = env->NewFunctionTemplate(tab[i].func)->GetFunction();
     target->Set(key, val);
   }
 
-  // Only Windows performance counters supported
-  // To enable other OS, use conditional compilation here
-  InitPerfCountersWin32();
+  // The GC times are kept for one isolate only, the one of the main thread,
+  // which is the first to get here.
+  static bool gc_callbacks_added;
+  if (gc_callbacks_added)
+    return;
+  gc_callbacks_added = true;
 
   // init times for GC percent calculation and hook callbacks
   counter_gc_start_time = NODE_COUNT_GET_GC_RAWTIME();
@@ -118,9 +148,9 @@ void InitPerfCounters(Environment* env, Local<Object> target) {
 
 
 void TermPerfCounters(Local<Object> target) {
-  // Only Windows performance counters supported
-  // To enable other OS, use conditional compilation here
+#ifdef HAVE_PERFCTR
   TermPerfCountersWin32();
+#endif
 }
 
 }  // namespace node
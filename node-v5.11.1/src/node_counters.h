@@ -5,6 +5,8 @@
 
 #ifdef HAVE_PERFCTR
 #include "node_win32_perfctr_provider.h"
+#elif defined(HAVE_SHM_COUNTERS)
+#include "node_shm_counters.h"
 #else
 #define NODE_COUNTER_ENABLED() (false)
 #define NODE_COUNT_GC_PERCENTTIME(percent) do { } while (false)
@@ -21,6 +23,14 @@
 #define NODE_COUNT_SERVER_CONN_OPEN() do { } while (false)
 #endif
 
+#ifndef HAVE_SHM_COUNTERS
+#define NODE_COUNT_GC_PAUSE(nanoseconds) do { } while (false)
+#define NODE_COUNT_HANDLE_CLOSE(provider) do { } while (false)
+#define NODE_COUNT_HANDLE_OPEN(provider) do { } while (false)
+#define NODE_COUNT_THREADPOOL_DONE() do { } while (false)
+#define NODE_COUNT_THREADPOOL_QUEUED() do { } while (false)
+#endif
+
 #include "v8.h"
 #include "env.h"
 
@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_buffer.h"
+#include "node_counters.h"
 #include "node_crypto.h"
 #include "node_crypto_bio.h"
 #include "node_crypto_groups.h"
@@ -5080,6 +5081,7 @@ void EIO_PBKDF2After(PBKDF2Request* req, Local<Value> argv[2]) {
 
 void EIO_PBKDF2After(uv_work_t* work_req, int status) {
   CHECK_EQ(status, 0);
+  NODE_COUNT_THREADPOOL_DONE();
   PBKDF2Request* req = ContainerOf(&PBKDF2Request::work_req_, work_req);
   Environment* env = req->env();
   HandleScope handle_scope(env->isolate());
@@ -5196,6 +5198,7 @@ void PBKDF2(const FunctionCallbackInfo<Value>& args) {
                   req->work_req(),
                   EIO_PBKDF2,
                   EIO_PBKDF2After);
+    NODE_COUNT_THREADPOOL_QUEUED();
   } else {
     env->PrintSyncTrace();
     Local<Value> argv[2];
@@ -5320,6 +5323,7 @@ void RandomBytesCheck(RandomBytesRequest* req, Local<Value> argv[2]) {
 
 void RandomBytesAfter(uv_work_t* work_req, int status) {
   CHECK_EQ(status, 0);
+  NODE_COUNT_THREADPOOL_DONE();
   RandomBytesRequest* req =
       ContainerOf(&RandomBytesRequest::work_req_, work_req);
   Environment* env = req->env();
@@ -5357,6 +5361,7 @@ void RandomBytes(const FunctionCallbackInfo<Value>& args) {
                   req->work_req(),
                   RandomBytesWork,
                   RandomBytesAfter);
+    NODE_COUNT_THREADPOOL_QUEUED();
     args.GetReturnValue().Set(obj);
   } else {
     env->PrintSyncTrace();
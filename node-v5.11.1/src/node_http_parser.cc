@@ -75,78 +75,6 @@ const uint32_t kOnExecute = 4;
   int name##_(const char* at, size_t length)
 
 
-// helper class for the Parser
-struct StringPtr {
-  StringPtr() {
-    on_heap_ = false;
-    Reset();
-  }
-
-
-  ~StringPtr() {
-    Reset();
-  }
-
-
-  // If str_ does not point to a heap string yet, this function makes it do
-  // so. This is called at the end of each http_parser_execute() so as not
-  // to leak references. See issue #2438 and test-http-parser-bad-ref.js.
-  void Save() {
-    if (!on_heap_ && size_ > 0) {
-      char* s = new char[size_];
-      memcpy(s, str_, size_);
-      str_ = s;
-      on_heap_ = true;
-    }
-  }
-
-
-  void Reset() {
-    if (on_heap_) {
-      delete[] str_;
-      on_heap_ = false;
-    }
-
-    str_ = nullptr;
-    size_ = 0;
-  }
-
-
-  void Update(const char* str, size_t size) {
-    if (str_ == nullptr)
-      str_ = str;
-    else if (on_heap_ || str_ + size_ != str) {
-      // Non-consecutive input, make a copy on the heap.
-      // TODO(bnoordhuis) Use slab allocation, O(n) allocs is bad.
-      char* s = new char[size_ + size];
-      memcpy(s, str_, size_);
-      memcpy(s + size_, str, size);
-
-      if (on_heap_)
-        delete[] str_;
-      else
-        on_heap_ = true;
-
-      str_ = s;
-    }
-    size_ += size;
-  }
-
-
-  Local<String> ToString(Environment* env) const {
-    if (str_)
-      return OneByteString(env->isolate(), str_, size_);
-    else
-      return String::Empty(env->isolate());
-  }
-
-
-  const char* str_;
-  bool on_heap_;
-  size_t size_;
-};
-
-
 class Parser : public AsyncWrap {
  public:
   Parser(Environment* env, Local<Object> wrap, enum http_parser_type type)
@@ -223,15 +223,65 @@ NODE_DEPRECATED("Use ThrowUVException(isolate)",
   return ThrowUVException(isolate, errorno, syscall, message, path);
 })
 
+// Counters kept by every ArrayBufferAllocator, exposed to JS through
+// process.binding('buffer').getAllocatorStatistics().  The pool and huge
+// page counters are only updated by PooledArrayBufferAllocator.
+#define ARRAY_BUFFER_ALLOCATOR_STATISTICS(V)                                  \
+  V(kAllocations, allocations)                                                \
+  V(kFrees, frees)                                                            \
+  V(kPoolHits, poolHits)                                                      \
+  V(kPoolMisses, poolMisses)                                                  \
+  V(kPoolFallbacks, poolFallbacks)                                            \
+  V(kPoolSlabBytes, poolSlabBytes)                                            \
+  V(kPoolFreeBytes, poolFreeBytes)                                            \
+  V(kHugePageAllocations, hugePageAllocations)                                \
+  V(kHugePageBytes, hugePageBytes)
+
 class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
  public:
-  ArrayBufferAllocator() : env_(nullptr) { }
+  enum Statistics {
+#define V(index, _) index,
+    ARRAY_BUFFER_ALLOCATOR_STATISTICS(V)
+#undef V
+    kStatisticsCount
+  };
+
+  ArrayBufferAllocator() : env_(nullptr) {
+    for (int i = 0; i < kStatisticsCount; i += 1)
+      statistics_[i] = 0;
+  }
+
+  // Creates the allocator selected with --buffer-allocator.
+  static ArrayBufferAllocator* New();  // Defined in src/node.cc
 
   inline void set_env(Environment* env) { env_ = env; }
+  inline const double* statistics() const { return statistics_; }
+
+  virtual void* Allocate(size_t size) {
+    statistics_[kAllocations] += 1;
+    return ShouldZeroFill() ? calloc(size, 1) : malloc(size);
+  }
+
+  virtual void* AllocateUninitialized(size_t size) {
+    statistics_[kAllocations] += 1;
+    return malloc(size);
+  }
 
-  virtual void* Allocate(size_t size);  // Defined in src/node.cc
-  virtual void* AllocateUninitialized(size_t size) { return malloc(size); }
-  virtual void Free(void* data, size_t) { free(data); }
+  virtual void Free(void* data, size_t) {
+    statistics_[kFrees] += 1;
+    free(data);
+  }
+
+  // Whether |data|, allocated by this allocator, is plain malloc() memory
+  // that can be handed to the allocator of another isolate.
+  virtual bool IsMalloced(const void* data) const { return true; }
+
+ protected:
+  // Consumes the one-shot no-zero-fill flag that lib/buffer.js sets right
+  // before allocating memory that it's going to overwrite anyway.
+  bool ShouldZeroFill();  // Defined in src/node.cc
+
+  double statistics_[kStatisticsCount];
 
  private:
   Environment* env_;
@@ -242,8 +292,17 @@ class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
 // by clearing all callbacks that could handle the error.
 void ClearFatalExceptionHandlers(Environment* env);
 
+// The platform V8 was initialized with.  Bindings use it to run work on the
+// platform's worker threads.
+class NodePlatform;
+NodePlatform* GetNodePlatform();
+
 enum NodeInstanceType { MAIN, WORKER };
 
+namespace worker {
+class Worker;
+}  // namespace worker
+
 class NodeInstanceData {
   public:
     NodeInstanceData(NodeInstanceType node_instance_type,
@@ -252,7 +311,8 @@ class NodeInstanceData {
                      const char** argv,
                      int exec_argc,
                      const char** exec_argv,
-                     bool use_debug_agent_flag)
+                     bool use_debug_agent_flag,
+                     worker::Worker* worker = nullptr)
         : node_instance_type_(node_instance_type),
           exit_code_(1),
           event_loop_(event_loop),
@@ -260,8 +320,10 @@ class NodeInstanceData {
           argv_(argv),
           exec_argc_(exec_argc),
           exec_argv_(exec_argv),
-          use_debug_agent_flag_(use_debug_agent_flag) {
+          use_debug_agent_flag_(use_debug_agent_flag),
+          worker_(worker) {
       CHECK_NE(event_loop_, nullptr);
+      CHECK_EQ(is_worker(), worker_ != nullptr);
     }
 
     uv_loop_t* event_loop() const {
@@ -269,12 +331,10 @@ class NodeInstanceData {
     }
 
     int exit_code() {
-      CHECK(is_main());
       return exit_code_;
     }
 
     void set_exit_code(int exit_code) {
-      CHECK(is_main());
       exit_code_ = exit_code;
     }
 
@@ -306,6 +366,10 @@ class NodeInstanceData {
       return is_main() && use_debug_agent_flag_;
     }
 
+    worker::Worker* worker() {
+      return worker_;
+    }
+
   private:
     const NodeInstanceType node_instance_type_;
     int exit_code_;
@@ -315,10 +379,16 @@ class NodeInstanceData {
     const int exec_argc_;
     const char** exec_argv_;
     const bool use_debug_agent_flag_;
+    worker::Worker* const worker_;
 
     DISALLOW_COPY_AND_ASSIGN(NodeInstanceData);
 };
 
+// Runs a node instance on the calling thread until its event loop is done,
+// |arg| is a NodeInstanceData.  The main thread and worker threads both
+// start here.
+void StartNodeInstance(void* arg);
+
 namespace Buffer {
 v8::MaybeLocal<v8::Object> Copy(Environment* env, const char* data, size_t len);
 v8::MaybeLocal<v8::Object> New(Environment* env, size_t size);
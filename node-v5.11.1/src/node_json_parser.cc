@@ -0,0 +1,779 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <utility>  // std::pair
+#include <vector>
+
+namespace node {
+
+using v8::Array;
+using v8::Boolean;
+using v8::Context;
+using v8::Exception;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Null;
+using v8::Number;
+using v8::Object;
+using v8::Persistent;
+using v8::String;
+using v8::Undefined;
+using v8::Value;
+
+
+// Incremental JSON parser that works on UTF-8 bytes as they arrive, so a
+// document never has to be assembled into a single string.  The state
+// machine survives chunk boundaries anywhere, including in the middle of a
+// string, escape sequence, number or literal.
+//
+// The parser runs in one of two modes:
+//
+//  - Values: every value that completes at nesting depth |emit_depth| is
+//    returned to JS as a (key, value) pair, where key is the array index or
+//    object key of the value in its parent.  Containers above that depth are
+//    validated but never materialized, so e.g. the elements of a huge
+//    top-level array can be consumed one at a time.
+//  - Tokens: nothing is materialized except for keys and scalars; each
+//    token is returned as a (type, value) pair.
+//
+// Any number of whitespace separated top-level values is accepted, which
+// covers newline-delimited JSON as well.
+class JSONParser : public BaseObject {
+ public:
+  enum TokenType {
+    kStartObject,
+    kEndObject,
+    kStartArray,
+    kEndArray,
+    kKey,
+    kValue
+  };
+
+  ~JSONParser() override {
+    partial_.Reset();
+  }
+
+  static void Initialize(Local<Object> target,
+                         Local<Value> unused,
+                         Local<Context> context);
+
+ private:
+  enum State {
+    kExpectValue,       // Any value.
+    kExpectValueOrEnd,  // After '['.
+    kExpectKeyOrEnd,    // After '{'.
+    kExpectKey,         // After ',' in an object.
+    kExpectColon,
+    kExpectCommaOrEnd,
+    kInString,
+    kInStringEscape,
+    kInStringUnicode,
+    kInNumber,
+    kInLiteral
+  };
+
+  // Escaped surrogates that aren't part of a pair, with the offset in the
+  // UTF-8 text that they go to.  UTF-8 can't carry them.
+  typedef std::vector<std::pair<size_t, uint16_t>> LoneSurrogates;
+
+  struct Frame {
+    bool is_object;
+    bool build;       // Container is materialized.
+    uint32_t length;  // Elements seen so far, arrays only.
+    std::string key;  // Key of the current member, objects only.
+    LoneSurrogates key_surrogates;
+  };
+
+  JSONParser(Environment* env,
+             Local<Object> wrap,
+             size_t emit_depth,
+             bool emit_tokens)
+      : BaseObject(env, wrap),
+        emit_depth_(emit_depth),
+        emit_tokens_(emit_tokens),
+        state_(kExpectValue),
+        string_is_key_(false),
+        unicode_digits_(0),
+        unicode_unit_(0),
+        pending_high_surrogate_(0),
+        literal_(nullptr),
+        literal_index_(0),
+        position_(0),
+        top_level_count_(0),
+        failed_(false),
+        results_length_(0) {
+    MakeWeak<JSONParser>(this);
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Execute(const FunctionCallbackInfo<Value>& args);
+  static void Finish(const FunctionCallbackInfo<Value>& args);
+
+  // Both return the results as an array, or a SyntaxError.
+  Local<Value> Execute(const char* data, size_t length);
+  Local<Value> Finish();
+
+  void Begin();
+  Local<Value> End();
+
+  bool Fail(const char* message);
+  bool FailAt(unsigned char c);
+
+  void Push(Local<Value> key_or_type, Local<Value> value);
+  void PushToken(TokenType type, Local<Value> value);
+  inline bool Materialize() const;
+  void AddValue(Local<Value> value);
+  void ValueDone();
+  void StartContainer(bool is_object);
+  bool EndContainer(bool is_object);
+  void EndString();
+  bool EndNumber();
+  void AppendCodePoint(uint32_t code_point);
+  void AppendLoneSurrogate(uint16_t unit);
+  void FlushSurrogate();
+  Local<String> NewString(const std::string& text,
+                          const LoneSurrogates& surrogates,
+                          String::NewStringType type);
+
+  const size_t emit_depth_;
+  const bool emit_tokens_;
+
+  State state_;
+  std::vector<Frame> stack_;
+
+  std::string string_;
+  LoneSurrogates string_surrogates_;
+  bool string_is_key_;
+  int unicode_digits_;
+  uint16_t unicode_unit_;
+  uint16_t pending_high_surrogate_;
+  std::string number_;
+  const char* literal_;
+  size_t literal_index_;
+
+  uint64_t position_;
+  double top_level_count_;
+  bool failed_;
+  std::string error_;
+
+  // Only valid during a call to Execute() or Finish().
+  std::vector<Local<Object>> containers_;
+  Local<Array> results_;
+  uint32_t results_length_;
+
+  // Materialized containers that are still open between calls.
+  Persistent<Array> partial_;
+};
+
+
+void JSONParser::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  Environment* env = Environment::GetCurrent(args);
+  // new JSONParser(depth) emits values, new JSONParser(-1) emits tokens.
+  const int64_t depth = args[0]->IntegerValue();
+  if (depth < 0)
+    new JSONParser(env, args.This(), SIZE_MAX, true);
+  else
+    new JSONParser(env, args.This(), static_cast<size_t>(depth), false);
+}
+
+
+void JSONParser::Execute(const FunctionCallbackInfo<Value>& args) {
+  JSONParser* parser = Unwrap<JSONParser>(args.Holder());
+  CHECK(Buffer::HasInstance(args[0]));
+  Local<Object> buffer = args[0].As<Object>();
+  args.GetReturnValue().Set(
+      parser->Execute(Buffer::Data(buffer), Buffer::Length(buffer)));
+}
+
+
+void JSONParser::Finish(const FunctionCallbackInfo<Value>& args) {
+  JSONParser* parser = Unwrap<JSONParser>(args.Holder());
+  args.GetReturnValue().Set(parser->Finish());
+}
+
+
+void JSONParser::Begin() {
+  Isolate* isolate = env()->isolate();
+  results_ = Array::New(isolate);
+  results_length_ = 0;
+  if (!partial_.IsEmpty()) {
+    Local<Array> partial = PersistentToLocal(isolate, partial_);
+    for (uint32_t i = 0; i < partial->Length(); i += 1)
+      containers_.push_back(partial->Get(i).As<Object>());
+    partial_.Reset();
+  }
+}
+
+
+Local<Value> JSONParser::End() {
+  Isolate* isolate = env()->isolate();
+  if (!containers_.empty() && !failed_) {
+    Local<Array> partial = Array::New(isolate, containers_.size());
+    for (size_t i = 0; i < containers_.size(); i += 1)
+      partial->Set(i, containers_[i]);
+    partial_.Reset(isolate, partial);
+  }
+  containers_.clear();
+
+  Local<Value> result = results_;
+  results_ = Local<Array>();
+  if (failed_) {
+    result = Exception::SyntaxError(
+        String::NewFromUtf8(isolate, error_.c_str()));
+  }
+  return result;
+}
+
+
+bool JSONParser::Fail(const char* message) {
+  failed_ = true;
+  error_ = message;
+  return false;
+}
+
+
+bool JSONParser::FailAt(unsigned char c) {
+  char message[96];
+  if (c >= 0x20 && c < 0x7f) {
+    snprintf(message, sizeof(message),
+             "Unexpected token %c in JSON at position %llu",
+             c, static_cast<unsigned long long>(position_));  // NOLINT
+  } else {
+    snprintf(message, sizeof(message),
+             "Unexpected byte 0x%02x in JSON at position %llu",
+             c, static_cast<unsigned long long>(position_));  // NOLINT
+  }
+  return Fail(message);
+}
+
+
+void JSONParser::Push(Local<Value> key_or_type, Local<Value> value) {
+  results_->Set(results_length_++, key_or_type);
+  results_->Set(results_length_++, value);
+}
+
+
+void JSONParser::PushToken(TokenType type, Local<Value> value) {
+  Push(Integer::New(env()->isolate(), type), value);
+}
+
+
+// Whether the value that's being parsed needs to exist as a JS value.
+inline bool JSONParser::Materialize() const {
+  return emit_tokens_ || stack_.size() >= emit_depth_;
+}
+
+
+// |value| is empty if it wasn't materialized.
+void JSONParser::AddValue(Local<Value> value) {
+  Isolate* isolate = env()->isolate();
+
+  if (stack_.empty()) {
+    if (emit_depth_ == 0)
+      Push(Number::New(isolate, top_level_count_), value);
+    top_level_count_ += 1;
+    return;
+  }
+
+  Frame& frame = stack_.back();
+  Local<String> key;
+  if (frame.is_object && (frame.build || stack_.size() == emit_depth_)) {
+    key = NewString(frame.key,
+                    frame.key_surrogates,
+                    String::kInternalizedString);
+  }
+
+  if (stack_.size() == emit_depth_) {
+    if (frame.is_object)
+      Push(key, value);
+    else
+      Push(Integer::NewFromUnsigned(isolate, frame.length), value);
+  } else if (frame.build) {
+    Local<Context> context = env()->context();
+    Local<Object> container = containers_.back();
+    if (frame.is_object)
+      container->CreateDataProperty(context, key, value).FromJust();
+    else
+      container->CreateDataProperty(context, frame.length, value).FromJust();
+  }
+  frame.length += 1;
+}
+
+
+void JSONParser::ValueDone() {
+  state_ = stack_.empty() ? kExpectValue : kExpectCommaOrEnd;
+}
+
+
+void JSONParser::StartContainer(bool is_object) {
+  Isolate* isolate = env()->isolate();
+  if (emit_tokens_)
+    PushToken(is_object ? kStartObject : kStartArray, Undefined(isolate));
+
+  Frame frame;
+  frame.is_object = is_object;
+  frame.build = !emit_tokens_ && stack_.size() >= emit_depth_;
+  frame.length = 0;
+  if (frame.build) {
+    if (is_object)
+      containers_.push_back(Object::New(isolate));
+    else
+      containers_.push_back(Array::New(isolate));
+  }
+  stack_.push_back(frame);
+  state_ = is_object ? kExpectKeyOrEnd : kExpectValueOrEnd;
+}
+
+
+bool JSONParser::EndContainer(bool is_object) {
+  if (stack_.back().is_object != is_object)
+    return FailAt(is_object ? '}' : ']');
+
+  const bool build = stack_.back().build;
+  stack_.pop_back();
+  if (emit_tokens_)
+    PushToken(is_object ? kEndObject : kEndArray, Undefined(env()->isolate()));
+
+  Local<Value> value;
+  if (build) {
+    value = containers_.back();
+    containers_.pop_back();
+  }
+  AddValue(value);
+  ValueDone();
+  return true;
+}
+
+
+void JSONParser::EndString() {
+  FlushSurrogate();
+  if (string_is_key_) {
+    if (emit_tokens_) {
+      PushToken(kKey, NewString(string_,
+                                string_surrogates_,
+                                String::kNormalString));
+    }
+    stack_.back().key.swap(string_);
+    stack_.back().key_surrogates.swap(string_surrogates_);
+    state_ = kExpectColon;
+  } else {
+    Local<Value> value;
+    if (Materialize()) {
+      value = NewString(string_, string_surrogates_, String::kNormalString);
+    }
+    if (emit_tokens_)
+      PushToken(kValue, value);
+    else
+      AddValue(value);
+    ValueDone();
+  }
+  string_.clear();
+  string_surrogates_.clear();
+}
+
+
+static bool IsValidNumber(const std::string& s) {
+  size_t i = 0;
+  const size_t n = s.size();
+  if (i < n && s[i] == '-')
+    i += 1;
+  if (i == n)
+    return false;
+  if (s[i] == '0') {
+    i += 1;
+  } else if (s[i] >= '1' && s[i] <= '9') {
+    while (i < n && s[i] >= '0' && s[i] <= '9')
+      i += 1;
+  } else {
+    return false;
+  }
+  if (i < n && s[i] == '.') {
+    i += 1;
+    if (i == n || s[i] < '0' || s[i] > '9')
+      return false;
+    while (i < n && s[i] >= '0' && s[i] <= '9')
+      i += 1;
+  }
+  if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+    i += 1;
+    if (i < n && (s[i] == '+' || s[i] == '-'))
+      i += 1;
+    if (i == n || s[i] < '0' || s[i] > '9')
+      return false;
+    while (i < n && s[i] >= '0' && s[i] <= '9')
+      i += 1;
+  }
+  return i == n;
+}
+
+
+bool JSONParser::EndNumber() {
+  if (!IsValidNumber(number_))
+    return Fail("Invalid number in JSON");
+
+  Local<Value> value;
+  if (Materialize()) {
+    Isolate* isolate = env()->isolate();
+    // Small integers are common enough to skip strtod() for.  -0 isn't an
+    // integer as far as JS is concerned.
+    const bool negative = number_[0] == '-';
+    const size_t digits = number_.size() - negative;
+    if (digits <= 9 &&
+        number_.find_first_of(".eE") == std::string::npos &&
+        !(negative && number_[1] == '0')) {
+      int32_t n = 0;
+      for (size_t i = negative; i < number_.size(); i += 1)
+        n = n * 10 + (number_[i] - '0');
+      value = Integer::New(isolate, negative ? -n : n);
+    } else {
+      value = Number::New(isolate, strtod(number_.c_str(), nullptr));
+    }
+  }
+  number_.clear();
+
+  if (emit_tokens_)
+    PushToken(kValue, value);
+  else
+    AddValue(value);
+  ValueDone();
+  return true;
+}
+
+
+void JSONParser::AppendCodePoint(uint32_t c) {
+  if (c < 0x80) {
+    string_ += static_cast<char>(c);
+  } else if (c < 0x800) {
+    string_ += static_cast<char>(0xC0 | (c >> 6));
+    string_ += static_cast<char>(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    string_ += static_cast<char>(0xE0 | (c >> 12));
+    string_ += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    string_ += static_cast<char>(0x80 | (c & 0x3F));
+  } else {
+    string_ += static_cast<char>(0xF0 | (c >> 18));
+    string_ += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+    string_ += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    string_ += static_cast<char>(0x80 | (c & 0x3F));
+  }
+}
+
+
+// V8's UTF-8 decoder turns a surrogate encoded on its own into U+FFFD, so it
+// is kept aside and put into the string as a UTF-16 code unit.
+void JSONParser::AppendLoneSurrogate(uint16_t unit) {
+  string_surrogates_.push_back(std::make_pair(string_.size(), unit));
+}
+
+
+// Writes out a high surrogate escape that wasn't followed by a low one.
+void JSONParser::FlushSurrogate() {
+  if (pending_high_surrogate_ != 0) {
+    AppendLoneSurrogate(pending_high_surrogate_);
+    pending_high_surrogate_ = 0;
+  }
+}
+
+
+Local<String> JSONParser::NewString(const std::string& text,
+                                    const LoneSurrogates& surrogates,
+                                    String::NewStringType type) {
+  Isolate* isolate = env()->isolate();
+  if (surrogates.empty())
+    return String::NewFromUtf8(isolate, text.data(), type, text.size());
+
+  // Rare enough to be put together piece by piece.
+  Local<String> result = String::Empty(isolate);
+  size_t start = 0;
+  for (size_t i = 0; i < surrogates.size(); i++) {
+    const size_t offset = surrogates[i].first;
+    const uint16_t unit = surrogates[i].second;
+    result = String::Concat(result,
+                            String::NewFromUtf8(isolate,
+                                                text.data() + start,
+                                                String::kNormalString,
+                                                offset - start));
+    result = String::Concat(result,
+                            String::NewFromTwoByte(isolate,
+                                                   &unit,
+                                                   String::kNormalString,
+                                                   1));
+    start = offset;
+  }
+  return String::Concat(result,
+                        String::NewFromUtf8(isolate,
+                                            text.data() + start,
+                                            String::kNormalString,
+                                            text.size() - start));
+}
+
+
+static inline bool IsWhitespace(unsigned char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+
+static inline int HexValue(unsigned char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+
+Local<Value> JSONParser::Execute(const char* data, size_t length) {
+  Begin();
+
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+  const unsigned char* const end = p + length;
+
+  while (p < end && !failed_) {
+    const unsigned char c = *p;
+
+    switch (state_) {
+      case kInString: {
+        // Copy runs of plain characters in one go.
+        const unsigned char* run = p;
+        while (p < end && *p != '"' && *p != '\\' && *p >= 0x20)
+          p += 1;
+        if (p > run) {
+          FlushSurrogate();
+          string_.append(reinterpret_cast<const char*>(run), p - run);
+          position_ += p - run;
+          continue;
+        }
+        if (c == '"')
+          EndString();
+        else if (c == '\\')
+          state_ = kInStringEscape;
+        else
+          FailAt(c);
+        break;
+      }
+
+      case kInStringEscape: {
+        char unescaped = 0;
+        switch (c) {
+          case '"': unescaped = '"'; break;
+          case '\\': unescaped = '\\'; break;
+          case '/': unescaped = '/'; break;
+          case 'b': unescaped = '\b'; break;
+          case 'f': unescaped = '\f'; break;
+          case 'n': unescaped = '\n'; break;
+          case 'r': unescaped = '\r'; break;
+          case 't': unescaped = '\t'; break;
+          case 'u':
+            unicode_digits_ = 0;
+            unicode_unit_ = 0;
+            state_ = kInStringUnicode;
+            break;
+          default:
+            FailAt(c);
+            break;
+        }
+        if (unescaped != 0) {
+          FlushSurrogate();
+          string_ += unescaped;
+          state_ = kInString;
+        }
+        break;
+      }
+
+      case kInStringUnicode: {
+        const int digit = HexValue(c);
+        if (digit < 0) {
+          FailAt(c);
+          break;
+        }
+        unicode_unit_ = (unicode_unit_ << 4) | digit;
+        if (++unicode_digits_ < 4)
+          break;
+        state_ = kInString;
+        const uint16_t unit = unicode_unit_;
+        if (pending_high_surrogate_ != 0 && unit >= 0xDC00 && unit <= 0xDFFF) {
+          AppendCodePoint(0x10000 +
+                          ((pending_high_surrogate_ - 0xD800) << 10) +
+                          (unit - 0xDC00));
+          pending_high_surrogate_ = 0;
+        } else {
+          FlushSurrogate();
+          if (unit >= 0xD800 && unit <= 0xDBFF)
+            pending_high_surrogate_ = unit;
+          else if (unit >= 0xDC00 && unit <= 0xDFFF)
+            AppendLoneSurrogate(unit);
+          else
+            AppendCodePoint(unit);
+        }
+        break;
+      }
+
+      case kInNumber: {
+        const unsigned char* run = p;
+        while (p < end && ((*p >= '0' && *p <= '9') ||
+                           *p == '-' || *p == '+' || *p == '.' ||
+                           *p == 'e' || *p == 'E')) {
+          p += 1;
+        }
+        number_.append(reinterpret_cast<const char*>(run), p - run);
+        position_ += p - run;
+        // The number continues in the next chunk.
+        if (p == end)
+          continue;
+        // The delimiter is handled in the state that follows the number.
+        EndNumber();
+        continue;
+      }
+
+      case kInLiteral:
+        if (c != static_cast<unsigned char>(literal_[literal_index_])) {
+          FailAt(c);
+          break;
+        }
+        if (literal_[++literal_index_] == '\0') {
+          Local<Value> value;
+          if (Materialize()) {
+            Isolate* isolate = env()->isolate();
+            if (literal_[0] == 'n')
+              value = Null(isolate);
+            else
+              value = Boolean::New(isolate, literal_[0] == 't');
+          }
+          if (emit_tokens_)
+            PushToken(kValue, value);
+          else
+            AddValue(value);
+          ValueDone();
+        }
+        break;
+
+      case kExpectKeyOrEnd:
+      case kExpectKey:
+        if (IsWhitespace(c))
+          break;
+        if (c == '"') {
+          string_is_key_ = true;
+          state_ = kInString;
+        } else if (c == '}' && state_ == kExpectKeyOrEnd) {
+          EndContainer(true);
+        } else {
+          FailAt(c);
+        }
+        break;
+
+      case kExpectColon:
+        if (IsWhitespace(c))
+          break;
+        if (c == ':')
+          state_ = kExpectValue;
+        else
+          FailAt(c);
+        break;
+
+      case kExpectCommaOrEnd:
+        if (IsWhitespace(c))
+          break;
+        if (c == ',')
+          state_ = stack_.back().is_object ? kExpectKey : kExpectValue;
+        else if (c == '}' || c == ']')
+          EndContainer(c == '}');
+        else
+          FailAt(c);
+        break;
+
+      case kExpectValueOrEnd:
+      case kExpectValue:
+        if (IsWhitespace(c))
+          break;
+        if (c == ']' && state_ == kExpectValueOrEnd) {
+          EndContainer(false);
+        } else if (c == '{' || c == '[') {
+          StartContainer(c == '{');
+        } else if (c == '"') {
+          string_is_key_ = false;
+          state_ = kInString;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+          state_ = kInNumber;
+          continue;
+        } else if (c == 't' || c == 'f' || c == 'n') {
+          literal_ = c == 't' ? "true" : c == 'f' ? "false" : "null";
+          literal_index_ = 1;
+          state_ = kInLiteral;
+        } else {
+          FailAt(c);
+        }
+        break;
+    }
+
+    if (!failed_) {
+      p += 1;
+      position_ += 1;
+    }
+  }
+
+  return End();
+}
+
+
+Local<Value> JSONParser::Finish() {
+  Begin();
+  if (!failed_) {
+    // A number can only end with the input at the top level, anywhere else
+    // the missing closing bracket is caught below.
+    if (state_ == kInNumber)
+      EndNumber();
+    if (!failed_ && (state_ != kExpectValue || !stack_.empty()))
+      Fail("Unexpected end of JSON input");
+  }
+  return End();
+}
+
+
+void JSONParser::Initialize(Local<Object> target,
+                            Local<Value> unused,
+                            Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  Isolate* isolate = env->isolate();
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(isolate, "JSONParser"));
+
+  env->SetProtoMethod(t, "execute", Execute);
+  env->SetProtoMethod(t, "finish", Finish);
+
+#define V(name)                                                               \
+  t->Set(FIXED_ONE_BYTE_STRING(isolate, #name), Integer::New(isolate, name));
+  V(kStartObject)
+  V(kEndObject)
+  V(kStartArray)
+  V(kEndArray)
+  V(kKey)
+  V(kValue)
+#undef V
+
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, "JSONParser"), t->GetFunction());
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(json_parser, node::JSONParser::Initialize)
@@ -0,0 +1,606 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace node {
+
+using v8::Array;
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::String;
+using v8::Value;
+
+
+// Growable output for JSONStringifier.  In contiguous mode everything goes
+// into one malloc()'d block that is grown with realloc().  In chunked mode
+// the output is a list of blocks of about kChunkSize bytes each, which
+// avoids the copies that come with growing a large block and can be handed
+// to writev() as-is.
+class JSONOutput {
+ public:
+  static const size_t kChunkSize = 64 * 1024;
+
+  struct Mark {
+    size_t chunk;
+    size_t length;
+  };
+
+  explicit JSONOutput(bool chunked) : chunked_(chunked) {}
+
+  ~JSONOutput() {
+    for (size_t i = 0; i < chunks_.size(); i += 1)
+      free(chunks_[i].data);
+  }
+
+  // Returns a pointer to at least |size| writable bytes.  Commit the bytes
+  // that were actually written with Advance().
+  inline char* Reserve(size_t size) {
+    if (chunks_.empty() ||
+        chunks_.back().capacity - chunks_.back().length < size) {
+      Grow(size);
+    }
+    return chunks_.back().data + chunks_.back().length;
+  }
+
+  inline void Advance(size_t size) {
+    chunks_.back().length += size;
+  }
+
+  inline void Append(const char* data, size_t size) {
+    memcpy(Reserve(size), data, size);
+    Advance(size);
+  }
+
+  inline void Append(char c) {
+    *Reserve(1) = c;
+    Advance(1);
+  }
+
+  inline Mark GetMark() const {
+    Mark mark = { chunks_.size(), 0 };
+    if (!chunks_.empty())
+      mark.length = chunks_.back().length;
+    return mark;
+  }
+
+  // Drops everything written after |mark| was taken.
+  void Rewind(const Mark& mark) {
+    while (chunks_.size() > mark.chunk && chunks_.size() > 1) {
+      free(chunks_.back().data);
+      chunks_.pop_back();
+    }
+    if (!chunks_.empty())
+      chunks_.back().length = mark.chunk == 0 ? 0 : mark.length;
+  }
+
+  // Moves the output into Buffer objects.  Returns false on allocation
+  // failure.
+  bool Release(Environment* env, std::vector<Local<Object> >* buffers) {
+    for (size_t i = 0; i < chunks_.size(); i += 1) {
+      Chunk* chunk = &chunks_[i];
+      if (chunk->length == 0) {
+        free(chunk->data);
+        chunk->data = nullptr;
+        continue;
+      }
+      // Give back the unused tail.
+      if (chunk->length < chunk->capacity) {
+        char* data = static_cast<char*>(realloc(chunk->data, chunk->length));
+        if (data != nullptr)
+          chunk->data = data;
+      }
+      Local<Object> buffer;
+      if (!Buffer::New(env, chunk->data, chunk->length).ToLocal(&buffer))
+        return false;
+      chunk->data = nullptr;  // Owned by |buffer| now.
+      buffers->push_back(buffer);
+    }
+    chunks_.clear();
+    return true;
+  }
+
+ private:
+  struct Chunk {
+    char* data;
+    size_t length;
+    size_t capacity;
+  };
+
+  void Grow(size_t size) {
+    if (!chunked_ && !chunks_.empty()) {
+      Chunk* chunk = &chunks_.back();
+      size_t capacity = chunk->capacity * 2;
+      while (capacity - chunk->length < size)
+        capacity *= 2;
+      chunk->data = static_cast<char*>(realloc(chunk->data, capacity));
+      CHECK_NE(chunk->data, nullptr);
+      chunk->capacity = capacity;
+      return;
+    }
+    // Strings that don't fit in a chunk get a chunk of their own size.
+    Chunk chunk;
+    chunk.capacity = size > kChunkSize ? size : kChunkSize;
+    chunk.length = 0;
+    chunk.data = static_cast<char*>(malloc(chunk.capacity));
+    CHECK_NE(chunk.data, nullptr);
+    chunks_.push_back(chunk);
+  }
+
+  const bool chunked_;
+  std::vector<Chunk> chunks_;
+};
+
+
+// JSON.stringify() that writes UTF-8 straight into Buffer memory instead of
+// building a string that then has to be encoded.  Follows the algorithm of
+// ES2015 24.3.2: toJSON(), replacer functions and property lists, boxed
+// primitives, and indentation all work the same.  The replacer and gap
+// arguments are normalized in lib/json_stream.js.
+class JSONStringifier {
+ public:
+  enum Result { kSuccess, kUndefined, kException };
+
+  JSONStringifier(Environment* env,
+                  Local<Function> replacer,
+                  Local<Array> property_list,
+                  const std::string& gap,
+                  bool chunked)
+      : env_(env),
+        isolate_(env->isolate()),
+        context_(env->context()),
+        replacer_(replacer),
+        property_list_(property_list),
+        gap_(gap),
+        output_(chunked) {
+  }
+
+  Result Stringify(Local<Value> value) {
+    Local<Object> wrapper = Object::New(isolate_);
+    Local<String> empty = String::Empty(isolate_);
+    if (!replacer_.IsEmpty()) {
+      if (wrapper->CreateDataProperty(context_, empty, value).IsNothing())
+        return kException;
+    }
+    return SerializeProperty(wrapper, empty, value);
+  }
+
+  JSONOutput* output() { return &output_; }
+
+ private:
+  // |key| is the property name of |value| in |holder|; it's only converted
+  // to a string when toJSON() or the replacer needs it.
+  Result SerializeProperty(Local<Object> holder,
+                           Local<Value> key,
+                           Local<Value> value);
+  Result SerializeObject(Local<Object> object);
+  Result SerializeArray(Local<Array> array);
+  Result SerializeMember(Local<Object> object,
+                         Local<String> key,
+                         bool* first);
+  void WriteNewline();
+  void WriteString(Local<String> string);
+  template <typename Char>
+  void WriteEscapedString(const Char* units, size_t length);
+  bool WriteNumber(Local<Value> number);
+  bool Enter(Local<Object> object);
+  void Leave();
+
+  Environment* const env_;
+  Isolate* const isolate_;
+  Local<Context> context_;
+  Local<Function> replacer_;
+  Local<Array> property_list_;
+  const std::string gap_;
+  std::string indent_;
+  JSONOutput output_;
+  std::vector<Local<Object> > stack_;
+  std::vector<uint8_t> one_byte_scratch_;
+  std::vector<uint16_t> scratch_;
+};
+
+
+static Local<String> KeyToString(Isolate* isolate, Local<Value> key) {
+  if (key->IsString())
+    return key.As<String>();
+  // Array indices.
+  return key->ToString(isolate);
+}
+
+
+JSONStringifier::Result JSONStringifier::SerializeProperty(
+    Local<Object> holder,
+    Local<Value> key,
+    Local<Value> value) {
+  if (value->IsObject()) {
+    Local<Object> object = value.As<Object>();
+    Local<Value> to_json;
+    if (!object->Get(context_, env_->to_json_string()).ToLocal(&to_json))
+      return kException;
+    if (to_json->IsFunction()) {
+      Local<Value> argv[] = { KeyToString(isolate_, key) };
+      if (!to_json.As<Function>()->Call(context_, object, 1, argv)
+              .ToLocal(&value)) {
+        return kException;
+      }
+    }
+  }
+
+  if (!replacer_.IsEmpty()) {
+    Local<Value> argv[] = { KeyToString(isolate_, key), value };
+    if (!replacer_->Call(context_, holder, 2, argv).ToLocal(&value))
+      return kException;
+  }
+
+  if (value->IsNumberObject()) {
+    Local<Value> number;
+    if (!value->ToNumber(context_).ToLocal(&number))
+      return kException;
+    value = number;
+  } else if (value->IsStringObject()) {
+    Local<String> string;
+    if (!value->ToString(context_).ToLocal(&string))
+      return kException;
+    value = string;
+  } else if (value->IsBooleanObject()) {
+    value = v8::Boolean::New(isolate_,
+                             value.As<v8::BooleanObject>()->ValueOf());
+  }
+
+  if (value->IsNull()) {
+    output_.Append("null", 4);
+  } else if (value->IsTrue()) {
+    output_.Append("true", 4);
+  } else if (value->IsFalse()) {
+    output_.Append("false", 5);
+  } else if (value->IsString()) {
+    WriteString(value.As<String>());
+  } else if (value->IsNumber()) {
+    if (!WriteNumber(value))
+      return kException;
+  } else if (value->IsArray()) {
+    return SerializeArray(value.As<Array>());
+  } else if (value->IsObject() && !value->IsFunction()) {
+    return SerializeObject(value.As<Object>());
+  } else {
+    // undefined, functions and symbols.
+    return kUndefined;
+  }
+  return kSuccess;
+}
+
+
+bool JSONStringifier::Enter(Local<Object> object) {
+  // Recursion happens on the C++ stack, stop where V8 would.  V8 reports
+  // its own overflows for toJSON() and replacer calls.
+  char here;
+  if (reinterpret_cast<uintptr_t>(&here) < env_->stack_limit()) {
+    env_->ThrowRangeError("Maximum call stack size exceeded");
+    return false;
+  }
+  for (size_t i = 0; i < stack_.size(); i += 1) {
+    if (stack_[i] == object) {
+      env_->ThrowTypeError("Converting circular structure to JSON");
+      return false;
+    }
+  }
+  stack_.push_back(object);
+  indent_ += gap_;
+  return true;
+}
+
+
+void JSONStringifier::Leave() {
+  stack_.pop_back();
+  indent_.resize(indent_.size() - gap_.size());
+}
+
+
+void JSONStringifier::WriteNewline() {
+  output_.Append('\n');
+  output_.Append(indent_.data(), indent_.size());
+}
+
+
+JSONStringifier::Result JSONStringifier::SerializeMember(Local<Object> object,
+                                                         Local<String> key,
+                                                         bool* first) {
+  Local<Value> value;
+  if (!object->Get(context_, key).ToLocal(&value))
+    return kException;
+
+  const JSONOutput::Mark mark = output_.GetMark();
+  if (!*first)
+    output_.Append(',');
+  if (!gap_.empty())
+    WriteNewline();
+  WriteString(key);
+  output_.Append(':');
+  if (!gap_.empty())
+    output_.Append(' ');
+
+  const Result result = SerializeProperty(object, key, value);
+  if (result == kUndefined)
+    output_.Rewind(mark);
+  else if (result == kSuccess)
+    *first = false;
+  return result;
+}
+
+
+JSONStringifier::Result JSONStringifier::SerializeObject(Local<Object> object) {
+  if (!Enter(object))
+    return kException;
+
+  Local<Array> keys = property_list_;
+  if (keys.IsEmpty() && !object->GetOwnPropertyNames(context_).ToLocal(&keys))
+    return kException;
+
+  output_.Append('{');
+  bool first = true;
+  const uint32_t length = keys->Length();
+  for (uint32_t i = 0; i < length; i += 1) {
+    HandleScope scope(isolate_);
+    Local<Value> key;
+    if (!keys->Get(context_, i).ToLocal(&key))
+      return kException;
+    Local<String> name;
+    if (!key->ToString(context_).ToLocal(&name))
+      return kException;
+    if (SerializeMember(object, name, &first) == kException)
+      return kException;
+  }
+
+  Leave();
+  if (!first && !gap_.empty())
+    WriteNewline();
+  output_.Append('}');
+  return kSuccess;
+}
+
+
+JSONStringifier::Result JSONStringifier::SerializeArray(Local<Array> array) {
+  if (!Enter(array))
+    return kException;
+
+  output_.Append('[');
+  const uint32_t length = array->Length();
+  for (uint32_t i = 0; i < length; i += 1) {
+    if (i > 0)
+      output_.Append(',');
+    if (!gap_.empty())
+      WriteNewline();
+
+    HandleScope scope(isolate_);
+    Local<Value> element;
+    if (!array->Get(context_, i).ToLocal(&element))
+      return kException;
+    Local<Value> index = Integer::NewFromUnsigned(isolate_, i);
+    const Result result = SerializeProperty(array, index, element);
+    if (result == kException)
+      return kException;
+    if (result == kUndefined)
+      output_.Append("null", 4);
+  }
+
+  Leave();
+  if (length > 0 && !gap_.empty())
+    WriteNewline();
+  output_.Append(']');
+  return kSuccess;
+}
+
+
+bool JSONStringifier::WriteNumber(Local<Value> number) {
+  if (number->IsInt32()) {
+    char buf[16];
+    const int32_t value = number.As<Integer>()->Value();
+    // Work with the magnitude as unsigned so INT32_MIN doesn't overflow.
+    uint32_t magnitude = value < 0 ? 0u - static_cast<uint32_t>(value)
+                                   : static_cast<uint32_t>(value);
+    char* end = buf + sizeof(buf);
+    char* p = end;
+    do {
+      *--p = '0' + magnitude % 10;
+      magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+      *--p = '-';
+    output_.Append(p, end - p);
+    return true;
+  }
+
+  const double value = number.As<v8::Number>()->Value();
+  if (value != value || value - value != 0) {
+    output_.Append("null", 4);  // NaN and the infinities.
+    return true;
+  }
+  // Leave the shortest round-trip representation to V8.
+  Local<String> string;
+  if (!number->ToString(context_).ToLocal(&string))
+    return false;
+  const int length = string->Length();
+  char* data = output_.Reserve(length);
+  string->WriteOneByte(reinterpret_cast<uint8_t*>(data),
+                       0,
+                       length,
+                       String::NO_NULL_TERMINATION);
+  output_.Advance(length);
+  return true;
+}
+
+
+// Returns the number of bytes that EscapeString() writes for |units|.
+template <typename Char>
+static size_t EscapedLength(const Char* units, size_t length) {
+  size_t size = 0;
+  for (size_t i = 0; i < length; i += 1) {
+    const uint16_t c = units[i];
+    if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+      size += 1;
+    } else if (c < 0x80) {
+      const bool is_short = c == '"' || c == '\\' || c == '\b' ||
+                            c == '\f' || c == '\n' || c == '\r' || c == '\t';
+      size += is_short ? 2 : 6;
+    } else if (c < 0x800) {
+      size += 2;
+    } else if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length &&
+               units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+      size += 4;
+      i += 1;
+    } else {
+      size += 3;
+    }
+  }
+  return size;
+}
+
+
+// Escapes |length| code units like JSON.stringify() does and encodes them as
+// UTF-8 at |p|, which must have room for EscapedLength() bytes.  Lone
+// surrogates become U+FFFD, as they would when the result of
+// JSON.stringify() is written to a Buffer.  Returns the end of the output.
+template <typename Char>
+static char* EscapeString(const Char* units, size_t length, char* p) {
+  static const char hex[] = "0123456789abcdef";
+  for (size_t i = 0; i < length; i += 1) {
+    const uint16_t c = units[i];
+    if (c >= 0x20 && c < 0x80 && c != '"' && c != '\\') {
+      *p++ = static_cast<char>(c);
+    } else if (c < 0x80) {
+      *p++ = '\\';
+      switch (c) {
+        case '"': *p++ = '"'; break;
+        case '\\': *p++ = '\\'; break;
+        case '\b': *p++ = 'b'; break;
+        case '\f': *p++ = 'f'; break;
+        case '\n': *p++ = 'n'; break;
+        case '\r': *p++ = 'r'; break;
+        case '\t': *p++ = 't'; break;
+        default:
+          *p++ = 'u';
+          *p++ = '0';
+          *p++ = '0';
+          *p++ = hex[c >> 4];
+          *p++ = hex[c & 15];
+          break;
+      }
+    } else if (c < 0x800) {
+      *p++ = static_cast<char>(0xC0 | (c >> 6));
+      *p++ = static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c >= 0xD800 && c <= 0xDBFF && i + 1 < length &&
+               units[i + 1] >= 0xDC00 && units[i + 1] <= 0xDFFF) {
+      const uint32_t code_point =
+          0x10000 + ((c - 0xD800) << 10) + (units[i + 1] - 0xDC00);
+      *p++ = static_cast<char>(0xF0 | (code_point >> 18));
+      *p++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      *p++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      *p++ = static_cast<char>(0x80 | (code_point & 0x3F));
+      i += 1;
+    } else {
+      const uint16_t u = (c >= 0xD800 && c <= 0xDFFF) ? 0xFFFD : c;
+      *p++ = static_cast<char>(0xE0 | (u >> 12));
+      *p++ = static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+      *p++ = static_cast<char>(0x80 | (u & 0x3F));
+    }
+  }
+  return p;
+}
+
+
+void JSONStringifier::WriteString(Local<String> string) {
+  const size_t length = string->Length();
+  if (string->IsOneByte()) {
+    if (one_byte_scratch_.size() < length)
+      one_byte_scratch_.resize(length);
+    string->WriteOneByte(one_byte_scratch_.data(),
+                         0,
+                         length,
+                         String::NO_NULL_TERMINATION);
+    WriteEscapedString(one_byte_scratch_.data(), length);
+  } else {
+    if (scratch_.size() < length)
+      scratch_.resize(length);
+    string->Write(scratch_.data(), 0, length, String::NO_NULL_TERMINATION);
+    WriteEscapedString(scratch_.data(), length);
+  }
+}
+
+
+// Reserves exactly what the escaped string takes, rather than the six bytes
+// per code unit that a \u00XX escape would need.
+template <typename Char>
+void JSONStringifier::WriteEscapedString(const Char* units, size_t length) {
+  const size_t size = EscapedLength(units, length) + 2;
+  char* const start = output_.Reserve(size);
+  char* p = start;
+  *p++ = '"';
+  p = EscapeString(units, length, p);
+  *p++ = '"';
+  CHECK_EQ(static_cast<size_t>(p - start), size);
+  output_.Advance(size);
+}
+
+
+// stringify(value, replacer, propertyList, gap, chunked) returns a Buffer,
+// or an array of Buffers when |chunked| is true, or undefined if |value|
+// doesn't serialize to anything.
+static void Stringify(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+
+  Local<Function> replacer;
+  if (args[1]->IsFunction())
+    replacer = args[1].As<Function>();
+  Local<Array> property_list;
+  if (args[2]->IsArray())
+    property_list = args[2].As<Array>();
+  CHECK(args[3]->IsString());
+  node::Utf8Value gap(env->isolate(), args[3]);
+  const bool chunked = args[4]->IsTrue();
+
+  JSONStringifier stringifier(env, replacer, property_list, *gap, chunked);
+  const JSONStringifier::Result result = stringifier.Stringify(args[0]);
+  if (result != JSONStringifier::kSuccess)
+    return;  // Either undefined or an exception is pending.
+
+  std::vector<Local<Object> > buffers;
+  if (!stringifier.output()->Release(env, &buffers))
+    return env->ThrowRangeError("Out of memory");
+
+  if (!chunked) {
+    CHECK_EQ(buffers.size(), 1);
+    return args.GetReturnValue().Set(buffers[0]);
+  }
+  Local<Array> array = Array::New(env->isolate(), buffers.size());
+  for (size_t i = 0; i < buffers.size(); i += 1)
+    array->Set(i, buffers[i]);
+  args.GetReturnValue().Set(array);
+}
+
+
+void InitJSONStringifier(Local<Object> target,
+                         Local<Value> unused,
+                         Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "stringify", Stringify);
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(json_stringifier, node::InitJSONStringifier)
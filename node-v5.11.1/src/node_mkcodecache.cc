@@ -0,0 +1,232 @@
+// Host tool that produces V8 code caches for node's core modules.  Invoked
+// by the node_code_cache target in node.gyp:
+//
+//   node_mkcodecache <output.cc> [module id ...]
+//
+// Each module is compiled exactly as NativeModule.prototype.compile() and
+// LoadEnvironment() compile it at run time, with the same source, wrapper
+// and file name, and V8 is asked for the code cache of the result.  At run
+// time the cache is handed back to V8, which then deserializes the compiled
+// code instead of parsing and compiling the source again.
+//
+// The functions inside a module are normally compiled lazily, the first
+// time they are called, and a cache only holds what was compiled when it
+// was produced.  Compiling eagerly here puts the code of every function in
+// the cache, so calling them for the first time doesn't compile either.
+//
+// V8 rejects a cache that was produced with different V8 flags, a different
+// V8 version or for a CPU with different features.  Node then compiles the
+// module from source as usual.
+//
+// Without module ids, all core modules are included.
+
+#include "node_natives.h"
+#include "libplatform/libplatform.h"
+#include "v8.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+namespace node {
+namespace code_cache {
+
+using v8::ArrayBuffer;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::NewStringType;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::String;
+using v8::TryCatch;
+
+static const char kBootstrapId[] = "internal/bootstrap_node";
+
+
+class ArrayBufferAllocator : public ArrayBuffer::Allocator {
+ public:
+  virtual void* Allocate(size_t size) { return calloc(size, 1); }
+  virtual void* AllocateUninitialized(size_t size) { return malloc(size); }
+  virtual void Free(void* data, size_t) { free(data); }
+};
+
+
+static bool IsSelected(const char* id, int argc, char** argv) {
+  if (argc == 0)
+    return true;
+  for (int i = 0; i < argc; i += 1)
+    if (strcmp(id, argv[i]) == 0)
+      return true;
+  return false;
+}
+
+
+// Appends |data| to |out| as the initializer of a uint8_t array.
+static void AppendBytes(std::string* out, const uint8_t* data, int length) {
+  char buf[8];
+  for (int i = 0; i < length; i += 1) {
+    snprintf(buf, sizeof(buf), "%u,", data[i]);
+    out->append(buf);
+    if (i % 32 == 31)
+      out->append("\n");
+  }
+  out->append("\n");
+}
+
+
+// Compiles one module and appends its cache to |data| and its entry in the
+// table to |table|.  Returns false if V8 didn't produce a cache.
+static bool AddModule(Isolate* isolate,
+                      const _native& native,
+                      int index,
+                      std::string* data,
+                      std::string* table) {
+  HandleScope handle_scope(isolate);
+  const bool is_bootstrap = strcmp(native.name, kBootstrapId) == 0;
+
+  // Keep in sync with NativeModule.wrapper in lib/internal/bootstrap_node.js
+  // and with LoadEnvironment() in src/node.cc.  V8 only checks the length of
+  // the source before it uses a cache.
+  std::string code;
+  std::string filename;
+  if (is_bootstrap) {
+    filename = "node.js";
+  } else {
+    code.append("(function (exports, require, module, __filename, "
+                "__dirname) { ");
+    filename = native.name;
+    filename.append(".js");
+  }
+  code.append(reinterpret_cast<const char*>(native.source), native.source_len);
+  if (!is_bootstrap)
+    code.append("\n});");
+
+  Local<String> source =
+      String::NewFromUtf8(isolate, code.data(), NewStringType::kNormal,
+                          static_cast<int>(code.size())).ToLocalChecked();
+  Local<String> name =
+      String::NewFromUtf8(isolate, filename.c_str(), NewStringType::kNormal)
+          .ToLocalChecked();
+  ScriptOrigin origin(name);
+  ScriptCompiler::Source script_source(source, origin);
+
+  TryCatch try_catch(isolate);
+  Local<v8::UnboundScript> script =
+      ScriptCompiler::CompileUnbound(isolate,
+                                     &script_source,
+                                     ScriptCompiler::kProduceCodeCache);
+  const ScriptCompiler::CachedData* cached_data =
+      script_source.GetCachedData();
+  if (script.IsEmpty() || cached_data == nullptr) {
+    fprintf(stderr, "node_mkcodecache: cannot compile %s\n", native.name);
+    return false;
+  }
+
+  char buf[256];
+  snprintf(buf, sizeof(buf), "static const uint8_t data_%d[] = {\n", index);
+  data->append(buf);
+  AppendBytes(data, cached_data->data, cached_data->length);
+  data->append("};\n\n");
+
+  snprintf(buf, sizeof(buf), "  { \"%s\", data_%d, sizeof(data_%d) },\n",
+           native.name, index, index);
+  table->append(buf);
+  return true;
+}
+
+
+static bool WriteCodeCacheFile(const char* filename,
+                               const std::string& data,
+                               const std::string& table) {
+  FILE* fp = fopen(filename, "w");
+  if (fp == nullptr) {
+    fprintf(stderr, "node_mkcodecache: cannot open %s\n", filename);
+    return false;
+  }
+
+  fprintf(fp, "// Generated by node_mkcodecache, do not edit.\n\n");
+  fprintf(fp, "#include \"node_code_cache.h\"\n\n");
+  fprintf(fp, "namespace node {\n");
+  fprintf(fp, "namespace code_cache {\n\n");
+  fputs(data.c_str(), fp);
+  fprintf(fp, "const Entry entries[] = {\n");
+  fputs(table.c_str(), fp);
+  fprintf(fp, "  { nullptr, nullptr, 0 }\n");
+  fprintf(fp, "};\n\n");
+  fprintf(fp, "}  // namespace code_cache\n");
+  fprintf(fp, "}  // namespace node\n");
+
+  const bool ok = ferror(fp) == 0;
+  return fclose(fp) == 0 && ok;
+}
+
+}  // namespace code_cache
+}  // namespace node
+
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <output.cc> [module id ...]\n", argv[0]);
+    return 1;
+  }
+
+  // V8 only accepts a cache that was produced with the same flags.  Keep in
+  // sync with the flags that node::Init() sets before V8::Initialize().
+#if defined(NODE_V8_OPTIONS)
+  v8::V8::SetFlagsFromString(NODE_V8_OPTIONS, sizeof(NODE_V8_OPTIONS) - 1);
+#endif
+  const char no_typed_array_heap[] = "--typed_array_max_size_in_heap=0";
+  v8::V8::SetFlagsFromString(no_typed_array_heap,
+                             sizeof(no_typed_array_heap) - 1);
+
+#if defined(NODE_HAVE_I18N_SUPPORT)
+  v8::V8::InitializeICU();
+#endif
+  v8::Platform* platform = v8::platform::CreateDefaultPlatform();
+  v8::V8::InitializePlatform(platform);
+  v8::V8::Initialize();
+
+  // V8 hashes the flags in V8::Initialize(), so this one doesn't change
+  // the hash that is stored in the caches.  It doesn't change the code
+  // that is generated either, only when it is generated.
+  const char no_lazy[] = "--nolazy";
+  v8::V8::SetFlagsFromString(no_lazy, sizeof(no_lazy) - 1);
+
+  node::code_cache::ArrayBufferAllocator allocator;
+  v8::Isolate::CreateParams params;
+  params.array_buffer_allocator = &allocator;
+  v8::Isolate* isolate = v8::Isolate::New(params);
+
+  int exit_code = 0;
+  {
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    v8::Local<v8::Context> context = v8::Context::New(isolate);
+    v8::Context::Scope context_scope(context);
+
+    std::string data;
+    std::string table;
+    int index = 0;
+    for (auto native : node::natives) {
+      if (!node::code_cache::IsSelected(native.name, argc - 2, argv + 2))
+        continue;
+      if (!node::code_cache::AddModule(isolate, native, index, &data, &table))
+        exit_code = 1;
+      index += 1;
+    }
+
+    if (exit_code == 0 &&
+        !node::code_cache::WriteCodeCacheFile(argv[1], data, table)) {
+      exit_code = 1;
+    }
+  }
+
+  isolate->Dispose();
+  v8::V8::Dispose();
+  v8::V8::ShutdownPlatform();
+  delete platform;
+  return exit_code;
+}
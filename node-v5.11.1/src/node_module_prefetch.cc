@@ -0,0 +1,380 @@
+#include "node.h"
+#include "node_internals.h"
+#include "node_platform.h"
+#include "base-object.h"
+#include "base-object-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+
+namespace node {
+
+using v8::Context;
+using v8::Function;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Object;
+using v8::Platform;
+using v8::Script;
+using v8::ScriptCompiler;
+using v8::ScriptOrigin;
+using v8::String;
+using v8::TryCatch;
+using v8::Value;
+
+
+// Reads and parses user modules on the platform's worker threads ahead of
+// require().  Each file is wrapped the way Module.wrap() would wrap it and
+// streamed into V8's background parser, so that Module._extensions['.js']
+// only has to finish the compilation on the main thread when the module is
+// actually loaded.  lib/internal/module_prefetch.js decides which files to
+// prefetch and when.
+class ModulePrefetcher : public BaseObject {
+ public:
+  ~ModulePrefetcher() override;
+
+  static void Initialize(Local<Object> target,
+                         Local<Value> unused,
+                         Local<Context> context);
+
+ private:
+  class Entry;
+  class ParseTask;
+  class SourceStream;
+
+  ModulePrefetcher(Environment* env,
+                   Local<Object> wrap,
+                   const std::string& head,
+                   const std::string& tail);
+
+  static void New(const FunctionCallbackInfo<Value>& args);
+  static void Prefetch(const FunctionCallbackInfo<Value>& args);
+  static void Take(const FunctionCallbackInfo<Value>& args);
+  static void Clear(const FunctionCallbackInfo<Value>& args);
+
+  void Clear();
+
+  // Module.wrapper at the time the prefetcher was created.
+  const std::string head_;
+  const std::string tail_;
+  std::unordered_map<std::string, Entry*> entries_;
+};
+
+
+class ModulePrefetcher::Entry {
+ public:
+  Entry(Isolate* isolate,
+        const std::string& filename,
+        const std::string& head,
+        const std::string& tail);
+  ~Entry();
+
+  // Runs on a platform thread.
+  void Parse();
+  bool ReadSource(const std::string** source);
+
+  // Waits for the parse to finish and compiles the module wrapper.  Returns
+  // an empty handle if the file couldn't be read or didn't parse; the caller
+  // then falls back to the regular loader, which reports the error.
+  MaybeLocal<Function> Finish(Environment* env);
+
+ private:
+  const std::string filename_;
+  const std::string& head_;
+  const std::string& tail_;
+  // Written by the platform thread before |done_| is posted.
+  std::string source_;
+  bool read_ok_;
+  bool finished_;
+  ScriptCompiler::StreamedSource streamed_source_;
+  ScriptCompiler::ScriptStreamingTask* streaming_task_;
+  uv_sem_t done_;
+
+  DISALLOW_COPY_AND_ASSIGN(Entry);
+};
+
+
+// Hands V8 the wrapped file contents in one chunk.  V8 takes ownership of
+// the stream through the StreamedSource.
+class ModulePrefetcher::SourceStream
+    : public ScriptCompiler::ExternalSourceStream {
+ public:
+  explicit SourceStream(Entry* entry) : entry_(entry) {}
+
+  size_t GetMoreData(const uint8_t** src) override;
+
+ private:
+  Entry* entry_;
+};
+
+
+class ModulePrefetcher::ParseTask : public v8::Task {
+ public:
+  explicit ParseTask(Entry* entry) : entry_(entry) {}
+
+  void Run() override {
+    entry_->Parse();
+  }
+
+ private:
+  Entry* const entry_;
+};
+
+
+size_t ModulePrefetcher::SourceStream::GetMoreData(const uint8_t** src) {
+  if (entry_ == nullptr)
+    return 0;  // Everything has been handed out.
+
+  Entry* entry = entry_;
+  entry_ = nullptr;
+  const std::string* source;
+  if (!entry->ReadSource(&source))
+    return 0;  // Parses as an empty script, Finish() ignores the result.
+
+  // V8 releases the chunk with delete[].
+  uint8_t* data = new uint8_t[source->size()];
+  memcpy(data, source->data(), source->size());
+  *src = data;
+  return source->size();
+}
+
+
+ModulePrefetcher::Entry::Entry(Isolate* isolate,
+                               const std::string& filename,
+                               const std::string& head,
+                               const std::string& tail)
+    : filename_(filename),
+      head_(head),
+      tail_(tail),
+      read_ok_(false),
+      finished_(false),
+      streamed_source_(new SourceStream(this),
+                       ScriptCompiler::StreamedSource::UTF8),
+      streaming_task_(nullptr) {
+  CHECK_EQ(0, uv_sem_init(&done_, 0));
+  streaming_task_ =
+      ScriptCompiler::StartStreamingScript(isolate, &streamed_source_);
+  GetNodePlatform()->CallOnBackgroundThread(new ParseTask(this),
+                                            Platform::kShortRunningTask);
+}
+
+
+ModulePrefetcher::Entry::~Entry() {
+  // The platform thread still references the entry until it's done.
+  if (!finished_)
+    uv_sem_wait(&done_);
+  uv_sem_destroy(&done_);
+  delete streaming_task_;
+}
+
+
+void ModulePrefetcher::Entry::Parse() {
+  streaming_task_->Run();
+  uv_sem_post(&done_);
+}
+
+
+bool ModulePrefetcher::Entry::ReadSource(const std::string** source) {
+  uv_fs_t open_req;
+  const int fd =
+      uv_fs_open(nullptr, &open_req, filename_.c_str(), O_RDONLY, 0, nullptr);
+  uv_fs_req_cleanup(&open_req);
+  if (fd < 0)
+    return false;
+
+  std::string contents;
+  int64_t offset = 0;
+  for (;;) {
+    char chunk[32 << 10];
+    uv_buf_t buf = uv_buf_init(chunk, sizeof(chunk));
+    uv_fs_t read_req;
+    const ssize_t nread =
+        uv_fs_read(nullptr, &read_req, fd, &buf, 1, offset, nullptr);
+    uv_fs_req_cleanup(&read_req);
+    if (nread <= 0) {
+      read_ok_ = (nread == 0);
+      break;
+    }
+    contents.append(chunk, nread);
+    offset += nread;
+  }
+
+  uv_fs_t close_req;
+  uv_fs_close(nullptr, &close_req, fd, nullptr);
+  uv_fs_req_cleanup(&close_req);
+
+  if (!read_ok_)
+    return false;
+
+  // Mirror what Module._extensions['.js'] and Module.prototype._compile do
+  // with the file contents: skip the UTF-8 BOM, blank out the shebang line
+  // (but keep its line terminator) and wrap the rest.
+  size_t start = 0;
+  if (contents.compare(0, 3, "\xEF\xBB\xBF") == 0)
+    start = 3;
+  if (contents.compare(start, 2, "#!") == 0) {
+    size_t end = start;
+    while (end < contents.size() &&
+           contents[end] != '\n' &&
+           contents[end] != '\r' &&
+           contents.compare(end, 3, "\xE2\x80\xA8") != 0 &&
+           contents.compare(end, 3, "\xE2\x80\xA9") != 0) {
+      end += 1;
+    }
+    start = end;
+  }
+
+  source_.reserve(head_.size() + contents.size() - start + tail_.size());
+  source_.append(head_);
+  source_.append(contents, start, std::string::npos);
+  source_.append(tail_);
+  *source = &source_;
+  return true;
+}
+
+
+MaybeLocal<Function> ModulePrefetcher::Entry::Finish(Environment* env) {
+  CHECK(!finished_);
+  uv_sem_wait(&done_);
+  finished_ = true;
+
+  if (!read_ok_)
+    return MaybeLocal<Function>();
+
+  Isolate* isolate = env->isolate();
+  Local<Context> context = env->context();
+  // Must be the exact string that was streamed, V8 uses it for the lazily
+  // compiled functions.
+  Local<String> source = String::NewFromUtf8(isolate,
+                                             source_.data(),
+                                             String::kNormalString,
+                                             source_.size());
+  Local<String> filename = String::NewFromUtf8(isolate,
+                                               filename_.data(),
+                                               String::kNormalString,
+                                               filename_.size());
+  ScriptOrigin origin(filename);
+
+  TryCatch try_catch(isolate);
+  Local<Script> script;
+  if (!ScriptCompiler::Compile(context, &streamed_source_, source, origin)
+           .ToLocal(&script)) {
+    return MaybeLocal<Function>();
+  }
+  Local<Value> wrapper;
+  if (!script->Run(context).ToLocal(&wrapper) || !wrapper->IsFunction())
+    return MaybeLocal<Function>();
+  return wrapper.As<Function>();
+}
+
+
+ModulePrefetcher::ModulePrefetcher(Environment* env,
+                                   Local<Object> wrap,
+                                   const std::string& head,
+                                   const std::string& tail)
+    : BaseObject(env, wrap), head_(head), tail_(tail) {
+  MakeWeak<ModulePrefetcher>(this);
+}
+
+
+ModulePrefetcher::~ModulePrefetcher() {
+  Clear();
+}
+
+
+void ModulePrefetcher::Clear() {
+  for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    delete it->second;
+  entries_.clear();
+}
+
+
+void ModulePrefetcher::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsString());
+  CHECK(args[1]->IsString());
+  Environment* env = Environment::GetCurrent(args);
+  node::Utf8Value head(env->isolate(), args[0]);
+  node::Utf8Value tail(env->isolate(), args[1]);
+  new ModulePrefetcher(env, args.This(), *head, *tail);
+}
+
+
+// prefetch(filename) starts reading and parsing |filename| in the background
+// unless that's already in progress.
+void ModulePrefetcher::Prefetch(const FunctionCallbackInfo<Value>& args) {
+  ModulePrefetcher* prefetcher = Unwrap<ModulePrefetcher>(args.Holder());
+  Environment* env = prefetcher->env();
+  CHECK(args[0]->IsString());
+  node::Utf8Value filename(env->isolate(), args[0]);
+
+  if (prefetcher->entries_.count(*filename) > 0)
+    return;
+  prefetcher->entries_[*filename] = new Entry(env->isolate(),
+                                              *filename,
+                                              prefetcher->head_,
+                                              prefetcher->tail_);
+}
+
+
+// take(filename) returns the compiled module wrapper for |filename| or
+// undefined if it wasn't prefetched or failed to parse.  Blocks until the
+// background parse is done.
+void ModulePrefetcher::Take(const FunctionCallbackInfo<Value>& args) {
+  ModulePrefetcher* prefetcher = Unwrap<ModulePrefetcher>(args.Holder());
+  Environment* env = prefetcher->env();
+  CHECK(args[0]->IsString());
+  node::Utf8Value filename(env->isolate(), args[0]);
+
+  auto it = prefetcher->entries_.find(*filename);
+  if (it == prefetcher->entries_.end())
+    return;
+  Entry* entry = it->second;
+  prefetcher->entries_.erase(it);
+
+  Local<Function> wrapper;
+  if (entry->Finish(env).ToLocal(&wrapper))
+    args.GetReturnValue().Set(wrapper);
+  delete entry;
+}
+
+
+// clear() drops all prefetched modules that haven't been taken.
+void ModulePrefetcher::Clear(const FunctionCallbackInfo<Value>& args) {
+  ModulePrefetcher* prefetcher = Unwrap<ModulePrefetcher>(args.Holder());
+  prefetcher->Clear();
+}
+
+
+void ModulePrefetcher::Initialize(Local<Object> target,
+                                  Local<Value> unused,
+                                  Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "ModulePrefetcher"));
+
+  env->SetProtoMethod(t, "prefetch", Prefetch);
+  env->SetProtoMethod(t, "take", Take);
+  env->SetProtoMethod(t, "clear", Clear);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "ModulePrefetcher"),
+              t->GetFunction());
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(module_prefetch,
+                                  node::ModulePrefetcher::Initialize)
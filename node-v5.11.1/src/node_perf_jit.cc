@@ -0,0 +1,614 @@
+#include "node_perf_jit.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>  // PATH_MAX
+#include <stddef.h>  // offsetof
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace node {
+namespace perf_jit {
+
+using v8::JitCodeEvent;
+using v8::Local;
+using v8::String;
+using v8::UnboundScript;
+using v8::Value;
+
+// The records of the jitdump format.  Everything is in native byte order.
+static const uint32_t kMagic = 0x4A695444;  // "JiTD"
+static const uint32_t kVersion = 1;
+
+enum RecordType {
+  kCodeLoad = 0,
+  kCodeMove = 1,
+  kCodeDebugInfo = 2,
+  kCodeClose = 3
+};
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t total_size;
+  uint32_t elf_mach;
+  uint32_t pad1;
+  uint32_t pid;
+  uint64_t timestamp;
+  uint64_t flags;
+};
+
+struct RecordHeader {
+  uint32_t id;
+  uint32_t total_size;
+  uint64_t timestamp;
+};
+
+// Followed by the NUL terminated name and the instructions.
+struct CodeLoadRecord {
+  RecordHeader header;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+};
+
+struct CodeMoveRecord {
+  RecordHeader header;
+  uint32_t pid;
+  uint32_t tid;
+  uint64_t vma;
+  uint64_t old_code_addr;
+  uint64_t new_code_addr;
+  uint64_t code_size;
+  uint64_t code_index;
+};
+
+// Followed by nr_entry DebugEntry records.
+struct DebugInfoRecord {
+  RecordHeader header;
+  uint64_t code_addr;
+  uint64_t nr_entry;
+};
+
+// Followed by the NUL terminated file name.
+struct DebugEntry {
+  uint64_t code_addr;
+  uint32_t line;
+  uint32_t discrim;
+};
+
+#if defined(__x86_64__)
+static const uint32_t kElfMachine = EM_X86_64;
+#elif defined(__i386__)
+static const uint32_t kElfMachine = EM_386;
+#elif defined(__aarch64__)
+static const uint32_t kElfMachine = EM_AARCH64;
+#elif defined(__arm__)
+static const uint32_t kElfMachine = EM_ARM;
+#elif defined(__powerpc64__)
+static const uint32_t kElfMachine = EM_PPC64;
+#elif defined(__powerpc__)
+static const uint32_t kElfMachine = EM_PPC;
+#elif defined(__s390__)
+static const uint32_t kElfMachine = EM_S390;
+#elif defined(__mips__)
+static const uint32_t kElfMachine = EM_MIPS;
+#else
+static const uint32_t kElfMachine = EM_NONE;
+#endif
+
+// A piece of code that V8 told us about and that has not been overwritten or
+// moved since.  V8 never reports code as removed, code that is dead is only
+// forgotten when other code takes its place.
+struct Code {
+  size_t size;
+  uint64_t index;
+  std::string name;
+};
+
+// Source positions by offset into the instructions, as V8 reports them while
+// it generates code and before it reports the code as added.
+struct LinePosition {
+  size_t offset;
+  size_t position;
+};
+typedef std::vector<LinePosition> LineTable;
+
+// Guards everything below.  Isolates on different threads report their code
+// through the same handler.
+static uv_mutex_t mutex;
+static bool enabled;
+static size_t max_size;
+static std::map<uintptr_t, Code>* live_code;
+static std::map<void*, LineTable*>* line_tables;
+static uint64_t next_code_index;
+
+static int map_fd = -1;
+static char map_path[PATH_MAX];
+static size_t map_size;
+static size_t map_limit;
+
+// Room for a directory of up to PATH_MAX bytes and the names that are
+// appended to it, an int takes up to 11 characters.
+static const size_t kDumpDirSize = PATH_MAX + sizeof("/node-jit--") + 2 * 11;
+static const size_t kDumpPathSize = kDumpDirSize + sizeof("/jit-.dump") + 11;
+
+static const char* dump_dir;
+static int dump_fd = -1;
+static int generation;
+static void* dump_marker = MAP_FAILED;
+static size_t dump_size;
+static size_t dump_limit;
+
+
+// perf timestamps its samples with CLOCK_MONOTONIC with `perf record -k mono`.
+static uint64_t Timestamp() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+
+static uint32_t ThreadId() {
+  return static_cast<uint32_t>(syscall(SYS_gettid));
+}
+
+
+template <typename T>
+static void Append(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+// Records are written with a single write(2) each, unbuffered, so that the
+// files are complete at any time, also when the process is killed.
+static void Write(int fd, const std::string& data, size_t* size) {
+  const char* p = data.data();
+  size_t left = data.size();
+  while (left > 0) {
+    ssize_t n = write(fd, p, left);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return;
+    p += n;
+    left -= n;
+    *size += n;
+  }
+}
+
+
+static void StartRecord(std::string* out, uint32_t id) {
+  RecordHeader header;
+  header.id = id;
+  header.total_size = 0;  // Filled in by WriteRecord().
+  header.timestamp = 0;
+  Append(out, header);
+}
+
+
+// Must be called with the lock held, so that the timestamps of the records
+// in the file never go backwards.
+static void WriteRecord(std::string* record) {
+  const uint32_t total_size = static_cast<uint32_t>(record->size());
+  const uint64_t timestamp = Timestamp();
+  memcpy(&(*record)[offsetof(RecordHeader, total_size)],
+         &total_size,
+         sizeof(total_size));
+  memcpy(&(*record)[offsetof(RecordHeader, timestamp)],
+         &timestamp,
+         sizeof(timestamp));
+  Write(dump_fd, *record, &dump_size);
+}
+
+
+static std::string MapLine(uintptr_t start, const Code& code) {
+  char prefix[64];
+  snprintf(prefix, sizeof(prefix), "%" PRIxPTR " %zx ", start, code.size);
+  std::string line(prefix);
+  line += code.name;
+  line += '\n';
+  return line;
+}
+
+
+// Forgets the code in [start, start + size), it is dead if other code was put
+// there.
+static void ForgetOverlapping(uintptr_t start, size_t size) {
+  auto it = live_code->lower_bound(start);
+  if (it != live_code->begin()) {
+    auto prev = it;
+    --prev;
+    if (prev->first + prev->second.size > start)
+      it = prev;
+  }
+  while (it != live_code->end() && it->first < start + size)
+    it = live_code->erase(it);
+}
+
+
+// `instructions` is nullptr when the code is logged again after a rotation.
+// The instructions may not be readable anymore at that point, zeros are
+// written instead; perf only needs them for annotating.
+static void WriteCodeLoad(uintptr_t start,
+                          const Code& code,
+                          const void* instructions) {
+  std::string record;
+  StartRecord(&record, kCodeLoad);
+  CodeLoadRecord load;
+  load.pid = getpid();
+  load.tid = ThreadId();
+  load.vma = start;
+  load.code_addr = start;
+  load.code_size = code.size;
+  load.code_index = code.index;
+  record.append(reinterpret_cast<const char*>(&load) + sizeof(load.header),
+                sizeof(load) - sizeof(load.header));
+  record.append(code.name.c_str(), code.name.size() + 1);
+  if (instructions != nullptr)
+    record.append(static_cast<const char*>(instructions), code.size);
+  else
+    record.append(code.size, '\0');
+  WriteRecord(&record);
+}
+
+
+// Formats the directory and the file of generation |which| into |dir| and
+// |path|, which hold kDumpDirSize and kDumpPathSize bytes.  Returns false and
+// prints a message if they don't fit, rather than use a truncated name.
+static bool FormatJitDumpPaths(int which, char* dir, char* path) {
+  const int dir_length = snprintf(dir, kDumpDirSize, "%s/node-jit-%d-%d",
+                                  dump_dir, getpid(), which);
+  const int path_length = dir_length < 0 ? -1 :
+      snprintf(path, kDumpPathSize, "%s/jit-%d.dump", dir, getpid());
+  if (dir_length < 0 || static_cast<size_t>(dir_length) >= kDumpDirSize ||
+      path_length < 0 || static_cast<size_t>(path_length) >= kDumpPathSize) {
+    fprintf(stderr, "node: jitdump directory name too long: %s\n", dump_dir);
+    return false;
+  }
+  return true;
+}
+
+
+static void RemoveGeneration(int which) {
+  char dir[kDumpDirSize];
+  char path[kDumpPathSize];
+  if (!FormatJitDumpPaths(which, dir, path))
+    return;
+  unlink(path);
+  rmdir(dir);
+}
+
+
+static bool OpenJitDump() {
+  char dir[kDumpDirSize];
+  char path[kDumpPathSize];
+  if (!FormatJitDumpPaths(generation, dir, path))
+    return false;
+  if (mkdir(dir, 0755) == -1 && errno != EEXIST) {
+    fprintf(stderr, "node: cannot create %s: %s\n", dir, strerror(errno));
+    return false;
+  }
+  dump_fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (dump_fd == -1) {
+    fprintf(stderr, "node: cannot create %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  FileHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.total_size = sizeof(header);
+  header.elf_mach = kElfMachine;
+  header.pid = getpid();
+  header.timestamp = Timestamp();
+  dump_size = 0;
+  Write(dump_fd,
+        std::string(reinterpret_cast<const char*>(&header), sizeof(header)),
+        &dump_size);
+
+  // perf finds the file through the mapping: `perf record` logs executable
+  // mappings and `perf inject` picks out the ones of jit-<pid>.dump files.
+  dump_marker = mmap(nullptr, sysconf(_SC_PAGESIZE), PROT_READ | PROT_EXEC,
+                     MAP_PRIVATE, dump_fd, 0);
+  if (dump_marker == MAP_FAILED) {
+    fprintf(stderr, "node: cannot map %s: %s\n", path, strerror(errno));
+    close(dump_fd);
+    dump_fd = -1;
+    unlink(path);
+    rmdir(dir);
+    return false;
+  }
+  return true;
+}
+
+
+static void CloseJitDump() {
+  std::string record;
+  StartRecord(&record, kCodeClose);
+  WriteRecord(&record);
+  munmap(dump_marker, sysconf(_SC_PAGESIZE));
+  dump_marker = MAP_FAILED;
+  close(dump_fd);
+  dump_fd = -1;
+}
+
+
+static void RotateJitDump() {
+  CloseJitDump();
+  if (generation > 0)
+    RemoveGeneration(generation - 1);
+  generation += 1;
+  if (!OpenJitDump())
+    return;
+  for (auto it = live_code->begin(); it != live_code->end(); ++it)
+    WriteCodeLoad(it->first, it->second, nullptr);
+  dump_limit = std::max(max_size, 2 * dump_size);
+}
+
+
+// perf reads the map only when it reports, so it is enough to replace it with
+// one that has the code that is live now.
+static void RewritePerfMap() {
+  char tmp_path[sizeof(map_path) + sizeof(".tmp")];
+  const int length = snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", map_path);
+  CHECK(length > 0 && static_cast<size_t>(length) < sizeof(tmp_path));
+  int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd == -1)
+    return;
+  size_t size = 0;
+  std::string lines;
+  for (auto it = live_code->begin(); it != live_code->end(); ++it) {
+    lines += MapLine(it->first, it->second);
+    if (lines.size() >= 64 * 1024) {
+      Write(fd, lines, &size);
+      lines.clear();
+    }
+  }
+  Write(fd, lines, &size);
+  if (rename(tmp_path, map_path) == -1) {
+    close(fd);
+    unlink(tmp_path);
+    return;
+  }
+  close(map_fd);
+  map_fd = fd;
+  map_size = size;
+  map_limit = std::max(max_size, 2 * map_size);
+}
+
+
+static void RotateIfNeeded() {
+  if (dump_fd != -1 && dump_size > dump_limit)
+    RotateJitDump();
+  if (map_fd != -1 && map_size > map_limit)
+    RewritePerfMap();
+}
+
+
+// Turns the source positions into a debug info record with line numbers.
+// Runs without the lock held: looking up line numbers may allocate on the V8
+// heap and reenter the handler.
+static std::string DebugInfoFor(const JitCodeEvent* event, LineTable* table) {
+  Local<UnboundScript> script = event->script;
+  if (script.IsEmpty())
+    return std::string();
+  Local<Value> script_name = script->GetScriptName();
+  if (!script_name->IsString())
+    return std::string();
+  String::Utf8Value filename(script_name);
+  if (filename.length() == 0)
+    return std::string();
+
+  std::string entries;
+  uint64_t count = 0;
+  int last_line = -1;
+  for (const LinePosition& pos : *table) {
+    const int line = script->GetLineNumber(static_cast<int>(pos.position)) + 1;
+    if (line <= 0 || line == last_line)
+      continue;
+    last_line = line;
+    DebugEntry entry;
+    entry.code_addr =
+        reinterpret_cast<uintptr_t>(event->code_start) + pos.offset;
+    entry.line = line;
+    entry.discrim = 0;
+    Append(&entries, entry);
+    entries.append(*filename, filename.length() + 1);
+    count += 1;
+  }
+  if (count == 0)
+    return std::string();
+
+  std::string record;
+  StartRecord(&record, kCodeDebugInfo);
+  DebugInfoRecord info;
+  info.code_addr = reinterpret_cast<uintptr_t>(event->code_start);
+  info.nr_entry = count;
+  record.append(reinterpret_cast<const char*>(&info) + sizeof(info.header),
+                sizeof(info) - sizeof(info.header));
+  record += entries;
+  return record;
+}
+
+
+static void CodeAdded(const JitCodeEvent* event) {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(event->code_start);
+
+  LineTable* table = nullptr;
+  uv_mutex_lock(&mutex);
+  auto it = line_tables->find(event->code_start);
+  if (it != line_tables->end()) {
+    table = it->second;
+    line_tables->erase(it);
+  }
+  uv_mutex_unlock(&mutex);
+
+  std::string debug_info;
+  if (table != nullptr) {
+    debug_info = DebugInfoFor(event, table);
+    delete table;
+  }
+
+  Code code;
+  code.size = event->code_len;
+  code.name.assign(event->name.str, event->name.len);
+  std::replace(code.name.begin(), code.name.end(), '\n', ' ');
+
+  uv_mutex_lock(&mutex);
+  code.index = next_code_index++;
+  ForgetOverlapping(start, code.size);
+  if (dump_fd != -1) {
+    // perf wants the debug info before the code it belongs to.
+    if (!debug_info.empty())
+      WriteRecord(&debug_info);
+    WriteCodeLoad(start, code, event->code_start);
+  }
+  if (map_fd != -1)
+    Write(map_fd, MapLine(start, code), &map_size);
+  live_code->insert(std::make_pair(start, std::move(code)));
+  RotateIfNeeded();
+  uv_mutex_unlock(&mutex);
+}
+
+
+// Called during garbage collection, for every piece of code that is moved.
+static void CodeMoved(const JitCodeEvent* event) {
+  const uintptr_t from = reinterpret_cast<uintptr_t>(event->code_start);
+  const uintptr_t to = reinterpret_cast<uintptr_t>(event->new_code_start);
+
+  uv_mutex_lock(&mutex);
+  auto it = live_code->find(from);
+  if (it == live_code->end()) {
+    uv_mutex_unlock(&mutex);
+    return;
+  }
+  Code code = std::move(it->second);
+  live_code->erase(it);
+  ForgetOverlapping(to, code.size);
+
+  if (dump_fd != -1) {
+    std::string record;
+    StartRecord(&record, kCodeMove);
+    CodeMoveRecord move;
+    move.pid = getpid();
+    move.tid = ThreadId();
+    move.vma = to;
+    move.old_code_addr = from;
+    move.new_code_addr = to;
+    move.code_size = code.size;
+    move.code_index = code.index;
+    record.append(reinterpret_cast<const char*>(&move) + sizeof(move.header),
+                  sizeof(move) - sizeof(move.header));
+    WriteRecord(&record);
+  }
+  if (map_fd != -1)
+    Write(map_fd, MapLine(to, code), &map_size);
+  live_code->insert(std::make_pair(to, std::move(code)));
+  RotateIfNeeded();
+  uv_mutex_unlock(&mutex);
+}
+
+
+void HandleCodeEvent(const JitCodeEvent* event) {
+  switch (event->type) {
+    case JitCodeEvent::CODE_ADDED:
+      CodeAdded(event);
+      break;
+    case JitCodeEvent::CODE_MOVED:
+      CodeMoved(event);
+      break;
+    case JitCodeEvent::CODE_REMOVED:
+      uv_mutex_lock(&mutex);
+      live_code->erase(reinterpret_cast<uintptr_t>(event->code_start));
+      uv_mutex_unlock(&mutex);
+      break;
+    case JitCodeEvent::CODE_START_LINE_INFO_RECORDING:
+      // Line tables only go into the jitdump file.  The table is handed back
+      // in the events below through user_data.
+      if (dump_dir != nullptr)
+        const_cast<JitCodeEvent*>(event)->user_data = new LineTable();
+      break;
+    case JitCodeEvent::CODE_ADD_LINE_POS_INFO:
+      if (event->user_data != nullptr) {
+        LineTable* table = static_cast<LineTable*>(event->user_data);
+        table->push_back(LinePosition { event->line_info.offset,
+                                        event->line_info.pos });
+      }
+      break;
+    case JitCodeEvent::CODE_END_LINE_INFO_RECORDING:
+      if (event->user_data != nullptr) {
+        LineTable* table = static_cast<LineTable*>(event->user_data);
+        uv_mutex_lock(&mutex);
+        LineTable*& slot = (*line_tables)[event->code_start];
+        delete slot;
+        slot = table;
+        uv_mutex_unlock(&mutex);
+      }
+      break;
+  }
+}
+
+
+bool Start(bool perf_map, const char* jitdump_dir, size_t size) {
+  CHECK_EQ(0, uv_mutex_init(&mutex));
+  live_code = new std::map<uintptr_t, Code>();
+  line_tables = new std::map<void*, LineTable*>();
+  max_size = size;
+
+  bool ok = true;
+  if (perf_map) {
+    // perf looks for the map in /tmp, nowhere else.
+    const int length =
+        snprintf(map_path, sizeof(map_path), "/tmp/perf-%d.map", getpid());
+    CHECK(length > 0 && static_cast<size_t>(length) < sizeof(map_path));
+    map_fd = open(map_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (map_fd == -1) {
+      fprintf(stderr, "node: cannot create %s: %s\n",
+              map_path, strerror(errno));
+      ok = false;
+    }
+    map_limit = max_size;
+  }
+
+  if (jitdump_dir != nullptr) {
+    dump_dir = jitdump_dir;
+    if (!OpenJitDump()) {
+      dump_dir = nullptr;
+      ok = false;
+    }
+    dump_limit = max_size;
+  }
+
+  enabled = map_fd != -1 || dump_fd != -1;
+  return ok;
+}
+
+
+bool IsEnabled() {
+  return enabled;
+}
+
+}  // namespace perf_jit
+}  // namespace node
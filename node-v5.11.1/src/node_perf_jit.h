@@ -0,0 +1,55 @@
+#ifndef SRC_NODE_PERF_JIT_H_
+#define SRC_NODE_PERF_JIT_H_
+
+#include "v8.h"
+
+#include <stddef.h>
+
+// Tells Linux perf about the code that V8 generates, so that JS frames in a
+// `perf record` profile can be symbolized.  There are two outputs, fed from
+// V8's code event handler:
+//
+//  - A perf map, /tmp/perf-<pid>.map, with one "start size name" line per
+//    piece of code.  perf reads it as is.  When code moves, the new location
+//    is appended; the map itself cannot express that the old location is no
+//    longer valid, so samples taken before a move may be attributed to
+//    whatever code is in the old location at the end.
+//
+//  - A jitdump file in the format of tools/perf/Documentation/jitdump-
+//    specification.txt in the kernel tree, with a record for every piece of
+//    code that is added or moved, the code itself and a line table for the
+//    functions that have one.  The records are timestamped, so that
+//    `perf inject --jit` attributes every sample to the code that was at the
+//    sampled address at the time.  perf needs `perf record -k mono` for the
+//    timestamps to match.
+//
+// Both outputs are rotated when they grow past a size limit.  The perf map is
+// rewritten with the code that is still live.  The jitdump file is closed
+// and a new one is started in a new directory with a record for every piece
+// of live code, without its instructions; only the previous generation is
+// kept.  The files are named
+//
+//   <dir>/node-jit-<pid>-<generation>/jit-<pid>.dump
+//
+// because perf only recognizes jitdump files called jit-<pid>.dump.
+
+namespace node {
+namespace perf_jit {
+
+// Opens the outputs.  `jitdump_dir` is nullptr when no jitdump file is to be
+// written.  `max_size` is the size in bytes at which the outputs are rotated.
+// Returns false and prints a message if an output can't be opened, or if
+// `jitdump_dir` is too long to name the file in it.
+bool Start(bool perf_map, const char* jitdump_dir, size_t max_size);
+
+// True if Start() opened any output.
+bool IsEnabled();
+
+// The handler to pass to v8::Isolate::SetJitCodeEventHandler().  Safe to use
+// for more than one isolate.
+void HandleCodeEvent(const v8::JitCodeEvent* event);
+
+}  // namespace perf_jit
+}  // namespace node
+
+#endif  // SRC_NODE_PERF_JIT_H_
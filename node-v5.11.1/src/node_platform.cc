@@ -0,0 +1,318 @@
+#include "node_platform.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <string.h>
+#include <time.h>
+
+namespace node {
+
+using v8::Isolate;
+using v8::Task;
+
+
+// Returns the CPU time of the calling thread in nanoseconds.
+static uint64_t ThreadCPUTime() {
+#if defined(_WIN32)
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(),
+                      &creation_time,
+                      &exit_time,
+                      &kernel_time,
+                      &user_time)) {
+    return uv_hrtime();
+  }
+  ULARGE_INTEGER kernel, user;
+  kernel.LowPart = kernel_time.dwLowDateTime;
+  kernel.HighPart = kernel_time.dwHighDateTime;
+  user.LowPart = user_time.dwLowDateTime;
+  user.HighPart = user_time.dwHighDateTime;
+  return (kernel.QuadPart + user.QuadPart) * 100;  // 100 ns units.
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    return uv_hrtime();
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+  // Wall time is the best we can do here.
+  return uv_hrtime();
+#endif
+}
+
+
+static int DefaultThreadPoolSize() {
+  uv_cpu_info_t* cpu_infos;
+  int count;
+  if (uv_cpu_info(&cpu_infos, &count) != 0)
+    return 1;
+  uv_free_cpu_info(cpu_infos, count);
+  return count;
+}
+
+
+static int ClampThreadPoolSize(int thread_pool_size) {
+  if (thread_pool_size < 1)
+    thread_pool_size = DefaultThreadPoolSize();
+  if (thread_pool_size > NodePlatform::kMaxThreadPoolSize)
+    thread_pool_size = NodePlatform::kMaxThreadPoolSize;
+  if (thread_pool_size < 1)
+    thread_pool_size = 1;
+  return thread_pool_size;
+}
+
+
+NodePlatform::NodePlatform(int thread_pool_size)
+    : stopping_(false),
+      thread_pool_size_(ClampThreadPoolSize(thread_pool_size)),
+      max_long_running_threads_(thread_pool_size_ > 1 ?
+                                thread_pool_size_ - 1 : 1),
+      idle_threads_(0),
+      busy_threads_(0),
+      long_running_threads_(0) {
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+  CHECK_EQ(0, uv_cond_init(&cond_));
+  memset(statistics_, 0, sizeof(statistics_));
+}
+
+
+NodePlatform::~NodePlatform() {
+  uv_mutex_lock(&mutex_);
+  stopping_ = true;
+  uv_cond_broadcast(&cond_);
+  uv_mutex_unlock(&mutex_);
+
+  for (size_t i = 0; i < threads_.size(); i += 1)
+    CHECK_EQ(0, uv_thread_join(&threads_[i]));
+
+  // Tasks that never ran are dropped, like DefaultPlatform does.
+  for (size_t i = 0; i < background_queue_.size(); i += 1)
+    delete background_queue_[i].task;
+  for (size_t i = 0; i < long_running_queue_.size(); i += 1)
+    delete long_running_queue_[i].task;
+  for (auto it = foreground_queues_.begin();
+       it != foreground_queues_.end();
+       ++it) {
+    for (size_t i = 0; i < it->second.size(); i += 1)
+      delete it->second[i].task;
+  }
+  for (auto it = delayed_queues_.begin(); it != delayed_queues_.end(); ++it) {
+    for (auto task = it->second.begin(); task != it->second.end(); ++task)
+      delete task->second;
+  }
+
+  uv_cond_destroy(&cond_);
+  uv_mutex_destroy(&mutex_);
+}
+
+
+const char* NodePlatform::TaskTypeName(TaskType type) {
+  switch (type) {
+#define V(type, name) case type: return name;
+    NODE_PLATFORM_TASK_TYPES(V)
+#undef V
+    default:
+      UNREACHABLE();
+  }
+}
+
+
+void NodePlatform::GetStatistics(Statistics* statistics) {
+  uv_mutex_lock(&mutex_);
+  statistics->thread_pool_size = thread_pool_size_;
+  statistics->threads = static_cast<int>(threads_.size());
+  statistics->busy_threads = busy_threads_;
+  memcpy(statistics->tasks, statistics_, sizeof(statistics_));
+  uv_mutex_unlock(&mutex_);
+}
+
+
+// Runs |queued| and updates the statistics of its type.  Must be called
+// with |mutex_| held; it's released while the task runs.
+void NodePlatform::RunTask(const QueuedTask& queued) {
+  TaskStatistics* const stats = &statistics_[queued.type];
+  const uint64_t start = uv_hrtime();
+  const uint64_t wait_time =
+      start > queued.ready_time ? start - queued.ready_time : 0;
+  stats->queued -= 1;
+  stats->wait_time += wait_time;
+  if (wait_time > stats->max_wait_time)
+    stats->max_wait_time = wait_time;
+
+  uv_mutex_unlock(&mutex_);
+  const uint64_t cpu_start = ThreadCPUTime();
+  queued.task->Run();
+  const uint64_t cpu_time = ThreadCPUTime() - cpu_start;
+  delete queued.task;
+  uv_mutex_lock(&mutex_);
+
+  stats->completed += 1;
+  stats->cpu_time += cpu_time;
+}
+
+
+bool NodePlatform::HasRunnableBackgroundTask() const {
+  return !background_queue_.empty() ||
+         (!long_running_queue_.empty() &&
+          long_running_threads_ < max_long_running_threads_);
+}
+
+
+void NodePlatform::WorkerThread(void* arg) {
+  static_cast<NodePlatform*>(arg)->RunBackgroundTasks();
+}
+
+
+void NodePlatform::RunBackgroundTasks() {
+  uv_mutex_lock(&mutex_);
+  for (;;) {
+    while (!stopping_ && !HasRunnableBackgroundTask()) {
+      idle_threads_ += 1;
+      uv_cond_wait(&cond_, &mutex_);
+      idle_threads_ -= 1;
+    }
+    if (stopping_)
+      break;
+
+    busy_threads_ += 1;
+    if (!background_queue_.empty()) {
+      const QueuedTask queued = background_queue_.front();
+      background_queue_.pop_front();
+      RunTask(queued);
+    } else {
+      const QueuedTask queued = long_running_queue_.front();
+      long_running_queue_.pop_front();
+      long_running_threads_ += 1;
+      RunTask(queued);
+      long_running_threads_ -= 1;
+    }
+    busy_threads_ -= 1;
+  }
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void NodePlatform::CallOnBackgroundThread(Task* task,
+                                          ExpectedRuntime expected_runtime) {
+  QueuedTask queued;
+  queued.task = task;
+  queued.ready_time = uv_hrtime();
+
+  uv_mutex_lock(&mutex_);
+  if (expected_runtime == kLongRunningTask) {
+    queued.type = kLongRunningBackgroundTask;
+    long_running_queue_.push_back(queued);
+  } else {
+    queued.type = kBackgroundTask;
+    background_queue_.push_back(queued);
+  }
+  statistics_[queued.type].posted += 1;
+  statistics_[queued.type].queued += 1;
+
+  // Idle threads may not have woken up for earlier tasks yet, only start a
+  // new one when there are more tasks than idle threads.
+  const size_t pending = background_queue_.size() + long_running_queue_.size();
+  if (static_cast<size_t>(idle_threads_) < pending &&
+      static_cast<int>(threads_.size()) < thread_pool_size_) {
+    uv_thread_t thread;
+    CHECK_EQ(0, uv_thread_create(&thread, WorkerThread, this));
+    threads_.push_back(thread);
+  }
+  if (idle_threads_ > 0)
+    uv_cond_signal(&cond_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void NodePlatform::CallOnForegroundThread(Isolate* isolate, Task* task) {
+  QueuedTask queued;
+  queued.task = task;
+  queued.type = kForegroundTask;
+  queued.ready_time = uv_hrtime();
+
+  uv_mutex_lock(&mutex_);
+  foreground_queues_[isolate].push_back(queued);
+  statistics_[kForegroundTask].posted += 1;
+  statistics_[kForegroundTask].queued += 1;
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void NodePlatform::CallDelayedOnForegroundThread(Isolate* isolate,
+                                                 Task* task,
+                                                 double delay_in_seconds) {
+  const uint64_t deadline =
+      uv_hrtime() + static_cast<uint64_t>(delay_in_seconds * 1e9);
+
+  uv_mutex_lock(&mutex_);
+  delayed_queues_[isolate].insert(std::make_pair(deadline, task));
+  statistics_[kDelayedForegroundTask].posted += 1;
+  statistics_[kDelayedForegroundTask].queued += 1;
+  uv_mutex_unlock(&mutex_);
+}
+
+
+bool NodePlatform::PumpMessageLoop(Isolate* isolate) {
+  uv_mutex_lock(&mutex_);
+
+  std::deque<QueuedTask>* const queue = &foreground_queues_[isolate];
+
+  // Move delayed tasks that hit their deadline to the foreground queue.
+  std::multimap<uint64_t, Task*>* const delayed = &delayed_queues_[isolate];
+  if (!delayed->empty()) {
+    const uint64_t now = uv_hrtime();
+    while (!delayed->empty() && delayed->begin()->first <= now) {
+      QueuedTask queued;
+      queued.task = delayed->begin()->second;
+      queued.type = kDelayedForegroundTask;
+      queued.ready_time = delayed->begin()->first;
+      queue->push_back(queued);
+      delayed->erase(delayed->begin());
+    }
+  }
+
+  if (queue->empty()) {
+    uv_mutex_unlock(&mutex_);
+    return false;
+  }
+
+  const QueuedTask queued = queue->front();
+  queue->pop_front();
+  RunTask(queued);
+  uv_mutex_unlock(&mutex_);
+  return true;
+}
+
+
+void NodePlatform::UnregisterIsolate(Isolate* isolate) {
+  uv_mutex_lock(&mutex_);
+
+  auto queue = foreground_queues_.find(isolate);
+  if (queue != foreground_queues_.end()) {
+    statistics_[kForegroundTask].queued -= queue->second.size();
+    for (size_t i = 0; i < queue->second.size(); i += 1)
+      delete queue->second[i].task;
+    foreground_queues_.erase(queue);
+  }
+
+  auto delayed = delayed_queues_.find(isolate);
+  if (delayed != delayed_queues_.end()) {
+    statistics_[kDelayedForegroundTask].queued -= delayed->second.size();
+    for (auto task = delayed->second.begin();
+         task != delayed->second.end();
+         ++task) {
+      delete task->second;
+    }
+    delayed_queues_.erase(delayed);
+  }
+
+  uv_mutex_unlock(&mutex_);
+}
+
+
+double NodePlatform::MonotonicallyIncreasingTime() {
+  return uv_hrtime() / 1e9;
+}
+
+}  // namespace node
@@ -0,0 +1,129 @@
+#ifndef SRC_NODE_PLATFORM_H_
+#define SRC_NODE_PLATFORM_H_
+
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+#include "v8-platform.h"
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace node {
+
+#define NODE_PLATFORM_TASK_TYPES(V)                                           \
+  V(kBackgroundTask, "background")                                            \
+  V(kLongRunningBackgroundTask, "background_long_running")                    \
+  V(kForegroundTask, "foreground")                                            \
+  V(kDelayedForegroundTask, "foreground_delayed")
+
+// The v8::Platform that node hands to V8.  It replaces libplatform's
+// DefaultPlatform so the work V8 pushes off the main thread (concurrent
+// sweeping, optimizing compiles, script streaming) can be observed.
+//
+// Background tasks run on a pool of at most |thread_pool_size| threads that
+// is shared by every isolate in the process.  Threads are started on demand,
+// so a process that never has more than one task in flight never starts more
+// than one thread.  Short running tasks take priority over long running ones,
+// and with two or more threads, long running tasks never occupy every thread
+// of the pool, there is always one left for the short ones.  A pool of one
+// thread runs long running tasks on that thread when no short ones are
+// queued; V8 waits for some of them, so they can't be held back for good.
+//
+// Foreground tasks are queued per isolate and run by PumpMessageLoop() from
+// the isolate's thread, like DefaultPlatform does.
+class NodePlatform : public v8::Platform {
+ public:
+  enum TaskType {
+#define V(type, _) type,
+    NODE_PLATFORM_TASK_TYPES(V)
+#undef V
+    kTaskTypeCount
+  };
+
+  // Times are in nanoseconds.  wait_time is the time between posting a task
+  // (or the end of its delay) and the start of its execution; cpu_time is the
+  // CPU time of the thread that ran it, or the wall time on platforms that
+  // can't measure per-thread CPU time.
+  struct TaskStatistics {
+    uint64_t posted;
+    uint64_t queued;
+    uint64_t completed;
+    uint64_t wait_time;
+    uint64_t max_wait_time;
+    uint64_t cpu_time;
+  };
+
+  struct Statistics {
+    int thread_pool_size;
+    int threads;
+    int busy_threads;
+    TaskStatistics tasks[kTaskTypeCount];
+  };
+
+  // |thread_pool_size| < 1 picks the number of CPUs, up to 4.
+  explicit NodePlatform(int thread_pool_size);
+  virtual ~NodePlatform() override;
+
+  // Runs at most one pending foreground task of |isolate|.  Returns true if
+  // it ran one.
+  bool PumpMessageLoop(v8::Isolate* isolate);
+
+  // Drops the foreground tasks that |isolate| didn't get to run.  Called
+  // before the isolate is disposed of, so the next isolate that's allocated
+  // at the same address doesn't inherit them.
+  void UnregisterIsolate(v8::Isolate* isolate);
+
+  void GetStatistics(Statistics* statistics);
+  static const char* TaskTypeName(TaskType type);
+
+  void CallOnBackgroundThread(v8::Task* task,
+                              ExpectedRuntime expected_runtime) override;
+  void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override;
+  void CallDelayedOnForegroundThread(v8::Isolate* isolate,
+                                     v8::Task* task,
+                                     double delay_in_seconds) override;
+  double MonotonicallyIncreasingTime() override;
+
+  static const int kMaxThreadPoolSize = 4;
+
+ private:
+  struct QueuedTask {
+    v8::Task* task;
+    TaskType type;
+    uint64_t ready_time;  // uv_hrtime() when the task became runnable.
+  };
+
+  static void WorkerThread(void* arg);
+  void RunBackgroundTasks();
+  bool HasRunnableBackgroundTask() const;
+  void RunTask(const QueuedTask& queued);
+
+  uv_mutex_t mutex_;
+  uv_cond_t cond_;
+  bool stopping_;
+
+  const int thread_pool_size_;
+  // Long running tasks are limited to this many threads, one less than the
+  // pool size but at least one.
+  const int max_long_running_threads_;
+  std::vector<uv_thread_t> threads_;
+  int idle_threads_;
+  int busy_threads_;
+  int long_running_threads_;
+
+  std::deque<QueuedTask> background_queue_;
+  std::deque<QueuedTask> long_running_queue_;
+  std::map<v8::Isolate*, std::deque<QueuedTask> > foreground_queues_;
+  std::map<v8::Isolate*, std::multimap<uint64_t, v8::Task*> > delayed_queues_;
+
+  TaskStatistics statistics_[kTaskTypeCount];
+
+  DISALLOW_COPY_AND_ASSIGN(NodePlatform);
+};
+
+}  // namespace node
+
+#endif  // SRC_NODE_PLATFORM_H_
@@ -0,0 +1,132 @@
+#include "node.h"
+#include "node_internals.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+#include "v8-profiler.h"
+
+#include <vector>
+
+namespace node {
+namespace profiler {
+
+using v8::Array;
+using v8::Context;
+using v8::CpuProfile;
+using v8::CpuProfileNode;
+using v8::CpuProfiler;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Number;
+using v8::Object;
+using v8::Value;
+
+
+// Thin wrapper around V8's sampling CPU profiler.  Samples are taken from a
+// separate thread that interrupts the main thread with SIGPROF (or suspends
+// it on Windows) at the configured interval; V8 aggregates them into a
+// top-down call tree as it goes.  Individual samples are not recorded, so the
+// memory that a profile uses grows with the number of distinct stacks and
+// not with how long the profiler runs.
+//
+// There is one profile per isolate; lib/profiler.js makes sure that start()
+// and stop() alternate.
+
+static const char kTitle[] = "node:profiler";
+
+
+// start(intervalUs)
+static void Start(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(args[0]->IsUint32());
+  CpuProfiler* profiler = env->isolate()->GetCpuProfiler();
+  // Has no effect while a profile is running; lib/profiler.js only calls
+  // start() when it is not.
+  profiler->SetSamplingInterval(args[0]->Uint32Value());
+  profiler->StartProfiling(FIXED_ONE_BYTE_STRING(env->isolate(), kTitle),
+                           false);
+}
+
+
+// stop() returns the call tree as parallel arrays, in pre-order, so that the
+// JS side does not have to walk a tree of objects:
+//
+//   { names, urls, lines, columns, parents, hitCounts, startTime, endTime }
+//
+// parents[i] is the index of the caller of node i, or -1 for the root.  The
+// times are in microseconds.
+static void Stop(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  Isolate* isolate = env->isolate();
+  CpuProfiler* profiler = isolate->GetCpuProfiler();
+  CpuProfile* profile =
+      profiler->StopProfiling(FIXED_ONE_BYTE_STRING(isolate, kTitle));
+  if (profile == nullptr)
+    return;
+
+  Local<Array> names = Array::New(isolate);
+  Local<Array> urls = Array::New(isolate);
+  Local<Array> lines = Array::New(isolate);
+  Local<Array> columns = Array::New(isolate);
+  Local<Array> parents = Array::New(isolate);
+  Local<Array> hit_counts = Array::New(isolate);
+
+  struct Entry {
+    const CpuProfileNode* node;
+    int parent;
+  };
+  std::vector<Entry> stack;
+  stack.push_back(Entry { profile->GetTopDownRoot(), -1 });
+  uint32_t index = 0;
+  while (!stack.empty()) {
+    Entry entry = stack.back();
+    stack.pop_back();
+    const CpuProfileNode* node = entry.node;
+    names->Set(index, node->GetFunctionName());
+    urls->Set(index, node->GetScriptResourceName());
+    lines->Set(index, Integer::New(isolate, node->GetLineNumber()));
+    columns->Set(index, Integer::New(isolate, node->GetColumnNumber()));
+    parents->Set(index, Integer::New(isolate, entry.parent));
+    hit_counts->Set(index, Integer::NewFromUnsigned(isolate,
+                                                    node->GetHitCount()));
+    // Pushed in reverse so that the children come out in order.
+    for (int i = node->GetChildrenCount() - 1; i >= 0; i -= 1)
+      stack.push_back(Entry { node->GetChild(i), static_cast<int>(index) });
+    index += 1;
+  }
+
+  Local<Object> result = Object::New(isolate);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "names"), names);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "urls"), urls);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "lines"), lines);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "columns"), columns);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "parents"), parents);
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "hitCounts"), hit_counts);
+  const double start_time = static_cast<double>(profile->GetStartTime());
+  const double end_time = static_cast<double>(profile->GetEndTime());
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "startTime"),
+              Number::New(isolate, start_time));
+  result->Set(FIXED_ONE_BYTE_STRING(isolate, "endTime"),
+              Number::New(isolate, end_time));
+
+  profile->Delete();
+  args.GetReturnValue().Set(result);
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  env->SetMethod(target, "start", Start);
+  env->SetMethod(target, "stop", Stop);
+}
+
+}  // namespace profiler
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(profiler, node::profiler::Initialize)
@@ -0,0 +1,142 @@
+#include "node_counters.h"
+#include "util.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>  // PATH_MAX
+#include <stdio.h>
+#include <stdlib.h>  // atexit, getenv
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace node {
+namespace counters {
+
+uint64_t* values;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t header_size;
+  uint32_t counter_count;
+  uint32_t name_size;
+  uint32_t names_offset;
+  uint32_t values_offset;
+  uint64_t pid;
+  uint64_t start_time;
+};
+
+static const char kMagic[8] = { 'N', 'O', 'D', 'E', 'C', 'T', 'R', 'S' };
+static const size_t kNamesOffset = sizeof(Header);
+static const size_t kValuesOffset =
+    ROUND_UP(kNamesOffset + kCounterCount * kNameSize, sizeof(uint64_t));
+static const size_t kFileSize =
+    kValuesOffset + kCounterCount * sizeof(uint64_t);
+
+static const uint64_t gc_pause_bounds[] = {
+#define V(bound) bound,
+  NODE_SHM_GC_PAUSE_BUCKETS(V)
+#undef V
+};
+
+static char path[PATH_MAX];
+static uv_once_t init_once = UV_ONCE_INIT;
+
+
+void RecordGCPause(uint64_t nanoseconds) {
+  if (values == nullptr)
+    return;
+  const uint64_t microseconds = nanoseconds / 1000;
+  size_t bucket = 0;
+  while (bucket < arraysize(gc_pause_bounds) &&
+         microseconds > gc_pause_bounds[bucket]) {
+    bucket += 1;
+  }
+  Add(kGCCount, 1);
+  Add(kGCPauseTotal, microseconds);
+  Add(static_cast<Counter>(kGCPauseHistogram + bucket), 1);
+}
+
+
+static void SetName(char* names, int index, const char* name) {
+  snprintf(names + index * kNameSize, kNameSize, "%s", name);
+}
+
+
+// The mapping stays, workers may still be counting while the process exits.
+static void RemoveCountersFile() {
+  unlink(path);
+}
+
+
+static void MapCountersFile() {
+  const char* dir = getenv("NODE_COUNTERS_DIR");
+  if (dir == nullptr || dir[0] == '\0')
+    return;
+
+  snprintf(path, sizeof(path), "%s/node-%d.counters", dir, getpid());
+  int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd == -1) {
+    fprintf(stderr, "node: cannot create %s: %s\n", path, strerror(errno));
+    return;
+  }
+
+  void* p = MAP_FAILED;
+  if (ftruncate(fd, kFileSize) == 0)
+    p = mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    fprintf(stderr, "node: cannot map %s: %s\n", path, strerror(errno));
+    unlink(path);
+    return;
+  }
+
+  char* names = static_cast<char*>(p) + kNamesOffset;
+#define V(index, name) SetName(names, index, name);
+  NODE_SHM_COUNTERS(V)
+#undef V
+#define V(PROVIDER)                                                           \
+  SetName(names,                                                              \
+          HandleCounter(AsyncWrap::PROVIDER_ ## PROVIDER),                    \
+          "handles." #PROVIDER);
+  NODE_ASYNC_PROVIDER_TYPES(V)
+#undef V
+  for (size_t i = 0; i < arraysize(gc_pause_bounds); i += 1) {
+    char name[kNameSize];
+    snprintf(name, sizeof(name), "gc.pause.le_%dus",
+             static_cast<int>(gc_pause_bounds[i]));
+    SetName(names, kGCPauseHistogram + i, name);
+  }
+  SetName(names, kCounterCount - 1, "gc.pause.le_inf");
+
+  struct timeval now;
+  gettimeofday(&now, nullptr);
+
+  Header* header = static_cast<Header*>(p);
+  header->version = kVersion;
+  header->header_size = sizeof(*header);
+  header->counter_count = kCounterCount;
+  header->name_size = kNameSize;
+  header->names_offset = kNamesOffset;
+  header->values_offset = kValuesOffset;
+  header->pid = getpid();
+  header->start_time = static_cast<uint64_t>(now.tv_sec) * 1000 +
+                       now.tv_usec / 1000;
+  // Readers that see the magic see everything else as well.
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(header->magic, kMagic, sizeof(kMagic));
+
+  values = reinterpret_cast<uint64_t*>(static_cast<char*>(p) + kValuesOffset);
+  atexit(RemoveCountersFile);
+}
+
+}  // namespace counters
+
+
+void InitPerfCountersShm() {
+  uv_once(&counters::init_once, counters::MapCountersFile);
+}
+
+}  // namespace node
@@ -0,0 +1,171 @@
+#ifndef SRC_NODE_SHM_COUNTERS_H_
+#define SRC_NODE_SHM_COUNTERS_H_
+
+#include "async-wrap.h"
+#include "uv.h"
+
+#include <stdint.h>
+
+// When NODE_COUNTERS_DIR is set, the counters below are published in a file
+// named node-<pid>.counters in that directory, which the process maps into
+// memory and updates in place, so that other processes can read them from a
+// mapping of their own without any help from this one.  The file is removed
+// when the process exits.
+//
+// The layout of the file, in native byte order:
+//
+//   offset  size
+//        0     8  magic, "NODECTRS", written after everything else
+//        8     4  version of the layout, kVersion
+//       12     4  header size
+//       16     4  number of counters, N
+//       20     4  size of a counter name, NUL padded
+//       24     4  offset of the names
+//       28     4  offset of the values
+//       32     8  pid
+//       40     8  start time in milliseconds since the epoch
+//
+// followed by N names and N 64-bit values.  Readers should go by the names,
+// their order is not part of the layout.
+
+namespace node {
+namespace counters {
+
+#define NODE_SHM_COUNTERS(V)                                                  \
+  V(kServerConnectionsOpened, "net.server.connections.opened")               \
+  V(kServerConnectionsClosed, "net.server.connections.closed")               \
+  V(kHttpServerRequests, "http.server.requests")                             \
+  V(kHttpServerResponses, "http.server.responses")                           \
+  V(kHttpClientRequests, "http.client.requests")                             \
+  V(kHttpClientResponses, "http.client.responses")                           \
+  V(kNetBytesSent, "net.bytes.sent")                                         \
+  V(kNetBytesReceived, "net.bytes.received")                                 \
+  V(kPipeBytesSent, "pipe.bytes.sent")                                       \
+  V(kPipeBytesReceived, "pipe.bytes.received")                               \
+  V(kThreadpoolRequests, "threadpool.requests")                              \
+  V(kGCCount, "gc.count")                                                    \
+  V(kGCPauseTotal, "gc.pause.total_us")                                      \
+  V(kGCTimePercent, "gc.time.percent")
+
+// Upper bounds of the buckets of the GC pause histogram, in microseconds.
+// The last bucket takes everything above.
+#define NODE_SHM_GC_PAUSE_BUCKETS(V)                                          \
+  V(100) V(250) V(500) V(1000) V(2500) V(5000) V(10000) V(25000) V(50000)    \
+  V(100000) V(250000)
+
+static const uint32_t kVersion = 1;
+static const size_t kNameSize = 48;
+
+#define V(PROVIDER) + 1
+static const int kProviderCount = 0 NODE_ASYNC_PROVIDER_TYPES(V);
+#undef V
+
+#define V(bound) + 1
+// One bucket per bound and one for the pauses above the last.
+static const int kGCPauseBucketCount = 1 NODE_SHM_GC_PAUSE_BUCKETS(V);
+#undef V
+
+enum Counter {
+#define V(index, _) index,
+  NODE_SHM_COUNTERS(V)
+#undef V
+  kHandles,  // Open handles, one counter per provider type.
+  kGCPauseHistogram = kHandles + kProviderCount,
+  kCounterCount = kGCPauseHistogram + kGCPauseBucketCount
+};
+
+// Null unless the counters file is mapped.  The counters are updated from
+// the main thread and from workers, hence the atomics.
+extern uint64_t* values;
+
+inline void Add(Counter counter, int64_t n) {
+  if (values != nullptr)
+    __atomic_fetch_add(&values[counter], n, __ATOMIC_RELAXED);
+}
+
+inline void Set(Counter counter, uint64_t value) {
+  if (values != nullptr)
+    __atomic_store_n(&values[counter], value, __ATOMIC_RELAXED);
+}
+
+inline Counter HandleCounter(AsyncWrap::ProviderType provider) {
+  return static_cast<Counter>(kHandles + provider);
+}
+
+void RecordGCPause(uint64_t nanoseconds);
+
+}  // namespace counters
+
+inline bool NODE_COUNTER_ENABLED() { return counters::values != nullptr; }
+
+inline void NODE_COUNT_HTTP_SERVER_REQUEST() {
+  counters::Add(counters::kHttpServerRequests, 1);
+}
+
+inline void NODE_COUNT_HTTP_SERVER_RESPONSE() {
+  counters::Add(counters::kHttpServerResponses, 1);
+}
+
+inline void NODE_COUNT_HTTP_CLIENT_REQUEST() {
+  counters::Add(counters::kHttpClientRequests, 1);
+}
+
+inline void NODE_COUNT_HTTP_CLIENT_RESPONSE() {
+  counters::Add(counters::kHttpClientResponses, 1);
+}
+
+inline void NODE_COUNT_SERVER_CONN_OPEN() {
+  counters::Add(counters::kServerConnectionsOpened, 1);
+}
+
+inline void NODE_COUNT_SERVER_CONN_CLOSE() {
+  counters::Add(counters::kServerConnectionsClosed, 1);
+}
+
+inline void NODE_COUNT_NET_BYTES_SENT(int bytes) {
+  counters::Add(counters::kNetBytesSent, bytes);
+}
+
+inline void NODE_COUNT_NET_BYTES_RECV(int bytes) {
+  counters::Add(counters::kNetBytesReceived, bytes);
+}
+
+inline void NODE_COUNT_PIPE_BYTES_SENT(int bytes) {
+  counters::Add(counters::kPipeBytesSent, bytes);
+}
+
+inline void NODE_COUNT_PIPE_BYTES_RECV(int bytes) {
+  counters::Add(counters::kPipeBytesReceived, bytes);
+}
+
+inline uint64_t NODE_COUNT_GET_GC_RAWTIME() { return uv_hrtime(); }
+
+inline void NODE_COUNT_GC_PERCENTTIME(unsigned int percent) {
+  counters::Set(counters::kGCTimePercent, percent);
+}
+
+inline void NODE_COUNT_GC_PAUSE(uint64_t nanoseconds) {
+  counters::RecordGCPause(nanoseconds);
+}
+
+inline void NODE_COUNT_HANDLE_OPEN(AsyncWrap::ProviderType provider) {
+  counters::Add(counters::HandleCounter(provider), 1);
+}
+
+inline void NODE_COUNT_HANDLE_CLOSE(AsyncWrap::ProviderType provider) {
+  counters::Add(counters::HandleCounter(provider), -1);
+}
+
+inline void NODE_COUNT_THREADPOOL_QUEUED() {
+  counters::Add(counters::kThreadpoolRequests, 1);
+}
+
+inline void NODE_COUNT_THREADPOOL_DONE() {
+  counters::Add(counters::kThreadpoolRequests, -1);
+}
+
+void InitPerfCountersShm();
+
+}  // namespace node
+
+#endif  // SRC_NODE_SHM_COUNTERS_H_
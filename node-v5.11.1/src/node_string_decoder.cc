@@ -0,0 +1,203 @@
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "env.h"
+#include "env-inl.h"
+#include "string_bytes.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdlib.h>  // malloc, free
+#include <string.h>  // memcpy
+
+namespace node {
+namespace string_decoder {
+
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::Integer;
+using v8::Isolate;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+// The decoder's state lives in a small Buffer that JS land allocates once
+// per StringDecoder: the bytes that were held back from the last write()
+// because they don't make a whole character yet, how many there are, and
+// the encoding.
+enum StateFields {
+  kCarriedBytes = 0,
+  kCarriedBytesEnd = 6,
+  kNumCarriedBytes = kCarriedBytesEnd,
+  kEncoding,
+  kStateSize
+};
+
+
+static bool IsLeadSurrogate(uint16_t unit) {
+  return unit >= 0xD800 && unit <= 0xDBFF;
+}
+
+
+// Returns how many of the |length| bytes at |data| make whole characters.
+// What is left never takes up more than the space for carried bytes.
+static size_t CompletePrefix(const uint8_t* data,
+                             size_t length,
+                             enum encoding encoding) {
+  size_t end = length;
+  switch (encoding) {
+    case UTF8: {
+      // Look for the lead byte of the last character among the last three
+      // bytes, a fourth one would always end a character.
+      for (size_t i = 1; i <= 3 && i <= length; i++) {
+        const uint8_t c = data[length - i];
+        if ((c & 0xC0) == 0x80)
+          continue;
+        if ((c >> 5 == 0x06 && i < 2) ||
+            (c >> 4 == 0x0E && i < 3) ||
+            (c >> 3 == 0x1E && i < 4)) {
+          end = length - i;
+        }
+        break;
+      }
+      // CESU-8 encodes a surrogate pair as two three-byte sequences, keep
+      // a lead surrogate back until its pair has been seen.
+      if (end >= 3 &&
+          data[end - 3] == 0xED &&
+          (data[end - 2] & 0xF0) == 0xA0) {
+        end -= 3;
+      }
+      break;
+    }
+    case UCS2:
+      end = length & ~static_cast<size_t>(1);
+      if (end >= 2 && IsLeadSurrogate(data[end - 2] | data[end - 1] << 8))
+        end -= 2;
+      break;
+    case BASE64:
+      end = length - length % 3;
+      break;
+    default:
+      CHECK(0 && "unsupported encoding");
+  }
+  return end;
+}
+
+
+static Local<Value> MakeString(Isolate* isolate,
+                               const char* data,
+                               size_t length,
+                               enum encoding encoding) {
+  if (encoding != UCS2)
+    return StringBytes::Encode(isolate, data, length, encoding);
+
+  length /= 2;
+  if (IsBigEndian() ||
+      reinterpret_cast<uintptr_t>(data) % sizeof(uint16_t) == 0) {
+    return StringBytes::Encode(isolate,
+                               reinterpret_cast<const uint16_t*>(data),
+                               length);
+  }
+
+  // Avoid unaligned accesses in v8::String::NewFromTwoByte(), like
+  // StringSlice<UCS2>() does.
+  uint16_t* copy = new uint16_t[length];
+  for (size_t i = 0, k = 0; i < length; i += 1, k += 2) {
+    const uint8_t lo = static_cast<uint8_t>(data[k + 0]);
+    const uint8_t hi = static_cast<uint8_t>(data[k + 1]);
+    copy[i] = lo | hi << 8;
+  }
+  Local<Value> string = StringBytes::Encode(isolate, copy, length);
+  delete[] copy;
+  return string;
+}
+
+
+// decode(state, buffer) returns the characters that are complete after the
+// carried bytes and |buffer|, and carries what is left over to the next
+// call.
+static void Decode(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(Buffer::HasInstance(args[0]));
+  CHECK_EQ(Buffer::Length(args[0]), kStateSize);
+  if (!Buffer::HasInstance(args[1]))
+    return env->ThrowTypeError("argument should be a Buffer");
+
+  uint8_t* const state = reinterpret_cast<uint8_t*>(Buffer::Data(args[0]));
+  const enum encoding encoding = static_cast<enum encoding>(state[kEncoding]);
+  const size_t carried = state[kNumCarriedBytes];
+  const char* chunk = Buffer::Data(args[1]);
+  const size_t chunk_length = Buffer::Length(args[1]);
+
+  // With carried bytes, decode them and the chunk in one go from a copy.
+  char* copy = nullptr;
+  const char* data = chunk;
+  size_t length = chunk_length;
+  if (carried > 0) {
+    length = carried + chunk_length;
+    copy = static_cast<char*>(malloc(length));
+    if (copy == nullptr)
+      return env->ThrowRangeError("Out of memory");
+    memcpy(copy, state + kCarriedBytes, carried);
+    memcpy(copy + carried, chunk, chunk_length);
+    data = copy;
+  }
+
+  const size_t end =
+      CompletePrefix(reinterpret_cast<const uint8_t*>(data), length, encoding);
+  CHECK_LE(length - end, kCarriedBytesEnd - kCarriedBytes);
+  memcpy(state + kCarriedBytes, data + end, length - end);
+  state[kNumCarriedBytes] = length - end;
+
+  args.GetReturnValue().Set(MakeString(env->isolate(), data, end, encoding));
+  free(copy);
+}
+
+
+// flush(state) returns the carried bytes as they are, incomplete characters
+// become replacement characters.
+static void Flush(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(Buffer::HasInstance(args[0]));
+  CHECK_EQ(Buffer::Length(args[0]), kStateSize);
+
+  uint8_t* const state = reinterpret_cast<uint8_t*>(Buffer::Data(args[0]));
+  const enum encoding encoding = static_cast<enum encoding>(state[kEncoding]);
+  const size_t carried = state[kNumCarriedBytes];
+  state[kNumCarriedBytes] = 0;
+
+  // Copied, so that UCS-2 data is aligned.
+  char copy[kCarriedBytesEnd - kCarriedBytes];
+  memcpy(copy, state + kCarriedBytes, carried);
+  args.GetReturnValue().Set(MakeString(env->isolate(), copy, carried,
+                                       encoding));
+}
+
+
+void Initialize(Local<Object> target,
+                Local<Value> unused,
+                Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  Isolate* isolate = env->isolate();
+
+#define SET_CONSTANT(name, value)                                            \
+  target->Set(FIXED_ONE_BYTE_STRING(isolate, name),                          \
+              Integer::New(isolate, value))
+  SET_CONSTANT("kNumCarriedBytes", kNumCarriedBytes);
+  SET_CONSTANT("kEncoding", kEncoding);
+  SET_CONSTANT("kStateSize", kStateSize);
+  SET_CONSTANT("UTF8", UTF8);
+  SET_CONSTANT("UCS2", UCS2);
+  SET_CONSTANT("BASE64", BASE64);
+#undef SET_CONSTANT
+
+  env->SetMethod(target, "decode", Decode);
+  env->SetMethod(target, "flush", Flush);
+}
+
+}  // namespace string_decoder
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(string_decoder,
+                                  node::string_decoder::Initialize)
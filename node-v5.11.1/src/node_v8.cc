@@ -1,4 +1,6 @@
 #include "node.h"
+#include "node_internals.h"
+#include "node_platform.h"
 #include "env.h"
 #include "env-inl.h"
 #include "util.h"
@@ -10,6 +12,7 @@ namespace node {
 using v8::Array;
 using v8::ArrayBuffer;
 using v8::Context;
+using v8::Float64Array;
 using v8::Function;
 using v8::FunctionCallbackInfo;
 using v8::HeapSpaceStatistics;
@@ -48,6 +51,35 @@ static const size_t kHeapSpaceStatisticsPropertiesCount =
     HEAP_SPACE_STATISTICS_PROPERTIES(V);
 #undef V
 
+#define GC_IDLE_STATISTICS_PROPERTIES(V)                                      \
+  V(Environment::GCIdleInfo::kNotifications, kGCIdleNotificationsIndex)       \
+  V(Environment::GCIdleInfo::kSkipped, kGCIdleSkippedIndex)                   \
+  V(Environment::GCIdleInfo::kCompleted, kGCIdleCompletedIndex)               \
+  V(Environment::GCIdleInfo::kBudgetMs, kGCIdleBudgetIndex)                   \
+  V(Environment::GCIdleInfo::kUsedMs, kGCIdleUsedIndex)
+
+#define PLATFORM_STATISTICS_PROPERTIES(V)                                     \
+  V(0, thread_pool_size, kPlatformThreadPoolSizeIndex)                        \
+  V(1, threads, kPlatformThreadsIndex)                                        \
+  V(2, busy_threads, kPlatformBusyThreadsIndex)
+
+#define PLATFORM_TASK_STATISTICS_PROPERTIES(V)                                \
+  V(0, posted, kTaskPostedIndex)                                              \
+  V(1, queued, kTaskQueuedIndex)                                              \
+  V(2, completed, kTaskCompletedIndex)                                        \
+  V(3, wait_time, kTaskWaitTimeIndex)                                         \
+  V(4, max_wait_time, kTaskMaxWaitTimeIndex)                                  \
+  V(5, cpu_time, kTaskCPUTimeIndex)
+
+#define V(a, b, c) +1
+static const size_t kPlatformStatisticsPropertiesCount =
+    PLATFORM_STATISTICS_PROPERTIES(V);
+static const size_t kPlatformTaskStatisticsPropertiesCount =
+    PLATFORM_TASK_STATISTICS_PROPERTIES(V);
+#undef V
+
+static const size_t kPlatformTaskTypeCount = NodePlatform::kTaskTypeCount;
+
 // Will be populated in InitializeV8Bindings.
 static size_t number_of_heap_spaces = 0;
 
@@ -80,6 +112,36 @@ void UpdateHeapSpaceStatisticsBuffer(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+// Fills the Float64Array in args[0] with the platform's thread pool state,
+// followed by kPlatformTaskStatisticsPropertiesCount values for each entry
+// of kPlatformTaskTypes.  Times are in nanoseconds.
+void UpdatePlatformStatistics(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args[0]->IsFloat64Array());
+  Local<Float64Array> array = args[0].As<Float64Array>();
+  const size_t count = kPlatformStatisticsPropertiesCount +
+                       kPlatformTaskTypeCount *
+                           kPlatformTaskStatisticsPropertiesCount;
+  CHECK_EQ(array->Length(), count);
+  double* const buffer = reinterpret_cast<double*>(
+      static_cast<char*>(array->Buffer()->GetContents().Data()) +
+      array->ByteOffset());
+
+  NodePlatform::Statistics s;
+  GetNodePlatform()->GetStatistics(&s);
+#define V(index, name, _) buffer[index] = s.name;
+  PLATFORM_STATISTICS_PROPERTIES(V)
+#undef V
+  for (size_t i = 0; i < kPlatformTaskTypeCount; i++) {
+    const NodePlatform::TaskStatistics& t = s.tasks[i];
+    double* const fields = buffer + kPlatformStatisticsPropertiesCount +
+                           i * kPlatformTaskStatisticsPropertiesCount;
+#define V(index, name, _) fields[index] = static_cast<double>(t.name);
+    PLATFORM_TASK_STATISTICS_PROPERTIES(V)
+#undef V
+  }
+}
+
+
 void SetFlagsFromString(const FunctionCallbackInfo<Value>& args) {
   Environment* env = Environment::GetCurrent(args);
 
@@ -168,6 +230,49 @@ void InitializeV8Bindings(Local<Object> target,
   HEAP_SPACE_STATISTICS_PROPERTIES(V)
 #undef V
 
+  // The idle GC counters are updated in place by the event loop, see
+  // GCIdleNotification() in src/node.cc, so no update function is needed.
+  Environment::GCIdleInfo* const gc_idle_info = env->gc_idle_info();
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(),
+                                    "gcIdleStatisticsArrayBuffer"),
+              ArrayBuffer::New(env->isolate(),
+                               gc_idle_info->fields(),
+                               sizeof(*gc_idle_info->fields()) *
+                                   gc_idle_info->fields_count()));
+
+#define V(i, name)                                                            \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), i));
+
+  GC_IDLE_STATISTICS_PROPERTIES(V)
+#undef V
+
+  env->SetMethod(target,
+                 "updatePlatformStatistics",
+                 UpdatePlatformStatistics);
+
+  const Local<Array> task_types = Array::New(env->isolate(),
+                                             kPlatformTaskTypeCount);
+  for (size_t i = 0; i < kPlatformTaskTypeCount; i++) {
+    const char* name =
+        NodePlatform::TaskTypeName(static_cast<NodePlatform::TaskType>(i));
+    task_types->Set(i, OneByteString(env->isolate(), name));
+  }
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "kPlatformTaskTypes"),
+              task_types);
+
+#define V(i, _, name)                                                         \
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), #name),                   \
+              Uint32::NewFromUnsigned(env->isolate(), i));
+
+  PLATFORM_STATISTICS_PROPERTIES(V)
+  PLATFORM_TASK_STATISTICS_PROPERTIES(V)
+  V(kPlatformStatisticsPropertiesCount, _,
+    kPlatformStatisticsPropertiesCount)
+  V(kPlatformTaskStatisticsPropertiesCount, _,
+    kPlatformTaskStatisticsPropertiesCount)
+#undef V
+
   env->SetMethod(target, "setFlagsFromString", SetFlagsFromString);
 }
 
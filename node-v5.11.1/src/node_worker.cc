@@ -0,0 +1,1106 @@
+#include "node_worker.h"
+#include "node.h"
+#include "node_buffer.h"
+#include "node_internals.h"
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "handle_wrap.h"
+#include "util.h"
+#include "util-inl.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <map>
+
+namespace node {
+namespace worker {
+
+using v8::Array;
+using v8::ArrayBuffer;
+using v8::ArrayBufferCreationMode;
+using v8::Boolean;
+using v8::Context;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::SharedArrayBuffer;
+using v8::String;
+using v8::Uint8Array;
+using v8::Value;
+using v8::WeakCallbackData;
+
+class AtomicsWaiterWrap;
+
+namespace {
+
+std::atomic<int> next_thread_id(1);
+
+// Code caches of the core modules, keyed by module id.  The first worker
+// that compiles a module stores the cache, the workers after it consume it,
+// see NativeModule.prototype.compile in lib/internal/bootstrap_node.js.
+uv_once_t code_cache_once = UV_ONCE_INIT;
+uv_mutex_t code_cache_mutex;
+std::map<std::string, std::string>* code_cache;
+
+
+void InitCodeCache() {
+  CHECK_EQ(0, uv_mutex_init(&code_cache_mutex));
+  code_cache = new std::map<std::string, std::string>();
+}
+
+
+// The asynchronous waits on Int32 words of shared memory, by address, in the
+// order they started.  See AtomicsWaiterWrap.
+struct Waiter {
+  AtomicsWaiterWrap* owner;
+  uint32_t id;
+};
+uv_mutex_t waiters_mutex;
+std::multimap<int32_t*, Waiter>* waiters;
+
+
+// The SharedMemory of the SharedArrayBuffers that were externalized, by
+// address.  The mutex also guards SharedMemory::refs_.  InitSharedMemory()
+// sets up the waiters too.
+uv_once_t shared_memory_once = UV_ONCE_INIT;
+uv_mutex_t shared_memory_mutex;
+std::map<void*, SharedMemory*>* shared_memory_registry;
+
+
+void InitSharedMemory() {
+  CHECK_EQ(0, uv_mutex_init(&shared_memory_mutex));
+  shared_memory_registry = new std::map<void*, SharedMemory*>();
+  CHECK_EQ(0, uv_mutex_init(&waiters_mutex));
+  waiters = new std::multimap<int32_t*, Waiter>();
+}
+
+
+// Returns the address of the Int32 at |byte_offset| in |sab|.
+int32_t* WordAddress(Local<Value> sab, Local<Value> byte_offset) {
+  CHECK(sab->IsSharedArrayBuffer());
+  SharedArrayBuffer::Contents contents =
+      sab.As<SharedArrayBuffer>()->GetContents();
+  const size_t offset = byte_offset->Uint32Value();
+  CHECK_EQ(offset % sizeof(int32_t), 0);
+  CHECK_LE(offset + sizeof(int32_t), contents.ByteLength());
+  return reinterpret_cast<int32_t*>(static_cast<char*>(contents.Data()) +
+                                    offset);
+}
+
+
+void CloseWalkCb(uv_handle_t* handle, void* arg) {
+  if (!uv_is_closing(handle))
+    uv_close(handle, nullptr);
+}
+
+}  // anonymous namespace
+
+
+SharedMemory::SharedMemory(void* data, size_t length)
+    : data_(data), length_(length), refs_(1) {
+}
+
+
+SharedMemory::~SharedMemory() {
+  free(data_);
+}
+
+
+SharedMemory* SharedMemory::ForSharedArrayBuffer(
+    Environment* env,
+    Local<SharedArrayBuffer> sab) {
+  uv_once(&shared_memory_once, InitSharedMemory);
+  SharedArrayBuffer::Contents contents = sab->GetContents();
+  void* const data = contents.Data();
+  SharedMemory* memory = nullptr;
+
+  if (sab->IsExternal()) {
+    uv_mutex_lock(&shared_memory_mutex);
+    auto it = shared_memory_registry->find(data);
+    if (it != shared_memory_registry->end()) {
+      memory = it->second;
+      memory->refs_ += 1;
+    }
+    uv_mutex_unlock(&shared_memory_mutex);
+    if (memory == nullptr)
+      env->ThrowError("SharedArrayBuffer is externalized and can't be shared");
+    return memory;
+  }
+
+  // Another thread may hold the last reference, the memory has to be
+  // something that any thread can free.
+  ArrayBufferAllocator* allocator = env->array_buffer_allocator();
+  if (allocator != nullptr && !allocator->IsMalloced(data)) {
+    env->ThrowError("SharedArrayBuffer is in pooled memory and can't be "
+                    "shared, see --buffer-allocator");
+    return nullptr;
+  }
+
+  sab->Externalize();
+  memory = new SharedMemory(data, contents.ByteLength());
+  uv_mutex_lock(&shared_memory_mutex);
+  shared_memory_registry->insert(std::make_pair(data, memory));
+  memory->refs_ += 1;
+  uv_mutex_unlock(&shared_memory_mutex);
+  // Takes over the reference that the constructor made.
+  new SharedMemoryReference(env, sab, memory);
+  return memory;
+}
+
+
+Local<SharedArrayBuffer> SharedMemory::ToSharedArrayBuffer(Environment* env) {
+  Local<SharedArrayBuffer> sab =
+      SharedArrayBuffer::New(env->isolate(),
+                             data_,
+                             length_,
+                             ArrayBufferCreationMode::kExternalized);
+  new SharedMemoryReference(env, sab, this);
+  return sab;
+}
+
+
+void SharedMemory::Ref() {
+  uv_mutex_lock(&shared_memory_mutex);
+  refs_ += 1;
+  uv_mutex_unlock(&shared_memory_mutex);
+}
+
+
+void SharedMemory::Unref() {
+  uv_mutex_lock(&shared_memory_mutex);
+  const bool last = --refs_ == 0;
+  if (last)
+    shared_memory_registry->erase(data_);
+  uv_mutex_unlock(&shared_memory_mutex);
+  if (last)
+    delete this;
+}
+
+
+SharedMemoryReference::SharedMemoryReference(Environment* env,
+                                             Local<SharedArrayBuffer> sab,
+                                             SharedMemory* memory)
+    : isolate_(env->isolate()),
+      persistent_(env->isolate(), sab),
+      memory_(memory) {
+  persistent_.SetWeak(this, WeakCallback);
+  persistent_.MarkIndependent();
+  isolate_->AdjustAmountOfExternalAllocatedMemory(memory_->length());
+  if (env->worker_context() != nullptr)
+    env->worker_context()->AddSharedMemoryReference(this);
+}
+
+
+SharedMemoryReference::~SharedMemoryReference() {
+  persistent_.Reset();
+  isolate_->AdjustAmountOfExternalAllocatedMemory(
+      -static_cast<int64_t>(memory_->length()));
+  memory_->Unref();
+}
+
+
+void SharedMemoryReference::WeakCallback(
+    const WeakCallbackData<SharedArrayBuffer, SharedMemoryReference>& data) {
+  delete data.GetParameter();
+}
+
+
+Message::~Message() {
+  for (size_t i = 0; i < buffers_.size(); i += 1)
+    free(buffers_[i].first);
+  for (size_t i = 0; i < shared_.size(); i += 1) {
+    if (shared_[i] != nullptr)
+      shared_[i]->Unref();
+  }
+}
+
+
+bool Message::Serialize(Environment* env,
+                        Local<Value> json,
+                        Local<Value> buffers,
+                        Local<Value> shared) {
+  if (!json->IsString()) {
+    env->ThrowTypeError("message must be a string");
+    return false;
+  }
+  node::Utf8Value json_utf8(env->isolate(), json);
+  json_.assign(*json_utf8, json_utf8.length());
+
+  // Check them all before neutering any of them.
+  Local<Array> array;
+  if (!buffers->IsUndefined()) {
+    if (!buffers->IsArray()) {
+      env->ThrowTypeError("buffers must be an array");
+      return false;
+    }
+    array = buffers.As<Array>();
+    for (uint32_t i = 0; i < array->Length(); i += 1) {
+      if (!array->Get(i)->IsArrayBuffer()) {
+        env->ThrowTypeError("buffers must only contain ArrayBuffers");
+        return false;
+      }
+    }
+  }
+  Local<Array> shared_array;
+  if (!shared->IsUndefined()) {
+    if (!shared->IsArray()) {
+      env->ThrowTypeError("shared must be an array");
+      return false;
+    }
+    shared_array = shared.As<Array>();
+    for (uint32_t i = 0; i < shared_array->Length(); i += 1) {
+      if (!shared_array->Get(i)->IsSharedArrayBuffer()) {
+        env->ThrowTypeError("shared must only contain SharedArrayBuffers");
+        return false;
+      }
+    }
+  }
+
+  if (!shared_array.IsEmpty()) {
+    for (uint32_t i = 0; i < shared_array->Length(); i += 1) {
+      Local<SharedArrayBuffer> sab =
+          shared_array->Get(i).As<SharedArrayBuffer>();
+      SharedMemory* memory = nullptr;
+      if (sab->ByteLength() != 0) {
+        memory = SharedMemory::ForSharedArrayBuffer(env, sab);
+        if (memory == nullptr)
+          return false;
+      }
+      shared_.push_back(memory);
+    }
+  }
+
+  if (array.IsEmpty())
+    return true;
+
+  ArrayBufferAllocator* allocator = env->array_buffer_allocator();
+  for (uint32_t i = 0; i < array->Length(); i += 1) {
+    Local<ArrayBuffer> ab = array->Get(i).As<ArrayBuffer>();
+    const size_t length = ab->ByteLength();
+    char* data = nullptr;
+
+    if (length == 0) {
+      // Nothing to move.
+    } else if (ab->IsExternal() || !ab->IsNeuterable()) {
+      // The memory belongs to someone else, send a copy.
+      data = static_cast<char*>(malloc(length));
+      CHECK_NE(data, nullptr);
+      memcpy(data, ab->GetContents().Data(), length);
+    } else {
+      ArrayBuffer::Contents contents = ab->Externalize();
+      data = static_cast<char*>(contents.Data());
+      if (allocator != nullptr && !allocator->IsMalloced(data)) {
+        // Pooled memory only goes back to the pool it came from.
+        char* copy = static_cast<char*>(malloc(length));
+        CHECK_NE(copy, nullptr);
+        memcpy(copy, data, length);
+        allocator->Free(data, length);
+        data = copy;
+      }
+    }
+
+    if (ab->IsNeuterable())
+      ab->Neuter();
+    buffers_.push_back(std::make_pair(data, length));
+  }
+
+  return true;
+}
+
+
+Local<Array> Message::DeserializeBuffers(Environment* env) {
+  Local<Array> array = Array::New(env->isolate(), buffers_.size());
+  for (size_t i = 0; i < buffers_.size(); i += 1) {
+    char* const data = buffers_[i].first;
+    const size_t length = buffers_[i].second;
+    Local<ArrayBuffer> ab;
+    if (data == nullptr) {
+      ab = ArrayBuffer::New(env->isolate(), 0);
+    } else {
+      ab = ArrayBuffer::New(env->isolate(),
+                            data,
+                            length,
+                            ArrayBufferCreationMode::kInternalized);
+    }
+    array->Set(i, ab);
+  }
+  buffers_.clear();
+  return array;
+}
+
+
+Local<Array> Message::DeserializeShared(Environment* env) {
+  Local<Array> array = Array::New(env->isolate(), shared_.size());
+  for (size_t i = 0; i < shared_.size(); i += 1) {
+    if (shared_[i] == nullptr)
+      array->Set(i, SharedArrayBuffer::New(env->isolate(), 0));
+    else
+      array->Set(i, shared_[i]->ToSharedArrayBuffer(env));
+  }
+  shared_.clear();
+  return array;
+}
+
+
+Local<String> Message::DeserializeJSON(Environment* env) const {
+  return String::NewFromUtf8(env->isolate(),
+                             json_.data(),
+                             String::kNormalString,
+                             json_.size());
+}
+
+
+Worker::Worker(const std::string& filename,
+               const std::vector<std::string>& exec_argv,
+               Message* worker_data)
+    : started_(false),
+      joined_(false),
+      thread_id_(next_thread_id++),
+      filename_(filename),
+      exec_argv_(exec_argv),
+      worker_data_(worker_data),
+      parent_async_(nullptr),
+      port_async_(nullptr),
+      isolate_(nullptr),
+      stop_requested_(false),
+      exited_(false),
+      exit_reported_(false),
+      env_(nullptr),
+      exit_code_(1) {
+  CHECK_EQ(0, uv_mutex_init(&mutex_));
+}
+
+
+Worker::~Worker() {
+  CHECK(!started_ || joined_);
+  for (size_t i = 0; i < to_parent_.size(); i += 1)
+    delete to_parent_[i];
+  for (size_t i = 0; i < to_worker_.size(); i += 1)
+    delete to_worker_[i];
+  delete worker_data_;
+  uv_mutex_destroy(&mutex_);
+}
+
+
+int Worker::Start(uv_async_t* parent_async) {
+  CHECK(!started_);
+  uv_mutex_lock(&mutex_);
+  parent_async_ = parent_async;
+  uv_mutex_unlock(&mutex_);
+
+  int err = uv_thread_create(&thread_, Run, this);
+  if (err == 0)
+    started_ = true;
+  return err;
+}
+
+
+void Worker::Run(void* arg) {
+  Worker* worker = static_cast<Worker*>(arg);
+
+  uv_loop_t loop;
+  CHECK_EQ(0, uv_loop_init(&loop));
+
+  // The worker runs |filename_| like the main thread runs process.argv[1].
+  const char* argv[] = { "node", worker->filename_.c_str() };
+  std::vector<const char*> exec_argv;
+  for (size_t i = 0; i < worker->exec_argv_.size(); i += 1)
+    exec_argv.push_back(worker->exec_argv_[i].c_str());
+
+  {
+    NodeInstanceData instance_data(NodeInstanceType::WORKER,
+                                   &loop,
+                                   arraysize(argv),
+                                   argv,
+                                   exec_argv.size(),
+                                   exec_argv.empty() ? nullptr : &exec_argv[0],
+                                   false,
+                                   worker);
+    StartNodeInstance(&instance_data);
+    worker->exit_code_ = instance_data.exit_code();
+  }
+
+  CHECK_EQ(0, uv_loop_close(&loop));
+
+  uv_mutex_lock(&worker->mutex_);
+  worker->exited_ = true;
+  if (worker->parent_async_ != nullptr)
+    uv_async_send(worker->parent_async_);
+  uv_mutex_unlock(&worker->mutex_);
+}
+
+
+void Worker::Terminate() {
+  uv_mutex_lock(&mutex_);
+  stop_requested_ = true;
+  if (isolate_ != nullptr)
+    isolate_->TerminateExecution();
+  if (port_async_ != nullptr)
+    uv_async_send(port_async_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::Join() {
+  if (started_ && !joined_) {
+    CHECK_EQ(0, uv_thread_join(&thread_));
+    joined_ = true;
+  }
+}
+
+
+void Worker::DetachParent() {
+  uv_mutex_lock(&mutex_);
+  parent_async_ = nullptr;
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::PostToWorker(Message* message) {
+  uv_mutex_lock(&mutex_);
+  to_worker_.push_back(message);
+  if (port_async_ != nullptr)
+    uv_async_send(port_async_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::TakeParentMessages(std::deque<Message*>* messages,
+                                bool* exited) {
+  uv_mutex_lock(&mutex_);
+  messages->swap(to_parent_);
+  *exited = exited_ && !exit_reported_;
+  if (exited_)
+    exit_reported_ = true;
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::Attach(Environment* env) {
+  env_ = env;
+  env->set_worker_context(this);
+
+  uv_mutex_lock(&mutex_);
+  isolate_ = env->isolate();
+  const bool stop_requested = stop_requested_;
+  uv_mutex_unlock(&mutex_);
+
+  if (stop_requested)
+    Exit(1);
+}
+
+
+void Worker::Detach(Environment* env) {
+  CHECK_EQ(env, env_);
+
+  // Terminate() mustn't touch the isolate once it's disposed of.
+  uv_mutex_lock(&mutex_);
+  isolate_ = nullptr;
+  uv_mutex_unlock(&mutex_);
+
+  // Close everything that's still open on the loop.  Handles that aren't
+  // owned by a HandleWrap are closed without their owner knowing, which
+  // leaks the owner but is safe; the loop goes away right after this.
+  env->set_can_call_into_js(false);
+  for (auto wrap : *env->handle_wrap_queue())
+    wrap->Close();
+  env->CleanupHandles();
+  uv_walk(env->event_loop(), CloseWalkCb, nullptr);
+  uv_run(env->event_loop(), UV_RUN_DEFAULT);
+
+  // The isolate goes away without garbage collecting its SharedArrayBuffers.
+  while (!shared_memory_references_.IsEmpty())
+    delete shared_memory_references_.PopFront();
+
+  env_ = nullptr;
+}
+
+
+void Worker::Exit(int code) {
+  if (!env_->can_call_into_js())
+    return;
+  exit_code_ = code;
+  env_->set_can_call_into_js(false);
+  env_->isolate()->TerminateExecution();
+  uv_stop(env_->event_loop());
+}
+
+
+bool Worker::IsStopping() {
+  uv_mutex_lock(&mutex_);
+  const bool stop_requested = stop_requested_;
+  uv_mutex_unlock(&mutex_);
+
+  if (stop_requested)
+    Exit(1);
+  return !env_->can_call_into_js();
+}
+
+
+void Worker::PostToParent(Message* message) {
+  uv_mutex_lock(&mutex_);
+  to_parent_.push_back(message);
+  if (parent_async_ != nullptr)
+    uv_async_send(parent_async_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::AttachPort(uv_async_t* port_async) {
+  uv_mutex_lock(&mutex_);
+  port_async_ = port_async;
+  if (!to_worker_.empty() || stop_requested_)
+    uv_async_send(port_async_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::DetachPort() {
+  uv_mutex_lock(&mutex_);
+  port_async_ = nullptr;
+  uv_mutex_unlock(&mutex_);
+}
+
+
+void Worker::TakeWorkerMessages(std::deque<Message*>* messages) {
+  uv_mutex_lock(&mutex_);
+  messages->swap(to_worker_);
+  uv_mutex_unlock(&mutex_);
+}
+
+
+Message* Worker::TakeWorkerData() {
+  Message* worker_data = worker_data_;
+  worker_data_ = nullptr;
+  return worker_data;
+}
+
+
+void Worker::AddSharedMemoryReference(SharedMemoryReference* reference) {
+  shared_memory_references_.PushBack(reference);
+}
+
+
+void Worker::StopWorkers(Environment* env) {
+  for (auto wrap : *env->handle_wrap_queue()) {
+    if (wrap->provider_type() == AsyncWrap::PROVIDER_WORKER)
+      wrap->Close();
+  }
+}
+
+
+// Calls wrap.onmessage(type, json, buffers, shared) for each of |messages|.
+static void DeliverMessages(HandleWrap* wrap,
+                            std::deque<Message*>* messages) {
+  Environment* env = wrap->env();
+  HandleScope handle_scope(env->isolate());
+  Context::Scope context_scope(env->context());
+
+  while (!messages->empty()) {
+    Message* message = messages->front();
+    messages->pop_front();
+    // A callback can close the handle or stop the thread.
+    if (HandleWrap::IsAlive(wrap) && env->can_call_into_js()) {
+      HandleScope scope(env->isolate());
+      Local<Value> argv[] = {
+        Integer::New(env->isolate(), message->type()),
+        message->DeserializeJSON(env),
+        message->DeserializeBuffers(env),
+        message->DeserializeShared(env)
+      };
+      wrap->MakeCallback(env->onmessage_string(), arraysize(argv), argv);
+    }
+    delete message;
+  }
+}
+
+
+static void PostMessage(Environment* env,
+                        const FunctionCallbackInfo<Value>& args,
+                        Worker* worker,
+                        bool to_worker) {
+  Message* message = new Message(args[0]->Int32Value());
+  if (!message->Serialize(env, args[1], args[2], args[3])) {
+    delete message;
+    return;
+  }
+  if (to_worker)
+    worker->PostToWorker(message);
+  else
+    worker->PostToParent(message);
+}
+
+
+// The parent's handle on a worker thread.
+class WorkerWrap : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"));
+
+    env->SetProtoMethod(t, "close", HandleWrap::Close);
+    env->SetProtoMethod(t, "ref", HandleWrap::Ref);
+    env->SetProtoMethod(t, "unref", HandleWrap::Unref);
+    env->SetProtoMethod(t, "start", Start);
+    env->SetProtoMethod(t, "terminate", Terminate);
+    env->SetProtoMethod(t, "postMessage", PostMessage);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "Worker"),
+                t->GetFunction());
+  }
+
+  // Waits for the thread if it's still running.
+  void Close(Local<Value> close_callback) override {
+    if (IsAlive(this)) {
+      worker_->DetachParent();
+      worker_->Terminate();
+      worker_->Join();
+    }
+    HandleWrap::Close(close_callback);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  WorkerWrap(Environment* env, Local<Object> object, Worker* worker)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&async_),
+                   AsyncWrap::PROVIDER_WORKER),
+        worker_(worker) {
+    CHECK_EQ(0, uv_async_init(env->event_loop(), &async_, OnAsync));
+    object->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "threadId"),
+                Integer::New(env->isolate(), worker->thread_id()));
+  }
+
+  ~WorkerWrap() override {
+    delete worker_;
+  }
+
+  // args: filename, execArgv[, workerDataJSON, workerDataBuffers,
+  //       workerDataShared]
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+
+    if (!args[0]->IsString())
+      return env->ThrowTypeError("filename must be a string");
+    if (!args[1]->IsArray())
+      return env->ThrowTypeError("execArgv must be an array");
+
+    node::Utf8Value filename(env->isolate(), args[0]);
+    std::vector<std::string> exec_argv;
+    Local<Array> exec_argv_array = args[1].As<Array>();
+    for (uint32_t i = 0; i < exec_argv_array->Length(); i += 1) {
+      node::Utf8Value arg(env->isolate(), exec_argv_array->Get(i));
+      exec_argv.push_back(*arg);
+    }
+
+    Message* worker_data = nullptr;
+    if (!args[2]->IsUndefined()) {
+      worker_data = new Message(0);
+      if (!worker_data->Serialize(env, args[2], args[3], args[4])) {
+        delete worker_data;
+        return;
+      }
+    }
+
+    new WorkerWrap(env, args.This(), new Worker(*filename,
+                                                exec_argv,
+                                                worker_data));
+  }
+
+  static void Start(const FunctionCallbackInfo<Value>& args) {
+    WorkerWrap* wrap = Unwrap<WorkerWrap>(args.Holder());
+    int err = UV_EINVAL;
+    if (IsAlive(wrap))
+      err = wrap->worker_->Start(&wrap->async_);
+    args.GetReturnValue().Set(err);
+  }
+
+  static void Terminate(const FunctionCallbackInfo<Value>& args) {
+    WorkerWrap* wrap = Unwrap<WorkerWrap>(args.Holder());
+    if (IsAlive(wrap))
+      wrap->worker_->Terminate();
+  }
+
+  // args: type, json, buffers, shared
+  static void PostMessage(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    WorkerWrap* wrap = Unwrap<WorkerWrap>(args.Holder());
+    if (IsAlive(wrap))
+      worker::PostMessage(env, args, wrap->worker_, true);
+  }
+
+  static void OnAsync(uv_async_t* handle) {
+    WorkerWrap* wrap = ContainerOf(&WorkerWrap::async_, handle);
+    Environment* env = wrap->env();
+
+    std::deque<Message*> messages;
+    bool exited;
+    wrap->worker_->TakeParentMessages(&messages, &exited);
+    DeliverMessages(wrap, &messages);
+
+    if (exited && IsAlive(wrap) && env->can_call_into_js()) {
+      wrap->worker_->Join();
+      HandleScope handle_scope(env->isolate());
+      Context::Scope context_scope(env->context());
+      Local<Value> arg = Integer::New(env->isolate(),
+                                      wrap->worker_->exit_code());
+      wrap->MakeCallback(env->onexit_string(), 1, &arg);
+    }
+  }
+
+  uv_async_t async_;
+  Worker* const worker_;
+};
+
+
+// The worker thread's end of the channel to its parent.
+class MessagePortWrap : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "MessagePort"));
+
+    env->SetProtoMethod(t, "close", HandleWrap::Close);
+    env->SetProtoMethod(t, "ref", HandleWrap::Ref);
+    env->SetProtoMethod(t, "unref", HandleWrap::Unref);
+    env->SetProtoMethod(t, "start", Start);
+    env->SetProtoMethod(t, "stop", Stop);
+    env->SetProtoMethod(t, "postMessage", PostMessage);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "MessagePort"),
+                t->GetFunction());
+  }
+
+  void Close(Local<Value> close_callback) override {
+    if (IsAlive(this))
+      worker_->DetachPort();
+    HandleWrap::Close(close_callback);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  MessagePortWrap(Environment* env, Local<Object> object, Worker* worker)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&async_),
+                   AsyncWrap::PROVIDER_WORKER),
+        worker_(worker),
+        receiving_(false) {
+    CHECK_EQ(0, uv_async_init(env->event_loop(), &async_, OnAsync));
+    worker_->AttachPort(&async_);
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+    if (env->worker_context() == nullptr)
+      return env->ThrowError("Not a worker thread");
+    new MessagePortWrap(env, args.This(), env->worker_context());
+  }
+
+  // Messages are queued until start() is called.
+  static void Start(const FunctionCallbackInfo<Value>& args) {
+    MessagePortWrap* wrap = Unwrap<MessagePortWrap>(args.Holder());
+    if (IsAlive(wrap)) {
+      wrap->receiving_ = true;
+      uv_async_send(&wrap->async_);
+    }
+  }
+
+  static void Stop(const FunctionCallbackInfo<Value>& args) {
+    MessagePortWrap* wrap = Unwrap<MessagePortWrap>(args.Holder());
+    wrap->receiving_ = false;
+  }
+
+  // args: type, json, buffers, shared
+  static void PostMessage(const FunctionCallbackInfo<Value>& args) {
+    Environment* env = Environment::GetCurrent(args);
+    MessagePortWrap* wrap = Unwrap<MessagePortWrap>(args.Holder());
+    worker::PostMessage(env, args, wrap->worker_, false);
+  }
+
+  static void OnAsync(uv_async_t* handle) {
+    MessagePortWrap* wrap = ContainerOf(&MessagePortWrap::async_, handle);
+
+    if (wrap->worker_->IsStopping())
+      return;
+
+    if (wrap->receiving_) {
+      std::deque<Message*> messages;
+      wrap->worker_->TakeWorkerMessages(&messages);
+      DeliverMessages(wrap, &messages);
+    }
+  }
+
+  uv_async_t async_;
+  Worker* const worker_;
+  bool receiving_;
+};
+
+
+// Delivers the wake-ups of the asynchronous waits of one thread, see
+// waitAsync() in lib/internal/worker.js.  notify() is called on the thread
+// that changed the memory, which queues the wake-ups here and sends the
+// handle; they are delivered on the loop of the waiting thread.
+class AtomicsWaiterWrap : public HandleWrap {
+ public:
+  static void Initialize(Environment* env, Local<Object> target) {
+    Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+    t->InstanceTemplate()->SetInternalFieldCount(1);
+    t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "AtomicsWaiter"));
+
+    env->SetProtoMethod(t, "close", HandleWrap::Close);
+    env->SetProtoMethod(t, "ref", HandleWrap::Ref);
+    env->SetProtoMethod(t, "unref", HandleWrap::Unref);
+    env->SetProtoMethod(t, "wait", Wait);
+    env->SetProtoMethod(t, "cancel", Cancel);
+
+    target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "AtomicsWaiter"),
+                t->GetFunction());
+  }
+
+  // notify() mustn't find the waits of a closed handle.
+  void Close(Local<Value> close_callback) override {
+    if (IsAlive(this)) {
+      uv_mutex_lock(&waiters_mutex);
+      for (auto it = pending_.begin(); it != pending_.end(); ++it)
+        RemoveWaiter(it->first, it->second);
+      pending_.clear();
+      woken_.clear();
+      uv_mutex_unlock(&waiters_mutex);
+    }
+    HandleWrap::Close(close_callback);
+  }
+
+  // Called by Notify() with |waiters_mutex| held.
+  void Wake(uint32_t id) {
+    pending_.erase(id);
+    woken_.push_back(id);
+    uv_async_send(&async_);
+  }
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  AtomicsWaiterWrap(Environment* env, Local<Object> object)
+      : HandleWrap(env,
+                   object,
+                   reinterpret_cast<uv_handle_t*>(&async_),
+                   AsyncWrap::PROVIDER_ATOMICSWAITER) {
+    CHECK_EQ(0, uv_async_init(env->event_loop(), &async_, OnAsync));
+  }
+
+  static void New(const FunctionCallbackInfo<Value>& args) {
+    CHECK(args.IsConstructCall());
+    Environment* env = Environment::GetCurrent(args);
+    uv_once(&shared_memory_once, InitSharedMemory);
+    new AtomicsWaiterWrap(env, args.This());
+  }
+
+  // Called with |waiters_mutex| held.
+  void RemoveWaiter(uint32_t id, int32_t* address) {
+    auto range = waiters->equal_range(address);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.owner == this && it->second.id == id) {
+        waiters->erase(it);
+        return;
+      }
+    }
+  }
+
+  // args: sab, byteOffset, value, id
+  // Starts wait |id| and returns true, or returns false if the word doesn't
+  // hold |value|.
+  static void Wait(const FunctionCallbackInfo<Value>& args) {
+    AtomicsWaiterWrap* wrap = Unwrap<AtomicsWaiterWrap>(args.Holder());
+    if (!IsAlive(wrap))
+      return args.GetReturnValue().Set(false);
+    int32_t* const address = WordAddress(args[0], args[1]);
+    const int32_t value = args[2]->Int32Value();
+    const uint32_t id = args[3]->Uint32Value();
+
+    // notify() takes the mutex after the store that it announces, so either
+    // the store is visible here or notify() finds the waiter.
+    uv_mutex_lock(&waiters_mutex);
+    const bool wait = *static_cast<volatile int32_t*>(address) == value;
+    if (wait) {
+      Waiter waiter = { wrap, id };
+      waiters->insert(std::make_pair(address, waiter));
+      wrap->pending_.insert(std::make_pair(id, address));
+    }
+    uv_mutex_unlock(&waiters_mutex);
+
+    args.GetReturnValue().Set(wait);
+  }
+
+  // args: id
+  // Returns true if wait |id| was cancelled, false if it's been woken up.
+  static void Cancel(const FunctionCallbackInfo<Value>& args) {
+    AtomicsWaiterWrap* wrap = Unwrap<AtomicsWaiterWrap>(args.Holder());
+    const uint32_t id = args[0]->Uint32Value();
+    bool cancelled = false;
+
+    uv_mutex_lock(&waiters_mutex);
+    auto it = wrap->pending_.find(id);
+    if (it != wrap->pending_.end()) {
+      wrap->RemoveWaiter(id, it->second);
+      wrap->pending_.erase(it);
+      cancelled = true;
+    }
+    uv_mutex_unlock(&waiters_mutex);
+
+    args.GetReturnValue().Set(cancelled);
+  }
+
+  // Calls wrap.onwake(ids).
+  static void OnAsync(uv_async_t* handle) {
+    AtomicsWaiterWrap* wrap = ContainerOf(&AtomicsWaiterWrap::async_, handle);
+    Environment* env = wrap->env();
+
+    std::vector<uint32_t> woken;
+    uv_mutex_lock(&waiters_mutex);
+    woken.swap(wrap->woken_);
+    uv_mutex_unlock(&waiters_mutex);
+
+    if (woken.empty() || !env->can_call_into_js())
+      return;
+
+    HandleScope handle_scope(env->isolate());
+    Context::Scope context_scope(env->context());
+    Local<Array> ids = Array::New(env->isolate(), woken.size());
+    for (size_t i = 0; i < woken.size(); i += 1)
+      ids->Set(i, Integer::NewFromUnsigned(env->isolate(), woken[i]));
+    Local<Value> arg = ids;
+    wrap->MakeCallback(env->onwake_string(), 1, &arg);
+  }
+
+  uv_async_t async_;
+  // Guarded by |waiters_mutex|.
+  std::map<uint32_t, int32_t*> pending_;
+  std::vector<uint32_t> woken_;
+};
+
+
+// args: sab, byteOffset, count
+// Wakes up to |count| of the asynchronous waits on the word, in the order
+// they started, and returns how many it woke up.
+static void Notify(const FunctionCallbackInfo<Value>& args) {
+  int32_t* const address = WordAddress(args[0], args[1]);
+  const double count = args[2]->NumberValue();
+  uint32_t woken = 0;
+  uv_once(&shared_memory_once, InitSharedMemory);
+
+  uv_mutex_lock(&waiters_mutex);
+  auto range = waiters->equal_range(address);
+  auto it = range.first;
+  while (it != range.second && woken < count) {
+    it->second.owner->Wake(it->second.id);
+    it = waiters->erase(it);
+    woken += 1;
+  }
+  uv_mutex_unlock(&waiters_mutex);
+
+  args.GetReturnValue().Set(woken);
+}
+
+
+// Returns [json, buffers, shared] or undefined.
+static void GetWorkerData(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  if (env->worker_context() == nullptr)
+    return;
+  Message* worker_data = env->worker_context()->TakeWorkerData();
+  if (worker_data == nullptr)
+    return;
+  Local<Array> result = Array::New(env->isolate(), 3);
+  result->Set(0, worker_data->DeserializeJSON(env));
+  result->Set(1, worker_data->DeserializeBuffers(env));
+  result->Set(2, worker_data->DeserializeShared(env));
+  delete worker_data;
+  args.GetReturnValue().Set(result);
+}
+
+
+// Returns a Uint8Array rather than a Buffer, the core modules that are
+// compiled before lib/buffer.js don't have Buffer.prototype yet.
+static void GetCodeCache(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  node::Utf8Value id(env->isolate(), args[0]);
+  uv_once(&code_cache_once, InitCodeCache);
+
+  char* data = nullptr;
+  size_t length = 0;
+  uv_mutex_lock(&code_cache_mutex);
+  auto it = code_cache->find(*id);
+  if (it != code_cache->end()) {
+    length = it->second.size();
+    data = static_cast<char*>(malloc(length));
+    CHECK_NE(data, nullptr);
+    memcpy(data, it->second.data(), length);
+  }
+  uv_mutex_unlock(&code_cache_mutex);
+
+  if (data == nullptr)
+    return;
+  Local<ArrayBuffer> ab =
+      ArrayBuffer::New(env->isolate(),
+                       data,
+                       length,
+                       ArrayBufferCreationMode::kInternalized);
+  args.GetReturnValue().Set(Uint8Array::New(ab, 0, length));
+}
+
+
+static void SetCodeCache(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  CHECK(Buffer::HasInstance(args[1]));
+  node::Utf8Value id(env->isolate(), args[0]);
+  std::string data(Buffer::Data(args[1]), Buffer::Length(args[1]));
+  uv_once(&code_cache_once, InitCodeCache);
+
+  uv_mutex_lock(&code_cache_mutex);
+  code_cache->insert(std::make_pair(std::string(*id), data));
+  uv_mutex_unlock(&code_cache_mutex);
+}
+
+
+static void Initialize(Local<Object> target,
+                       Local<Value> unused,
+                       Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+  Worker* worker = env->worker_context();
+
+  WorkerWrap::Initialize(env, target);
+  MessagePortWrap::Initialize(env, target);
+  AtomicsWaiterWrap::Initialize(env, target);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "isMainThread"),
+              Boolean::New(env->isolate(), worker == nullptr));
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "threadId"),
+              Integer::New(env->isolate(),
+                           worker == nullptr ? 0 : worker->thread_id()));
+
+  env->SetMethod(target, "notify", Notify);
+  env->SetMethod(target, "getWorkerData", GetWorkerData);
+  env->SetMethod(target, "getCodeCache", GetCodeCache);
+  env->SetMethod(target, "setCodeCache", SetCodeCache);
+}
+
+}  // namespace worker
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(worker, node::worker::Initialize)
@@ -0,0 +1,196 @@
+#ifndef SRC_NODE_WORKER_H_
+#define SRC_NODE_WORKER_H_
+
+#include "env.h"
+#include "util.h"
+#include "uv.h"
+#include "v8.h"
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace node {
+namespace worker {
+
+// The memory behind a SharedArrayBuffer that was posted to another thread.
+// Every SharedArrayBuffer object for it, in any isolate, holds a reference
+// and so does every message in flight that carries it; the last one to go
+// frees the memory.
+class SharedMemory {
+ public:
+  // Returns the SharedMemory of |sab| with a reference for the caller.  The
+  // first call externalizes |sab|.  Returns nullptr with an exception pending
+  // if the memory isn't malloc()'d or |sab| was externalized by an addon.
+  static SharedMemory* ForSharedArrayBuffer(
+      Environment* env,
+      v8::Local<v8::SharedArrayBuffer> sab);
+
+  // Creates a SharedArrayBuffer for the memory in |env|'s isolate, which
+  // takes over the caller's reference.
+  v8::Local<v8::SharedArrayBuffer> ToSharedArrayBuffer(Environment* env);
+
+  void Ref();
+  void Unref();
+
+  size_t length() const { return length_; }
+
+ private:
+  SharedMemory(void* data, size_t length);
+  ~SharedMemory();
+
+  void* const data_;
+  const size_t length_;
+  int refs_;  // Guarded by the registry mutex in node_worker.cc.
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemory);
+};
+
+
+// The reference that a SharedArrayBuffer object holds on its SharedMemory,
+// dropped when the object is garbage collected.  A worker thread drops the
+// references of its isolate when it stops, see Worker::Detach().
+class SharedMemoryReference {
+ public:
+  SharedMemoryReference(Environment* env,
+                        v8::Local<v8::SharedArrayBuffer> sab,
+                        SharedMemory* memory);
+  ~SharedMemoryReference();
+
+  ListNode<SharedMemoryReference> list_node_;
+
+ private:
+  static void WeakCallback(
+      const v8::WeakCallbackData<v8::SharedArrayBuffer,
+                                 SharedMemoryReference>& data);
+
+  v8::Isolate* const isolate_;
+  v8::Persistent<v8::SharedArrayBuffer> persistent_;
+  SharedMemory* const memory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedMemoryReference);
+};
+
+
+// A value posted between a worker and its parent: the JSON text that
+// lib/internal/worker.js made of it, the contents of the ArrayBuffers it
+// references, which move from one isolate to the other without a copy, and
+// the SharedArrayBuffers it references, which both sides keep using.
+class Message {
+ public:
+  explicit Message(int type) : type_(type) {}
+  ~Message();
+
+  // Takes |json|, the contents of the ArrayBuffers in the |buffers| array
+  // and a reference to the memory of the SharedArrayBuffers in the |shared|
+  // array.  The ArrayBuffers are neutered.  Returns false with an exception
+  // pending if the arrays hold anything else.
+  bool Serialize(Environment* env,
+                 v8::Local<v8::Value> json,
+                 v8::Local<v8::Value> buffers,
+                 v8::Local<v8::Value> shared);
+
+  // Hand the ArrayBuffers and SharedArrayBuffers over to the isolate of
+  // |env|.  Can be called once.
+  v8::Local<v8::Array> DeserializeBuffers(Environment* env);
+  v8::Local<v8::Array> DeserializeShared(Environment* env);
+  v8::Local<v8::String> DeserializeJSON(Environment* env) const;
+
+  int type() const { return type_; }
+
+ private:
+  const int type_;
+  std::string json_;
+  // malloc()'d, so the ArrayBuffer::Allocator of any isolate can free them.
+  std::vector<std::pair<char*, size_t> > buffers_;
+  // nullptr for empty SharedArrayBuffers, which have no memory to share.
+  std::vector<SharedMemory*> shared_;
+
+  DISALLOW_COPY_AND_ASSIGN(Message);
+};
+
+
+// A worker thread.  The parent controls it through a Worker object in JS
+// land, the thread runs its own isolate, environment and event loop, see
+// StartNodeInstance() in src/node.cc.
+//
+// The two sides share nothing but this object.  Messages are queued here
+// under |mutex_| and the receiving side is woken up through a uv_async_t on
+// its loop.  Either handle is nullptr while that side isn't listening; the
+// owner clears it under |mutex_| before it closes the handle, so uv_async_send
+// never races with uv_close.
+class Worker {
+ public:
+  Worker(const std::string& filename,
+         const std::vector<std::string>& exec_argv,
+         Message* worker_data);
+  ~Worker();
+
+  // Parent thread.
+  int Start(uv_async_t* parent_async);
+  void Terminate();
+  void Join();
+  void DetachParent();
+  void PostToWorker(Message* message);
+  // Moves the messages the worker posted to |messages| and tells whether the
+  // thread exited.
+  void TakeParentMessages(std::deque<Message*>* messages, bool* exited);
+  int exit_code() const { return exit_code_; }
+  int thread_id() const { return thread_id_; }
+
+  // Worker thread.
+  void Attach(Environment* env);
+  void Detach(Environment* env);
+  // Stops the thread with |code|, the rest of the current JS is abandoned.
+  void Exit(int code);
+  // Returns true once Exit() was called or the parent asked the thread to
+  // stop.  Called by the event loop of the thread between iterations.
+  bool IsStopping();
+  void PostToParent(Message* message);
+  void AttachPort(uv_async_t* port_async);
+  void DetachPort();
+  void TakeWorkerMessages(std::deque<Message*>* messages);
+  Message* TakeWorkerData();
+  void AddSharedMemoryReference(SharedMemoryReference* reference);
+
+  // Terminates the workers that |env| started and waits for their threads,
+  // for when |env| goes away with workers still running.
+  static void StopWorkers(Environment* env);
+
+ private:
+  static void Run(void* arg);
+
+  uv_mutex_t mutex_;
+  uv_thread_t thread_;
+  bool started_;
+  bool joined_;
+
+  const int thread_id_;
+  const std::string filename_;
+  const std::vector<std::string> exec_argv_;
+  Message* worker_data_;
+
+  // Guarded by |mutex_|.
+  uv_async_t* parent_async_;
+  uv_async_t* port_async_;
+  std::deque<Message*> to_parent_;
+  std::deque<Message*> to_worker_;
+  v8::Isolate* isolate_;
+  bool stop_requested_;
+  bool exited_;
+  bool exit_reported_;
+
+  // Worker thread only, until it exits.
+  Environment* env_;
+  int exit_code_;
+  ListHead<SharedMemoryReference,
+           &SharedMemoryReference::list_node_> shared_memory_references_;
+
+  DISALLOW_COPY_AND_ASSIGN(Worker);
+};
+
+}  // namespace worker
+}  // namespace node
+
+#endif  // SRC_NODE_WORKER_H_
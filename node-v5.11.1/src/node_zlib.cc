@@ -1,5 +1,6 @@
 #include "node.h"
 #include "node_buffer.h"
+#include "node_counters.h"
 
 #include "async-wrap.h"
 #include "async-wrap-inl.h"
@@ -16,6 +17,8 @@
 #include <string.h>
 #include <sys/types.h>
 
+#include <vector>
+
 namespace node {
 
 using v8::Array;
@@ -28,6 +31,7 @@ using v8::Local;
 using v8::Number;
 using v8::Object;
 using v8::String;
+using v8::Undefined;
 using v8::Value;
 
 enum node_zlib_mode {
@@ -70,7 +74,14 @@ class ZCtx : public AsyncWrap {
         pending_close_(false),
         refs_(0),
         first_member_ended_(false),
-        gzip_id_bytes_read_(0) {
+        gzip_id_bytes_read_(0),
+        chain_(false),
+        chain_flush_(0),
+        chain_last_flush_(0),
+        chain_total_in_(0),
+        chain_in_after_(0),
+        chain_avail_in_(0),
+        chain_next_out_(0) {
     MakeWeak<ZCtx>(this);
   }
 
@@ -78,6 +89,7 @@ class ZCtx : public AsyncWrap {
   ~ZCtx() override {
     CHECK_EQ(false, write_in_progress_ && "write in progress");
     Close();
+    ClearChain();
   }
 
   void Close() {
@@ -132,15 +144,7 @@ class ZCtx : public AsyncWrap {
     CHECK_EQ(false, args[0]->IsUndefined() && "must provide flush value");
 
     unsigned int flush = args[0]->Uint32Value();
-
-    if (flush != Z_NO_FLUSH &&
-        flush != Z_PARTIAL_FLUSH &&
-        flush != Z_SYNC_FLUSH &&
-        flush != Z_FULL_FLUSH &&
-        flush != Z_FINISH &&
-        flush != Z_BLOCK) {
-      CHECK(0 && "Invalid flush value");
-    }
+    CHECK(IsValidFlush(flush) && "Invalid flush value");
 
     Bytef *in;
     Bytef *out;
@@ -197,13 +201,134 @@ class ZCtx : public AsyncWrap {
                   work_req,
                   ZCtx::Process,
                   ZCtx::After);
+    NODE_COUNT_THREADPOOL_QUEUED();
 
     args.GetReturnValue().Set(ctx->object());
   }
 
 
+  // writeChain(flush, last_flush, inputs, outputs)
+  //
+  // Runs all of the Buffers in |inputs| through zlib in one go, |flush| is
+  // used at the end of every input but the last one and |last_flush| at the
+  // end of the last one.  The output goes to the Buffers in |outputs|, in
+  // order; once those are full, more memory is allocated on the thread pool,
+  // sized from the compression ratio seen so far.  The result is
+  // (avail_in, written, overflow): the input left after the end of the
+  // stream, the number of bytes written to |outputs| and an array of Buffers
+  // with the rest of the output, or undefined.
+  template <bool async>
+  static void WriteChain(const FunctionCallbackInfo<Value>& args) {
+    CHECK_EQ(args.Length(), 4);
+
+    ZCtx* ctx = Unwrap<ZCtx>(args.Holder());
+    CHECK(ctx->init_done_ && "write before init");
+    CHECK(ctx->mode_ != NONE && "already finalized");
+
+    CHECK_EQ(false, ctx->write_in_progress_ && "write already in progress");
+    CHECK_EQ(false, ctx->pending_close_ && "close is pending");
+
+    unsigned int flush = args[0]->Uint32Value();
+    unsigned int last_flush = args[1]->Uint32Value();
+    CHECK(IsValidFlush(flush) && "Invalid flush value");
+    CHECK(IsValidFlush(last_flush) && "Invalid flush value");
+
+    CHECK(args[2]->IsArray());
+    CHECK(args[3]->IsArray());
+    Local<Array> inputs = args[2].As<Array>();
+    Local<Array> outputs = args[3].As<Array>();
+    CHECK_GT(inputs->Length(), 0);
+
+    ctx->chain_total_in_ = 0;
+    for (uint32_t i = 0; i < inputs->Length(); i += 1) {
+      Local<Value> input = inputs->Get(i);
+      CHECK(Buffer::HasInstance(input));
+      ChainBuffer buffer;
+      buffer.data = reinterpret_cast<Bytef*>(Buffer::Data(input));
+      buffer.length = Buffer::Length(input);
+      buffer.used = 0;
+      buffer.owned = false;
+      ctx->chain_in_.push_back(buffer);
+      ctx->chain_total_in_ += buffer.length;
+    }
+    for (uint32_t i = 0; i < outputs->Length(); i += 1) {
+      Local<Value> output = outputs->Get(i);
+      CHECK(Buffer::HasInstance(output));
+      ChainBuffer buffer;
+      buffer.data = reinterpret_cast<Bytef*>(Buffer::Data(output));
+      buffer.length = Buffer::Length(output);
+      buffer.used = 0;
+      buffer.owned = false;
+      ctx->chain_out_.push_back(buffer);
+    }
+
+    ctx->write_in_progress_ = true;
+    ctx->Ref();
+
+    ctx->chain_ = true;
+    ctx->chain_flush_ = flush;
+    ctx->chain_last_flush_ = last_flush;
+    ctx->chain_in_after_ = 0;
+    ctx->chain_avail_in_ = 0;
+    ctx->chain_next_out_ = 0;
+    ctx->strm_.avail_in = 0;
+    ctx->strm_.next_in = nullptr;
+    ctx->strm_.avail_out = 0;
+    ctx->strm_.next_out = nullptr;
+
+    uv_work_t* work_req = &(ctx->work_req_);
+
+    if (!async) {
+      // sync version
+      ctx->env()->PrintSyncTrace();
+      Process(work_req);
+      if (CheckError(ctx))
+        AfterSync(ctx, args);
+      return;
+    }
+
+    // async version
+    uv_queue_work(ctx->env()->event_loop(),
+                  work_req,
+                  ZCtx::Process,
+                  ZCtx::After);
+    NODE_COUNT_THREADPOOL_QUEUED();
+
+    args.GetReturnValue().Set(ctx->object());
+  }
+
+
+  static bool IsValidFlush(unsigned int flush) {
+    return flush == Z_NO_FLUSH ||
+           flush == Z_PARTIAL_FLUSH ||
+           flush == Z_SYNC_FLUSH ||
+           flush == Z_FULL_FLUSH ||
+           flush == Z_FINISH ||
+           flush == Z_BLOCK;
+  }
+
+
   static void AfterSync(ZCtx* ctx, const FunctionCallbackInfo<Value>& args) {
     Environment* env = ctx->env();
+
+    if (ctx->chain_) {
+      Local<Integer> avail_in = Integer::New(env->isolate(),
+                                             ctx->chain_avail_in_);
+      size_t written;
+      Local<Value> overflow = ctx->TakeChainOutput(&written);
+
+      ctx->write_in_progress_ = false;
+
+      Local<Array> result = Array::New(env->isolate(), 3);
+      result->Set(0, avail_in);
+      result->Set(1, Number::New(env->isolate(), written));
+      result->Set(2, overflow);
+      args.GetReturnValue().Set(result);
+
+      ctx->Unref();
+      return;
+    }
+
     Local<Integer> avail_out = Integer::New(env->isolate(),
                                             ctx->strm_.avail_out);
     Local<Integer> avail_in = Integer::New(env->isolate(),
@@ -223,10 +348,64 @@ class ZCtx : public AsyncWrap {
   // thread pool!
   // This function may be called multiple times on the uv_work pool
   // for a single write() call, until all of the input bytes have
-  // been consumed.
+  // been consumed.  A writeChain() call is done in one go.
   static void Process(uv_work_t* work_req) {
     ZCtx *ctx = ContainerOf(&ZCtx::work_req_, work_req);
 
+    if (ctx->chain_) {
+      ProcessChain(ctx);
+      // Whatever zlib didn't fill of the last output is unused.
+      if (ctx->chain_next_out_ > 0) {
+        ChainBuffer* out = &ctx->chain_out_[ctx->chain_next_out_ - 1];
+        out->used = out->length - ctx->strm_.avail_out;
+      }
+    } else {
+      ProcessBuffer(ctx);
+    }
+  }
+
+
+  // Does what the JS side of write() does in a loop: keeps calling zlib on
+  // each input until it stops filling all of the output space.
+  static void ProcessChain(ZCtx* ctx) {
+    const size_t count = ctx->chain_in_.size();
+    size_t after = ctx->chain_total_in_;
+
+    for (size_t i = 0; i < count; i += 1) {
+      after -= ctx->chain_in_[i].length;
+      ctx->chain_in_after_ = after;
+      ctx->strm_.next_in = ctx->chain_in_[i].data;
+      ctx->strm_.avail_in = ctx->chain_in_[i].length;
+      ctx->flush_ = i + 1 < count ? ctx->chain_flush_ : ctx->chain_last_flush_;
+
+      do {
+        while (ctx->strm_.avail_out == 0) {
+          if (!ctx->NextChainOutput()) {
+            ctx->err_ = Z_MEM_ERROR;
+            return;
+          }
+        }
+
+        ProcessBuffer(ctx);
+
+        // Go on with the next input after the end of the stream, like
+        // write() would; it may hold the next member of a gzip file.
+        if (ctx->err_ == Z_STREAM_END)
+          break;
+
+        if (ctx->err_ != Z_OK && ctx->err_ != Z_BUF_ERROR) {
+          // An error for After() to report.
+          ctx->chain_avail_in_ += ctx->strm_.avail_in + after;
+          return;
+        }
+      } while (ctx->strm_.avail_out == 0);
+
+      ctx->chain_avail_in_ += ctx->strm_.avail_in;
+    }
+  }
+
+
+  static void ProcessBuffer(ZCtx* ctx) {
     const Bytef* next_expected_header_byte = nullptr;
 
     // If the avail_out is left at 0, then it means that it ran out
@@ -370,6 +549,7 @@ class ZCtx : public AsyncWrap {
   // v8 land!
   static void After(uv_work_t* work_req, int status) {
     CHECK_EQ(status, 0);
+    NODE_COUNT_THREADPOOL_DONE();
 
     ZCtx* ctx = ContainerOf(&ZCtx::work_req_, work_req);
     Environment* env = ctx->env();
@@ -380,16 +560,33 @@ class ZCtx : public AsyncWrap {
     if (!CheckError(ctx))
       return;
 
-    Local<Integer> avail_out = Integer::New(env->isolate(),
-                                            ctx->strm_.avail_out);
-    Local<Integer> avail_in = Integer::New(env->isolate(),
-                                           ctx->strm_.avail_in);
+    if (ctx->chain_) {
+      Local<Integer> avail_in = Integer::New(env->isolate(),
+                                             ctx->chain_avail_in_);
+      size_t written;
+      Local<Value> overflow = ctx->TakeChainOutput(&written);
+
+      ctx->write_in_progress_ = false;
+
+      // call the writeChain() cb
+      Local<Value> args[3] = {
+        avail_in,
+        Number::New(env->isolate(), written),
+        overflow
+      };
+      ctx->MakeCallback(env->callback_string(), arraysize(args), args);
+    } else {
+      Local<Integer> avail_out = Integer::New(env->isolate(),
+                                              ctx->strm_.avail_out);
+      Local<Integer> avail_in = Integer::New(env->isolate(),
+                                             ctx->strm_.avail_in);
 
-    ctx->write_in_progress_ = false;
+      ctx->write_in_progress_ = false;
 
-    // call the write() cb
-    Local<Value> args[2] = { avail_in, avail_out };
-    ctx->MakeCallback(env->callback_string(), arraysize(args), args);
+      // call the write() cb
+      Local<Value> args[2] = { avail_in, avail_out };
+      ctx->MakeCallback(env->callback_string(), arraysize(args), args);
+    }
 
     ctx->Unref();
     if (ctx->pending_close_)
@@ -414,6 +611,7 @@ class ZCtx : public AsyncWrap {
     ctx->MakeCallback(env->onerror_string(), arraysize(args), args);
 
     // no hope of rescue.
+    ctx->ClearChain();
     if (ctx->write_in_progress_)
       ctx->Unref();
     ctx->write_in_progress_ = false;
@@ -629,8 +827,120 @@ class ZCtx : public AsyncWrap {
     }
   }
 
+  struct ChainBuffer {
+    Bytef* data;
+    size_t length;
+    size_t used;
+    bool owned;  // Allocated by NextChainOutput(), not by the caller.
+  };
+
+  // Points zlib at the next output buffer of a writeChain(), allocating one
+  // when the caller's are full.  Called when zlib has filled the current one.
+  bool NextChainOutput() {
+    if (chain_next_out_ > 0) {
+      ChainBuffer* full = &chain_out_[chain_next_out_ - 1];
+      full->used = full->length;
+    }
+
+    if (chain_next_out_ == chain_out_.size()) {
+      const size_t length = ChainOverflowSize();
+      Bytef* data = static_cast<Bytef*>(malloc(length));
+      if (data == nullptr)
+        return false;
+      ChainBuffer buffer;
+      buffer.data = data;
+      buffer.length = length;
+      buffer.used = 0;
+      buffer.owned = true;
+      chain_out_.push_back(buffer);
+    }
+
+    ChainBuffer* out = &chain_out_[chain_next_out_];
+    chain_next_out_ += 1;
+    strm_.next_out = out->data;
+    strm_.avail_out = out->length;
+    return true;
+  }
+
+  // Guesses how much output the rest of the input will produce from the
+  // ratio so far.  Never less than what was produced so far, so that a bad
+  // guess (or the output of a final flush, which has no input left) costs
+  // a logarithmic number of allocations.
+  size_t ChainOverflowSize() const {
+    size_t produced = 0;
+    for (size_t i = 0; i < chain_out_.size(); i += 1)
+      produced += chain_out_[i].length;
+
+    const size_t remaining = strm_.avail_in + chain_in_after_;
+    const size_t consumed = chain_total_in_ - remaining;
+    double length = produced;
+    if (consumed > 0) {
+      const double estimate =
+          static_cast<double>(remaining) * produced / consumed;
+      if (estimate > length)
+        length = estimate;
+    }
+    if (length < kMinChainOverflowSize)
+      return kMinChainOverflowSize;
+    if (length > kMaxChainOverflowSize)
+      return kMaxChainOverflowSize;
+    return static_cast<size_t>(length);
+  }
+
+  // Turns the result of a writeChain() into the values returned to JS and
+  // resets the chain state.  The memory allocated by NextChainOutput() is
+  // handed to the returned Buffers without copying.
+  Local<Value> TakeChainOutput(size_t* written) {
+    Local<Array> overflow;
+    uint32_t count = 0;
+
+    *written = 0;
+    for (size_t i = 0; i < chain_out_.size(); i += 1) {
+      ChainBuffer* out = &chain_out_[i];
+      if (!out->owned) {
+        *written += out->used;
+        continue;
+      }
+      if (out->used == 0) {
+        free(out->data);
+        continue;
+      }
+      char* data = reinterpret_cast<char*>(out->data);
+      if (out->used < out->length) {
+        // Give back what the last guess overshot.
+        char* shrunk = static_cast<char*>(realloc(data, out->used));
+        if (shrunk != nullptr)
+          data = shrunk;
+      }
+      if (overflow.IsEmpty())
+        overflow = Array::New(env()->isolate());
+      overflow->Set(count++, Buffer::New(env(), data, out->used)
+                                 .ToLocalChecked());
+    }
+
+    chain_in_.clear();
+    chain_out_.clear();
+    chain_ = false;
+
+    if (overflow.IsEmpty())
+      return Undefined(env()->isolate());
+    return overflow;
+  }
+
+  void ClearChain() {
+    for (size_t i = 0; i < chain_out_.size(); i += 1) {
+      if (chain_out_[i].owned)
+        free(chain_out_[i].data);
+    }
+    chain_in_.clear();
+    chain_out_.clear();
+    chain_ = false;
+  }
+
   static const int kDeflateContextSize = 16384;  // approximate
   static const int kInflateContextSize = 10240;  // approximate
+  static const size_t kMinChainOverflowSize = 16 * 1024;
+  static const size_t kMaxChainOverflowSize = 8 * 1024 * 1024;
 
   int chunk_size_;
   Bytef* dictionary_;
@@ -650,6 +960,16 @@ class ZCtx : public AsyncWrap {
   unsigned int refs_;
   bool first_member_ended_;
   unsigned int gzip_id_bytes_read_;
+  // State of a writeChain() in progress.
+  bool chain_;
+  int chain_flush_;
+  int chain_last_flush_;
+  std::vector<ChainBuffer> chain_in_;
+  std::vector<ChainBuffer> chain_out_;
+  size_t chain_total_in_;
+  size_t chain_in_after_;  // Bytes in the inputs after the current one.
+  size_t chain_avail_in_;
+  size_t chain_next_out_;
 };
 
 
@@ -664,6 +984,8 @@ void InitZlib(Local<Object> target,
 
   env->SetProtoMethod(z, "write", ZCtx::Write<true>);
   env->SetProtoMethod(z, "writeSync", ZCtx::Write<false>);
+  env->SetProtoMethod(z, "writeChain", ZCtx::WriteChain<true>);
+  env->SetProtoMethod(z, "writeChainSync", ZCtx::WriteChain<false>);
   env->SetProtoMethod(z, "init", ZCtx::Init);
   env->SetProtoMethod(z, "close", ZCtx::Close);
   env->SetProtoMethod(z, "params", ZCtx::Params);
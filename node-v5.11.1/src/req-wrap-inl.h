@@ -6,11 +6,19 @@
 #include "async-wrap-inl.h"
 #include "env.h"
 #include "env-inl.h"
+#include "node_counters.h"
 #include "util.h"
 #include "util-inl.h"
 
 namespace node {
 
+// Requests of these types wait for and run on the thread pool.
+inline bool IsThreadPoolRequest(AsyncWrap::ProviderType provider) {
+  return provider == AsyncWrap::PROVIDER_FSREQWRAP ||
+         provider == AsyncWrap::PROVIDER_GETADDRINFOREQWRAP ||
+         provider == AsyncWrap::PROVIDER_GETNAMEINFOREQWRAP;
+}
+
 template <typename T>
 ReqWrap<T>::ReqWrap(Environment* env,
                     v8::Local<v8::Object> object,
@@ -22,6 +30,8 @@ ReqWrap<T>::ReqWrap(Environment* env,
   // FIXME(bnoordhuis) The fact that a reinterpret_cast is needed is
   // arguably a good indicator that there should be more than one queue.
   env->req_wrap_queue()->PushBack(reinterpret_cast<ReqWrap<uv_req_t>*>(this));
+  if (IsThreadPoolRequest(provider))
+    NODE_COUNT_THREADPOOL_QUEUED();
 }
 
 template <typename T>
@@ -29,6 +39,8 @@ ReqWrap<T>::~ReqWrap() {
   CHECK_EQ(req_.data, this);  // Assert that someone has called Dispatched().
   CHECK_EQ(false, persistent().IsEmpty());
   persistent().Reset();
+  if (IsThreadPoolRequest(provider_type()))
+    NODE_COUNT_THREADPOOL_DONE();
 }
 
 template <typename T>
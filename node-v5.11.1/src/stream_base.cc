@@ -118,13 +118,8 @@ int StreamBase::Writev(const FunctionCallbackInfo<Value>& args) {
     Local<String> string = chunk->ToString(env->isolate());
     enum encoding encoding = ParseEncoding(env->isolate(),
                                            chunks->Get(i * 2 + 1));
-    size_t chunk_size;
-    if (encoding == UTF8 && string->Length() > 65535)
-      chunk_size = StringBytes::Size(env->isolate(), string, encoding);
-    else
-      chunk_size = StringBytes::StorageSize(env->isolate(), string, encoding);
-
-    storage_size += chunk_size;
+    storage_size +=
+        StringBytes::WriteStorageSize(env->isolate(), string, encoding);
   }
 
   if (storage_size > INT_MAX)
@@ -256,13 +251,8 @@ int StreamBase::WriteString(const FunctionCallbackInfo<Value>& args) {
   int err;
 
   // Compute the size of the storage that the string will be flattened into.
-  // For UTF8 strings that are very long, go ahead and take the hit for
-  // computing their actual size, rather than tripling the storage.
-  size_t storage_size;
-  if (enc == UTF8 && string->Length() > 65535)
-    storage_size = StringBytes::Size(env->isolate(), string, enc);
-  else
-    storage_size = StringBytes::StorageSize(env->isolate(), string, enc);
+  size_t storage_size =
+      StringBytes::WriteStorageSize(env->isolate(), string, enc);
 
   if (storage_size > INT_MAX)
     return UV_ENOBUFS;
@@ -0,0 +1,469 @@
+#include "stream_pipe.h"
+#include "stream_base.h"
+#include "stream_base-inl.h"
+#include "stream_wrap.h"
+
+#include "async-wrap.h"
+#include "async-wrap-inl.h"
+#include "env.h"
+#include "env-inl.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <stdlib.h>  // malloc, free
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>  // splice, pipe2
+#include <unistd.h>
+#endif  // __linux__
+
+namespace node {
+
+using v8::Boolean;
+using v8::Context;
+using v8::External;
+using v8::FunctionCallbackInfo;
+using v8::FunctionTemplate;
+using v8::HandleScope;
+using v8::Integer;
+using v8::Local;
+using v8::Object;
+using v8::Value;
+
+// What a write to the sink needs to remember, in the WriteWrap's storage.
+struct PendingWrite {
+  StreamPipe* pipe;
+  char* data;
+  size_t length;
+};
+
+
+StreamPipe::StreamPipe(Environment* env,
+                       Local<Object> object,
+                       StreamBase* source,
+                       StreamBase* sink,
+                       size_t high_water_mark)
+    : AsyncWrap(env, object, AsyncWrap::PROVIDER_STREAMPIPE),
+      source_(source),
+      sink_(sink),
+      high_water_mark_(high_water_mark),
+      started_(false),
+      reading_(false),
+      finished_(false),
+      unpiped_(false),
+      completed_(false),
+      status_(0),
+      status_in_sink_(false),
+      pending_writes_(0),
+      pending_bytes_(0),
+      splicing_(false),
+      source_fd_(-1),
+      sink_fd_(-1),
+      in_pipe_(0),
+      eof_(false),
+      waiting_for_sink_queue_(false),
+      open_polls_(0) {
+  pipe_fds_[0] = pipe_fds_[1] = -1;
+  node::Wrap(object, this);
+  MakeWeak<StreamPipe>(this);
+}
+
+
+StreamPipe::~StreamPipe() {
+  // Kept alive by Start() until everything is done.
+  CHECK(!started_ || completed_);
+}
+
+
+void StreamPipe::New(const FunctionCallbackInfo<Value>& args) {
+  CHECK(args.IsConstructCall());
+  CHECK(args[0]->IsExternal());
+  CHECK(args[1]->IsExternal());
+  Environment* env = Environment::GetCurrent(args);
+  StreamBase* source =
+      static_cast<StreamBase*>(args[0].As<External>()->Value());
+  StreamBase* sink = static_cast<StreamBase*>(args[1].As<External>()->Value());
+  new StreamPipe(env, args.This(), source, sink, args[2]->Uint32Value());
+}
+
+
+// start(splice) starts moving data, with splice() if |splice| is true and the
+// platform has it.  Returns 0 or an error code.
+void StreamPipe::Start(const FunctionCallbackInfo<Value>& args) {
+  StreamPipe* pipe = Unwrap<StreamPipe>(args.Holder());
+  CHECK(!pipe->started_);
+
+  if (!pipe->source_->IsAlive() || pipe->source_->IsClosing() ||
+      !pipe->sink_->IsAlive() || pipe->sink_->IsClosing()) {
+    return args.GetReturnValue().Set(UV_EINVAL);
+  }
+
+  int err = UV_ENOSYS;
+#ifdef __linux__
+  if (args[0]->IsTrue())
+    err = pipe->StartSplice();
+#endif  // __linux__
+  if (err != 0)
+    err = pipe->StartCopy();
+
+  if (err == 0) {
+    pipe->started_ = true;
+    pipe->ClearWeak();
+  }
+  args.GetReturnValue().Set(err);
+}
+
+
+void StreamPipe::Unpipe(const FunctionCallbackInfo<Value>& args) {
+  StreamPipe* pipe = Unwrap<StreamPipe>(args.Holder());
+  pipe->unpiped_ = true;
+  pipe->Finish(UV_ECANCELED, false);
+}
+
+
+void StreamPipe::Finish(int status, bool in_sink) {
+  if (!started_ || finished_)
+    return;
+  finished_ = true;
+  status_ = status;
+  status_in_sink_ = in_sink;
+
+  if (reading_) {
+    source_->ReadStop();
+    reading_ = false;
+  }
+
+  if (splicing_) {
+#ifdef __linux__
+    uv_close(reinterpret_cast<uv_handle_t*>(&source_poll_), OnPollClose);
+    uv_close(reinterpret_cast<uv_handle_t*>(&sink_poll_), OnPollClose);
+    sink_->set_after_write_cb(sink_after_write_cb_);
+#endif  // __linux__
+  } else {
+    source_->set_alloc_cb(source_alloc_cb_);
+    source_->set_read_cb(source_read_cb_);
+  }
+
+  MaybeComplete();
+}
+
+
+void StreamPipe::MaybeComplete() {
+  if (!finished_ || completed_ || pending_writes_ > 0 || open_polls_ > 0)
+    return;
+  completed_ = true;
+
+  if (!unpiped_) {
+    HandleScope handle_scope(env()->isolate());
+    Context::Scope context_scope(env()->context());
+    Local<Value> argv[] = {
+      Integer::New(env()->isolate(), status_),
+      Boolean::New(env()->isolate(), status_in_sink_)
+    };
+    MakeCallback(env()->oncomplete_string(), arraysize(argv), argv);
+  }
+
+  MakeWeak<StreamPipe>(this);
+}
+
+
+int StreamPipe::StartCopy() {
+  source_alloc_cb_ = source_->alloc_cb();
+  source_read_cb_ = source_->read_cb();
+  source_->set_alloc_cb({ OnAlloc, this });
+  source_->set_read_cb({ OnRead, this });
+
+  int err = source_->ReadStart();
+  if (err != 0) {
+    source_->set_alloc_cb(source_alloc_cb_);
+    source_->set_read_cb(source_read_cb_);
+    return err;
+  }
+  reading_ = true;
+  return 0;
+}
+
+
+void StreamPipe::OnAlloc(size_t size, uv_buf_t* buf, void* ctx) {
+  buf->base = static_cast<char*>(malloc(size));
+  buf->len = size;
+
+  if (buf->base == nullptr && size > 0)
+    FatalError("node::StreamPipe::OnAlloc(size_t, uv_buf_t*, void*)",
+               "Out Of Memory");
+}
+
+
+void StreamPipe::OnRead(ssize_t nread,
+                        const uv_buf_t* buf,
+                        uv_handle_type pending,
+                        void* ctx) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(ctx);
+
+  if (nread <= 0) {
+    if (buf != nullptr)
+      free(buf->base);
+    if (nread < 0)
+      pipe->Finish(nread == UV_EOF ? 0 : nread, false);
+    return;
+  }
+
+  pipe->Write(buf->base, nread);
+}
+
+
+// Takes ownership of |data|.
+void StreamPipe::Write(char* data, size_t length) {
+  uv_buf_t buf = uv_buf_init(data, length);
+  uv_buf_t* bufs = &buf;
+  size_t count = 1;
+
+  int err = sink_->DoTryWrite(&bufs, &count);
+  if (err != 0 || count == 0) {
+    free(data);
+    if (err != 0) {
+      sink_->ClearError();
+      Finish(err, true);
+    }
+    return;
+  }
+
+  Local<Object> req_wrap_obj =
+      env()->write_wrap_constructor_function()->NewInstance();
+  WriteWrap* req_wrap = WriteWrap::New(env(),
+                                       req_wrap_obj,
+                                       sink_,
+                                       AfterWrite,
+                                       sizeof(PendingWrite));
+  PendingWrite* write = reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+  write->pipe = this;
+  write->data = data;
+  write->length = bufs[0].len;
+
+  err = sink_->DoWrite(req_wrap, bufs, count, nullptr);
+  if (err != 0) {
+    req_wrap->Dispose();
+    free(data);
+    sink_->ClearError();
+    Finish(err, true);
+    return;
+  }
+
+  pending_writes_++;
+  pending_bytes_ += write->length;
+  if (pending_bytes_ >= high_water_mark_ && reading_) {
+    source_->ReadStop();
+    reading_ = false;
+  }
+}
+
+
+void StreamPipe::AfterWrite(WriteWrap* req_wrap, int status) {
+  PendingWrite* write = reinterpret_cast<PendingWrite*>(req_wrap->Extra());
+  StreamPipe* pipe = write->pipe;
+  free(write->data);
+  pipe->pending_writes_--;
+  pipe->pending_bytes_ -= write->length;
+  req_wrap->Dispose();
+
+  if (status != 0) {
+    pipe->Finish(status, true);
+  } else if (!pipe->finished_ && !pipe->reading_ &&
+             pipe->pending_bytes_ < pipe->high_water_mark_) {
+    int err = pipe->source_->ReadStart();
+    if (err != 0)
+      pipe->Finish(err, false);
+    else
+      pipe->reading_ = true;
+  }
+
+  pipe->MaybeComplete();
+}
+
+
+#ifdef __linux__
+// Returns a negated errno.
+static int DupFD(int fd) {
+  int r = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  return r == -1 ? -errno : r;
+}
+
+
+int StreamPipe::StartSplice() {
+  int source_fd = source_->GetFD();
+  int sink_fd = sink_->GetFD();
+  if (source_fd < 0 || sink_fd < 0)
+    return UV_EINVAL;
+
+  if (pipe2(pipe_fds_, O_NONBLOCK | O_CLOEXEC) == -1)
+    return -errno;
+
+  source_fd_ = DupFD(source_fd);
+  sink_fd_ = DupFD(sink_fd);
+  int err = source_fd_ < 0 ? source_fd_ : sink_fd_ < 0 ? sink_fd_ : 0;
+  if (err == 0)
+    err = uv_poll_init(env()->event_loop(), &source_poll_, source_fd_);
+  if (err == 0) {
+    err = uv_poll_init(env()->event_loop(), &sink_poll_, sink_fd_);
+    if (err != 0)
+      uv_close(reinterpret_cast<uv_handle_t*>(&source_poll_), nullptr);
+  }
+  if (err != 0) {
+    // The close callback of source_poll_ doesn't touch the fds.
+    const int fds[] = { pipe_fds_[0], pipe_fds_[1], source_fd_, sink_fd_ };
+    for (size_t i = 0; i < arraysize(fds); i++) {
+      if (fds[i] >= 0)
+        close(fds[i]);
+    }
+    pipe_fds_[0] = pipe_fds_[1] = source_fd_ = sink_fd_ = -1;
+    return err;
+  }
+
+  source_poll_.data = this;
+  sink_poll_.data = this;
+  open_polls_ = 2;
+  splicing_ = true;
+
+  sink_after_write_cb_ = sink_->after_write_cb();
+  sink_->set_after_write_cb({ OnSinkAfterWrite, this });
+
+  // The source's own reads would compete for the data.
+  source_->ReadStop();
+  WaitFor(&source_poll_, UV_READABLE);
+  return 0;
+}
+
+
+// Watches the source or the sink, never both: while the sink can't take what
+// is in the pipe, the source isn't read.
+void StreamPipe::WaitFor(uv_poll_t* poll, int events) {
+  uv_poll_t* other = poll == &source_poll_ ? &sink_poll_ : &source_poll_;
+  uv_poll_stop(other);
+  int err = uv_poll_start(poll,
+                          events,
+                          poll == &source_poll_ ? OnSourceReadable :
+                                                  OnSinkWritable);
+  if (err != 0)
+    Finish(err, poll == &sink_poll_);
+}
+
+
+void StreamPipe::Splice() {
+  static const size_t kSpliceSize = 64 * 1024;
+  static const unsigned int kFlags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+
+  // Give other handles a chance after this many rounds, the poll is level
+  // triggered and comes back on the next iteration of the loop.
+  for (int i = 0; i < 16; i++) {
+    while (in_pipe_ > 0) {
+      // A write from JS land that libuv only partly wrote has to be finished
+      // first, or the spliced data ends up in the middle of it.
+      if (SinkWriteQueueSize() > 0) {
+        uv_poll_stop(&source_poll_);
+        uv_poll_stop(&sink_poll_);
+        waiting_for_sink_queue_ = true;
+        return;
+      }
+      ssize_t n = splice(pipe_fds_[0], nullptr, sink_fd_, nullptr,
+                         in_pipe_, kFlags);
+      if (n == -1 && errno == EINTR)
+        continue;
+      if (n == -1 && errno == EAGAIN)
+        return WaitFor(&sink_poll_, UV_WRITABLE);
+      if (n == -1)
+        return Finish(-errno, true);
+      in_pipe_ -= n;
+    }
+
+    if (eof_)
+      return Finish(0, false);
+
+    ssize_t n = splice(source_fd_, nullptr, pipe_fds_[1], nullptr,
+                       kSpliceSize, kFlags);
+    if (n == -1 && errno == EINTR)
+      continue;
+    if (n == -1 && errno == EAGAIN)
+      return WaitFor(&source_poll_, UV_READABLE);
+    if (n == -1)
+      return Finish(-errno, false);
+    if (n == 0)
+      eof_ = true;
+    in_pipe_ += n;
+  }
+
+  WaitFor(&source_poll_, UV_READABLE);
+}
+
+
+void StreamPipe::OnSourceReadable(uv_poll_t* handle, int status, int events) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(handle->data);
+  if (status != 0)
+    return pipe->Finish(status, false);
+  pipe->Splice();
+}
+
+
+void StreamPipe::OnSinkWritable(uv_poll_t* handle, int status, int events) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(handle->data);
+  if (status != 0)
+    return pipe->Finish(status, true);
+  pipe->Splice();
+}
+
+
+// Only TCP sockets are spliced, the sink is a StreamWrap.
+size_t StreamPipe::SinkWriteQueueSize() {
+  return sink_->Cast<StreamWrap>()->stream()->write_queue_size;
+}
+
+
+void StreamPipe::OnSinkAfterWrite(WriteWrap* w, void* ctx) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(ctx);
+  StreamResource::Callback<StreamResource::AfterWriteCb> next =
+      pipe->sink_after_write_cb_;
+  if (!next.is_empty())
+    next.fn(w, next.ctx);
+
+  // Splice again once the sink's poll comes back, JS land hears of the write
+  // first.
+  if (pipe->waiting_for_sink_queue_ && !pipe->finished_ &&
+      pipe->SinkWriteQueueSize() == 0) {
+    pipe->waiting_for_sink_queue_ = false;
+    pipe->WaitFor(&pipe->sink_poll_, UV_WRITABLE);
+  }
+}
+
+
+void StreamPipe::OnPollClose(uv_handle_t* handle) {
+  StreamPipe* pipe = static_cast<StreamPipe*>(handle->data);
+  if (--pipe->open_polls_ > 0)
+    return;
+  close(pipe->pipe_fds_[0]);
+  close(pipe->pipe_fds_[1]);
+  close(pipe->source_fd_);
+  close(pipe->sink_fd_);
+  pipe->MaybeComplete();
+}
+#endif  // __linux__
+
+
+void StreamPipe::Initialize(Local<Object> target,
+                            Local<Value> unused,
+                            Local<Context> context) {
+  Environment* env = Environment::GetCurrent(context);
+
+  Local<FunctionTemplate> t = env->NewFunctionTemplate(New);
+  t->SetClassName(FIXED_ONE_BYTE_STRING(env->isolate(), "StreamPipe"));
+  t->InstanceTemplate()->SetInternalFieldCount(1);
+
+  env->SetProtoMethod(t, "start", Start);
+  env->SetProtoMethod(t, "unpipe", Unpipe);
+
+  target->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "StreamPipe"),
+              t->GetFunction());
+}
+
+}  // namespace node
+
+NODE_MODULE_CONTEXT_AWARE_BUILTIN(stream_pipe, node::StreamPipe::Initialize)
@@ -0,0 +1,109 @@
+#ifndef SRC_STREAM_PIPE_H_
+#define SRC_STREAM_PIPE_H_
+
+#include "stream_base.h"
+
+#include "async-wrap.h"
+#include "env.h"
+#include "uv.h"
+#include "v8.h"
+
+namespace node {
+
+// Moves everything that is read from one StreamBase to another without a
+// detour through JS land.  The read callbacks of the source are replaced
+// while the pipe runs, each chunk that is read is written to the sink as it
+// is, and the source stops reading while more than |high_water_mark_| bytes
+// wait to be written.  Between two TCP sockets on Linux, the data is moved
+// with splice() and never leaves the kernel.  Writes from JS land may go
+// to the sink while the pipe runs; whatever of them libuv still has queued
+// goes out before the next splice() into the sink.
+//
+// JS land hears from the pipe once: `oncomplete(status, inSink)` is called
+// with status 0 after the source ended and everything was written, or with
+// the error of the read or, if inSink is true, the write that failed.  The
+// streams must stay open while the pipe runs, unpipe() stops it early.
+class StreamPipe : public AsyncWrap {
+ public:
+  static void Initialize(v8::Local<v8::Object> target,
+                         v8::Local<v8::Value> unused,
+                         v8::Local<v8::Context> context);
+
+  ~StreamPipe() override;
+
+  size_t self_size() const override { return sizeof(*this); }
+
+ private:
+  StreamPipe(Environment* env,
+             v8::Local<v8::Object> object,
+             StreamBase* source,
+             StreamBase* sink,
+             size_t high_water_mark);
+
+  static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Start(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void Unpipe(const v8::FunctionCallbackInfo<v8::Value>& args);
+
+  // Copying through user space, for any pair of streams.
+  int StartCopy();
+  void Write(char* data, size_t length);
+  static void OnAlloc(size_t size, uv_buf_t* buf, void* ctx);
+  static void OnRead(ssize_t nread,
+                     const uv_buf_t* buf,
+                     uv_handle_type pending,
+                     void* ctx);
+  static void AfterWrite(WriteWrap* req_wrap, int status);
+
+#ifdef __linux__
+  // splice() through a kernel pipe, for two TCP sockets.
+  int StartSplice();
+  void Splice();
+  void WaitFor(uv_poll_t* poll, int events);
+  static void OnSourceReadable(uv_poll_t* handle, int status, int events);
+  static void OnSinkWritable(uv_poll_t* handle, int status, int events);
+  static void OnSinkAfterWrite(WriteWrap* w, void* ctx);
+  size_t SinkWriteQueueSize();
+  static void OnPollClose(uv_handle_t* handle);
+#endif  // __linux__
+
+  // Stops moving data and calls oncomplete() once the pending writes are
+  // done, unless the pipe was unpiped.
+  void Finish(int status, bool in_sink);
+  void MaybeComplete();
+
+  StreamBase* const source_;
+  StreamBase* const sink_;
+  StreamResource::Callback<StreamResource::AllocCb> source_alloc_cb_;
+  StreamResource::Callback<StreamResource::ReadCb> source_read_cb_;
+  StreamResource::Callback<StreamResource::AfterWriteCb> sink_after_write_cb_;
+  const size_t high_water_mark_;
+
+  bool started_;
+  bool reading_;
+  bool finished_;
+  bool unpiped_;
+  bool completed_;
+  int status_;
+  bool status_in_sink_;
+
+  // Copying.
+  size_t pending_writes_;
+  size_t pending_bytes_;
+
+  // Splicing.  The polls watch duplicates of the sockets' fds, libuv
+  // doesn't allow two watchers on one fd.
+  bool splicing_;
+  int source_fd_;
+  int sink_fd_;
+  int pipe_fds_[2];
+  size_t in_pipe_;
+  bool eof_;
+  bool waiting_for_sink_queue_;
+  int open_polls_;
+  uv_poll_t source_poll_;
+  uv_poll_t sink_poll_;
+};
+
+}  // namespace node
+
+#endif  // SRC_STREAM_PIPE_H_
@@ -310,6 +310,12 @@ int StreamWrap::DoTryWrite(uv_buf_t** bufs, size_t* count) {
   if (err < 0)
     return err;
 
+  if (stream()->type == UV_TCP) {
+    NODE_COUNT_NET_BYTES_SENT(err);
+  } else if (stream()->type == UV_NAMED_PIPE) {
+    NODE_COUNT_PIPE_BYTES_SENT(err);
+  }
+
   // Slice off the buffers: skip all written buffers and slice the one that
   // was partially written.
   written = err;
@@ -564,6 +564,15 @@ size_t StringBytes::Size(Isolate* isolate,
 }
 
 
+size_t StringBytes::WriteStorageSize(Isolate* isolate,
+                                     Local<String> string,
+                                     enum encoding encoding) {
+  if (encoding == UTF8 && string->Length() > 65535)
+    return Size(isolate, string, encoding);
+  return StorageSize(isolate, string, encoding);
+}
+
+
 
 
 static bool contains_non_ascii_slow(const char* buf, size_t len) {
@@ -76,6 +76,13 @@ class StringBytes {
                      v8::Local<v8::Value> val,
                      enum encoding enc);
 
+  // The storage that a string written to a stream is flattened into.  For
+  // very long UTF-8 strings it takes the hit of computing their actual size,
+  // rather than tripling the storage.
+  static size_t WriteStorageSize(v8::Isolate* isolate,
+                                 v8::Local<v8::String> string,
+                                 enum encoding enc);
+
   // If the string is external then assign external properties to data and len,
   // then return true. If not return false.
   static bool GetExternalParts(v8::Isolate* isolate,
@@ -12,10 +12,24 @@
 #include "util-inl.h"
 
 #include <stdlib.h>
+#include <string.h>  // memcpy
+
+#if defined(__linux__)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>  // close
+#endif
 
 
 namespace node {
 
+using v8::Array;
 using v8::Boolean;
 using v8::Context;
 using v8::EscapableHandleScope;
@@ -26,6 +40,7 @@ using v8::FunctionTemplate;
 using v8::HandleScope;
 using v8::Integer;
 using v8::Local;
+using v8::Number;
 using v8::Object;
 using v8::PropertyAttribute;
 using v8::String;
@@ -103,6 +118,10 @@ void TCPWrap::Initialize(Local<Object> target,
                       GetSockOrPeerName<TCPWrap, uv_tcp_getpeername>);
   env->SetProtoMethod(t, "setNoDelay", SetNoDelay);
   env->SetProtoMethod(t, "setKeepAlive", SetKeepAlive);
+  env->SetProtoMethod(t, "setAutoCork", SetAutoCork);
+  env->SetProtoMethod(t, "flushCork", FlushCork);
+  env->SetProtoMethod(t, "getWriteStats", GetWriteStats);
+  env->SetProtoMethod(t, "setAcceptOptions", SetAcceptOptions);
 
 #ifdef _WIN32
   env->SetProtoMethod(t, "setSimultaneousAccepts", SetSimultaneousAccepts);
@@ -150,7 +169,18 @@ TCPWrap::TCPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
                  object,
                  reinterpret_cast<uv_stream_t*>(&handle_),
                  AsyncWrap::PROVIDER_TCPWRAP,
-                 parent) {
+                 parent),
+      cork_prepare_(nullptr),
+      auto_cork_(false),
+      try_write_pending_(false),
+      cork_budget_(0),
+      corked_since_(0),
+      writes_(0),
+      batches_(0),
+      accept_batch_(1),
+      accept_no_delay_(false),
+      accept_keep_alive_(false),
+      accept_keep_alive_delay_(0) {
   int r = uv_tcp_init(env->event_loop(), &handle_);
   CHECK_EQ(r, 0);  // How do we proxy this error up to javascript?
                    // Suggestion: uv_tcp_init() returns void.
@@ -160,6 +190,14 @@ TCPWrap::TCPWrap(Environment* env, Local<Object> object, AsyncWrap* parent)
 
 TCPWrap::~TCPWrap() {
   CHECK(persistent().IsEmpty());
+  if (cork_prepare_ != nullptr) {
+    // The prepare handle outlives the wrap until its close callback ran.
+    cork_prepare_->data = nullptr;
+    uv_close(reinterpret_cast<uv_handle_t*>(cork_prepare_),
+             [](uv_handle_t* handle) {
+               delete reinterpret_cast<uv_prepare_t*>(handle);
+             });
+  }
 }
 
 
@@ -180,6 +218,154 @@ void TCPWrap::SetKeepAlive(const FunctionCallbackInfo<Value>& args) {
 }
 
 
+void TCPWrap::SetAutoCork(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  bool enable = args[0]->BooleanValue();
+#if defined(__linux__) && defined(TCP_CORK)
+  if (enable) {
+    double budget = args[1]->NumberValue();  // Microseconds.
+    if (wrap->cork_prepare_ == nullptr) {
+      wrap->cork_prepare_ = new uv_prepare_t;
+      uv_prepare_init(wrap->env()->event_loop(), wrap->cork_prepare_);
+      uv_unref(reinterpret_cast<uv_handle_t*>(wrap->cork_prepare_));
+      wrap->cork_prepare_->data = wrap;
+    }
+    wrap->cork_budget_ = budget > 0 ? static_cast<uint64_t>(budget * 1e3) : 0;
+  } else {
+    wrap->Uncork();
+  }
+  wrap->auto_cork_ = enable;
+  args.GetReturnValue().Set(0);
+#else
+  args.GetReturnValue().Set(enable ? UV_ENOTSUP : 0);
+  static_cast<void>(wrap);
+#endif
+}
+
+
+void TCPWrap::FlushCork(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  wrap->Uncork();
+}
+
+
+// Returns the number of write requests, the number of batches that auto cork
+// has released and, where the kernel keeps count, the number of TCP segments
+// with data that went out on the socket.
+void TCPWrap::GetWriteStats(const FunctionCallbackInfo<Value>& args) {
+  Environment* env = Environment::GetCurrent(args);
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  Local<Object> stats = Object::New(env->isolate());
+  stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "writes"),
+             Number::New(env->isolate(), wrap->writes_));
+  stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "batches"),
+             Number::New(env->isolate(), wrap->batches_));
+#if defined(__linux__) && defined(TCP_INFO)
+  // tcpi_data_segs_out appeared in Linux 4.6 and is missing from older libc
+  // headers.  struct tcp_info only ever grows, so read the field from its
+  // fixed offset when the kernel fills in that much of the struct.
+  static const size_t kDataSegsOutOffset = 156;
+  uv_os_fd_t fd;
+  uint8_t info[256];
+  socklen_t length = sizeof(info);
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle_), &fd) == 0 &&
+      getsockopt(fd, IPPROTO_TCP, TCP_INFO, info, &length) == 0 &&
+      length >= kDataSegsOutOffset + sizeof(uint32_t)) {
+    uint32_t segments;
+    memcpy(&segments, info + kDataSegsOutOffset, sizeof(segments));
+    stats->Set(FIXED_ONE_BYTE_STRING(env->isolate(), "segments"),
+               Number::New(env->isolate(), segments));
+  }
+#endif
+  args.GetReturnValue().Set(stats);
+}
+
+
+void TCPWrap::SetAcceptOptions(const FunctionCallbackInfo<Value>& args) {
+  TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
+  uint32_t batch = args[0]->Uint32Value();
+  wrap->accept_batch_ = batch > 0 ? batch : 1;
+  wrap->accept_no_delay_ = args[1]->BooleanValue();
+  wrap->accept_keep_alive_ = args[2]->BooleanValue();
+  wrap->accept_keep_alive_delay_ = args[3]->Uint32Value();
+}
+
+
+void TCPWrap::OnCorkPrepare(uv_prepare_t* handle) {
+  TCPWrap* wrap = static_cast<TCPWrap*>(handle->data);
+  if (wrap != nullptr)
+    wrap->Uncork();
+}
+
+
+void TCPWrap::Cork() {
+#if defined(__linux__) && defined(TCP_CORK)
+  uv_os_fd_t fd;
+  int on = 1;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) != 0 ||
+      setsockopt(fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on)) != 0) {
+    return;
+  }
+  corked_since_ = uv_hrtime();
+  uv_prepare_start(cork_prepare_, OnCorkPrepare);
+#endif
+}
+
+
+void TCPWrap::Uncork() {
+#if defined(__linux__) && defined(TCP_CORK)
+  if (corked_since_ == 0)
+    return;
+  corked_since_ = 0;
+  batches_ += 1;
+  uv_prepare_stop(cork_prepare_);
+  uv_os_fd_t fd;
+  int off = 0;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &fd) == 0)
+    setsockopt(fd, IPPROTO_TCP, TCP_CORK, &off, sizeof(off));
+#endif
+}
+
+
+void TCPWrap::BeginWrite() {
+  if (auto_cork_ && corked_since_ == 0)
+    Cork();
+}
+
+
+void TCPWrap::EndWrite() {
+  if (corked_since_ != 0 && uv_hrtime() - corked_since_ >= cork_budget_)
+    Uncork();
+}
+
+
+int TCPWrap::DoTryWrite(uv_buf_t** bufs, size_t* count) {
+  writes_ += 1;
+  BeginWrite();
+  int err = StreamWrap::DoTryWrite(bufs, count);
+  // Whatever is left goes to DoWrite() as part of the same write.
+  try_write_pending_ = err == 0 && *count > 0;
+  if (!try_write_pending_)
+    EndWrite();
+  return err;
+}
+
+
+int TCPWrap::DoWrite(WriteWrap* w,
+                     uv_buf_t* bufs,
+                     size_t count,
+                     uv_stream_t* send_handle) {
+  if (!try_write_pending_) {
+    writes_ += 1;
+    BeginWrite();
+  }
+  try_write_pending_ = false;
+  int err = StreamWrap::DoWrite(w, bufs, count, send_handle);
+  EndWrite();
+  return err;
+}
+
+
 #ifdef _WIN32
 void TCPWrap::SetSimultaneousAccepts(const FunctionCallbackInfo<Value>& args) {
   TCPWrap* wrap = Unwrap<TCPWrap>(args.Holder());
@@ -265,6 +451,12 @@ void TCPWrap::OnConnection(uv_stream_t* handle, int status) {
     if (uv_accept(handle, client_handle))
       return;
 
+    tcp_wrap->ApplyAcceptOptions(wrap);
+    if (tcp_wrap->accept_batch_ > 1) {
+      tcp_wrap->AcceptBatch(client_obj);
+      return;
+    }
+
     // Successful accept. Call the onconnection callback in JavaScript land.
     argv[1] = client_obj;
   }
@@ -273,6 +465,70 @@ void TCPWrap::OnConnection(uv_stream_t* handle, int status) {
 }
 
 
+void TCPWrap::ApplyAcceptOptions(TCPWrap* client) {
+  if (accept_no_delay_)
+    uv_tcp_nodelay(&client->handle_, 1);
+  if (accept_keep_alive_)
+    uv_tcp_keepalive(&client->handle_, 1, accept_keep_alive_delay_);
+}
+
+
+#ifndef _WIN32
+static int AcceptSocket(int server_fd) {
+  int fd;
+  do {
+#if defined(__linux__) && defined(SOCK_NONBLOCK)
+    fd = accept4(server_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+    fd = accept(server_fd, nullptr, nullptr);
+#endif
+  } while (fd == -1 && errno == EINTR);
+#if !defined(__linux__) || !defined(SOCK_NONBLOCK)
+  if (fd != -1)
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+  return fd;
+}
+#endif
+
+
+// libuv hands out one connection per callback. Take the ones that are
+// already queued up behind it straight off the listen socket, until there
+// are none left or the batch is full. Whatever error accept() runs into,
+// libuv runs into it as well when it tries next and reports it then. A
+// connection that can't be wrapped is closed and left out of the batch.
+void TCPWrap::AcceptBatch(Local<Object> first) {
+  Environment* env = this->env();
+  Local<Array> clients = Array::New(env->isolate(), 1);
+  clients->Set(0, first);
+
+#ifndef _WIN32
+  uv_os_fd_t server_fd;
+  if (uv_fileno(reinterpret_cast<uv_handle_t*>(&handle_), &server_fd) == 0) {
+    uint32_t count = 1;
+    for (uint32_t i = 1; i < accept_batch_; i++) {
+      int fd = AcceptSocket(server_fd);
+      if (fd == -1)
+        break;
+      Local<Object> client_obj =
+          Instantiate(env, static_cast<AsyncWrap*>(this));
+      TCPWrap* wrap = Unwrap<TCPWrap>(client_obj);
+      if (uv_tcp_open(&wrap->handle_, fd) != 0) {
+        close(fd);
+        wrap->Close();
+        continue;
+      }
+      ApplyAcceptOptions(wrap);
+      clients->Set(count++, client_obj);
+    }
+  }
+#endif
+
+  Local<Value> arg = clients;
+  MakeCallback(env->onconnections_string(), 1, &arg);
+}
+
+
 void TCPWrap::AfterConnect(uv_connect_t* req, int status) {
   TCPConnectWrap* req_wrap = static_cast<TCPConnectWrap*>(req->data);
   TCPWrap* wrap = static_cast<TCPWrap*>(req->handle->data);
@@ -18,6 +18,13 @@ class TCPWrap : public StreamWrap {
 
   size_t self_size() const override { return sizeof(*this); }
 
+  // Resource implementation
+  int DoTryWrite(uv_buf_t** bufs, size_t* count) override;
+  int DoWrite(WriteWrap* w,
+              uv_buf_t* bufs,
+              size_t count,
+              uv_stream_t* send_handle) override;
+
  private:
   typedef uv_tcp_t HandleType;
 
@@ -31,6 +38,11 @@ class TCPWrap : public StreamWrap {
   static void New(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetNoDelay(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void SetKeepAlive(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetAutoCork(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void FlushCork(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void GetWriteStats(const v8::FunctionCallbackInfo<v8::Value>& args);
+  static void SetAcceptOptions(
+      const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Bind6(const v8::FunctionCallbackInfo<v8::Value>& args);
   static void Listen(const v8::FunctionCallbackInfo<v8::Value>& args);
@@ -45,8 +57,35 @@ class TCPWrap : public StreamWrap {
 
   static void OnConnection(uv_stream_t* handle, int status);
   static void AfterConnect(uv_connect_t* req, int status);
+  static void OnCorkPrepare(uv_prepare_t* handle);
+
+  // Socket options that a listening socket applies to the connections it
+  // accepts, and with a batch size above one, the draining of connections
+  // that are already waiting so that JS land gets them in a single call.
+  void ApplyAcceptOptions(TCPWrap* client);
+  void AcceptBatch(v8::Local<v8::Object> first);
+
+  // With auto cork on, the first write of a batch corks the socket and the
+  // cork is released at the end of the message, when a write finds that it
+  // has been held for longer than the budget, or before the event loop
+  // blocks for I/O, whichever comes first.
+  void BeginWrite();
+  void EndWrite();
+  void Cork();
+  void Uncork();
 
   uv_tcp_t handle_;
+  uv_prepare_t* cork_prepare_;  // Only allocated once auto cork is enabled.
+  bool auto_cork_;
+  bool try_write_pending_;
+  uint64_t cork_budget_;  // Nanoseconds.
+  uint64_t corked_since_;  // uv_hrtime() at the time of corking, or 0.
+  uint64_t writes_;
+  uint64_t batches_;
+  uint32_t accept_batch_;
+  bool accept_no_delay_;
+  bool accept_keep_alive_;
+  unsigned int accept_keep_alive_delay_;  // Seconds.
 };
 
 
@@ -0,0 +1,16 @@
+#include <node.h>
+#include <v8.h>
+
+void Method(const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+  args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, "world"));
+}
+
+void init(v8::Local<v8::Object> target,
+          v8::Local<v8::Value> module,
+          v8::Local<v8::Context> context) {
+  NODE_SET_METHOD(target, "hello", Method);
+}
+
+NODE_MODULE_CONTEXT_AWARE(binding, init);
@@ -0,0 +1,12 @@
+{
+  'targets': [
+    {
+      'target_name': 'binding',
+      'sources': [ 'binding.cc' ]
+    },
+    {
+      'target_name': 'legacy',
+      'sources': [ 'legacy.cc' ]
+    }
+  ]
+}
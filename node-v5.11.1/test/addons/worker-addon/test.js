@@ -0,0 +1,40 @@
+'use strict';
+// Flags: --experimental-worker
+
+const common = require('../../common');
+const assert = require('assert');
+const worker_threads = require('worker_threads');
+
+const bindingPath = require.resolve('./build/Release/binding');
+const legacyPath = require.resolve('./build/Release/legacy');
+
+if (!worker_threads.isMainThread) {
+  if (worker_threads.workerData === 'binding') {
+    worker_threads.parentPort.postMessage(require(bindingPath).hello());
+  } else {
+    assert.throws(function() {
+      require(legacyPath);
+    }, /^Error: Module is not context-aware/);
+    worker_threads.parentPort.postMessage('threw');
+  }
+  return;
+}
+
+assert.strictEqual(require(bindingPath).hello(), 'world');
+assert.strictEqual(require(legacyPath).hello(), 'world');
+
+// The shared objects are already loaded, they don't register again.
+delete require.cache[bindingPath];
+delete require.cache[legacyPath];
+assert.strictEqual(require(bindingPath).hello(), 'world');
+assert.strictEqual(require(legacyPath).hello(), 'world');
+
+['binding', 'legacy'].forEach(function(which) {
+  const worker = new worker_threads.Worker(__filename, { workerData: which });
+  worker.on('message', common.mustCall(function(message) {
+    assert.strictEqual(message, which === 'binding' ? 'world' : 'threw');
+  }));
+  worker.on('exit', common.mustCall(function(code) {
+    assert.strictEqual(code, 0);
+  }));
+});
@@ -0,0 +1,167 @@
+#include "bench.h"
+#include "libplatform/libplatform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace bench {
+
+struct Benchmark {
+  const char* name;
+  Function function;
+  std::vector<size_t> sizes;
+};
+
+// Function-local so that it exists before the static registrations run.
+static std::vector<Benchmark>* benchmarks() {
+  static std::vector<Benchmark> benchmarks;
+  return &benchmarks;
+}
+
+Registration::Registration(const char* name,
+                           Function function,
+                           std::initializer_list<size_t> sizes) {
+  benchmarks()->push_back(Benchmark { name, function, sizes });
+}
+
+static v8::Isolate* current_isolate;
+
+v8::Isolate* isolate() {
+  return current_isolate;
+}
+
+class ArrayBufferAllocator : public v8::ArrayBuffer::Allocator {
+ public:
+  void* Allocate(size_t size) override { return calloc(size, 1); }
+  void* AllocateUninitialized(size_t size) override { return malloc(size); }
+  void Free(void* data, size_t) override { free(data); }
+};
+
+static State Run(Function function, size_t size, uint64_t iterations) {
+  v8::HandleScope handle_scope(current_isolate);
+  State state(size, iterations);
+  function(&state);
+  return state;
+}
+
+// Runs the benchmark with more and more iterations until a run lasts at
+// least `min_time` nanoseconds, and returns the last run.
+static State Measure(Function function, size_t size, uint64_t min_time) {
+  uint64_t iterations = 1;
+  for (;;) {
+    State state = Run(function, size, iterations);
+    const uint64_t elapsed = state.elapsed() > 0 ? state.elapsed() : 1;
+    if (elapsed >= min_time || iterations >= (1ULL << 40))
+      return state;
+    // Aim a bit past the minimum so that the next run is likely the last.
+    double next = 1.4 * min_time * iterations / elapsed;
+    if (next < 2.0 * iterations)
+      next = 2.0 * iterations;
+    if (next > 100.0 * iterations)
+      next = 100.0 * iterations;
+    iterations = static_cast<uint64_t>(next);
+  }
+}
+
+static void FormatThroughput(char* out, size_t size, double bytes_per_sec) {
+  static const char* const units[] = { "B/s", "kB/s", "MB/s", "GB/s" };
+  size_t unit = 0;
+  while (bytes_per_sec >= 1000 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+    bytes_per_sec /= 1000;
+    unit += 1;
+  }
+  snprintf(out, size, "%.2f %s", bytes_per_sec, units[unit]);
+}
+
+static int Main(int argc, char** argv) {
+  bool csv = false;
+  bool list = false;
+  double seconds = 0.5;
+  const char* filter = nullptr;
+
+  for (int i = 1; i < argc; i += 1) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      csv = true;
+    } else if (strcmp(argv[i], "--list") == 0) {
+      list = true;
+    } else if (strncmp(argv[i], "--time=", 7) == 0) {
+      seconds = atof(argv[i] + 7);
+    } else if (argv[i][0] != '-' && filter == nullptr) {
+      filter = argv[i];
+    } else {
+      fprintf(stderr,
+              "usage: %s [--csv] [--list] [--time=seconds] [filter]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  if (list) {
+    for (const Benchmark& benchmark : *benchmarks())
+      printf("%s\n", benchmark.name);
+    return 0;
+  }
+
+  v8::Platform* platform = v8::platform::CreateDefaultPlatform();
+  v8::V8::InitializePlatform(platform);
+  v8::V8::Initialize();
+
+  ArrayBufferAllocator allocator;
+  v8::Isolate::CreateParams params;
+  params.array_buffer_allocator = &allocator;
+  current_isolate = v8::Isolate::New(params);
+
+  {
+    v8::Isolate::Scope isolate_scope(current_isolate);
+    v8::HandleScope handle_scope(current_isolate);
+    v8::Local<v8::Context> context = v8::Context::New(current_isolate);
+    v8::Context::Scope context_scope(context);
+
+    if (csv)
+      printf("name,size,iterations,ns_per_op,bytes_per_sec\n");
+
+    const uint64_t min_time = static_cast<uint64_t>(seconds * 1e9);
+    for (const Benchmark& benchmark : *benchmarks()) {
+      if (filter != nullptr && strstr(benchmark.name, filter) == nullptr)
+        continue;
+      for (size_t size : benchmark.sizes) {
+        State state = Measure(benchmark.function, size, min_time);
+        const double ns_per_op =
+            static_cast<double>(state.elapsed()) / state.iterations();
+        const double bytes_per_sec =
+            state.bytes_per_iteration() * 1e9 / ns_per_op;
+        if (csv) {
+          printf("%s,%zu,%llu,%.3f,%.0f\n",
+                 benchmark.name,
+                 size,
+                 static_cast<unsigned long long>(state.iterations()),
+                 ns_per_op,
+                 bytes_per_sec);
+        } else if (state.bytes_per_iteration() > 0) {
+          char throughput[32];
+          FormatThroughput(throughput, sizeof(throughput), bytes_per_sec);
+          printf("%s size=%zu: %.2f ns/op, %s\n",
+                 benchmark.name, size, ns_per_op, throughput);
+        } else {
+          printf("%s size=%zu: %.2f ns/op\n",
+                 benchmark.name, size, ns_per_op);
+        }
+        fflush(stdout);
+      }
+    }
+  }
+
+  current_isolate->Dispose();
+  v8::V8::Dispose();
+  v8::V8::ShutdownPlatform();
+  delete platform;
+  return 0;
+}
+
+}  // namespace bench
+
+int main(int argc, char** argv) {
+  return bench::Main(argc, argv);
+}
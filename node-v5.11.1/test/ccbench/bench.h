@@ -0,0 +1,104 @@
+#ifndef TEST_CCBENCH_BENCH_H_
+#define TEST_CCBENCH_BENCH_H_
+
+#include "uv.h"
+#include "v8.h"
+
+#include <initializer_list>
+#include <stddef.h>
+#include <stdint.h>
+
+// A small harness for benchmarking native code without going through JS.
+//
+// A benchmark is a function that does one operation per iteration of
+//
+//   while (state->KeepRunning()) { ... }
+//
+// and is registered for a list of input sizes:
+//
+//   static void Copy(bench::State* state) { ... }
+//   BENCHMARK("memcpy", Copy, 16, 1024, 64 * 1024);
+//
+// The harness picks the number of iterations so that a run lasts long enough
+// to be measured, and reports the time per operation and, when the benchmark
+// sets it, the throughput.
+
+namespace bench {
+
+class State {
+ public:
+  State(size_t size, uint64_t iterations)
+      : size_(size),
+        iterations_(iterations),
+        done_(0),
+        start_(0),
+        end_(0),
+        bytes_per_iteration_(0) {}
+
+  // Input size the benchmark runs with.
+  size_t size() const { return size_; }
+
+  // Returns true until the iterations are done.  The clock starts with the
+  // first call, so that the setup before the loop is not measured.
+  inline bool KeepRunning() {
+    if (done_ == 0)
+      start_ = uv_hrtime();
+    if (done_ < iterations_) {
+      done_ += 1;
+      return true;
+    }
+    end_ = uv_hrtime();
+    return false;
+  }
+
+  // Bytes processed by one operation, for reporting the throughput.
+  void SetBytesPerIteration(size_t bytes) { bytes_per_iteration_ = bytes; }
+
+  uint64_t iterations() const { return iterations_; }
+  uint64_t elapsed() const { return end_ - start_; }
+  size_t bytes_per_iteration() const { return bytes_per_iteration_; }
+
+ private:
+  const size_t size_;
+  const uint64_t iterations_;
+  uint64_t done_;
+  uint64_t start_;
+  uint64_t end_;
+  size_t bytes_per_iteration_;
+};
+
+typedef void (*Function)(State* state);
+
+class Registration {
+ public:
+  Registration(const char* name,
+               Function function,
+               std::initializer_list<size_t> sizes);
+};
+
+// The isolate the benchmarks run in.  A context is entered and a handle scope
+// is open while a benchmark runs.
+v8::Isolate* isolate();
+
+// Keeps the compiler from optimizing away a computation whose result is not
+// otherwise used.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "m"(value) : "memory");
+#else
+  static const void* volatile sink;
+  sink = &value;
+#endif
+}
+
+}  // namespace bench
+
+#define BENCHMARK_CONCAT2(a, b) a ## b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT2(a, b)
+
+#define BENCHMARK(name, function, ...)                                        \
+  static bench::Registration BENCHMARK_CONCAT(registration_, __LINE__)(       \
+      name, function, { __VA_ARGS__ })
+
+#endif  // TEST_CCBENCH_BENCH_H_
@@ -0,0 +1,54 @@
+// The parts of node::Buffer that StringBytes needs, without the Environment
+// that src/node_buffer.cc depends on.  Buffers here are plain Uint8Arrays.
+
+#include "node_buffer.h"
+#include "util.h"
+#include "util-inl.h"
+#include "v8.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace node {
+namespace Buffer {
+
+using v8::ArrayBuffer;
+using v8::ArrayBufferCreationMode;
+using v8::Isolate;
+using v8::Local;
+using v8::MaybeLocal;
+using v8::Object;
+using v8::Uint8Array;
+using v8::Value;
+
+bool HasInstance(Local<Value> val) {
+  return val->IsUint8Array();
+}
+
+
+char* Data(Local<Value> val) {
+  CHECK(val->IsUint8Array());
+  Local<Uint8Array> ui = val.As<Uint8Array>();
+  ArrayBuffer::Contents ab_c = ui->Buffer()->GetContents();
+  return static_cast<char*>(ab_c.Data()) + ui->ByteOffset();
+}
+
+
+size_t Length(Local<Value> val) {
+  CHECK(val->IsUint8Array());
+  return val.As<Uint8Array>()->ByteLength();
+}
+
+
+MaybeLocal<Object> Copy(Isolate* isolate, const char* data, size_t length) {
+  void* copy = malloc(length);
+  CHECK(length == 0 || copy != nullptr);
+  memcpy(copy, data, length);
+  Local<ArrayBuffer> ab =
+      ArrayBuffer::New(isolate, copy, length,
+                       ArrayBufferCreationMode::kInternalized);
+  return Uint8Array::New(ab, 0, length);
+}
+
+}  // namespace Buffer
+}  // namespace node
@@ -0,0 +1,191 @@
+#include "node_http_parser.h"
+#include "bench.h"
+#include "util.h"
+#include "util-inl.h"
+
+#include <string.h>
+#include <string>
+
+using node::StringPtr;
+
+// The bookkeeping that the Parser in src/node_http_parser.cc does in its
+// callbacks, without handing the results to JS: the URL, the status message
+// and the header fields and values are collected in its StringPtrs, as
+// pointers into the input that are copied when they are split across reads.
+struct Message {
+  static const size_t kMaxHeaderFieldsCount = 32;
+
+  http_parser parser;
+  StringPtr url;
+  StringPtr status_message;
+  StringPtr fields[kMaxHeaderFieldsCount];
+  StringPtr values[kMaxHeaderFieldsCount];
+  size_t num_fields;
+  size_t num_values;
+  size_t body_size;
+  size_t messages;
+};
+
+
+static Message* FromParser(http_parser* parser) {
+  return node::ContainerOf(&Message::parser, parser);
+}
+
+
+static int OnMessageBegin(http_parser* parser) {
+  Message* message = FromParser(parser);
+  message->num_fields = message->num_values = 0;
+  message->url.Reset();
+  message->status_message.Reset();
+  return 0;
+}
+
+
+static int OnUrl(http_parser* parser, const char* at, size_t length) {
+  FromParser(parser)->url.Update(at, length);
+  return 0;
+}
+
+
+static int OnStatus(http_parser* parser, const char* at, size_t length) {
+  FromParser(parser)->status_message.Update(at, length);
+  return 0;
+}
+
+
+static int OnHeaderField(http_parser* parser, const char* at, size_t length) {
+  Message* message = FromParser(parser);
+  if (message->num_fields == message->num_values) {
+    message->num_fields += 1;
+    if (message->num_fields == Message::kMaxHeaderFieldsCount) {
+      // The Parser flushes the headers to JS here.
+      message->num_fields = 1;
+      message->num_values = 0;
+    }
+    message->fields[message->num_fields - 1].Reset();
+  }
+  message->fields[message->num_fields - 1].Update(at, length);
+  return 0;
+}
+
+
+static int OnHeaderValue(http_parser* parser, const char* at, size_t length) {
+  Message* message = FromParser(parser);
+  if (message->num_values != message->num_fields) {
+    message->num_values += 1;
+    message->values[message->num_values - 1].Reset();
+  }
+  message->values[message->num_values - 1].Update(at, length);
+  return 0;
+}
+
+
+static int OnHeadersComplete(http_parser* parser) {
+  // The Parser hands the headers to JS here.
+  Message* message = FromParser(parser);
+  message->num_fields = message->num_values = 0;
+  return 0;
+}
+
+
+static int OnBody(http_parser* parser, const char* at, size_t length) {
+  FromParser(parser)->body_size += length;
+  return 0;
+}
+
+
+static int OnMessageComplete(http_parser* parser) {
+  FromParser(parser)->messages += 1;
+  return 0;
+}
+
+
+static http_parser_settings Settings() {
+  http_parser_settings settings;
+  memset(&settings, 0, sizeof(settings));
+  settings.on_message_begin = OnMessageBegin;
+  settings.on_url = OnUrl;
+  settings.on_status = OnStatus;
+  settings.on_header_field = OnHeaderField;
+  settings.on_header_value = OnHeaderValue;
+  settings.on_headers_complete = OnHeadersComplete;
+  settings.on_body = OnBody;
+  settings.on_message_complete = OnMessageComplete;
+  return settings;
+}
+
+
+// Like Parser::Save(), at the end of every read: the input doesn't outlive
+// the call, whatever still points into it is copied.
+static void Save(Message* message) {
+  message->url.Save();
+  message->status_message.Save();
+  for (size_t i = 0; i < message->num_fields; i++)
+    message->fields[i].Save();
+  for (size_t i = 0; i < message->num_values; i++)
+    message->values[i].Save();
+}
+
+
+static void Parse(bench::State* state,
+                  enum http_parser_type type,
+                  const std::string& input,
+                  size_t chunk_size) {
+  const http_parser_settings settings = Settings();
+  Message message;
+  message.body_size = 0;
+  message.messages = 0;
+  state->SetBytesPerIteration(input.size());
+  while (state->KeepRunning()) {
+    http_parser_init(&message.parser, type);
+    for (size_t offset = 0; offset < input.size(); offset += chunk_size) {
+      const size_t length = input.size() - offset < chunk_size ?
+                            input.size() - offset : chunk_size;
+      const size_t parsed = http_parser_execute(&message.parser,
+                                                &settings,
+                                                input.data() + offset,
+                                                length);
+      CHECK_EQ(parsed, length);
+      Save(&message);
+    }
+  }
+  CHECK_EQ(message.messages, state->iterations());
+}
+
+
+static std::string BuildMessage(const char* start_line, size_t headers) {
+  std::string message = start_line;
+  message += "Host: www.example.com\r\n";
+  for (size_t i = 1; i < headers; i += 1)
+    message += "X-Custom-Header-" + std::to_string(i) + ": some value\r\n";
+  return message + "\r\n";
+}
+
+static const char kRequestLine[] =
+    "GET /index.html?utm_source=bench HTTP/1.1\r\n";
+static const char kStatusLine[] = "HTTP/1.1 204 No Content\r\n";
+
+
+// A request with the given number of headers.
+static void ParseRequest(bench::State* state) {
+  const std::string request = BuildMessage(kRequestLine, state->size());
+  Parse(state, HTTP_REQUEST, request, SIZE_MAX);
+}
+
+// The same, read 16 bytes at a time, so that the fields and values are split
+// across reads and have to be copied.
+static void ParseRequestSplit(bench::State* state) {
+  const std::string request = BuildMessage(kRequestLine, state->size());
+  Parse(state, HTTP_REQUEST, request, 16);
+}
+
+// A response with the given number of headers.  Bodies are not benchmarked,
+// the parser hands them over without looking at them.
+static void ParseResponse(bench::State* state) {
+  const std::string response = BuildMessage(kStatusLine, state->size());
+  Parse(state, HTTP_RESPONSE, response, SIZE_MAX);
+}
+
+BENCHMARK("http_parser/request", ParseRequest, 1, 8, 32);
+BENCHMARK("http_parser/request_split", ParseRequestSplit, 1, 8, 32);
+BENCHMARK("http_parser/response", ParseResponse, 1, 8, 32);
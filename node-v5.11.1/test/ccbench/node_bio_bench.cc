@@ -0,0 +1,59 @@
+#include "node_crypto_bio.h"
+#include "bench.h"
+#include "openssl/bio.h"
+
+#include <vector>
+
+using node::NodeBIO;
+
+// Data goes through the BIO in records of at most this size, like TLS
+// records through the BIOs of a TLSWrap.
+static const size_t kRecordSize = 16 * 1024;
+
+
+// What OpenSSL does with the incoming and outgoing BIOs: BIO_write() the
+// data, then BIO_read() it in records.
+static void WriteRead(bench::State* state) {
+  const size_t size = state->size();
+  std::vector<char> data(size, 'x');
+  std::vector<char> out(kRecordSize);
+  BIO* bio = NodeBIO::New();
+  state->SetBytesPerIteration(size);
+  while (state->KeepRunning()) {
+    BIO_write(bio, data.data(), size);
+    while (BIO_read(bio, out.data(), out.size()) > 0) {
+    }
+  }
+  BIO_free_all(bio);
+}
+
+
+// What TLSWrap::EncOut() does with the outgoing BIO: written in records,
+// then handed to the socket with PeekMultiple() and skipped once written.
+static void PeekMultiple(bench::State* state) {
+  static const size_t kBufferCount = 10;  // TLSWrap::kSimultaneousBufferCount
+  const size_t size = state->size();
+  std::vector<char> data(size, 'x');
+  BIO* bio = NodeBIO::New();
+  NodeBIO* node_bio = NodeBIO::FromBIO(bio);
+  state->SetBytesPerIteration(size);
+  while (state->KeepRunning()) {
+    for (size_t offset = 0; offset < size; offset += kRecordSize) {
+      const size_t length =
+          size - offset < kRecordSize ? size - offset : kRecordSize;
+      BIO_write(bio, data.data() + offset, length);
+    }
+    while (node_bio->Length() > 0) {
+      char* bufs[kBufferCount];
+      size_t sizes[kBufferCount];
+      size_t count = kBufferCount;
+      const size_t available = node_bio->PeekMultiple(bufs, sizes, &count);
+      bench::DoNotOptimize(bufs[0]);
+      node_bio->Read(nullptr, available);
+    }
+  }
+  BIO_free_all(bio);
+}
+
+BENCHMARK("node_bio/write_read", WriteRead, 1024, 16 * 1024, 256 * 1024);
+BENCHMARK("node_bio/peek_multiple", PeekMultiple, 1024, 16 * 1024, 256 * 1024);
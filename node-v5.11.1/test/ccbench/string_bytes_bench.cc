@@ -0,0 +1,134 @@
+#include "string_bytes.h"
+#include "stream_base.h"
+#include "bench.h"
+
+#include <vector>
+
+using node::StringBytes;
+using v8::HandleScope;
+using v8::Isolate;
+using v8::Local;
+using v8::String;
+using v8::Value;
+
+// ASCII text, or when `two_byte` is set, UTF-8 text made of characters that
+// take two bytes each.
+static std::vector<char> Text(size_t size, bool two_byte) {
+  std::vector<char> text(size);
+  for (size_t i = 0; i < size; i += 1) {
+    if (two_byte)
+      text[i] = i % 2 == 0 ? '\xC3' : '\xA9';  // U+00E9
+    else
+      text[i] = 'a' + i % 26;
+  }
+  return text;
+}
+
+
+// StringBytes::Encode() takes UCS-2 as 16-bit units.
+static Local<Value> EncodeText(Isolate* isolate,
+                               const std::vector<char>& text,
+                               node::encoding encoding) {
+  if (encoding == node::UCS2) {
+    return StringBytes::Encode(isolate,
+                               reinterpret_cast<const uint16_t*>(text.data()),
+                               text.size() / 2);
+  }
+  return StringBytes::Encode(isolate, text.data(), text.size(), encoding);
+}
+
+
+// Decoding of strings into bytes, as done for buffer.write() and for strings
+// written to streams.
+template <node::encoding kEncoding, bool kTwoByte = false>
+static void Write(bench::State* state) {
+  Isolate* isolate = bench::isolate();
+  const size_t size = state->size();
+  std::vector<char> text = Text(size, kTwoByte);
+  Local<Value> string = EncodeText(isolate, text, kEncoding);
+  std::vector<char> out(size);
+  state->SetBytesPerIteration(size);
+  while (state->KeepRunning()) {
+    bench::DoNotOptimize(StringBytes::Write(isolate,
+                                            out.data(),
+                                            out.size(),
+                                            string,
+                                            kEncoding));
+  }
+}
+
+BENCHMARK("string_bytes/write/ascii", Write<node::ASCII>, 64, 1024, 65536);
+BENCHMARK("string_bytes/write/utf8", Write<node::UTF8>, 64, 1024, 65536);
+BENCHMARK("string_bytes/write/utf8_two_byte",
+          (Write<node::UTF8, true>), 64, 1024, 65536);
+BENCHMARK("string_bytes/write/ucs2", Write<node::UCS2>, 64, 1024, 65536);
+BENCHMARK("string_bytes/write/binary", Write<node::BINARY>, 64, 1024, 65536);
+BENCHMARK("string_bytes/write/hex", Write<node::HEX>, 64, 1024, 65536);
+BENCHMARK("string_bytes/write/base64", Write<node::BASE64>, 64, 1024, 65536);
+
+
+// Encoding of bytes into strings, as done for buffer.toString().
+template <node::encoding kEncoding, bool kTwoByte = false>
+static void Encode(bench::State* state) {
+  Isolate* isolate = bench::isolate();
+  const size_t size = state->size();
+  std::vector<char> text = Text(size, kTwoByte);
+  state->SetBytesPerIteration(size);
+  while (state->KeepRunning()) {
+    HandleScope handle_scope(isolate);
+    bench::DoNotOptimize(EncodeText(isolate, text, kEncoding));
+  }
+}
+
+BENCHMARK("string_bytes/encode/ascii", Encode<node::ASCII>, 64, 1024, 65536);
+BENCHMARK("string_bytes/encode/utf8", Encode<node::UTF8>, 64, 1024, 65536);
+BENCHMARK("string_bytes/encode/utf8_two_byte",
+          (Encode<node::UTF8, true>), 64, 1024, 65536);
+BENCHMARK("string_bytes/encode/ucs2", Encode<node::UCS2>, 64, 1024, 65536);
+BENCHMARK("string_bytes/encode/binary", Encode<node::BINARY>, 64, 1024, 65536);
+BENCHMARK("string_bytes/encode/hex", Encode<node::HEX>, 64, 1024, 65536);
+BENCHMARK("string_bytes/encode/base64", Encode<node::BASE64>, 64, 1024, 65536);
+
+
+// The string path of StreamBase::Writev(): the storage for all the chunks is
+// sized up front with the same StringBytes::WriteStorageSize(), then every
+// chunk is decoded into it.  Only the sizing and decoding are measured, not
+// the write request or the write itself.
+static void Writev(bench::State* state) {
+  static const size_t kChunks = 16;
+  static const size_t kAlignSize = node::WriteWrap::kAlignSize;
+  Isolate* isolate = bench::isolate();
+  const size_t size = state->size();
+  std::vector<char> text = Text(size / kChunks, false);
+  Local<String> chunks[kChunks];
+  for (size_t i = 0; i < kChunks; i += 1) {
+    chunks[i] = String::NewFromUtf8(isolate,
+                                    text.data(),
+                                    String::kNormalString,
+                                    text.size());
+  }
+  state->SetBytesPerIteration(text.size() * kChunks);
+  while (state->KeepRunning()) {
+    size_t storage_size = 0;
+    for (size_t i = 0; i < kChunks; i += 1) {
+      storage_size = ROUND_UP(storage_size, kAlignSize);
+      storage_size += StringBytes::WriteStorageSize(isolate,
+                                                    chunks[i],
+                                                    node::UTF8);
+    }
+    char* storage = new char[storage_size];
+    size_t offset = 0;
+    for (size_t i = 0; i < kChunks; i += 1) {
+      offset = ROUND_UP(offset, kAlignSize);
+      offset += StringBytes::Write(isolate,
+                                   storage + offset,
+                                   storage_size - offset,
+                                   chunks[i],
+                                   node::UTF8);
+    }
+    bench::DoNotOptimize(storage[0]);
+    delete[] storage;
+  }
+}
+
+BENCHMARK("stream_base/writev_strings", Writev, 1024, 65536);
@@ -0,0 +1,58 @@
+#include "string_search.h"
+#include "bench.h"
+
+#include <stdint.h>
+#include <vector>
+
+// Random lowercase letters, with the needle, which has a dash in it, put at
+// the end so that it is found there and nowhere else.
+template <typename Char>
+static std::vector<Char> Haystack(size_t size,
+                                  const std::vector<Char>& needle) {
+  std::vector<Char> haystack(size);
+  uint32_t seed = 42;
+  for (size_t i = 0; i < size; i += 1) {
+    seed = seed * 1103515245 + 12345;
+    haystack[i] = 'a' + (seed >> 16) % 26;
+  }
+  for (size_t i = 0; i < needle.size() && i < size; i += 1)
+    haystack[size - needle.size() + i] = needle[i];
+  return haystack;
+}
+
+
+template <typename Char>
+static std::vector<Char> Needle(size_t length) {
+  std::vector<Char> needle(length);
+  for (size_t i = 0; i < length; i += 1)
+    needle[i] = "-needle-in-a-haystack-of-letters"[i % 32];
+  return needle;
+}
+
+
+// Searches the way buffer.indexOf() does, with a new StringSearch every time.
+template <typename Char, size_t kNeedleLength>
+static void Search(bench::State* state) {
+  const size_t size = state->size();
+  std::vector<Char> needle = Needle<Char>(kNeedleLength);
+  std::vector<Char> haystack = Haystack<Char>(size, needle);
+  state->SetBytesPerIteration(size * sizeof(Char));
+  while (state->KeepRunning()) {
+    bench::DoNotOptimize(node::SearchString(haystack.data(),
+                                            haystack.size(),
+                                            needle.data(),
+                                            needle.size(),
+                                            0));
+  }
+}
+
+// Below 7 characters the search is linear, above it is Boyer-Moore-Horspool
+// and then Boyer-Moore.
+BENCHMARK("string_search/one_byte/short",
+          (Search<uint8_t, 4>), 1024, 65536, 1 << 20);
+BENCHMARK("string_search/one_byte/long",
+          (Search<uint8_t, 32>), 1024, 65536, 1 << 20);
+BENCHMARK("string_search/two_byte/short",
+          (Search<uint16_t, 4>), 1024, 65536, 1 << 20);
+BENCHMARK("string_search/two_byte/long",
+          (Search<uint16_t, 32>), 1024, 65536, 1 << 20);
@@ -0,0 +1,2 @@
+exports.json_stream = require('json_stream');
+exports.profiler = require('profiler');
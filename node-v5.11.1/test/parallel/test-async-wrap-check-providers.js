@@ -62,6 +62,16 @@ new StreamWrap(new net.Socket());
 
 new (process.binding('tty_wrap').TTY)();
 
+{
+  const tcp = new (process.binding('tcp_wrap').TCP)();
+  new (process.binding('stream_pipe').StreamPipe)(tcp._externalStream,
+                                                  tcp._externalStream, 0);
+  tcp.close();
+}
+
+new (process.binding('worker').Worker)(__filename, [], '', []).close();
+new (process.binding('worker').AtomicsWaiter)().close();
+
 crypto.randomBytes(1, noop);
 
 common.refreshTmpDir();
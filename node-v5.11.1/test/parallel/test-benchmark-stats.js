@@ -0,0 +1,37 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const stats = require('../../benchmark/_stats.js');
+
+function near(actual, expected, epsilon) {
+  assert(Math.abs(actual - expected) < epsilon,
+         `${actual} is not within ${epsilon} of ${expected}`);
+}
+
+near(stats.mean([1, 2, 3, 4]), 2.5, 1e-12);
+near(stats.variance([1, 2, 3, 4]), 5 / 3, 1e-12);
+
+// Quantiles of Student's t distribution from the usual tables.
+near(stats.studentTCdf(0, 7), 0.5, 1e-12);
+near(stats.studentTQuantile(0.975, 1), 12.706, 1e-3);
+near(stats.studentTQuantile(0.975, 10), 2.228, 1e-3);
+near(stats.studentTQuantile(0.995, 30), 2.750, 1e-3);
+near(stats.studentTCdf(-2.228, 10), 0.025, 1e-4);
+
+// Samples with unequal variances and sizes; the reference values are those
+// of R's t.test(b, a).
+const a = [19.8, 20.4, 19.6, 17.8, 18.5, 18.9, 18.3, 18.9, 19.5, 22.0];
+const b = [28.2, 26.6, 20.1, 23.3, 25.2, 22.1, 17.7, 27.6, 20.6, 13.7,
+           23.2, 17.5, 20.6, 18.0, 23.9, 21.6, 24.3, 20.4, 23.9, 13.3];
+const result = stats.welch(a, b);
+near(result.diff, 2.22, 1e-9);
+near(result.t, 2.2255, 1e-4);
+near(result.df, 24.525, 1e-3);
+near(result.p, 0.03548, 1e-5);
+near(result.low, 0.1635, 1e-4);
+near(result.high, 4.2765, 1e-4);
+
+// Degenerate cases.
+assert(isNaN(stats.welch([1], [1, 2]).p));
+assert.strictEqual(stats.welch([1, 1], [1, 1]).p, 1);
+assert.strictEqual(stats.welch([1, 1], [2, 2]).p, 0);
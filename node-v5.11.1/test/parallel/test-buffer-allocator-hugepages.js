@@ -0,0 +1,52 @@
+'use strict';
+require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const spawnSync = require('child_process').spawnSync;
+
+if (process.argv[2] === 'child') {
+  const binding = process.binding('buffer');
+  const before = binding.getAllocatorStatistics();
+  const buf = Buffer.alloc(2 * 1024 * 1024, 0xAB);
+  const after = binding.getAllocatorStatistics();
+  assert.strictEqual(buf[buf.length - 1], 0xAB);
+
+  // The arena is only set up where mmap() takes MAP_NORESERVE.
+  if (process.platform === 'linux') {
+    assert.strictEqual(after.hugePageAllocations,
+                       before.hugePageAllocations + 1);
+    assert(after.hugePageBytes >= before.hugePageBytes + buf.length);
+
+    // The arena is a single 1 GB mapping that is madvise()'d for huge
+    // pages, which shows up as the "hg" flag.
+    const smaps = fs.readFileSync('/proc/self/smaps', 'utf8');
+    const marked = smaps.split(/\n(?=[0-9a-f]+-[0-9a-f]+ )/).some(function(m) {
+      const size = /^Size:\s+(\d+) kB$/m.exec(m);
+      const flags = /^VmFlags:(.*)$/m.exec(m);
+      return size !== null && Number(size[1]) >= 1024 * 1024 &&
+             flags !== null && / hg\b/.test(flags[1]);
+    });
+    assert(marked, 'no 1 GB mapping with MADV_HUGEPAGE');
+  }
+  return;
+}
+
+const args = ['--buffer-allocator=pool', '--buffer-hugepages',
+              __filename, 'child'];
+let child = spawnSync(process.execPath, args);
+assert.strictEqual(child.status, 0, child.stderr.toString());
+
+// The order of the options doesn't matter.
+args[0] = '--buffer-hugepages';
+args[1] = '--buffer-allocator=pool';
+child = spawnSync(process.execPath, args);
+assert.strictEqual(child.status, 0, child.stderr.toString());
+
+// Huge pages are a feature of the pool allocator.
+[[], ['--buffer-allocator=malloc']].forEach(function(extra) {
+  child = spawnSync(process.execPath,
+                    extra.concat('--buffer-hugepages', '-e', '0'));
+  assert.strictEqual(child.status, 9);
+  assert(/--buffer-hugepages requires --buffer-allocator=pool/.test(
+      child.stderr.toString()));
+});
@@ -0,0 +1,55 @@
+'use strict';
+// Flags: --buffer-allocator=pool --expose-gc
+
+require('../common');
+const assert = require('assert');
+const binding = process.binding('buffer');
+
+const sizes = [1, 64, 100, 4096, 8191, 16384, 65536, 65537, 1024 * 1024];
+
+function fill() {
+  sizes.forEach(function(size) {
+    const u8 = new Uint8Array(size);
+    u8.fill(0xAB);
+    Buffer.alloc(size, 0xCD);
+  });
+}
+
+fill();
+gc();
+
+// Recycled blocks must still come out zeroed for typed arrays and
+// Buffer.alloc().
+sizes.forEach(function(size) {
+  const u8 = new Uint8Array(size);
+  for (let i = 0; i < size; i++)
+    assert.strictEqual(u8[i], 0);
+  const buf = Buffer.alloc(size);
+  for (let i = 0; i < size; i++)
+    assert.strictEqual(buf[i], 0);
+});
+
+fill();
+gc();
+
+const stats = binding.getAllocatorStatistics();
+[
+  'allocations',
+  'frees',
+  'hugePageAllocations',
+  'hugePageBytes',
+  'poolFallbacks',
+  'poolFreeBytes',
+  'poolHits',
+  'poolMisses',
+  'poolSlabBytes'
+].forEach(function(key) {
+  assert.strictEqual(typeof stats[key], 'number', key);
+  assert(stats[key] >= 0, key);
+});
+
+assert(stats.allocations > 0);
+assert(stats.frees > 0);
+assert(stats.poolHits > 0);
+assert(stats.poolSlabBytes > 0);
+assert(stats.poolFreeBytes <= stats.poolSlabBytes);
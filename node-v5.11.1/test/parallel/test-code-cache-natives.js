@@ -0,0 +1,44 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const spawnSync = require('child_process').spawnSync;
+
+// Core modules compile from the code caches that are built into the binary
+// with --with-code-cache.  Without the option there are none.
+const codeCache = process.binding('code_cache');
+assert(Array.isArray(codeCache.ids));
+assert.deepEqual(codeCache.rejected, []);
+
+const loaded = codeCache.ids.filter(function(id) {
+  return process.moduleLoadList.indexOf(`NativeModule ${id}`) !== -1;
+});
+if (codeCache.ids.length > 0)
+  assert(loaded.length > 0);
+
+// V8 refuses the caches when it runs with different flags.  The modules are
+// then compiled from source.
+const child = spawnSync(process.execPath, [
+  '--max-old-space-size=1024',
+  '-e',
+  'const codeCache = process.binding("code_cache");' +
+  'console.log(JSON.stringify(codeCache.ids.filter(function(id) {' +
+  '  return process.moduleLoadList.indexOf(`NativeModule ${id}`) !== -1;' +
+  '})));' +
+  'console.log(JSON.stringify(codeCache.rejected));'
+]);
+assert.strictEqual(child.status, 0, child.stderr.toString());
+const lines = child.stdout.toString().trim().split(common.isWindows ?
+                                                   '\r\n' : '\n');
+assert.deepEqual(JSON.parse(lines[1]).sort(), JSON.parse(lines[0]).sort());
+
+// Stack traces through core modules keep their file names.
+const EventEmitter = require('events');
+const emitter = new EventEmitter();
+emitter.on('foo', function() {
+  throw new Error('foo');
+});
+assert.throws(function() {
+  emitter.emit('foo');
+}, function(err) {
+  return /\(events\.js:\d+:\d+\)/.test(err.stack);
+});
@@ -0,0 +1,104 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawn = require('child_process').spawn;
+
+if (process.platform !== 'linux') {
+  console.log('1..0 # Skipped: the counters file is only published on Linux');
+  return;
+}
+
+function readCounters(file) {
+  const buf = fs.readFileSync(file);
+  assert.strictEqual(buf.toString('binary', 0, 8), 'NODECTRS');
+
+  const le = require('os').endianness() === 'LE';
+  function u32(offset) {
+    return le ? buf.readUInt32LE(offset) : buf.readUInt32BE(offset);
+  }
+  function u64(offset) {
+    const low = u32(offset + (le ? 0 : 4));
+    const high = u32(offset + (le ? 4 : 0));
+    return high * 0x100000000 + low;
+  }
+  assert.strictEqual(u32(8), 1);
+
+  const count = u32(16);
+  const nameSize = u32(20);
+  const namesOffset = u32(24);
+  const valuesOffset = u32(28);
+  assert.strictEqual(u64(32), process.pid);
+
+  const counters = {};
+  for (let i = 0; i < count; i++) {
+    const start = namesOffset + i * nameSize;
+    const name = buf.toString('binary', start, buf.indexOf(0, start));
+    counters[name] = u64(valuesOffset + i * 8);
+  }
+  return counters;
+}
+
+function isNative(fn) {
+  return /\[native code\]/.test(Function.prototype.toString.call(fn));
+}
+
+if (process.argv[2] === 'child') {
+  assert(isNative(global.COUNTER_HTTP_SERVER_REQUEST));
+  const http = require('http');
+  const file = path.join(process.env.NODE_COUNTERS_DIR,
+                         `node-${process.pid}.counters`);
+  const server = http.createServer(function(req, res) {
+    res.end('ok');
+  });
+  server.listen(0, function() {
+    const before = readCounters(file);
+    assert.strictEqual(before['handles.TCPWRAP'], 1);
+    http.get({ port: server.address().port }, function(res) {
+      res.resume();
+      res.on('end', function() {
+        server.close();
+        global.gc();
+        fs.stat(__filename, function() {});
+        const counters = readCounters(file);
+        assert.strictEqual(counters['http.server.requests'], 1);
+        assert.strictEqual(counters['http.client.responses'], 1);
+        assert.strictEqual(counters['net.server.connections.opened'], 1);
+        assert(counters['net.bytes.sent'] > 0);
+        // The server is closing but not closed yet.
+        assert(counters['handles.TCPWRAP'] >= 1);
+        // The stat() call is still queued or running.
+        assert(counters['threadpool.requests'] >= 1);
+
+        const pauses = Object.keys(counters)
+                             .filter((name) => name.startsWith('gc.pause.le_'))
+                             .reduce((sum, name) => sum + counters[name], 0);
+        assert(counters['gc.count'] >= 1);
+        assert.strictEqual(pauses, counters['gc.count']);
+        assert(counters['gc.pause.total_us'] > 0);
+        console.log('ok');
+      });
+    });
+  });
+  return;
+}
+
+// Without the file, the probes are JS functions that do nothing.
+if (!process.env.NODE_COUNTERS_DIR)
+  assert(!isNative(global.COUNTER_HTTP_SERVER_REQUEST));
+
+common.refreshTmpDir();
+const child = spawn(process.execPath, ['--expose-gc', __filename, 'child'], {
+  env: Object.assign({}, process.env, { NODE_COUNTERS_DIR: common.tmpDir })
+});
+let stdout = '';
+child.stdout.setEncoding('utf8');
+child.stdout.on('data', (data) => stdout += data);
+child.stderr.pipe(process.stderr);
+child.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 0);
+  assert.strictEqual(stdout, 'ok\n');
+  // The file goes away with the process.
+  assert.deepStrictEqual(fs.readdirSync(common.tmpDir), []);
+}));
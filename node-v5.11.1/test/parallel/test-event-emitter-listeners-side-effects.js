@@ -6,12 +6,13 @@ var assert = require('assert');
 var EventEmitter = require('events').EventEmitter;
 
 var e = new EventEmitter();
+var empty = new EventEmitter()._events;
 var fl;  // foo listeners
 
 fl = e.listeners('foo');
 assert(Array.isArray(fl));
 assert(fl.length === 0);
-assert.deepEqual(e._events, {});
+assert.deepEqual(e._events, empty);
 
 e.on('foo', assert.fail);
 fl = e.listeners('foo');
@@ -4,7 +4,8 @@ var assert = require('assert');
 var events = require('events');
 
 var e = new events.EventEmitter();
+var empty = new events.EventEmitter()._events;
 
-assert.deepEqual(e._events, {});
+assert.deepEqual(e._events, empty);
 e.setMaxListeners(5);
-assert.deepEqual(e._events, {});
+assert.deepEqual(e._events, empty);
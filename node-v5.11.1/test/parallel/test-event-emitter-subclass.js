@@ -30,7 +30,7 @@ assert.throws(function() {
 
 process.on('exit', function() {
   assert(called);
-  assert.deepEqual(myee._events, {});
+  assert.deepEqual(myee._events, new EventEmitter()._events);
   console.log('ok');
 });
 
@@ -0,0 +1,15 @@
+'use strict';
+require('../common');
+var assert = require('assert');
+
+// Without their flags, experimental modules leave the name to node_modules.
+assert.throws(function() {
+  require('json_stream');
+}, /Cannot find module 'json_stream'/);
+assert.throws(function() {
+  require('profiler');
+}, /Cannot find module 'profiler'/);
+
+var modules = require('../fixtures/experimental-modules');
+assert.strictEqual(modules.json_stream, 'json_stream from node_modules');
+assert.strictEqual(modules.profiler, 'profiler from node_modules');
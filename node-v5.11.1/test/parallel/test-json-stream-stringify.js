@@ -0,0 +1,101 @@
+'use strict';
+// Flags: --experimental-json-stream
+require('../common');
+const assert = require('assert');
+const json_stream = require('json_stream');
+
+function expect(value, replacer, space) {
+  const text = JSON.stringify(value, replacer, space);
+  const buffer = json_stream.stringify(value, replacer, space);
+  const chunks = json_stream.stringifyChunks(value, replacer, space);
+  if (text === undefined) {
+    assert.strictEqual(buffer, undefined);
+    assert.strictEqual(chunks, undefined);
+    return;
+  }
+  assert(Buffer.isBuffer(buffer));
+  assert.strictEqual(buffer.toString('hex'), new Buffer(text).toString('hex'));
+  assert(Array.isArray(chunks));
+  chunks.forEach((chunk) => assert(Buffer.isBuffer(chunk)));
+  assert.strictEqual(Buffer.concat(chunks).toString(), buffer.toString());
+}
+
+// Primitives, wrappers and values that serialize to nothing.
+[
+  null, true, false, 0, -0, 1, -1, 2147483647, -2147483648, 2147483648,
+  0.1, -1.5e-7, 1e21, 1 / 3, NaN, Infinity, -Infinity,
+  '', 'abc', 'héllo € 😀', '"\\\b\f\n\r\t\u0000\u001f\u007f/',
+  '\ud800', 'a\udc00b', '􏿿', 'ÿ',
+  new Number(3), new String('x'), new Boolean(false), Object(1.5),
+  undefined, function() {}, Symbol('x')
+].forEach((value) => expect(value));
+
+// Containers.
+expect([]);
+expect({});
+expect([1, 'a', null, undefined, function() {}, Symbol('s'), [[]], {}]);
+expect({ a: 1, b: undefined, c: function() {}, d: [{ e: 'f' }], g: {} });
+expect({ b: undefined });
+expect({ a: undefined, b: 1, c: undefined });
+expect({ 1: 'one', a: 'a', 0: 'zero' });
+expect({ 'quo"te': 1, 'ü': 2 });
+expect(Object.create({ inherited: 1 }, { own: { value: 2, enumerable: true },
+                                         hidden: { value: 3 } }));
+expect(new Date(0));
+expect(/re/g);
+expect(new Array(3));
+expect(new Buffer('buf'));
+
+// toJSON() and replacers.
+expect({ toJSON: (key) => ['key', key] });
+expect({ a: { toJSON: (key) => key + '!' }, b: [{ toJSON: (key) => key }] });
+expect({ a: 1, b: [1, 2], c: { d: 'e' } },
+       (key, value) => {
+         return typeof value === 'number' ? value * 2 : value;
+       });
+expect({ a: 1, b: 2 }, function(key, value) {
+  return key === '' ? [this[''], Object.keys(this)] : value;
+});
+expect({ a: 1 }, (key, value) => {
+  return key === '' ? undefined : value;
+});
+expect({ a: 1, b: { a: 2, c: 3 }, c: 4 }, ['a', 'b', 'a', 5]);
+expect({ 5: 'five', a: 'a' }, [5, new String('a'), {}]);
+expect([{ a: 1, b: 2 }], ['b']);
+
+// Indentation.
+const nested = { a: [1, { b: [] }, {}], c: 'd', e: { f: null } };
+const spaces = [undefined, 0, 2, 20, -1, 1.9, '', '\t', 'abcdefghijklm',
+                new Number(3), new String('--'), true];
+spaces.forEach((space) => {
+  expect(nested, null, space);
+  expect([], null, space);
+  expect([[1]], null, space);
+});
+
+// Large output spans several chunks.
+const big = [];
+for (var i = 0; i < 20000; i++)
+  big.push({ id: i, name: 'item ' + i + ' é€😀', score: i / 7 });
+expect(big);
+assert(json_stream.stringifyChunks(big).length > 1);
+expect('x'.repeat(200 * 1024));
+expect(['€'.repeat(100 * 1024), 'y']);
+
+// Errors.
+const cyclic = { a: [] };
+cyclic.a.push(cyclic);
+assert.throws(() => json_stream.stringify(cyclic),
+              /^TypeError: Converting circular structure to JSON$/);
+assert.throws(() => json_stream.stringifyChunks(cyclic), TypeError);
+
+var deep = [];
+for (i = 0; i < 1e6; i++)
+  deep = [deep];
+assert.throws(() => json_stream.stringify(deep), RangeError);
+
+const error = new Error('from toJSON');
+assert.throws(() => json_stream.stringify({ toJSON: () => { throw error; } }),
+              (err) => err === error);
+assert.throws(() => json_stream.stringify({ a: 1 }, () => { throw error; }),
+              (err) => err === error);
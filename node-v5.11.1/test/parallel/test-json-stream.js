@@ -0,0 +1,154 @@
+'use strict';
+// Flags: --experimental-json-stream
+const common = require('../common');
+const assert = require('assert');
+const json_stream = require('json_stream');
+
+// Feeds |input| to a new parser in chunks of |chunkSize| bytes and calls
+// |callback| with the error or the objects that came out.
+function parse(input, options, chunkSize, callback) {
+  const parser = new json_stream.Parser(options);
+  const buffer = new Buffer(input);
+  const results = [];
+  var failed = false;
+  parser.on('data', (item) => results.push(item));
+  parser.on('end', () => callback(null, results));
+  parser.on('error', (err) => {
+    assert(!failed);
+    failed = true;
+    callback(err);
+  });
+  for (var i = 0; i < buffer.length && !failed; i += chunkSize)
+    parser.write(buffer.slice(i, i + chunkSize));
+  if (!failed)
+    parser.end();
+}
+
+function expect(input, options, expected) {
+  [1, 2, 3, 7, Infinity].forEach((chunkSize) => {
+    parse(input, options, chunkSize, common.mustCall((err, results) => {
+      assert.ifError(err);
+      assert.deepStrictEqual(results, expected);
+    }));
+  });
+}
+
+function expectError(input, message) {
+  [1, Infinity].forEach((chunkSize) => {
+    parse(input, {}, chunkSize, common.mustCall((err, results) => {
+      assert(err instanceof SyntaxError, input);
+      assert.strictEqual(err.message, message);
+    }));
+  });
+}
+
+// Top-level values match JSON.parse() however the input is split up.
+[
+  '{"a":1,"b":[true,false,null],"c":"x\\ny","d":{"e":-0.5e+3}}',
+  '[]',
+  '{}',
+  ' [ 1 , [ 2 , [ 3 , { } ] ] ] ',
+  '"héllo € 😀"',
+  '"\\"\\\\\\/\\b\\f\\n\\r\\t\\u0041\\u00e9\\u20ac\\ud83d\\ude00"',
+  '0',
+  '-0',
+  '123456789',
+  '-123456789',
+  '12345678901',
+  '3.25',
+  '1E3',
+  '1e-7',
+  'true',
+  'false',
+  'null',
+  '{"__proto__":1,"a":{"a":2},"a":3}'
+].forEach((text) => {
+  expect(text, {}, [{ key: 0, value: JSON.parse(text) }]);
+});
+
+// Lone surrogates stay single UTF-16 code units, in keys too.
+[
+  '"\\ud800"',
+  '"\\udc00"',
+  '"a\\ud83dé\\ud83d\\ud83d\\ude00\\ude00b"',
+  '{"\\udbff€":"\\ud800\\u0041"}'
+].forEach((text) => {
+  expect(text, {}, [{ key: 0, value: JSON.parse(text) }]);
+});
+parse('["\\ud800"]', {}, 1, common.mustCall((err, results) => {
+  assert.ifError(err);
+  assert.strictEqual(results[0].value[0].length, 1);
+  assert.strictEqual(results[0].value[0].charCodeAt(0), 0xD800);
+}));
+
+// Own property, not the prototype.
+parse('{"__proto__":[]}', {}, 1, common.mustCall((err, results) => {
+  assert.ifError(err);
+  const value = results[0].value;
+  assert(Object.prototype.hasOwnProperty.call(value, '__proto__'));
+  assert.strictEqual(Object.getPrototypeOf(value), Object.prototype);
+}));
+
+// Whitespace separated values, i.e. newline-delimited JSON.
+expect('1\n"a"\n{"b":null}\r\n[]\n', {}, [
+  { key: 0, value: 1 },
+  { key: 1, value: 'a' },
+  { key: 2, value: { b: null } },
+  { key: 3, value: [] }
+]);
+expect('', {}, []);
+expect(' \n ', {}, []);
+
+// Values nested at a given depth.
+expect('[1, null, {"a": [2]}, "x"]', { depth: 1 }, [
+  { key: 0, value: 1 },
+  { key: 1, value: null },
+  { key: 2, value: { a: [2] } },
+  { key: 3, value: 'x' }
+]);
+expect('{"a": [1, 2], "b": {"c": null}} [[3]]', { depth: 2 }, [
+  { key: 0, value: 1 },
+  { key: 1, value: 2 },
+  { key: 'c', value: null },
+  { key: 0, value: 3 }
+]);
+expect('[1, [2], 3]', { depth: 5 }, []);
+
+// Tokens.
+expect('{"a": [1, "x", {}], "b": null}', { tokens: true }, [
+  { type: 'startObject', value: undefined },
+  { type: 'key', value: 'a' },
+  { type: 'startArray', value: undefined },
+  { type: 'value', value: 1 },
+  { type: 'value', value: 'x' },
+  { type: 'startObject', value: undefined },
+  { type: 'endObject', value: undefined },
+  { type: 'endArray', value: undefined },
+  { type: 'key', value: 'b' },
+  { type: 'value', value: null },
+  { type: 'endObject', value: undefined }
+]);
+
+// Syntax errors.
+expectError('[1,]', 'Unexpected token ] in JSON at position 3');
+expectError('{"a" 1}', 'Unexpected token 1 in JSON at position 5');
+expectError('[1}', 'Unexpected token } in JSON at position 2');
+expectError('{,}', 'Unexpected token , in JSON at position 1');
+expectError('{"a":1,}', 'Unexpected token } in JSON at position 7');
+expectError('nul!', 'Unexpected token ! in JSON at position 3');
+expectError('"a\nb"', 'Unexpected byte 0x0a in JSON at position 2');
+expectError('"\\x"', 'Unexpected token x in JSON at position 2');
+expectError('"\\u12G4"', 'Unexpected token G in JSON at position 5');
+expectError('01', 'Invalid number in JSON');
+expectError('1.', 'Invalid number in JSON');
+expectError('-', 'Invalid number in JSON');
+expectError('[1e+]', 'Invalid number in JSON');
+expectError('"abc', 'Unexpected end of JSON input');
+expectError('[1, 2', 'Unexpected end of JSON input');
+expectError('{"a":1', 'Unexpected end of JSON input');
+expectError('tr', 'Unexpected end of JSON input');
+
+assert.throws(() => new json_stream.Parser({ depth: -1 }), TypeError);
+assert.throws(() => new json_stream.Parser({ depth: 1.5 }), TypeError);
+assert.throws(() => new json_stream.Parser({ depth: '1' }), TypeError);
+assert(json_stream.createParser() instanceof json_stream.Parser);
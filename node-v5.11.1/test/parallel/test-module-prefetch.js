@@ -0,0 +1,72 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawnSync = require('child_process').spawnSync;
+
+common.refreshTmpDir();
+
+const manifest = path.join(common.tmpDir, 'manifest.txt');
+const main = path.join(common.tmpDir, 'main.js');
+const bom = path.join(common.tmpDir, 'bom.js');
+const shebang = path.join(common.tmpDir, 'shebang.js');
+const broken = path.join(common.tmpDir, 'broken.js');
+
+fs.writeFileSync(main, [
+  'console.log(require("./bom.js"));',
+  'console.log(require("./shebang.js"));',
+  'if (process.env.LOAD_BROKEN) require("./broken.js");'
+].join('\n'));
+fs.writeFileSync(bom, '\ufeffmodule.exports = "bom " + __filename.length;');
+fs.writeFileSync(shebang, '#!/usr/bin/env node\n' +
+                          'module.exports = "shebang " + new Error().stack' +
+                          '.split("\\n")[1].match(/:(\\d+):\\d+\\)$/)[1];');
+
+function run(env) {
+  const child = spawnSync(process.execPath,
+                          ['--prefetch-modules=' + manifest, main],
+                          { env: Object.assign({}, process.env, env) });
+  return {
+    status: child.status,
+    stdout: child.stdout.toString(),
+    stderr: child.stderr.toString()
+  };
+}
+
+const expected = 'bom ' + bom.length + '\nshebang 2\n';
+
+// Without a manifest nothing is prefetched but one is written.
+let result = run({ NODE_DEBUG: 'module' });
+assert.strictEqual(result.status, 0);
+assert.strictEqual(result.stdout, expected);
+assert(!/prefetched/.test(result.stderr));
+assert.strictEqual(fs.readFileSync(manifest, 'utf8'),
+                   [main, bom, shebang].join('\n') + '\n');
+// It was written to a temporary file that was renamed to the manifest.
+assert.deepStrictEqual(fs.readdirSync(common.tmpDir).filter((name) => {
+  return name.startsWith('manifest.txt.');
+}), []);
+
+// The second run finds the modules from the first run ready to compile.
+result = run({ NODE_DEBUG: 'module' });
+assert.strictEqual(result.status, 0);
+assert.strictEqual(result.stdout, expected);
+[main, bom, shebang].forEach(function(filename) {
+  assert(result.stderr.includes('prefetched ' + filename), result.stderr);
+});
+
+// Files that fail to parse are reported by the regular loader.
+fs.writeFileSync(broken, '\n\nvar;');
+fs.appendFileSync(manifest, broken + '\n');
+result = run({ LOAD_BROKEN: '1' });
+assert.notStrictEqual(result.status, 0);
+assert.strictEqual(result.stdout, expected);
+assert(result.stderr.includes(broken + ':3'), result.stderr);
+assert(/SyntaxError/.test(result.stderr), result.stderr);
+
+// Files that disappeared are loaded, or not, as usual.
+fs.unlinkSync(bom);
+result = run({});
+assert.notStrictEqual(result.status, 0);
+assert(/Cannot find module '\.\/bom\.js'/.test(result.stderr), result.stderr);
@@ -0,0 +1,75 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+if (process.platform !== 'linux') {
+  console.log('1..0 # Skipped: TCP_CORK is only used on Linux');
+  return;
+}
+
+const server = net.createServer(function(conn) {
+  conn.resume();
+});
+
+server.listen(common.PORT, common.mustCall(function() {
+  let pending = 3;
+  function done() {
+    if (--pending === 0)
+      server.close();
+  }
+
+  // Small writes in the same tick go out together.
+  const a = net.connect(common.PORT).setNoDelay(true).setAutoCork(true, 1e6);
+  a.on('connect', common.mustCall(function() {
+    for (let i = 0; i < 10; i++)
+      a.write('x');
+    let stats = a.getWriteStats();
+    assert.strictEqual(stats.writes, 10);
+    assert.strictEqual(stats.batches, 0);
+    // The cork is released before the event loop waits for I/O again.
+    setImmediate(function() {
+      setImmediate(common.mustCall(function() {
+        stats = a.getWriteStats();
+        assert.strictEqual(stats.batches, 1);
+        if (stats.segments !== undefined)
+          assert(stats.segments < stats.writes, stats.segments + ' segments');
+        a.end();
+        done();
+      }));
+    });
+  }));
+
+  // uncork() marks the end of a message.
+  const b = net.connect(common.PORT).setAutoCork(true, 1e6);
+  b.on('connect', common.mustCall(function() {
+    b.cork();
+    b.write('a');
+    b.write('b');
+    assert.strictEqual(b.getWriteStats().writes, 0);
+    b.uncork();
+    assert.deepStrictEqual(
+        [b.getWriteStats().writes, b.getWriteStats().batches], [1, 1]);
+    b.end();
+    done();
+  }));
+
+  // With a budget of 0 every write is sent right away.
+  const c = net.connect(common.PORT).setAutoCork(true, 0);
+  c.on('connect', common.mustCall(function() {
+    c.write('a');
+    c.write('b');
+    assert.deepStrictEqual(
+        [c.getWriteStats().writes, c.getWriteStats().batches], [2, 2]);
+    c.setAutoCork(false);
+    c.write('c');
+    assert.deepStrictEqual(
+        [c.getWriteStats().writes, c.getWriteStats().batches], [3, 2]);
+    c.end();
+    done();
+  }));
+}));
+
+assert.throws(function() {
+  new net.Socket().setAutoCork(true, -1);
+}, /^TypeError: budget must be a non-negative number$/);
@@ -0,0 +1,177 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+const chunk = new Buffer(64 * 1024);
+chunk.fill('x');
+const total = 64 * chunk.length;
+
+// Accepts one connection on `server` and pipes it natively into a new
+// connection to `target`, then calls `cb` with both sockets.
+function relay(server, target, cb) {
+  server.once('connection', function(inbound) {
+    const outbound = net.connect(target, function() {
+      const ret = inbound.pipe(outbound, { native: true });
+      assert.strictEqual(ret, outbound);
+      assert(inbound._nativePipe, 'native pipe was not used');
+      cb(inbound, outbound);
+    });
+  });
+}
+
+function send(target, size, cb) {
+  const client = net.connect(target, function() {
+    let left = size;
+    (function write() {
+      while (left > 0) {
+        left -= chunk.length;
+        if (!client.write(chunk))
+          return client.once('drain', write);
+      }
+      client.end();
+    })();
+  });
+  if (cb) cb(client);
+  return client;
+}
+
+// Everything arrives, then the end is passed on.
+{
+  const sink = net.createServer(common.mustCall(function(socket) {
+    let received = 0;
+    socket.on('data', function(data) {
+      received += data.length;
+    });
+    socket.on('end', common.mustCall(function() {
+      assert.strictEqual(received, total);
+      socket.end();
+      sink.close();
+    }));
+  }));
+
+  const front = net.createServer({ pauseOnConnect: true });
+  sink.listen(0, function() {
+    front.listen(0, function() {
+      relay(front, sink.address().port, function(inbound, outbound) {
+        outbound.on('unpipe', common.mustCall(function(src) {
+          assert.strictEqual(src, inbound);
+          assert.strictEqual(inbound._nativePipe, null);
+        }));
+        inbound.on('end', common.mustCall(function() {
+          front.close();
+        }));
+      });
+      send(this.address().port, total);
+    });
+  });
+}
+
+// The same through a unix domain socket, which copies instead of splicing.
+{
+  common.refreshTmpDir();
+  const sink = net.createServer(common.mustCall(function(socket) {
+    let received = 0;
+    socket.on('data', function(data) {
+      received += data.length;
+    });
+    socket.on('end', common.mustCall(function() {
+      assert.strictEqual(received, total);
+      sink.close();
+    }));
+  }));
+
+  const front = net.createServer({ pauseOnConnect: true });
+  sink.listen(common.PIPE, function() {
+    front.listen(0, function() {
+      relay(front, common.PIPE, common.mustCall(function() {
+        front.close();
+      }));
+      send(this.address().port, total);
+    });
+  });
+}
+
+// Destroying the destination stops the pipe, and the source can be read
+// from JS land again.
+{
+  let paused;
+  const sink = net.createServer(function(socket) {
+    // Doesn't read, so that the pipe has to wait for the sink.
+    paused = socket;
+    socket.pause();
+    socket.on('error', function() {});
+  });
+
+  const front = net.createServer({ pauseOnConnect: true });
+  sink.listen(0, function() {
+    front.listen(0, function() {
+      relay(front, sink.address().port, function(inbound, outbound) {
+        setTimeout(function() {
+          outbound.destroy();
+          assert.strictEqual(inbound._nativePipe, null);
+          assert.strictEqual(inbound.isPaused(), true);
+          inbound.on('data', function() {});
+          inbound.resume();
+          inbound.on('end', common.mustCall(function() {
+            paused.destroy();
+            front.close();
+            sink.close();
+          }));
+        }, 100);
+      });
+      send(this.address().port, total, function(client) {
+        client.on('error', function() {});
+      });
+    });
+  });
+}
+
+// Sockets that aren't connected use the JS pipe.
+{
+  const a = new net.Socket();
+  const b = new net.Socket();
+  a.pipe(b, { native: true });
+  assert.strictEqual(a._nativePipe, undefined);
+  assert.strictEqual(a._readableState.pipesCount, 1);
+  a.unpipe(b);
+}
+
+// Writes to the destination while the pipe runs arrive in one piece, even
+// when libuv can only write part of them at once.
+{
+  const big = new Buffer(8 * 1024 * 1024);
+  big.fill('b');
+
+  const sink = net.createServer(common.mustCall(function(socket) {
+    let received = 0;
+    let runs = 0;
+    let last = 0;
+    socket.on('data', function(data) {
+      received += data.length;
+      for (let i = 0; i < data.length; i++) {
+        if (data[i] === 0x62 && last !== 0x62)
+          runs++;
+        last = data[i];
+      }
+    });
+    socket.on('end', common.mustCall(function() {
+      assert.strictEqual(received, total + big.length);
+      assert.strictEqual(runs, 1);
+      sink.close();
+    }));
+  }));
+
+  const front = net.createServer({ pauseOnConnect: true });
+  sink.listen(0, function() {
+    front.listen(0, function() {
+      relay(front, sink.address().port, function(inbound, outbound) {
+        outbound.write(big);
+        inbound.on('end', common.mustCall(function() {
+          front.close();
+        }));
+      });
+      send(this.address().port, total);
+    });
+  });
+}
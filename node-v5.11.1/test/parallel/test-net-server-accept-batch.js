@@ -0,0 +1,63 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const net = require('net');
+
+if (common.isWindows) {
+  console.log('1..0 # Skipped: connections are accepted one at a time');
+  return;
+}
+
+const CLIENTS = 10;
+
+function connectAll(port, cb) {
+  let closed = 0;
+  for (let i = 0; i < CLIENTS; i++) {
+    net.connect(port).on('error', function() {}).on('close', function() {
+      if (++closed === CLIENTS)
+        cb();
+    }).resume();
+  }
+}
+
+// Connections that come in together are handed to JS land together.
+{
+  const batches = [];
+  const server = net.createServer({
+    acceptBatch: 16,
+    noDelay: true,
+    keepAlive: true,
+    keepAliveInitialDelay: 5000
+  }, common.mustCall(function(conn) {
+    assert.strictEqual(conn.server, server);
+    conn.end();
+  }, CLIENTS));
+
+  server.listen(0, common.mustCall(function() {
+    const onconnections = server._handle.onconnections;
+    server._handle.onconnections = function(handles) {
+      batches.push(handles.length);
+      return onconnections.apply(this, arguments);
+    };
+    connectAll(server.address().port, common.mustCall(function() {
+      assert.strictEqual(batches.reduce((a, b) => a + b, 0), CLIENTS);
+      assert(batches.length < CLIENTS, batches);
+      server.close();
+    }));
+  }));
+}
+
+// maxConnections still applies within a batch.
+{
+  const server = net.createServer({ acceptBatch: 16 });
+  server.maxConnections = 5;
+  server.on('connection', common.mustCall(function(conn) {
+    conn.end();
+  }, 5));
+
+  server.listen(0, common.mustCall(function() {
+    connectAll(server.address().port, common.mustCall(function() {
+      server.close();
+    }));
+  }));
+}
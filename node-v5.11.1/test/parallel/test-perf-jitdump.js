@@ -0,0 +1,162 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const spawnSync = require('child_process').spawnSync;
+
+if (process.platform !== 'linux') {
+  console.log('1..0 # Skipped: perf map and jitdump output are Linux only');
+  return;
+}
+
+const kCodeLoad = 0;
+const kCodeMove = 1;
+const kCodeDebugInfo = 2;
+const kCodeClose = 3;
+
+const le = require('os').endianness() === 'LE';
+
+function readJitDump(file, pid) {
+  const buf = fs.readFileSync(file);
+  function u32(offset) {
+    return le ? buf.readUInt32LE(offset) : buf.readUInt32BE(offset);
+  }
+  function u64(offset) {
+    const low = u32(offset + (le ? 0 : 4));
+    const high = u32(offset + (le ? 4 : 0));
+    return high * 0x100000000 + low;
+  }
+  function cstring(offset) {
+    const end = buf.indexOf(0, offset);
+    assert(end !== -1);
+    return { value: buf.toString('utf8', offset, end), end: end + 1 };
+  }
+
+  assert.strictEqual(u32(0), 0x4A695444);
+  assert.strictEqual(u32(4), 1);
+  const headerSize = u32(8);
+  assert.strictEqual(headerSize, 40);
+  assert.strictEqual(u32(20), pid);
+
+  const result = { loads: new Map(), moves: 0, lines: [], closed: false };
+  var lastTimestamp = 0;
+  var offset = headerSize;
+  while (offset < buf.length) {
+    const id = u32(offset);
+    const size = u32(offset + 4);
+    const timestamp = u64(offset + 8);
+    assert(size >= 16 && offset + size <= buf.length, 'record at ' + offset);
+    assert(timestamp >= lastTimestamp);
+    lastTimestamp = timestamp;
+
+    if (id === kCodeLoad) {
+      assert.strictEqual(u32(offset + 16), pid);
+      const codeSize = u64(offset + 40);
+      const index = u64(offset + 48);
+      const name = cstring(offset + 56);
+      assert.strictEqual(name.end + codeSize, offset + size);
+      result.loads.set(index, name.value);
+    } else if (id === kCodeMove) {
+      assert(result.loads.has(u64(offset + 56)));
+      result.moves += 1;
+    } else if (id === kCodeDebugInfo) {
+      const count = u64(offset + 24);
+      var entry = offset + 32;
+      for (var i = 0; i < count; i++) {
+        const line = u32(entry + 8);
+        const filename = cstring(entry + 16);
+        result.lines.push({ filename: filename.value, line: line });
+        entry = filename.end;
+      }
+      assert.strictEqual(entry, offset + size);
+    } else if (id === kCodeClose) {
+      result.closed = true;
+    }
+    offset += size;
+  }
+  return result;
+}
+
+// The child runs one function hot enough to be optimized, so it shows up in
+// the outputs with its source lines.
+const script = `
+function perfJitdumpHotFunction(n) {
+  var sum = 0;
+  for (var i = 0; i < n; i++)
+    sum += i % 7;
+  return sum;
+}
+for (var i = 0; i < 500; i++)
+  perfJitdumpHotFunction(10000);
+`;
+
+common.refreshTmpDir();
+const scriptFile = path.join(common.tmpDir, 'hot.js');
+fs.writeFileSync(scriptFile, script);
+
+function run(args) {
+  const child = spawnSync(process.execPath, args.concat(scriptFile));
+  assert.strictEqual(child.status, 0, child.stderr.toString());
+  return child.pid;
+}
+
+{
+  const pid = run(['--perf-map', '--perf-jitdump=' + common.tmpDir]);
+
+  const mapFile = `/tmp/perf-${pid}.map`;
+  const map = fs.readFileSync(mapFile, 'utf8');
+  fs.unlinkSync(mapFile);
+  map.trim().split('\n').forEach((line) => {
+    assert(/^[0-9a-f]+ [0-9a-f]+ ./.test(line), line);
+  });
+  assert(map.includes('perfJitdumpHotFunction'));
+
+  const dir = path.join(common.tmpDir, `node-jit-${pid}-0`);
+  const dump = readJitDump(path.join(dir, `jit-${pid}.dump`), pid);
+  const names = Array.from(dump.loads.values());
+  assert(names.some((name) => name.includes('perfJitdumpHotFunction')));
+  assert(dump.lines.some((entry) => {
+    return entry.filename === scriptFile && entry.line >= 3 && entry.line <= 5;
+  }));
+  assert.strictEqual(dump.closed, false);
+}
+
+// With a tiny size limit, the jitdump file is rotated and only the last two
+// generations are kept.  Every generation is complete on its own.
+{
+  const manyFunctions = 'for (var i = 0; i < 5000; i++) ' +
+                        'new Function("return " + i)(); gc();';
+  const pid = run(['--perf-jitdump=' + common.tmpDir, '--perf-max-size=1',
+                   '--always-compact', '--expose-gc', '-e', manyFunctions]);
+  const generation = (name) => +name.slice(name.lastIndexOf('-') + 1);
+  const dirs = fs.readdirSync(common.tmpDir).filter((name) => {
+    return name.startsWith(`node-jit-${pid}-`);
+  }).sort((a, b) => generation(a) - generation(b));
+  assert(dirs.length >= 1 && dirs.length <= 2, dirs);
+  const last = dirs.pop();
+  assert(generation(last) > 0, last);
+  dirs.forEach((dir) => {
+    const dump = readJitDump(path.join(common.tmpDir, dir, `jit-${pid}.dump`),
+                             pid);
+    assert.strictEqual(dump.closed, true);
+  });
+  const dump = readJitDump(path.join(common.tmpDir, last, `jit-${pid}.dump`),
+                           pid);
+  assert(dump.loads.size > 0);
+}
+
+// Node refuses to start rather than write somewhere else than asked.
+{
+  const tooLong = path.join(common.tmpDir, 'x'.repeat(5000));
+  let child = spawnSync(process.execPath,
+                        ['--perf-jitdump=' + tooLong, '-e', '0']);
+  assert.strictEqual(child.status, 9);
+  assert(/jitdump directory name too long/.test(child.stderr.toString()));
+
+  const missing = path.join(common.tmpDir, 'missing');
+  child = spawnSync(process.execPath,
+                    ['--perf-jitdump=' + missing, '-e', '0']);
+  assert.strictEqual(child.status, 9);
+  assert(/cannot create/.test(child.stderr.toString()));
+}
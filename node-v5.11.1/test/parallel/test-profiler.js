@@ -0,0 +1,91 @@
+'use strict';
+// Flags: --experimental-profiler
+const common = require('../common');
+const assert = require('assert');
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const profiler = require('profiler');
+
+assert.throws(() => profiler.stop(), /not running/);
+assert.throws(() => profiler.start({ interval: 0 }), TypeError);
+assert.throws(() => profiler.start({ interval: 1.5 }), TypeError);
+assert.throws(() => profiler.start({ interval: '1000' }), TypeError);
+assert.strictEqual(profiler.isProfiling(), false);
+
+function spinInProfiledFunction(ms) {
+  const end = Date.now() + ms;
+  var n = 0;
+  while (Date.now() < end)
+    n += Math.sqrt(n + 1);
+  return n;
+}
+
+profiler.start({ interval: 1000 });
+assert.strictEqual(profiler.isProfiling(), true);
+assert.throws(() => profiler.start(), /already running/);
+spinInProfiledFunction(200);
+const profile = profiler.stop();
+assert.strictEqual(profiler.isProfiling(), false);
+
+assert.strictEqual(profile.interval, 1000);
+assert(profile.duration >= 200, profile.duration);
+assert(profile.samples > 0);
+assert.strictEqual(profile.nodes[0].parent, -1);
+profile.nodes.slice(1).forEach((node, index) => {
+  assert(node.parent >= 0 && node.parent <= index, node);
+});
+
+const spin = profile.nodes.filter((node) => {
+  return node.name === 'spinInProfiledFunction';
+});
+assert.strictEqual(spin.length, 1);
+assert.strictEqual(spin[0].url, __filename);
+assert.strictEqual(spin[0].native, false);
+assert(spin[0].hitCount > 0);
+
+const collapsed = profile.toCollapsed();
+const lines = collapsed.trim().split('\n');
+var total = 0;
+lines.forEach((line) => {
+  const match = line.match(/^[^;\n]+(;[^;\n]+)* (\d+)$/);
+  assert(match, line);
+  total += +match[2];
+});
+assert.strictEqual(total, profile.samples);
+const spinLabel = `spinInProfiledFunction (${__filename}:16)`;
+assert(collapsed.includes(spinLabel), collapsed);
+
+const pprof = profile.toPprof();
+assert(pprof instanceof Buffer);
+// The first field is a sample_type message.
+assert.strictEqual(pprof[0], 1 << 3 | 2);
+assert(pprof.includes('spinInProfiledFunction'));
+assert(pprof.includes('nanoseconds'));
+
+// The profiler can run again after it was stopped.
+profiler.start();
+profiler.stop();
+
+if (common.isWindows) {
+  console.log('1..0 # Skipped: no SIGUSR2 on Windows');
+  return;
+}
+
+common.refreshTmpDir();
+// The profiler's timer does not keep the process alive.
+const keepAlive = setInterval(() => {}, 1000);
+const unwatch = profiler.watchSignal({
+  duration: 100,
+  directory: common.tmpDir
+}, common.mustCall((err, filename) => {
+  assert.ifError(err);
+  unwatch();
+  clearInterval(keepAlive);
+  assert.strictEqual(path.dirname(filename), common.tmpDir);
+  assert(/^profile-\d+-\d+\.pb\.gz$/.test(path.basename(filename)), filename);
+  const data = zlib.gunzipSync(fs.readFileSync(filename));
+  assert.strictEqual(data[0], 1 << 3 | 2);
+  assert.strictEqual(profiler.isProfiling(), false);
+}));
+process.kill(process.pid, 'SIGUSR2');
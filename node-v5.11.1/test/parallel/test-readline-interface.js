@@ -17,7 +17,7 @@ FakeInput.prototype.end = function() {};
 function isWarned(emitter) {
   for (var name in emitter) {
     var listeners = emitter[name];
-    if (listeners.warned) return true;
+    if (listeners && listeners.warned) return true;
   }
   return false;
 }
@@ -0,0 +1,84 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const LineSplitter = require('readline').LineSplitter;
+
+function split(chunks, options, cb) {
+  const splitter = new LineSplitter(options);
+  const lines = [];
+  splitter.on('data', function(line) {
+    lines.push(line);
+  });
+  splitter.on('end', common.mustCall(function() {
+    cb(lines);
+  }));
+  chunks.forEach(function(chunk) {
+    splitter.write(new Buffer(chunk));
+  });
+  splitter.end();
+}
+
+// All kinds of line endings, and a last line without one.
+split(['a\nb\r\nc\rd\n\ne'], {}, function(lines) {
+  assert.deepStrictEqual(lines, ['a', 'b', 'c', 'd', '', 'e']);
+});
+
+// Lines and \r\n split across chunks.
+split(['ab', 'c\r', '\nd', 'e\r', 'f\n', '', 'g'], {}, function(lines) {
+  assert.deepStrictEqual(lines, ['abc', 'de', 'f', 'g']);
+});
+
+// \r at the end of a chunk ends the line right away.
+{
+  const splitter = new LineSplitter();
+  const lines = [];
+  splitter.on('data', function(line) {
+    lines.push(line);
+  });
+  splitter.write(new Buffer('a\r'));
+  setImmediate(common.mustCall(function() {
+    assert.deepStrictEqual(lines, ['a']);
+    splitter.end(new Buffer('\nb\n'));
+    splitter.on('end', common.mustCall(function() {
+      assert.deepStrictEqual(lines, ['a', 'b']);
+    }));
+  }));
+}
+
+// Multibyte characters split across chunks.
+{
+  const euro = new Buffer('€\n');
+  split([euro.slice(0, 1), euro.slice(1, 2), euro.slice(2)], {},
+        function(lines) {
+          assert.deepStrictEqual(lines, ['€']);
+        });
+}
+
+// More lines in one chunk than the scanner looks for at once.
+{
+  const many = [];
+  for (let i = 0; i < 5000; i++)
+    many.push(String(i));
+  split([many.join('\n') + '\n'], {}, function(lines) {
+    assert.deepStrictEqual(lines, many);
+  });
+}
+
+// Buffers instead of strings.
+split(['x\ny', 'z\n'], { encoding: null }, function(lines) {
+  assert(lines.every(Buffer.isBuffer));
+  assert.deepStrictEqual(lines.map(String), ['x', 'yz']);
+});
+
+// Batches of lines.
+{
+  const splitter = new LineSplitter({ batch: true });
+  splitter.on('datav', common.mustCall(function(lines) {
+    assert.deepStrictEqual(lines, ['1', '2', '3']);
+  }));
+  splitter.end(new Buffer('1\n2\n3'));
+}
+
+assert.throws(function() {
+  new LineSplitter({ encoding: 'ucs2' });
+}, /^TypeError: Unsupported encoding: ucs2$/);
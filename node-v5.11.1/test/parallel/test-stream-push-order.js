@@ -26,7 +26,6 @@ s.read(0);
 // ACTUALLY [1, 3, 5, 6, 4, 2]
 
 process.on('exit', function() {
-  assert.deepEqual(s._readableState.buffer,
-                   ['1', '2', '3', '4', '5', '6']);
+  assert.equal(s._readableState.buffer.join(','), '1,2,3,4,5,6');
   console.log('ok');
 });
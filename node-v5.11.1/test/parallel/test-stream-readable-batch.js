@@ -0,0 +1,109 @@
+'use strict';
+const common = require('../common');
+const assert = require('assert');
+const stream = require('stream');
+
+// Chunks pushed during one event loop iteration arrive as one 'datav'.
+{
+  const r = new stream.Readable({ batch: true, read: function() {} });
+  const batches = [];
+  r.on('datav', function(chunks) {
+    batches.push(chunks.map(String));
+    if (batches.length === 1) {
+      process.nextTick(function() {
+        r.push('c');
+        r.push('d');
+        r.push(null);
+      });
+    }
+  });
+  r.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(batches, [['a', 'b'], ['c', 'd']]);
+  }));
+  r.push('a');
+  r.push('b');
+}
+
+// Adding a 'datav' listener switches to batch mode, 'data' listeners still
+// get one event per chunk.
+{
+  const r = new stream.Readable({ objectMode: true, read: function() {} });
+  const seen = [];
+  r.on('datav', function(chunks) {
+    seen.push(chunks);
+  });
+  r.on('data', function(chunk) {
+    seen.push(chunk);
+  });
+  r.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(seen, [[1, 2, 3], 1, 2, 3]);
+  }));
+  r.push(1);
+  r.push(2);
+  r.push(3);
+  r.push(null);
+}
+
+// Pausing keeps the chunks buffered until the stream is resumed.
+{
+  const r = new stream.Readable({ batch: true, read: function() {} });
+  const batches = [];
+  r.on('datav', function(chunks) {
+    batches.push(Buffer.concat(chunks).toString());
+    if (batches.length === 1) {
+      r.pause();
+      r.push('c');
+      r.push('d');
+      setTimeout(function() {
+        assert.strictEqual(batches.length, 1);
+        r.resume();
+        r.push(null);
+      }, 10);
+    }
+  });
+  r.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(batches, ['ab', 'cd']);
+  }));
+  r.push('a');
+  r.push('b');
+}
+
+// pipe() writes a batch corked, so the dest's _writev() gets all of it.
+{
+  const r = new stream.Readable({ batch: true, read: function() {} });
+  const w = new stream.Writable();
+  const writes = [];
+  w._write = common.fail;
+  w._writev = function(chunks, cb) {
+    writes.push(chunks.map(function(c) { return c.chunk.toString(); }));
+    cb();
+  };
+  w.on('finish', common.mustCall(function() {
+    assert.deepStrictEqual(writes, [['x', 'y', 'z']]);
+  }));
+  r.pipe(w);
+  r.push('x');
+  r.push('y');
+  r.push('z');
+  r.push(null);
+}
+
+// The readable side of a Transform batches what _transform() pushes.
+{
+  const t = new stream.Transform({
+    batch: true,
+    transform: function(chunk, enc, cb) {
+      cb(null, chunk.toString().toUpperCase());
+    }
+  });
+  const batches = [];
+  t.on('datav', function(chunks) {
+    batches.push(chunks.map(String));
+  });
+  t.on('end', common.mustCall(function() {
+    assert.deepStrictEqual(batches, [['A', 'B', 'C']]);
+  }));
+  t.write('a');
+  t.write('b');
+  t.end('c');
+}
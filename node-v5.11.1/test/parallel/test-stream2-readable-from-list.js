@@ -1,7 +1,16 @@
+// Flags: --expose_internals
 'use strict';
 require('../common');
 var assert = require('assert');
 var fromList = require('_stream_readable')._fromList;
+var BufferList = require('internal/streams/buffer_list');
+
+function bufferListFromArray(arr) {
+  var bl = new BufferList();
+  for (var i = 0; i < arr.length; ++i)
+    bl.push(arr[i]);
+  return bl;
+}
 
 // tiny node-tap lookalike.
 var tests = [];
@@ -39,10 +48,10 @@ process.nextTick(run);
 
 
 test('buffers', function(t) {
-  var list = [ new Buffer('foog'),
-               new Buffer('bark'),
-               new Buffer('bazy'),
-               new Buffer('kuel') ];
+  var list = bufferListFromArray([ new Buffer('foog'),
+                                   new Buffer('bark'),
+                                   new Buffer('bazy'),
+                                   new Buffer('kuel') ]);
 
   // read more than the first element.
   var ret = fromList(6, { buffer: list, length: 16 });
@@ -61,16 +70,16 @@ test('buffers', function(t) {
   t.equal(ret.toString(), 'zykuel');
 
   // all consumed.
-  t.same(list, []);
+  t.equal(list.length, 0);
 
   t.end();
 });
 
 test('strings', function(t) {
-  var list = [ 'foog',
-               'bark',
-               'bazy',
-               'kuel' ];
+  var list = bufferListFromArray([ 'foog',
+                                   'bark',
+                                   'bazy',
+                                   'kuel' ]);
 
   // read more than the first element.
   var ret = fromList(6, { buffer: list, length: 16, decoder: true });
@@ -89,7 +98,7 @@ test('strings', function(t) {
   t.equal(ret, 'zykuel');
 
   // all consumed.
-  t.same(list, []);
+  t.equal(list.length, 0);
 
   t.end();
 });
@@ -47,7 +47,7 @@ assert.equal(dest.listeners('finish').length, 0);
 
 console.error(src._readableState);
 process.on('exit', function() {
-  src._readableState.buffer.length = 0;
+  src._readableState.buffer.clear();
   console.error(src._readableState);
   assert(src._readableState.length >= src._readableState.highWaterMark);
   console.log('ok');
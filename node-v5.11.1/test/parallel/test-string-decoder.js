@@ -23,14 +23,42 @@ test(
   '\u02e4\u0064\u12e4\u0030\u3045'
 );
 
+// Incomplete characters followed by something else decode like toString()
+// decodes the whole buffer.
+[
+  [0xE1, 0x8B, 0x61],
+  [0xF0, 0x61, 0xE2, 0x62],
+  [0xC3, 0xC3, 0xBC]
+].forEach(function(bytes) {
+  var buf = new Buffer(bytes);
+  test('utf-8', buf, buf.toString('utf-8'));
+});
+
 // UCS-2
 test('ucs2', new Buffer('ababc', 'ucs2'), 'ababc');
 
 // UTF-16LE
 test('ucs2', new Buffer('3DD84DDC', 'hex'),  '\ud83d\udc4d'); // thumbs up
 
+// Base64
+test('base64', new Buffer('abcdefg'), 'YWJjZGVm');
+
 console.log(' crayon!');
 
+// end() returns what is left of an incomplete character.
+var decoder = new StringDecoder('utf8');
+assert.strictEqual(decoder.write(new Buffer('E282', 'hex')), '');
+assert.strictEqual(decoder.charBuffer.toString('hex'), 'e282');
+assert.strictEqual(decoder.end(), new Buffer('E282', 'hex').toString());
+assert.strictEqual(decoder.charBuffer.length, 0);
+
+decoder = new StringDecoder('base64');
+assert.strictEqual(decoder.write(new Buffer('abcd')), 'YWJj');
+assert.strictEqual(decoder.end(), 'ZA==');
+
+// Strings are passed through.
+assert.strictEqual(new StringDecoder('utf8').write('abc'), 'abc');
+
 // test verifies that StringDecoder will correctly decode the given input
 // buffer with the given encoding to the expected output. It will attempt all
 // possible ways to write() the input buffer, see writeSequences(). The
@@ -0,0 +1,61 @@
+'use strict';
+// Flags: --gc-idle-time=5
+
+require('../common');
+const assert = require('assert');
+const v8 = require('v8');
+
+const keys = [
+  'completed',
+  'idle_budget_ms',
+  'idle_time_used_ms',
+  'notifications',
+  'skipped'];
+assert.deepEqual(Object.keys(v8.getGCIdleStatistics()).sort(), keys);
+
+// Produce some garbage and give the event loop a few idle gaps between
+// timers so V8 gets offered the time to clean it up.
+let garbage = [];
+let ticks = 0;
+
+setTimeout(function tick() {
+  for (let i = 0; i < 1e4; i++)
+    garbage.push({ i: i });
+  garbage = [];
+
+  if (++ticks < 10)
+    return setTimeout(tick, 20);
+
+  const s = v8.getGCIdleStatistics();
+  keys.forEach(function(key) {
+    assert.strictEqual(typeof s[key], 'number');
+    assert(s[key] >= 0);
+  });
+  assert(s.notifications > 0);
+  assert(s.completed <= s.notifications);
+  // Each notification is offered at most --gc-idle-time milliseconds.
+  assert(s.idle_budget_ms <= s.notifications * 5);
+}, 20);
+
+// A socket that is ready to be read is pending work too.  With no timers
+// armed, each round trip of the ping-pong below passes through the loop
+// while the other side's data is already waiting.
+const net = require('net');
+const before = v8.getGCIdleStatistics().skipped;
+let rounds = 0;
+const server = net.createServer(function(socket) {
+  socket.on('data', function(data) {
+    socket.write(data);
+  });
+}).listen(0, function() {
+  const client = net.connect(this.address().port, function() {
+    client.write('x');
+  });
+  client.on('data', function() {
+    if (++rounds < 100)
+      return client.write('x');
+    client.end();
+    server.close();
+    assert(v8.getGCIdleStatistics().skipped > before);
+  });
+});
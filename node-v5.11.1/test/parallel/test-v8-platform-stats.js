@@ -0,0 +1,60 @@
+'use strict';
+// Flags: --v8-pool-size=2 --expose-gc
+
+require('../common');
+const assert = require('assert');
+const v8 = require('v8');
+
+const taskKeys = [
+  'completed',
+  'cpu_time_ms',
+  'max_wait_time_ms',
+  'posted',
+  'queued',
+  'wait_time_ms'];
+const taskTypes = [
+  'background',
+  'background_long_running',
+  'foreground',
+  'foreground_delayed'];
+
+function check(s) {
+  assert.deepEqual(Object.keys(s).sort(),
+                   ['busy_threads', 'tasks', 'thread_pool_size', 'threads']);
+  assert.strictEqual(s.thread_pool_size, 2);
+  assert(s.threads >= 0 && s.threads <= s.thread_pool_size);
+  assert(s.busy_threads >= 0 && s.busy_threads <= s.threads);
+  assert.deepEqual(Object.keys(s.tasks).sort(), taskTypes);
+  taskTypes.forEach(function(type) {
+    const t = s.tasks[type];
+    assert.deepEqual(Object.keys(t).sort(), taskKeys);
+    taskKeys.forEach(function(key) {
+      assert.strictEqual(typeof t[key], 'number');
+      assert(t[key] >= 0);
+    });
+    // Tasks that are neither queued nor completed are running.
+    assert(t.completed + t.queued <= t.posted);
+    assert(t.max_wait_time_ms <= t.wait_time_ms);
+  });
+}
+
+const before = v8.getPlatformStatistics();
+check(before);
+
+// Full collections sweep concurrently on the pool.
+let garbage = [];
+for (let i = 0; i < 10; i++) {
+  for (let j = 0; j < 1e5; j++)
+    garbage.push({ j: j });
+  garbage = [];
+  global.gc();
+}
+
+setImmediate(function() {
+  const after = v8.getPlatformStatistics();
+  check(after);
+  taskTypes.forEach(function(type) {
+    assert(after.tasks[type].posted >= before.tasks[type].posted);
+    assert(after.tasks[type].completed >= before.tasks[type].completed);
+  });
+});
@@ -0,0 +1,67 @@
+'use strict';
+// Flags: --experimental-worker
+
+const common = require('../common');
+const assert = require('assert');
+const worker_threads = require('worker_threads');
+
+if (!worker_threads.isMainThread) {
+  switch (worker_threads.workerData) {
+    case 'exit':
+      process.on('exit', function(code) {
+        worker_threads.parentPort.postMessage(code);
+      });
+      process.exit(42);
+      break;
+    case 'throw':
+      throw new TypeError('thrown in worker');
+    case 'spin':
+      worker_threads.parentPort.postMessage('spinning');
+      for (;;);
+    case 'process':
+      assert.throws(function() { process.chdir('..'); }, /not supported/);
+      assert.throws(function() { process.umask(0); }, /not supported/);
+      assert.strictEqual(typeof process.umask(), 'number');
+      break;
+  }
+  return;
+}
+
+const exit = new worker_threads.Worker(__filename, { workerData: 'exit' });
+exit.on('message', common.mustCall(function(code) {
+  assert.strictEqual(code, 42);
+}));
+exit.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 42);
+  assert.strictEqual(exit.exitCode, 42);
+  // Messages to a worker that exited are dropped.
+  exit.postMessage('ignored');
+}));
+
+const thrower = new worker_threads.Worker(__filename, { workerData: 'throw' });
+thrower.on('error', common.mustCall(function(er) {
+  assert(er instanceof Error);
+  assert.strictEqual(er.name, 'TypeError');
+  assert.strictEqual(er.message, 'thrown in worker');
+  assert(/test-worker-exit/.test(er.stack));
+}));
+thrower.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 1);
+}));
+
+// terminate() stops a worker that never returns to its event loop.
+const spinner = new worker_threads.Worker(__filename, { workerData: 'spin' });
+spinner.on('message', common.mustCall(function() {
+  spinner.terminate(common.mustCall(function(err, code) {
+    assert.strictEqual(err, null);
+    assert.strictEqual(code, 1);
+  }));
+}));
+
+new worker_threads.Worker(__filename, { workerData: 'process' })
+  .on('exit', common.mustCall(function(code) {
+    assert.strictEqual(code, 0);
+  }));
+
+// An unref()'d worker doesn't keep the process alive.
+new worker_threads.Worker(__filename, { workerData: 'spin' }).unref();
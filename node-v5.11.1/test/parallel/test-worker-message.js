@@ -0,0 +1,86 @@
+'use strict';
+// Flags: --experimental-worker
+
+const common = require('../common');
+const assert = require('assert');
+const worker_threads = require('worker_threads');
+
+if (!worker_threads.isMainThread) {
+  const parentPort = worker_threads.parentPort;
+  assert.deepStrictEqual(worker_threads.workerData.options, { n: 1 });
+  assert.strictEqual(worker_threads.workerData.floats[2], 0.5);
+  parentPort.on('message', function(value) {
+    if (value === 'done')
+      return parentPort.removeAllListeners('message');
+    // Echo everything back, binary data by transfer.
+    const transfer = value && value.transfer ? [value.transfer] : [];
+    parentPort.postMessage(value, transfer);
+  });
+  return;
+}
+
+assert.strictEqual(worker_threads.threadId, 0);
+assert.strictEqual(worker_threads.parentPort, null);
+assert.strictEqual(worker_threads.workerData, undefined);
+
+const floats = new Float64Array([0, 0.25, 0.5]);
+const worker = new worker_threads.Worker(__filename, {
+  workerData: { options: { n: 1 }, floats: floats },
+  transferList: [floats.buffer]
+});
+assert(worker.threadId > 0);
+// Transferred ArrayBuffers are neutered on the sending side.
+assert.strictEqual(floats.length, 0);
+
+const ab = new ArrayBuffer(4);
+new Uint8Array(ab).set([1, 2, 3, 4]);
+const pooled = Buffer.from('pooled');
+const messages = [
+  { value: null },
+  { value: [1, 'two', { three: 3 }] },
+  { value: 'ünicode' },
+  { value: { buf: Buffer.from('abc'), view: new Uint16Array([1, 2]) } },
+  { value: { transfer: ab, view: new DataView(ab, 1, 2) }, neutered: ab },
+  // Pool Buffers are copied even when their ArrayBuffer is listed.
+  { value: { transfer: pooled.buffer, pooled: pooled } }
+];
+
+worker.on('message', common.mustCall(function(value) {
+  const expected = messages.shift();
+  if (expected.neutered) {
+    assert.strictEqual(expected.neutered.byteLength, 0);
+    assert.deepStrictEqual(Array.from(new Uint8Array(value.transfer)),
+                           [1, 2, 3, 4]);
+    assert(value.view instanceof DataView);
+    assert.strictEqual(value.view.buffer, value.transfer);
+    assert.strictEqual(value.view.getUint8(0), 2);
+    assert.strictEqual(value.view.byteLength, 2);
+  } else if (expected.value && expected.value.pooled) {
+    assert.strictEqual(pooled.toString(), 'pooled');
+    assert(value.pooled instanceof Buffer);
+    assert.strictEqual(value.pooled.toString(), 'pooled');
+  } else if (expected.value && expected.value.buf) {
+    assert(value.buf instanceof Buffer);
+    assert.strictEqual(value.buf.toString(), 'abc');
+    assert(value.view instanceof Uint16Array);
+    assert.deepStrictEqual(Array.from(value.view), [1, 2]);
+  } else {
+    assert.deepStrictEqual(value, expected.value);
+  }
+  if (messages.length === 0)
+    worker.postMessage('done');
+}, messages.length));
+
+worker.on('exit', common.mustCall(function(code) {
+  assert.strictEqual(code, 0);
+  assert.strictEqual(messages.length, 0);
+}));
+
+messages.forEach(function(message) {
+  const value = message.value;
+  worker.postMessage(value, value && value.transfer ? [value.transfer] : []);
+});
+
+assert.throws(function() {
+  worker.postMessage(null, [new Uint8Array(1)]);
+}, /transferList may only contain ArrayBuffers/);
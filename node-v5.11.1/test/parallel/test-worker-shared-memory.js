@@ -0,0 +1,93 @@
+'use strict';
+// Flags: --experimental-worker --harmony-sharedarraybuffer --harmony-atomics
+
+const common = require('../common');
+const assert = require('assert');
+const worker_threads = require('worker_threads');
+
+const kIterations = 10000;
+
+if (!worker_threads.isMainThread) {
+  const counters = worker_threads.workerData.counters;
+  const flags = worker_threads.workerData.flags;
+  for (var i = 0; i < kIterations; i++)
+    Atomics.add(counters, 0, 1);
+  // Tell the parent that the counting is done, then block until it says
+  // that it has seen it.
+  Atomics.store(flags, 0, 1);
+  worker_threads.notify(flags, 0);
+  Atomics.futexWait(flags, 1, 0);
+  worker_threads.parentPort.postMessage(Atomics.load(flags, 1));
+  return;
+}
+
+const sab = new SharedArrayBuffer(16);
+const counters = new Int32Array(sab, 0, 2);
+const flags = new Int32Array(sab, 8, 2);
+
+const worker = new worker_threads.Worker(__filename, {
+  workerData: { counters: counters, flags: flags }
+});
+
+// The wait doesn't block the event loop.
+var ticked = false;
+setImmediate(function() {
+  ticked = true;
+});
+
+worker_threads.waitAsync(flags, 0, 0, common.mustCall(function(result) {
+  assert.strictEqual(result, 0);  // Atomics.OK
+  assert(ticked);
+  assert.strictEqual(Atomics.load(flags, 0), 1);
+
+  // Both threads counted into the same memory.
+  for (var i = 0; i < kIterations; i++)
+    Atomics.add(counters, 0, 1);
+  assert.strictEqual(Atomics.load(counters, 0), 2 * kIterations);
+
+  // Wakes the worker from Atomics.futexWait().
+  Atomics.store(flags, 1, 1);
+  wakeWorker();
+}));
+
+// If the worker gets to Atomics.futexWait() after flags[1] is set, the wait
+// returns right away and nobody is there to notify anymore.
+var wakeTimer = null;
+function wakeWorker() {
+  wakeTimer = null;
+  if (worker_threads.notify(flags, 1, 1) === 0)
+    wakeTimer = setTimeout(wakeWorker, 10);  // It isn't waiting yet.
+}
+
+function stopWaking() {
+  if (wakeTimer !== null)
+    clearTimeout(wakeTimer);
+  wakeTimer = null;
+}
+
+worker.on('message', common.mustCall(function(value) {
+  stopWaking();
+  assert.strictEqual(value, 1);
+}));
+worker.on('exit', common.mustCall(function(code) {
+  stopWaking();
+  assert.strictEqual(code, 0);
+}));
+
+// The word doesn't hold the value.
+worker_threads.waitAsync(counters, 1, 42, common.mustCall(function(result) {
+  assert.strictEqual(result, -1);  // Atomics.NOTEQUAL
+}));
+
+// Nobody notifies.
+worker_threads.waitAsync(counters, 1, 0, 10, common.mustCall(function(result) {
+  assert.strictEqual(result, -2);  // Atomics.TIMEDOUT
+}));
+
+// Memory that isn't shared can't be waited on.
+assert.throws(function() {
+  worker_threads.waitAsync(new Int32Array(4), 0, 0, common.fail);
+}, /must be an Int32Array on a SharedArrayBuffer/);
+assert.throws(function() {
+  worker_threads.notify(counters, 2);
+}, /index out of range/);
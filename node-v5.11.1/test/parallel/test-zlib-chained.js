@@ -0,0 +1,108 @@
+'use strict';
+// Checks that the `chained` option and the convenience methods, which use
+// writeChain() on the binding, produce the same data as plain streams.
+
+const common = require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+// Highly compressible, so the output outgrows the first guess at it.
+const zeros = new Buffer(4 * 1024 * 1024).fill(0);
+const text = new Buffer(new Array(20000).join('chained zlib output '));
+const random = new Buffer(100000);
+for (let i = 0; i < random.length; i++)
+  random[i] = (i * 2654435761) >>> 24;
+
+[zeros, text, random].forEach((input) => {
+  const deflated = zlib.deflateSync(input);
+  assert.deepStrictEqual(zlib.inflateSync(deflated), input);
+  assert.deepStrictEqual(zlib.gunzipSync(zlib.gzipSync(input)), input);
+  assert.deepStrictEqual(
+      zlib.inflateRawSync(zlib.deflateRawSync(input)), input);
+  assert.deepStrictEqual(zlib.unzipSync(deflated), input);
+
+  zlib.inflate(deflated, common.mustCall((err, result) => {
+    assert.ifError(err);
+    assert.deepStrictEqual(result, input);
+  }));
+});
+
+// Empty input.
+assert.strictEqual(zlib.inflateSync(zlib.deflateSync(new Buffer(0))).length,
+                   0);
+
+// Truncated input still fails.
+assert.throws(() => {
+  const deflated = zlib.deflateSync(text);
+  zlib.inflateSync(deflated.slice(0, deflated.length - 10));
+}, /unexpected end of file/);
+
+// Corked writes reach the binding as one writeChain() call with many inputs,
+// including a gzip file with two members split across them.
+{
+  const first = zlib.gzipSync(text);
+  const second = zlib.gzipSync(random);
+  const both = Buffer.concat([first, second]);
+  const gunzip = zlib.createGunzip({ chained: true });
+  const output = [];
+  gunzip.on('data', (chunk) => output.push(chunk));
+  gunzip.on('end', common.mustCall(() => {
+    assert.deepStrictEqual(Buffer.concat(output),
+                           Buffer.concat([text, random]));
+  }));
+
+  gunzip.cork();
+  for (let offset = 0; offset < both.length; offset += 1000)
+    gunzip.write(both.slice(offset, offset + 1000));
+  gunzip.uncork();
+  gunzip.end();
+}
+
+// Flushing works like it does without the option, see test-zlib-flush.js.
+{
+  const deflater = zlib.createDeflate({ level: 0, chained: true });
+  const chunk = text.slice(0, 16);
+
+  deflater.write(chunk, common.mustCall(() => {
+    deflater.flush(zlib.Z_NO_FLUSH, common.mustCall(() => {
+      assert.deepStrictEqual(deflater.read(), new Buffer([0x78, 0x01]));
+      deflater.flush(common.mustCall(() => {
+        const bufs = [];
+        let buf;
+        while ((buf = deflater.read()) !== null)
+          bufs.push(buf);
+        assert.deepStrictEqual(Buffer.concat(bufs), Buffer.concat([
+          new Buffer([0x00, 0x10, 0x00, 0xef, 0xff]),
+          chunk,
+          new Buffer([0x00, 0x00, 0x00, 0xff, 0xff])
+        ]));
+      }));
+    }));
+  }));
+}
+
+// A chained stream makes fewer, larger chunks than a plain one.
+{
+  const deflated = zlib.deflateSync(zeros);
+  let plainChunks = 0;
+  let chainedChunks = 0;
+
+  zlib.createInflate()
+    .on('data', () => plainChunks++)
+    .on('end', common.mustCall(() => {
+      assert.strictEqual(plainChunks, zeros.length / (16 * 1024));
+    }))
+    .end(deflated);
+
+  let length = 0;
+  zlib.createInflate({ chained: true })
+    .on('data', (chunk) => {
+      chainedChunks++;
+      length += chunk.length;
+    })
+    .on('end', common.mustCall(() => {
+      assert.strictEqual(length, zeros.length);
+      assert(chainedChunks < 20, `${chainedChunks} chunks`);
+    }))
+    .end(deflated);
+}
@@ -0,0 +1,67 @@
+'use strict';
+// Checks the CRC-32 and Adler-32 trailers written by gzip and deflate
+// against plain JavaScript implementations.  The checksums have vectorized
+// versions for longer inputs, so go over lengths around their block sizes
+// and over unaligned slices.
+
+require('../common');
+const assert = require('assert');
+const zlib = require('zlib');
+
+const crcTable = [];
+for (let n = 0; n < 256; n++) {
+  let c = n;
+  for (let k = 0; k < 8; k++)
+    c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+  crcTable[n] = c >>> 0;
+}
+
+function crc32(buf) {
+  let crc = 0xffffffff;
+  for (let i = 0; i < buf.length; i++)
+    crc = crcTable[(crc ^ buf[i]) & 0xff] ^ (crc >>> 8);
+  return (crc ^ 0xffffffff) >>> 0;
+}
+
+function adler32(buf) {
+  let a = 1;
+  let b = 0;
+  for (let i = 0; i < buf.length; i++) {
+    a = (a + buf[i]) % 65521;
+    b = (b + a) % 65521;
+  }
+  return ((b << 16) | a) >>> 0;
+}
+
+function check(data) {
+  const gzipped = zlib.gzipSync(data);
+  assert.strictEqual(gzipped.readUInt32LE(gzipped.length - 8), crc32(data));
+  assert.strictEqual(gzipped.readUInt32LE(gzipped.length - 4), data.length);
+  assert.deepStrictEqual(zlib.gunzipSync(gzipped), data);
+
+  const deflated = zlib.deflateSync(data);
+  assert.strictEqual(deflated.readUInt32BE(deflated.length - 4),
+                     adler32(data));
+  assert.deepStrictEqual(zlib.inflateSync(deflated), data);
+}
+
+const random = new Buffer(70000);
+let seed = 1;
+for (let i = 0; i < random.length; i++) {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  random[i] = seed >>> 16;
+}
+// All 0xff maximizes the Adler-32 sums between reductions.
+const ones = new Buffer(70000).fill(0xff);
+
+for (let length = 0; length <= 300; length++) {
+  check(random.slice(0, length));
+  check(random.slice(length % 16, length % 16 + length));
+}
+
+[1023, 1024, 5552, 5553, 11104, 65536, 65537, 69999].forEach((length) => {
+  for (let offset = 0; offset < 4; offset++) {
+    check(random.slice(offset, offset + length));
+    check(ones.slice(offset, offset + length));
+  }
+});
@@ -197,6 +197,7 @@ def ReadMacros(lines):
 HEADER_TEMPLATE = """\
 #ifndef node_natives_h
 #define node_natives_h
+#include <stddef.h>
 namespace node {
 
 %(source_lines)s\